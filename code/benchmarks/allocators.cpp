@@ -0,0 +1,104 @@
+#include "benchmark.h"
+
+#include "platform/startup.h"
+
+#include "nstl/fixed_pool.h"
+#include "nstl/frame_arena.h"
+#include "nstl/malloc_allocator.h"
+#include "nstl/monotonic_arena.h"
+#include "nstl/vector.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// The "frame" cases mirror gfx_vk::renderer::draw_indexed: every draw fills a few short-lived arrays of handles
+
+namespace
+{
+    constexpr size_t drawsPerFrame = 1000;
+    constexpr size_t setsPerDraw = 3;
+    constexpr size_t buffersPerDraw = 2;
+
+    uint64_t recordDraws(nstl::any_allocator const& allocator)
+    {
+        uint64_t checksum = 0;
+
+        for (size_t draw = 0; draw < drawsPerFrame; draw++)
+        {
+            nstl::vector<uint64_t> sets{ allocator };
+            sets.reserve(setsPerDraw);
+            for (size_t i = 0; i < setsPerDraw; i++)
+                sets.push_back(draw + i);
+
+            nstl::vector<uint64_t> buffers{ allocator };
+            nstl::vector<uint64_t> offsets{ allocator };
+            buffers.reserve(buffersPerDraw);
+            offsets.reserve(buffersPerDraw);
+            for (size_t i = 0; i < buffersPerDraw; i++)
+            {
+                buffers.push_back(draw * i);
+                offsets.push_back(i * 256);
+            }
+
+            checksum += sets.back() + buffers.back() + offsets.back();
+        }
+
+        return checksum;
+    }
+}
+
+int run(int argc, char** argv)
+{
+    benchmark::options options = benchmark::parse_options(argc, argv);
+
+    size_t const frameCount = options.quick ? 2 : 200;
+    size_t const allocationCount = options.quick ? 1000 : 1000000;
+    size_t const allocationSize = 48;
+
+    benchmark::run(options, "frame: default allocator", frameCount * drawsPerFrame, [&]()
+    {
+        for (size_t frame = 0; frame < frameCount; frame++)
+            benchmark::consume(recordDraws({}));
+    });
+
+    nstl::frame_arena frameArena;
+    benchmark::run(options, "frame: frame_arena", frameCount * drawsPerFrame, [&]()
+    {
+        for (size_t frame = 0; frame < frameCount; frame++)
+        {
+            frameArena.next_frame();
+            benchmark::consume(recordDraws(frameArena.get_allocator()));
+        }
+    });
+
+    nstl::vector<void*> allocations;
+    allocations.resize(allocationCount);
+
+    nstl::malloc_allocator defaultAllocator;
+    benchmark::run(options, "allocate and free: default allocator", allocationCount, [&]()
+    {
+        for (void*& ptr : allocations)
+            ptr = defaultAllocator.allocate(allocationSize, alignof(max_align_t));
+        for (void* ptr : allocations)
+            defaultAllocator.deallocate(ptr);
+    });
+
+    nstl::monotonic_arena arena;
+    benchmark::run(options, "allocate and reset: monotonic_arena", allocationCount, [&]()
+    {
+        for (void*& ptr : allocations)
+            ptr = arena.allocate(allocationSize, alignof(max_align_t));
+        arena.reset();
+    });
+
+    nstl::fixed_pool pool{ allocationSize, alignof(max_align_t), 1024 };
+    benchmark::run(options, "allocate and free: fixed_pool", allocationCount, [&]()
+    {
+        for (void*& ptr : allocations)
+            ptr = pool.allocate();
+        for (void* ptr : allocations)
+            pool.deallocate(ptr);
+    });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+#include "benchmark.h"
+
+#include "editor/assets/AssetDatabase.h"
+#include "editor/assets/Uuid.h"
+
+#include "mt/job_system.h"
+
+#include "fs/directory.h"
+#include "fs/file.h"
+
+#include "path/path.h"
+
+#include "platform/startup.h"
+
+#include "nstl/sprintf.h"
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+#include "nstl/vector.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Cold lookups start a new database, which loads the asset index, compared to rebuilding the index from
+// the metadata file of every asset. Warm lookups read the metadata from the index which is already loaded.
+// The assets are created in data/assets of the working directory and removed afterwards, so it has to be empty
+
+namespace
+{
+    using editor::assets::Uuid;
+
+    nstl::string_view assetsRoot = "data/assets";
+
+    void removeAssets()
+    {
+        for (nstl::string const& name : fs::list_directory(assetsRoot))
+        {
+            nstl::string path = path::join(assetsRoot, name);
+
+            for (nstl::string const& filename : fs::list_directory(path))
+            {
+                [[maybe_unused]] bool removed = fs::remove_file(path::join(path, filename));
+            }
+
+            // The index file
+            if (!fs::remove_directory(path))
+            {
+                [[maybe_unused]] bool removed = fs::remove_file(path);
+            }
+        }
+
+        [[maybe_unused]] bool removed = fs::remove_directory(assetsRoot);
+    }
+
+    nstl::vector<Uuid> createAssets(mt::job_system& jobs, size_t count)
+    {
+        nstl::vector<Uuid> ids;
+        ids.reserve(count);
+
+        editor::assets::AssetDatabase database{ jobs };
+
+        database.beginTransaction();
+        for (size_t i = 0; i < count; i++)
+        {
+            nstl::string name = nstl::sprintf("image %zu", i);
+            nstl::string sourcePath = nstl::sprintf("data/images/image_%zu.png", i);
+
+            Uuid id = database.createAsset(editor::assets::AssetType::Image, name, sourcePath);
+            database.addAssetFile(id, name, "image.png");
+            ids.push_back(id);
+        }
+        database.endTransaction();
+
+        // A directory without metadata, which must not make the index out of date
+        fs::create_directories(path::join(assetsRoot, editor::assets::generateUuid().toString()));
+
+        return ids;
+    }
+}
+
+int run(int argc, char** argv)
+{
+    benchmark::options options = benchmark::parse_options(argc, argv);
+
+    size_t const assetCount = options.quick ? 100 : 10000;
+
+    // The importers aren't used, so the database doesn't need workers
+    mt::job_system jobs{ 0 };
+
+    if (!fs::list_directory(assetsRoot).empty())
+    {
+        printf("'%.*s' isn't empty, run the benchmark in a different directory\n", assetsRoot.slength(), assetsRoot.data());
+        return EXIT_FAILURE;
+    }
+
+    nstl::vector<Uuid> ids = createAssets(jobs, assetCount);
+
+    benchmark::run(options, "cold: load the index", assetCount, [&]()
+    {
+        editor::assets::AssetDatabase database{ jobs };
+        benchmark::consume(database.getImagePath(ids[0]).size());
+    });
+
+    benchmark::run(options, "cold: rebuild the index from the metadata files", assetCount, [&]()
+    {
+        editor::assets::AssetDatabase database{ jobs };
+        database.rebuildIndex();
+        benchmark::consume(database.getImagePath(ids[0]).size());
+    });
+
+    bool isCorrect = true;
+
+    {
+        editor::assets::AssetDatabase database{ jobs };
+
+        benchmark::run(options, "warm: lookup", assetCount, [&]()
+        {
+            for (Uuid const& id : ids)
+                benchmark::consume(database.getImagePath(id).size());
+        });
+
+        for (Uuid const& id : ids)
+            isCorrect &= database.getImagePath(id) == path::join(assetsRoot, id.toString(), "image.png");
+    }
+
+    removeAssets();
+
+    if (!isCorrect)
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,197 @@
+#include "benchmark.h"
+
+#include "editor/assets/AssetData.h"
+#include "editor/assets/AssetDatabase.h"
+#include "editor/assets/AssetFile.h"
+#include "editor/assets/Uuid.h"
+
+#include "common/json-glm.h"
+#include "common/json-nstl.h"
+#include "common/json-tiny-ctti.h"
+
+#include "mt/job_system.h"
+
+#include "fs/directory.h"
+#include "fs/file.h"
+
+#include "path/path.h"
+
+#include "platform/startup.h"
+
+#include "yyjsoncpp/yyjsoncpp.h"
+
+#include "nstl/span.h"
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+#include "nstl/vector.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Compares loading the descriptions of the imported materials, meshes and scenes from the binary asset files
+// with loading them from the JSON files, which the database falls back to for the assets imported before the
+// binary format (loadLegacyJsonFile()) and which are still written with the "assets.export-json" option.
+// The mesh data isn't part of the comparison: the binary path only reads its range, so it's uploaded from the file.
+// The model is imported into data/assets of the working directory and removed afterwards, so it has to be empty
+
+namespace
+{
+    using editor::assets::Uuid;
+
+    nstl::string_view assetsRoot = "data/assets";
+
+    void removeAssets()
+    {
+        for (nstl::string const& name : fs::list_directory(assetsRoot))
+        {
+            nstl::string path = path::join(assetsRoot, name);
+
+            for (nstl::string const& filename : fs::list_directory(path))
+            {
+                [[maybe_unused]] bool removed = fs::remove_file(path::join(path, filename));
+            }
+
+            // The index file
+            if (!fs::remove_directory(path))
+            {
+                [[maybe_unused]] bool removed = fs::remove_file(path);
+            }
+        }
+
+        [[maybe_unused]] bool removed = fs::remove_directory(assetsRoot);
+    }
+
+    // Same as loadLegacyJsonFile() in the database
+    template<typename T>
+    T loadJsonFile(nstl::string_view path)
+    {
+        fs::file f{ path, fs::open_mode::read };
+
+        nstl::string contents;
+        contents.resize(f.size());
+        f.read(contents.data(), contents.size());
+
+        yyjsoncpp::doc doc;
+        if (!doc.read(contents.data(), contents.size()))
+            assert(false);
+
+        return doc.get_root().get<T>();
+    }
+
+    template<typename T>
+    T loadBinaryFile(nstl::string_view path)
+    {
+        T data;
+        [[maybe_unused]] editor::assets::AssetFileReadCode code = editor::assets::readAssetFile(path, data);
+        assert(code == editor::assets::AssetFileReadCode::Success);
+
+        return data;
+    }
+
+    nstl::vector<unsigned char> writeDescription(editor::assets::MaterialData const& data) { return editor::assets::writeAssetFile(data); }
+    nstl::vector<unsigned char> writeDescription(editor::assets::MeshData const& data) { return editor::assets::writeAssetFile(data, {}); }
+    nstl::vector<unsigned char> writeDescription(editor::assets::SceneData const& data) { return editor::assets::writeAssetFile(data); }
+
+    // Picks the assets that have both files
+    nstl::vector<Uuid> filterAssets(nstl::span<Uuid const> ids, nstl::string_view binaryFilename, nstl::string_view jsonFilename)
+    {
+        nstl::vector<Uuid> result;
+
+        for (Uuid const& id : ids)
+        {
+            bool hasBinaryFile = false;
+            bool hasJsonFile = false;
+            for (nstl::string const& filename : fs::list_directory(path::join(assetsRoot, id.toString())))
+            {
+                hasBinaryFile |= filename == binaryFilename;
+                hasJsonFile |= filename == jsonFilename;
+            }
+
+            if (hasBinaryFile && hasJsonFile)
+                result.push_back(id);
+        }
+
+        return result;
+    }
+
+    template<typename T>
+    bool runCase(benchmark::options const& options, char const* name, nstl::span<Uuid const> allIds, nstl::string_view binaryFilename, nstl::string_view jsonFilename)
+    {
+        nstl::vector<Uuid> ids = filterAssets(allIds, binaryFilename, jsonFilename);
+        if (ids.empty())
+        {
+            printf("The model doesn't have any %s assets\n", name);
+            return false;
+        }
+
+        nstl::vector<nstl::string> binaryPaths;
+        nstl::vector<nstl::string> jsonPaths;
+        for (Uuid const& id : ids)
+        {
+            binaryPaths.push_back(path::join(assetsRoot, id.toString(), binaryFilename));
+            jsonPaths.push_back(path::join(assetsRoot, id.toString(), jsonFilename));
+        }
+
+        size_t const passes = options.quick ? 1 : 100;
+
+        char caseName[64];
+        snprintf(caseName, sizeof(caseName), "%s: binary", name);
+        double binaryTime = benchmark::run(options, caseName, passes * ids.size(), [&]()
+        {
+            for (size_t pass = 0; pass < passes; pass++)
+                for (nstl::string const& path : binaryPaths)
+                    benchmark::consume(loadBinaryFile<T>(path).version);
+        });
+
+        snprintf(caseName, sizeof(caseName), "%s: JSON", name);
+        double jsonTime = benchmark::run(options, caseName, passes * ids.size(), [&]()
+        {
+            for (size_t pass = 0; pass < passes; pass++)
+                for (nstl::string const& path : jsonPaths)
+                    benchmark::consume(loadJsonFile<T>(path).version);
+        });
+
+        printf("%-56s %11.2fx\n", "    binary speedup", jsonTime / binaryTime);
+
+        // Both files have to describe the same asset
+        for (size_t i = 0; i < ids.size(); i++)
+            if (writeDescription(loadBinaryFile<T>(binaryPaths[i])) != writeDescription(loadJsonFile<T>(jsonPaths[i])))
+                return false;
+
+        return true;
+    }
+}
+
+int run(int argc, char** argv)
+{
+    benchmark::options options = benchmark::parse_options(argc, argv);
+
+    if (!fs::list_directory(assetsRoot).empty())
+    {
+        printf("'%.*s' isn't empty, run the benchmark in a different directory\n", assetsRoot.slength(), assetsRoot.data());
+        return EXIT_FAILURE;
+    }
+
+    nstl::string modelPath = path::join(MODELS_DIRECTORY, options.quick ? "Duck/glTF/Duck.gltf" : "Sponza/glTF/Sponza.gltf");
+
+    mt::job_system jobs;
+
+    nstl::vector<Uuid> ids;
+    {
+        editor::assets::AssetDatabase database{ jobs };
+        database.setJsonExportEnabled(true);
+        ids = database.importAsset(modelPath);
+    }
+
+    bool isCorrect = true;
+    isCorrect &= runCase<editor::assets::MaterialData>(options, "material", ids, editor::assets::materialAssetFilename, "material.json");
+    isCorrect &= runCase<editor::assets::MeshData>(options, "mesh", ids, editor::assets::meshAssetFilename, "mesh.json");
+    isCorrect &= runCase<editor::assets::SceneData>(options, "scene", ids, editor::assets::sceneAssetFilename, "scene.json");
+
+    removeAssets();
+
+    if (!isCorrect)
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "common/Timer.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// Every benchmark is a separate executable. "--quick" runs each case once with a small size,
+// the tests use it to make sure that the benchmarks keep working
+
+namespace benchmark
+{
+    struct options
+    {
+        bool quick = false;
+    };
+
+    inline options parse_options(int argc, char** argv)
+    {
+        options result;
+
+        for (int i = 1; i < argc; i++)
+            if (strcmp(argv[i], "--quick") == 0)
+                result.quick = true;
+
+        return result;
+    }
+
+    inline size_t get_repetition_count(options const& options)
+    {
+        return options.quick ? 1 : 10;
+    }
+
+    // Keeps the compiler from throwing away the results of the measured code
+    template<typename T>
+    void consume(T const& value)
+    {
+        static T volatile sink{};
+        sink = value;
+    }
+
+    // Runs the function several times and prints the best time per item, e.g. per object or per insertion
+    template<typename Func>
+    double run(options const& options, char const* name, size_t items, Func&& func)
+    {
+        size_t repetitions = get_repetition_count(options);
+
+        double best_time = 0.0;
+        for (size_t i = 0; i < repetitions; i++)
+        {
+            vkc::Timer timer;
+            func();
+            double time = timer.getTime();
+
+            if (i == 0 || time < best_time)
+                best_time = time;
+        }
+
+        double ns_per_item = items > 0 ? best_time * 1e9 / static_cast<double>(items) : 0.0;
+        printf("%-56s %10.2f ns/item %10.3f ms\n", name, ns_per_item, best_time * 1e3);
+
+        return ns_per_item;
+    }
+}
@@ -0,0 +1,128 @@
+#include "benchmark.h"
+
+#include "tglm/bounds.h"
+#include "tglm/camera.h"
+#include "tglm/types.h"
+
+#include "platform/startup.h"
+
+#include "nstl/vector.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Mirrors DemoSceneDrawer: world space bounds are computed once per object, and each pass tests them against its frustum
+
+namespace
+{
+    struct RandomGenerator
+    {
+        uint32_t state = 0x12345678;
+
+        float next(float min, float max)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+
+            return min + (max - min) * static_cast<float>(state & 0xffffff) / static_cast<float>(0xffffff);
+        }
+    };
+
+    tglm::mat4 createTranslation(tglm::vec3 const& position)
+    {
+        tglm::mat4 matrix = tglm::mat4::identity();
+        matrix.data[3][0] = position.x;
+        matrix.data[3][1] = position.y;
+        matrix.data[3][2] = position.z;
+        return matrix;
+    }
+
+    size_t cull(tglm::frustum const& frustum, nstl::vector<tglm::aabb> const& bounds)
+    {
+        size_t visibleCount = 0;
+
+        for (tglm::aabb const& box : bounds)
+            if (box.is_empty() || tglm::intersects(frustum, box))
+                visibleCount++;
+
+        return visibleCount;
+    }
+
+    // Cheaper per plane than the box, but the spheres of the boxes are looser, so more objects pass
+    size_t cull(tglm::frustum const& frustum, nstl::vector<tglm::sphere> const& bounds)
+    {
+        size_t visibleCount = 0;
+
+        for (tglm::sphere const& sphere : bounds)
+            if (tglm::intersects(frustum, sphere))
+                visibleCount++;
+
+        return visibleCount;
+    }
+}
+
+int run(int argc, char** argv)
+{
+    benchmark::options options = benchmark::parse_options(argc, argv);
+
+    size_t const objectCount = options.quick ? 1000 : 100000;
+
+    RandomGenerator rng;
+
+    tglm::aabb localBounds{ tglm::vec3{ -0.5f, -0.5f, -0.5f }, tglm::vec3{ 0.5f, 0.5f, 0.5f } };
+
+    nstl::vector<tglm::mat4> matrices;
+    matrices.reserve(objectCount);
+    for (size_t i = 0; i < objectCount; i++)
+        matrices.push_back(createTranslation({ rng.next(-200.0f, 200.0f), rng.next(-20.0f, 20.0f), rng.next(-200.0f, 200.0f) }));
+
+    nstl::vector<tglm::aabb> worldBounds;
+    worldBounds.resize(objectCount);
+
+    benchmark::run(options, "transform bounds", objectCount, [&]()
+    {
+        for (size_t i = 0; i < objectCount; i++)
+            worldBounds[i] = tglm::transformed(localBounds, matrices[i]);
+    });
+
+    tglm::mat4 viewProjection = tglm::perspective(1.0f, 16.0f / 9.0f, 0.1f, 150.0f) * createTranslation({ 0.0f, -2.0f, 0.0f });
+
+    size_t visibleCount = 0;
+    benchmark::run(options, "cull against the camera frustum", objectCount, [&]()
+    {
+        tglm::frustum frustum = tglm::extract_frustum(viewProjection);
+        visibleCount = cull(frustum, worldBounds);
+        benchmark::consume(visibleCount);
+    });
+
+    nstl::vector<tglm::sphere> worldSpheres;
+    worldSpheres.reserve(objectCount);
+    for (tglm::aabb const& box : worldBounds)
+        worldSpheres.push_back(tglm::bounding_sphere(box));
+
+    size_t sphereVisibleCount = 0;
+    benchmark::run(options, "cull bounding spheres against the camera frustum", objectCount, [&]()
+    {
+        tglm::frustum frustum = tglm::extract_frustum(viewProjection);
+        sphereVisibleCount = cull(frustum, worldSpheres);
+        benchmark::consume(sphereVisibleCount);
+    });
+
+    printf("%zu/%zu objects are visible, %zu with the bounding spheres\n", visibleCount, objectCount, sphereVisibleCount);
+
+    if (visibleCount == 0 || visibleCount == objectCount)
+    {
+        fprintf(stderr, "The camera is expected to see some of the objects\n");
+        return EXIT_FAILURE;
+    }
+
+    // Both tests are conservative, and the sphere encloses the box
+    if (sphereVisibleCount < visibleCount)
+    {
+        fprintf(stderr, "The bounding spheres culled visible objects\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
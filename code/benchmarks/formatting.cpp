@@ -0,0 +1,121 @@
+#include "benchmark.h"
+
+#include "common/fmt.h"
+
+#include "platform/startup.h"
+
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Compares the format strings which are validated and split into segments at compile time with the same strings
+// parsed at runtime (picofmt::runtime), and with snprintf. All of them write into a reused buffer
+
+namespace
+{
+    template<typename PicofmtFunc, typename SnprintfFunc>
+    bool runCase(benchmark::options const& options, char const* name, size_t iterations, PicofmtFunc&& picofmtFunc, SnprintfFunc&& snprintfFunc)
+    {
+        nstl::string buffer;
+        buffer.reserve(256);
+
+        char compileTimeName[64];
+        snprintf(compileTimeName, sizeof(compileTimeName), "%s: compile time", name);
+        benchmark::run(options, compileTimeName, iterations, [&]()
+        {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                buffer.resize(0);
+                picofmtFunc(buffer, i, false);
+            }
+            benchmark::consume(buffer.size());
+        });
+        nstl::string compileTimeResult = buffer;
+
+        char runtimeName[64];
+        snprintf(runtimeName, sizeof(runtimeName), "%s: runtime", name);
+        benchmark::run(options, runtimeName, iterations, [&]()
+        {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                buffer.resize(0);
+                picofmtFunc(buffer, i, true);
+            }
+            benchmark::consume(buffer.size());
+        });
+        nstl::string runtimeResult = buffer;
+
+        char snprintfName[64];
+        snprintf(snprintfName, sizeof(snprintfName), "%s: snprintf", name);
+        char snprintfBuffer[256];
+        benchmark::run(options, snprintfName, iterations, [&]()
+        {
+            int length = 0;
+            for (size_t i = 0; i < iterations; i++)
+                length = snprintfFunc(snprintfBuffer, sizeof(snprintfBuffer), i);
+            benchmark::consume(length);
+        });
+
+        if (compileTimeResult != runtimeResult || compileTimeResult != nstl::string_view{ snprintfBuffer })
+        {
+            printf("'%s' results differ: '%s', '%s', '%s'\n", name, compileTimeResult.c_str(), runtimeResult.c_str(), snprintfBuffer);
+            return false;
+        }
+
+        return true;
+    }
+}
+
+int run(int argc, char** argv)
+{
+    benchmark::options options = benchmark::parse_options(argc, argv);
+
+    size_t const iterations = options.quick ? 1000 : 1000000;
+
+    bool isCorrect = true;
+
+    isCorrect &= runCase(options, "text only", iterations, [](nstl::string& buffer, size_t, bool isRuntime)
+    {
+        if (isRuntime)
+            common::format_to(buffer, picofmt::runtime("Frame finished"));
+        else
+            common::format_to(buffer, "Frame finished");
+    }, [](char* buffer, size_t size, size_t)
+    {
+        return snprintf(buffer, size, "Frame finished");
+    });
+
+    isCorrect &= runCase(options, "2 integers", iterations, [](nstl::string& buffer, size_t i, bool isRuntime)
+    {
+        int frame = static_cast<int>(i);
+        int draws = static_cast<int>(i % 1000);
+        if (isRuntime)
+            common::format_to(buffer, picofmt::runtime("Frame {}: {} draws"), frame, draws);
+        else
+            common::format_to(buffer, "Frame {}: {} draws", frame, draws);
+    }, [](char* buffer, size_t size, size_t i)
+    {
+        return snprintf(buffer, size, "Frame %d: %d draws", static_cast<int>(i), static_cast<int>(i % 1000));
+    });
+
+    isCorrect &= runCase(options, "string, hex and width", iterations, [](nstl::string& buffer, size_t i, bool isRuntime)
+    {
+        nstl::string_view name = "vertex_buffer";
+        int size = static_cast<int>(i);
+        unsigned int flags = static_cast<unsigned int>(i * 7);
+        if (isRuntime)
+            common::format_to(buffer, picofmt::runtime("Buffer '{}' of {:8} bytes, flags {:#x}"), name, size, flags);
+        else
+            common::format_to(buffer, "Buffer '{}' of {:8} bytes, flags {:#x}", name, size, flags);
+    }, [](char* buffer, size_t size, size_t i)
+    {
+        return snprintf(buffer, size, "Buffer '%s' of %8d bytes, flags %#x", "vertex_buffer", static_cast<int>(i), static_cast<unsigned int>(i * 7));
+    });
+
+    if (!isCorrect)
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
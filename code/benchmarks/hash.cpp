@@ -0,0 +1,204 @@
+#include "benchmark.h"
+
+#include "platform/startup.h"
+
+#include "nstl/hash.h"
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+#include "nstl/vector.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Compares the byte hash with djb2, which it replaced, and checks the quality of the hashes on the kinds of keys
+// the engine uses: sequential handles, aligned pointers, asset paths and float values.
+// The distribution is measured on the low bits, that's what unordered_map uses to pick a bucket
+
+namespace
+{
+    size_t djb2(void const* data, size_t size)
+    {
+        auto bytes = static_cast<unsigned char const*>(data);
+
+        size_t hash = 5381;
+        for (size_t i = 0; i < size; i++)
+            hash = hash * 33 + bytes[i];
+        return hash;
+    }
+
+    struct Quality
+    {
+        size_t collisions = 0;
+        double chiSquaredRatio = 0.0; // Close to 1 for a uniform distribution
+        size_t maxBucketLoad = 0;
+    };
+
+    int compareHashes(void const* lhs, void const* rhs)
+    {
+        size_t l = *static_cast<size_t const*>(lhs);
+        size_t r = *static_cast<size_t const*>(rhs);
+        return l < r ? -1 : (l > r ? 1 : 0);
+    }
+
+    Quality measureQuality(nstl::vector<size_t> hashes, size_t bucketCount)
+    {
+        Quality quality;
+
+        nstl::vector<size_t> buckets;
+        buckets.resize(bucketCount, 0);
+        for (size_t hash : hashes)
+            buckets[hash & (bucketCount - 1)]++;
+
+        double expected = static_cast<double>(hashes.size()) / static_cast<double>(bucketCount);
+        double chiSquared = 0.0;
+        for (size_t load : buckets)
+        {
+            double delta = static_cast<double>(load) - expected;
+            chiSquared += delta * delta / expected;
+            quality.maxBucketLoad = load > quality.maxBucketLoad ? load : quality.maxBucketLoad;
+        }
+        quality.chiSquaredRatio = chiSquared / static_cast<double>(bucketCount - 1);
+
+        qsort(hashes.data(), hashes.size(), sizeof(size_t), &compareHashes);
+        for (size_t i = 1; i < hashes.size(); i++)
+            if (hashes[i] == hashes[i - 1])
+                quality.collisions++;
+
+        return quality;
+    }
+
+    bool reportQuality(char const* name, nstl::vector<size_t> const& hashes, size_t bucketCount, bool isChecked)
+    {
+        Quality quality = measureQuality(hashes, bucketCount);
+
+        printf("%-56s %10zu collisions, chi^2/df %6.2f, max bucket %zu (expected %zu)\n", name, quality.collisions, quality.chiSquaredRatio, quality.maxBucketLoad, hashes.size() / bucketCount);
+
+        if (!isChecked)
+            return true;
+
+        return quality.collisions == 0 && quality.chiSquaredRatio < 1.5;
+    }
+
+    size_t countBits(uint64_t value)
+    {
+        size_t count = 0;
+        for (; value != 0; value &= value - 1)
+            count++;
+        return count;
+    }
+
+    // Average number of output bits that change when a single input bit is flipped, 32 is ideal
+    template<typename Func>
+    double measureAvalanche(size_t sampleCount, Func&& func)
+    {
+        uint64_t state = 0x9e3779b97f4a7c15ull;
+        size_t changedBits = 0;
+
+        for (size_t i = 0; i < sampleCount; i++)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+
+            uint64_t hash = func(state);
+            for (size_t bit = 0; bit < 64; bit++)
+                changedBits += countBits(hash ^ func(state ^ (1ull << bit)));
+        }
+
+        return static_cast<double>(changedBits) / static_cast<double>(sampleCount * 64);
+    }
+}
+
+int run(int argc, char** argv)
+{
+    benchmark::options options = benchmark::parse_options(argc, argv);
+
+    size_t const totalBytes = options.quick ? (1 << 16) : (1 << 28);
+
+    nstl::vector<unsigned char> data;
+    data.resize(1 << 20);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = static_cast<unsigned char>(i * 131 + (i >> 8));
+
+    size_t const sizes[] = { 4, 8, 16, 32, 64, 256, 4096, 1 << 20 };
+    for (size_t size : sizes)
+    {
+        size_t count = totalBytes / size;
+        char name[64];
+
+        snprintf(name, sizeof(name), "hash_bytes, %zu bytes", size);
+        double wyhashTime = benchmark::run(options, name, count, [&]()
+        {
+            size_t sum = 0;
+            for (size_t i = 0; i < count; i++)
+                sum += nstl::hash_bytes(data.data() + (i * 64) % (data.size() - size + 1), size);
+            benchmark::consume(sum);
+        });
+
+        snprintf(name, sizeof(name), "djb2, %zu bytes", size);
+        double djb2Time = benchmark::run(options, name, count, [&]()
+        {
+            size_t sum = 0;
+            for (size_t i = 0; i < count; i++)
+                sum += djb2(data.data() + (i * 64) % (data.size() - size + 1), size);
+            benchmark::consume(sum);
+        });
+
+        if (wyhashTime > 0.0 && djb2Time > 0.0)
+            printf("%-56s %10.2f GB/s vs %.2f GB/s\n", "", static_cast<double>(size) / wyhashTime, static_cast<double>(size) / djb2Time);
+    }
+
+    size_t const keyCount = options.quick ? (1 << 14) : (1 << 20);
+    size_t const bucketCount = keyCount / 4;
+
+    nstl::vector<size_t> integerHashes;
+    nstl::vector<size_t> pointerHashes;
+    nstl::vector<size_t> pathHashes;
+    nstl::vector<size_t> pathHashesDjb2;
+    nstl::vector<size_t> floatHashes;
+    nstl::vector<size_t> pairHashes;
+
+    for (size_t i = 0; i < keyCount; i++)
+    {
+        integerHashes.push_back(nstl::hash<size_t>{}(i));
+        pointerHashes.push_back(nstl::hash<void*>{}(reinterpret_cast<void*>(0x10000 + i * 64)));
+
+        char path[64];
+        int length = snprintf(path, sizeof(path), "assets/meshes/mesh_%zu.bin", i);
+        pathHashes.push_back(nstl::hash<nstl::string_view>{}(nstl::string_view{ path, static_cast<size_t>(length) }));
+        pathHashesDjb2.push_back(djb2(path, static_cast<size_t>(length)));
+
+        floatHashes.push_back(nstl::hash<float>{}(static_cast<float>(i) * 0.25f));
+        pairHashes.push_back(nstl::hash_values(static_cast<uint32_t>(i / 64), static_cast<uint32_t>(i % 64)));
+    }
+
+    bool isQualityGood = true;
+    isQualityGood &= reportQuality("sequential integers", integerHashes, bucketCount, true);
+    isQualityGood &= reportQuality("pointers aligned to 64 bytes", pointerHashes, bucketCount, true);
+    isQualityGood &= reportQuality("asset paths", pathHashes, bucketCount, true);
+    isQualityGood &= reportQuality("asset paths (djb2)", pathHashesDjb2, bucketCount, false);
+    isQualityGood &= reportQuality("floats with step 0.25", floatHashes, bucketCount, true);
+    isQualityGood &= reportQuality("hash_values of index pairs", pairHashes, bucketCount, true);
+
+    size_t const avalancheSamples = options.quick ? 100 : 10000;
+    printf("%-56s %10.2f bits of 64\n", "avalanche: integer hash", measureAvalanche(avalancheSamples, [](uint64_t value)
+    {
+        return static_cast<uint64_t>(nstl::hash<uint64_t>{}(value));
+    }));
+    printf("%-56s %10.2f bits of 64\n", "avalanche: hash_bytes, 8 bytes", measureAvalanche(avalancheSamples, [](uint64_t value)
+    {
+        return static_cast<uint64_t>(nstl::hash_bytes(&value, sizeof(value)));
+    }));
+    printf("%-56s %10.2f bits of 64\n", "avalanche: djb2, 8 bytes", measureAvalanche(avalancheSamples, [](uint64_t value)
+    {
+        return static_cast<uint64_t>(djb2(&value, sizeof(value)));
+    }));
+
+    if (!isQualityGood)
+    {
+        printf("The hashes have collisions or are not distributed uniformly\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+#include "benchmark.h"
+
+#include "platform/startup.h"
+
+#include "nstl/flat_hash_map.h"
+#include "nstl/unordered_map.h"
+#include "nstl/vector.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// The keys are shuffled so that neither the insertions nor the lookups walk the table in order.
+// The misses use keys that were never inserted
+
+namespace
+{
+    uint64_t scramble(uint64_t value)
+    {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    template<typename Map>
+    void runCases(benchmark::options const& options, char const* mapName, nstl::vector<uint64_t> const& keys, nstl::vector<uint64_t> const& missingKeys)
+    {
+        char name[64];
+
+        snprintf(name, sizeof(name), "%s: insert", mapName);
+        benchmark::run(options, name, keys.size(), [&]()
+        {
+            Map map;
+            for (uint64_t key : keys)
+                map.insert_or_assign(key, key);
+            benchmark::consume(map.size());
+        });
+
+        Map map;
+        for (uint64_t key : keys)
+            map.insert_or_assign(key, key);
+
+        snprintf(name, sizeof(name), "%s: lookup hit", mapName);
+        benchmark::run(options, name, keys.size(), [&]()
+        {
+            uint64_t sum = 0;
+            for (uint64_t key : keys)
+                sum += map.find(key)->value();
+            benchmark::consume(sum);
+        });
+
+        snprintf(name, sizeof(name), "%s: lookup miss", mapName);
+        benchmark::run(options, name, missingKeys.size(), [&]()
+        {
+            size_t found = 0;
+            for (uint64_t key : missingKeys)
+                found += map.find(key) != map.end() ? 1 : 0;
+            benchmark::consume(found);
+        });
+
+        snprintf(name, sizeof(name), "%s: iterate", mapName);
+        benchmark::run(options, name, keys.size(), [&]()
+        {
+            uint64_t sum = 0;
+            for (auto const& pair : map)
+                sum += pair.value();
+            benchmark::consume(sum);
+        });
+
+        // Erasing needs a fresh map for every repetition, filling it is not part of the measurement
+        nstl::vector<Map> maps;
+        maps.resize(benchmark::get_repetition_count(options));
+        for (Map& erasedMap : maps)
+            for (uint64_t key : keys)
+                erasedMap.insert_or_assign(key, key);
+
+        size_t repetition = 0;
+        snprintf(name, sizeof(name), "%s: erase", mapName);
+        benchmark::run(options, name, keys.size(), [&]()
+        {
+            Map& erasedMap = maps[repetition++];
+            for (uint64_t key : keys)
+                erasedMap.erase(key);
+            benchmark::consume(erasedMap.size());
+        });
+    }
+}
+
+int run(int argc, char** argv)
+{
+    benchmark::options options = benchmark::parse_options(argc, argv);
+
+    size_t const keyCount = options.quick ? 1000 : 1000000;
+
+    nstl::vector<uint64_t> keys;
+    nstl::vector<uint64_t> missingKeys;
+    keys.reserve(keyCount);
+    missingKeys.reserve(keyCount);
+    for (uint64_t i = 0; i < keyCount; i++)
+    {
+        keys.push_back(scramble(2 * i));
+        missingKeys.push_back(scramble(2 * i + 1));
+    }
+
+    runCases<nstl::flat_hash_map<uint64_t, uint64_t>>(options, "flat_hash_map", keys, missingKeys);
+    runCases<nstl::unordered_map<uint64_t, uint64_t>>(options, "unordered_map", keys, missingKeys);
+
+    return EXIT_SUCCESS;
+}
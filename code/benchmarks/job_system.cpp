@@ -0,0 +1,95 @@
+#include "benchmark.h"
+
+#include "mt/atomic.h"
+#include "mt/job_system.h"
+
+#include "platform/startup.h"
+
+#include "nstl/algorithm.h"
+#include "nstl/vector.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Measures how the job system scales with the number of workers: a compute bound parallel_for compared to
+// the same loop on a single thread, and the overhead of starting and waiting for tiny jobs
+
+namespace
+{
+    float computeValue(size_t index)
+    {
+        float value = static_cast<float>(index);
+        for (size_t i = 0; i < 64; i++)
+            value = sqrtf(value * value + 1.0f);
+        return value;
+    }
+
+    void computeRange(nstl::vector<float>& values, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            values[i] = computeValue(i);
+    }
+
+    bool runCases(benchmark::options const& options, size_t workerCount, double serialTime, nstl::vector<float> const& expected)
+    {
+        mt::job_system jobs{ workerCount };
+
+        size_t const count = expected.size();
+        nstl::vector<float> values;
+        values.resize(count, 0.0f);
+
+        char name[64];
+        snprintf(name, sizeof(name), "parallel_for, %zu workers", workerCount);
+        double time = benchmark::run(options, name, count, [&]()
+        {
+            jobs.parallel_for(count, 0, [&values](size_t begin, size_t end) { computeRange(values, begin, end); });
+            benchmark::consume(values[count - 1]);
+        });
+        printf("%-56s %11.2fx\n", "    speedup over serial", serialTime / time);
+
+        size_t const jobCount = options.quick ? 1000 : 100000;
+        snprintf(name, sizeof(name), "empty jobs, %zu workers", workerCount);
+        benchmark::run(options, name, jobCount, [&]()
+        {
+            mt::atomic<uint64_t> executed;
+            mt::job_counter counter;
+            for (size_t i = 0; i < jobCount; i++)
+                jobs.run(counter, [&executed]() { executed.fetch_add(1); });
+            jobs.wait(counter);
+            benchmark::consume(executed.load_relaxed());
+        });
+
+        for (size_t i = 0; i < count; i++)
+            if (values[i] != expected[i])
+                return false;
+
+        return true;
+    }
+}
+
+int run(int argc, char** argv)
+{
+    benchmark::options options = benchmark::parse_options(argc, argv);
+
+    size_t const count = options.quick ? 10000 : 1000000;
+
+    nstl::vector<float> expected;
+    expected.resize(count, 0.0f);
+    double serialTime = benchmark::run(options, "serial", count, [&]()
+    {
+        computeRange(expected, 0, count);
+        benchmark::consume(expected[count - 1]);
+    });
+
+    size_t maxWorkerCount = nstl::max<size_t>(mt::job_system::get_default_worker_count(), 3);
+
+    bool isCorrect = true;
+    for (size_t workerCount = 0; workerCount <= maxWorkerCount; workerCount++)
+        isCorrect &= runCases(options, workerCount, serialTime, expected);
+
+    if (!isCorrect)
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
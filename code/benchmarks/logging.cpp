@@ -0,0 +1,129 @@
+#include "benchmark.h"
+
+#include "logging/logging.h"
+
+#include "mt/atomic.h"
+#include "mt/thread.h"
+
+#include "platform/startup.h"
+#include "platform/time.h"
+
+#include "nstl/unique_ptr.h"
+#include "nstl/vector.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Measures how long the logging call takes for the calling thread, with the messages written synchronously
+// (before logging::init()) and by the background thread. The sink only counts the bytes, so the cost of
+// the actual output doesn't hide the cost of the call
+
+namespace
+{
+    class CountingSink final : public logging::sink
+    {
+    public:
+        void log(nstl::string_view str) override
+        {
+            mt::atomic_fetch_add(m_bytes, str.size());
+        }
+
+        uint64_t getBytes() const
+        {
+            return mt::atomic_load_relaxed(m_bytes);
+        }
+
+    private:
+        uint64_t volatile m_bytes = 0;
+    };
+
+    int compareTimes(void const* lhs, void const* rhs)
+    {
+        size_t l = *static_cast<size_t const*>(lhs);
+        size_t r = *static_cast<size_t const*>(rhs);
+        return l < r ? -1 : (l > r ? 1 : 0);
+    }
+
+    // Every thread records the duration of each call in monotonic clock counts
+    void logMessages(nstl::vector<size_t>& durations, size_t threadIndex)
+    {
+        for (size_t i = 0; i < durations.size(); i++)
+        {
+            size_t start = platform::get_monotonic_time_counter();
+            logging::info("Thread {}: frame {} finished with {} draws", threadIndex, i, i % 1000);
+            durations[i] = platform::get_monotonic_time_counter() - start;
+        }
+    }
+
+    void runCase(char const* mode, size_t threadCount, size_t messagesPerThread)
+    {
+        nstl::vector<nstl::vector<size_t>> durations;
+        durations.resize(threadCount);
+        for (nstl::vector<size_t>& threadDurations : durations)
+            threadDurations.resize(messagesPerThread);
+
+        vkc::Timer timer;
+
+        nstl::vector<mt::thread> threads;
+        threads.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            nstl::vector<size_t>* threadDurations = &durations[i];
+            threads.push_back(mt::thread{ "Benchmark", [threadDurations, i]() { logMessages(*threadDurations, i); } });
+        }
+
+        for (mt::thread& thread : threads)
+            thread.join();
+
+        double time = timer.getTime();
+
+        logging::flush();
+
+        nstl::vector<size_t> allDurations;
+        allDurations.reserve(threadCount * messagesPerThread);
+        for (nstl::vector<size_t> const& threadDurations : durations)
+            for (size_t duration : threadDurations)
+                allDurations.push_back(duration);
+
+        qsort(allDurations.data(), allDurations.size(), sizeof(size_t), &compareTimes);
+
+        double nsPerCount = 1e9 / static_cast<double>(platform::get_monotonic_time_frequency());
+        auto getPercentile = [&](size_t percentile)
+        {
+            size_t index = (allDurations.size() - 1) * percentile / 100;
+            return static_cast<double>(allDurations[index]) * nsPerCount;
+        };
+
+        char name[64];
+        snprintf(name, sizeof(name), "%s, %zu threads", mode, threadCount);
+        printf("%-56s p50 %8.0f ns, p99 %8.0f ns, max %10.0f ns, %8.3f ms total\n", name, getPercentile(50), getPercentile(99), getPercentile(100), time * 1e3);
+    }
+}
+
+int run(int argc, char** argv)
+{
+    benchmark::options options = benchmark::parse_options(argc, argv);
+
+    size_t const messagesPerThread = options.quick ? 1000 : 100000;
+    size_t const threadCounts[] = { 1, 4 };
+
+    auto sink = nstl::make_unique<CountingSink>();
+    CountingSink const* sinkPtr = sink.get();
+    logging::add_sink(nstl::move(sink));
+
+    for (size_t threadCount : threadCounts)
+        runCase("synchronous", threadCount, messagesPerThread);
+
+    logging::init();
+
+    for (size_t threadCount : threadCounts)
+        runCase("background thread", threadCount, messagesPerThread);
+
+    logging::shutdown();
+
+    // The messages from all the cases have to reach the sink
+    if (sinkPtr->getBytes() == 0)
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
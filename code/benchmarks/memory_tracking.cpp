@@ -0,0 +1,96 @@
+#include "benchmark.h"
+
+#include "memory/memory.h"
+#include "memory/untracked_allocator.h"
+
+#include "mt/thread.h"
+
+#include "platform/startup.h"
+#include "platform/threading.h"
+
+#include "nstl/vector.h"
+
+#include <stdlib.h>
+
+// Every thread keeps a window of live allocations of different sizes and replaces them one by one,
+// so the allocations are freed in a different order than they were made
+
+namespace
+{
+    constexpr size_t liveAllocationCount = 64;
+
+    template<typename Allocator>
+    void allocateAndFree(Allocator& allocator, size_t iterations)
+    {
+        void* allocations[liveAllocationCount] = {};
+
+        for (size_t i = 0; i < iterations; i++)
+        {
+            size_t slot = (i * 7) % liveAllocationCount;
+            allocator.deallocate(allocations[slot]);
+            allocations[slot] = allocator.allocate(16 + (i % 16) * 16, alignof(max_align_t));
+        }
+
+        for (void* ptr : allocations)
+            allocator.deallocate(ptr);
+    }
+
+    struct TrackedAllocator
+    {
+        void* allocate(size_t size, size_t alignment) { return memory::allocate(size, alignment); }
+        void deallocate(void* ptr) { memory::deallocate(ptr); }
+    };
+
+    struct UntrackedAllocator
+    {
+        void* allocate(size_t size, size_t alignment) { return m_allocator.allocate(size, alignment); }
+        void deallocate(void* ptr) { if (ptr) m_allocator.deallocate(ptr); }
+
+        memory::untracked_allocator m_allocator;
+    };
+
+    template<typename Allocator>
+    void runThreads(size_t threadCount, size_t iterationsPerThread)
+    {
+        nstl::vector<mt::thread> threads;
+        threads.reserve(threadCount);
+
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            threads.push_back(mt::thread{ "Benchmark", [iterationsPerThread]()
+            {
+                Allocator allocator;
+                allocateAndFree(allocator, iterationsPerThread);
+            } });
+        }
+
+        for (mt::thread& thread : threads)
+            thread.join();
+    }
+}
+
+int run(int argc, char** argv)
+{
+    benchmark::options options = benchmark::parse_options(argc, argv);
+
+    size_t const iterationsPerThread = options.quick ? 1000 : 200000;
+
+    size_t maxThreadCount = platform::get_hardware_thread_count();
+    if (maxThreadCount < 4)
+        maxThreadCount = 4;
+
+    for (size_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2)
+    {
+        char name[64];
+
+        snprintf(name, sizeof(name), "untracked, %zu threads", threadCount);
+        double untracked = benchmark::run(options, name, threadCount * iterationsPerThread, [&]() { runThreads<UntrackedAllocator>(threadCount, iterationsPerThread); });
+
+        snprintf(name, sizeof(name), "tracked, %zu threads", threadCount);
+        double tracked = benchmark::run(options, name, threadCount * iterationsPerThread, [&]() { runThreads<TrackedAllocator>(threadCount, iterationsPerThread); });
+
+        printf("tracking overhead with %zu threads: %.2fx\n", threadCount, untracked > 0.0 ? tracked / untracked : 0.0);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,96 @@
+#include "benchmark.h"
+
+#include "memory/tracking.h"
+
+#include "platform/startup.h"
+
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+#include "nstl/vector.h"
+
+#include <stdlib.h>
+
+// Short strings (up to nstl::string::inline_capacity characters) are expected to never allocate
+
+namespace
+{
+    memory::tracking::scope_id const benchmarkScopeId = memory::tracking::create_scope_id("Benchmark/Strings");
+
+    size_t getTotalAllocations()
+    {
+        return memory::tracking::get_scope_stats_copy()[benchmarkScopeId.index].total_allocations;
+    }
+
+    template<typename Func>
+    void runCase(benchmark::options const& options, char const* name, size_t iterations, Func&& func)
+    {
+        size_t allocationsBefore = getTotalAllocations();
+
+        benchmark::run(options, name, iterations, [&]()
+        {
+            MEMORY_TRACKING_SCOPE(benchmarkScopeId);
+            for (size_t i = 0; i < iterations; i++)
+                func(i);
+        });
+
+        size_t allocations = getTotalAllocations() - allocationsBefore;
+        size_t items = benchmark::get_repetition_count(options) * iterations;
+        printf("%-56s %10.2f allocations/item\n", "", static_cast<double>(allocations) / static_cast<double>(items));
+    }
+}
+
+int run(int argc, char** argv)
+{
+    benchmark::options options = benchmark::parse_options(argc, argv);
+
+    size_t const iterations = options.quick ? 1000 : 1000000;
+
+    runCase(options, "construct short", iterations, [](size_t i)
+    {
+        nstl::string s{ "material_" };
+        s.push_back(static_cast<char>('0' + i % 10));
+        benchmark::consume(s.length());
+    });
+
+    runCase(options, "construct long", iterations, [](size_t i)
+    {
+        nstl::string s{ "assets/meshes/a_much_longer_name_" };
+        s.push_back(static_cast<char>('0' + i % 10));
+        benchmark::consume(s.length());
+    });
+
+    runCase(options, "append 64 characters one by one", iterations / 10, [](size_t i)
+    {
+        nstl::string s;
+        for (size_t j = 0; j < 64; j++)
+            s.push_back(static_cast<char>('a' + (i + j) % 26));
+        benchmark::consume(s.length());
+    });
+
+    nstl::vector<nstl::string> shortNames;
+    nstl::vector<nstl::string> longNames;
+    for (size_t i = 0; i < 100; i++)
+    {
+        shortNames.push_back(nstl::string{ "node_" } + "x");
+        longNames.push_back(nstl::string{ "scene/nodes/with/a/long/path/node_" } + "x");
+    }
+
+    runCase(options, "copy 100 short strings", iterations / 100, [&shortNames](size_t)
+    {
+        nstl::vector<nstl::string> copy = shortNames;
+        benchmark::consume(copy.size());
+    });
+
+    runCase(options, "copy 100 long strings", iterations / 100, [&longNames](size_t)
+    {
+        nstl::vector<nstl::string> copy = longNames;
+        benchmark::consume(copy.size());
+    });
+
+    runCase(options, "compare short", iterations, [&shortNames](size_t i)
+    {
+        benchmark::consume(shortNames[i % shortNames.size()] == nstl::string_view{ "node_x" });
+    });
+
+    return EXIT_SUCCESS;
+}
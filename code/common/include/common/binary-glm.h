@@ -0,0 +1,29 @@
+#pragma once
+
+#include "tglm/fwd.h"
+
+#include "common/binary.h"
+
+namespace common
+{
+    template<>
+    struct binary_serializer<tglm::vec3>
+    {
+        static void write(binary_writer& writer, tglm::vec3 const& value);
+        static bool read(binary_reader& reader, tglm::vec3& value);
+    };
+
+    template<>
+    struct binary_serializer<tglm::vec4>
+    {
+        static void write(binary_writer& writer, tglm::vec4 const& value);
+        static bool read(binary_reader& reader, tglm::vec4& value);
+    };
+
+    template<>
+    struct binary_serializer<tglm::quat>
+    {
+        static void write(binary_writer& writer, tglm::quat const& value);
+        static bool read(binary_reader& reader, tglm::quat& value);
+    };
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "common/binary.h"
+
+#include "nstl/algorithm.h"
+#include "nstl/string.h"
+#include "nstl/vector.h"
+#include "nstl/optional.h"
+
+namespace common
+{
+    template<>
+    struct binary_serializer<nstl::string>
+    {
+        static void write(binary_writer& writer, nstl::string const& value);
+        static bool read(binary_reader& reader, nstl::string& value);
+    };
+
+    template<typename T>
+    struct binary_serializer<nstl::vector<T>>
+    {
+        static void write(binary_writer& writer, nstl::vector<T> const& value)
+        {
+            uint32_t count = static_cast<uint32_t>(value.size());
+            binary_write(writer, count);
+
+            for (T const& element : value)
+                binary_write(writer, element);
+        }
+
+        static bool read(binary_reader& reader, nstl::vector<T>& value)
+        {
+            uint32_t count = 0;
+            if (!binary_read(reader, count))
+                return false;
+
+            // Every element takes at least a byte, which rejects most of the corrupted counts
+            if (count > reader.get_remaining_size())
+                return false;
+
+            // An element can take much more memory than bytes in the file, so the vector only grows
+            // with the elements that were actually read instead of allocating the whole count up front
+            constexpr size_t max_reserved_size = 64 * 1024;
+
+            value.clear();
+            value.reserve(nstl::min<size_t>(count, max_reserved_size / sizeof(T)));
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                T element{};
+                if (!binary_read(reader, element))
+                    return false;
+
+                value.push_back(nstl::move(element));
+            }
+
+            return true;
+        }
+    };
+
+    template<typename T>
+    struct binary_serializer<nstl::optional<T>>
+    {
+        static void write(binary_writer& writer, nstl::optional<T> const& value)
+        {
+            binary_write(writer, static_cast<bool>(value));
+
+            if (value)
+                binary_write(writer, *value);
+        }
+
+        static bool read(binary_reader& reader, nstl::optional<T>& value)
+        {
+            bool hasValue = false;
+            if (!binary_read(reader, hasValue))
+                return false;
+
+            value = {};
+            if (!hasValue)
+                return true;
+
+            value = T{};
+            return binary_read(reader, *value);
+        }
+    };
+}
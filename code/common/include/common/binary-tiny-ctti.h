@@ -0,0 +1,62 @@
+#pragma once
+
+#include "common/binary.h"
+#include "common/tiny_ctti.h"
+
+#include "nstl/type_traits.h"
+
+namespace common
+{
+    template<tiny_ctti::described_enum E>
+    struct binary_serializer<E>
+    {
+        using UnderlyingType = nstl::underlying_type_t<E>;
+
+        static void write(binary_writer& writer, E const& value)
+        {
+            assert(!tiny_ctti::enum_name(value).empty());
+            binary_write(writer, static_cast<UnderlyingType>(value));
+        }
+
+        static bool read(binary_reader& reader, E& value)
+        {
+            UnderlyingType underlyingValue{};
+            if (!binary_read(reader, underlyingValue))
+                return false;
+
+            value = static_cast<E>(underlyingValue);
+            return !tiny_ctti::enum_name(value).empty();
+        }
+    };
+
+    // The fields are stored in the order of the description
+    template<tiny_ctti::described_struct T>
+    struct binary_serializer<T>
+    {
+        static void write(binary_writer& writer, T const& obj)
+        {
+            auto writeField = [&obj, &writer]<typename FieldType>(tiny_ctti::struct_entry<T, FieldType> const& entry)
+            {
+                static_assert(binary_serializable<FieldType>);
+                binary_write(writer, obj.*(entry.field));
+            };
+
+            common::for_each_struct_entry<T>(writeField);
+        }
+
+        static bool read(binary_reader& reader, T& obj)
+        {
+            bool success = true;
+
+            auto readField = [&obj, &reader, &success]<typename FieldType>(tiny_ctti::struct_entry<T, FieldType> const& entry)
+            {
+                static_assert(binary_serializable<FieldType>);
+                success = success && binary_read(reader, obj.*(entry.field));
+            };
+
+            common::for_each_struct_entry<T>(readField);
+
+            return success;
+        }
+    };
+}
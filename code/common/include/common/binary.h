@@ -0,0 +1,108 @@
+#pragma once
+
+#include "nstl/blob_view.h"
+#include "nstl/type_traits.h"
+#include "nstl/vector.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace common
+{
+    class binary_writer
+    {
+    public:
+        binary_writer(nstl::vector<unsigned char>& bytes) : m_bytes(bytes) {}
+
+        void write(void const* data, size_t size);
+        void align(size_t alignment); // Pads with zeros until the size is a multiple of the alignment
+
+        size_t get_size() const { return m_bytes.size(); }
+
+    private:
+        nstl::vector<unsigned char>& m_bytes;
+    };
+
+    class binary_reader
+    {
+    public:
+        binary_reader(nstl::blob_view bytes) : m_bytes(bytes) {}
+
+        [[nodiscard]] bool read(void* data, size_t size);
+
+        size_t get_remaining_size() const { return m_bytes.size() - m_offset; }
+        bool is_at_end() const { return m_offset == m_bytes.size(); }
+
+    private:
+        nstl::blob_view m_bytes;
+        size_t m_offset = 0;
+    };
+
+    // The serializer is expected to look like this:
+    // struct binary_serializer<T>
+    // {
+    //     static void write(binary_writer& writer, T const& value);
+    //     static bool read(binary_reader& reader, T& value);
+    // };
+    // The values are stored without any field names, so the readers rely on the versions of the data
+
+    template<typename T>
+    struct binary_serializer;
+
+    template<typename T>
+    concept binary_serializable = requires(binary_writer& writer, binary_reader& reader, T const& value, T& destination)
+    {
+        binary_serializer<T>::write(writer, value);
+        { binary_serializer<T>::read(reader, destination) } -> nstl::same_as<bool>;
+    };
+
+    template<binary_serializable T>
+    void binary_write(binary_writer& writer, T const& value)
+    {
+        binary_serializer<T>::write(writer, value);
+    }
+
+    template<binary_serializable T>
+    [[nodiscard]] bool binary_read(binary_reader& reader, T& value)
+    {
+        return binary_serializer<T>::read(reader, value);
+    }
+
+    // Fixed-size values are stored the same way as in memory
+    template<typename T>
+    struct binary_trivial_serializer
+    {
+        static void write(binary_writer& writer, T const& value)
+        {
+            writer.write(&value, sizeof(value));
+        }
+
+        static bool read(binary_reader& reader, T& value)
+        {
+            return reader.read(&value, sizeof(value));
+        }
+    };
+
+    // Only the fixed-width types are serializable, so that the data has the same layout on every platform.
+    // Platform-dependent types like size_t or long have to be stored as one of them
+    static_assert(sizeof(float) == 4 && sizeof(double) == 8);
+
+    template<> struct binary_serializer<char> : binary_trivial_serializer<char> {};
+    template<> struct binary_serializer<int8_t> : binary_trivial_serializer<int8_t> {};
+    template<> struct binary_serializer<uint8_t> : binary_trivial_serializer<uint8_t> {};
+    template<> struct binary_serializer<int16_t> : binary_trivial_serializer<int16_t> {};
+    template<> struct binary_serializer<uint16_t> : binary_trivial_serializer<uint16_t> {};
+    template<> struct binary_serializer<int32_t> : binary_trivial_serializer<int32_t> {};
+    template<> struct binary_serializer<uint32_t> : binary_trivial_serializer<uint32_t> {};
+    template<> struct binary_serializer<int64_t> : binary_trivial_serializer<int64_t> {};
+    template<> struct binary_serializer<uint64_t> : binary_trivial_serializer<uint64_t> {};
+    template<> struct binary_serializer<float> : binary_trivial_serializer<float> {};
+    template<> struct binary_serializer<double> : binary_trivial_serializer<double> {};
+
+    template<>
+    struct binary_serializer<bool>
+    {
+        static void write(binary_writer& writer, bool const& value);
+        static bool read(binary_reader& reader, bool& value);
+    };
+}
@@ -68,10 +68,18 @@ struct picofmt::formatter<nstl::vector<T>> : public picofmt::formatter<nstl::spa
 
 namespace common
 {
-    nstl::string vformat(nstl::string_view format, picofmt::args_list const& args);
+    // Appends to the buffer, so a reserved buffer can be reused without allocations
+    void vformat_to(nstl::string& buffer, picofmt::format_string_view format, picofmt::args_list const& args);
+    nstl::string vformat(picofmt::format_string_view format, picofmt::args_list const& args);
 
     template<picofmt::formattable... Ts>
-    nstl::string format(nstl::string_view format, Ts const&... args)
+    void format_to(nstl::string& buffer, picofmt::format_string<Ts...> format, Ts const&... args)
+    {
+        return vformat_to(buffer, format, picofmt::args_list{ args... });
+    }
+
+    template<picofmt::formattable... Ts>
+    nstl::string format(picofmt::format_string<Ts...> format, Ts const&... args)
     {
         return vformat(format, picofmt::args_list{ args... });
     }
@@ -8,23 +8,6 @@
 
 #include "common/tiny_ctti.h"
 
-#include "nstl/sequence.h"
-
-namespace common
-{
-    template<typename T, typename F, size_t... Is>
-    constexpr void for_each_struct_entry_impl(F const& func, nstl::index_sequence<Is...>)
-    {
-        (func(tiny_ctti::struct_field_v<T, Is>), ...);
-    }
-
-    template<typename T, typename F>
-    constexpr void for_each_struct_entry(F const& func)
-    {
-        return for_each_struct_entry_impl<T>(func, nstl::make_index_sequence<tiny_ctti::struct_size_v<T>>{});
-    }
-}
-
 namespace yyjsoncpp
 {
     template<tiny_ctti::described_enum E>
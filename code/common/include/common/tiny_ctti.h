@@ -3,9 +3,25 @@
 #include "nstl/span.h"
 #include "nstl/optional.h"
 #include "nstl/string_view.h"
+#include "nstl/sequence.h"
 
 #define TINY_CTTI_CUSTOM_STRING_VIEW nstl::string_view
 #define TINY_CTTI_CUSTOM_SPAN nstl::span
 #define TINY_CTTI_CUSTOM_OPTIONAL nstl::optional
 
 #include "tiny_ctti/tiny_ctti.hpp"
+
+namespace common
+{
+    template<typename T, typename F, size_t... Is>
+    constexpr void for_each_struct_entry_impl(F const& func, nstl::index_sequence<Is...>)
+    {
+        (func(tiny_ctti::struct_field_v<T, Is>), ...);
+    }
+
+    template<typename T, typename F>
+    constexpr void for_each_struct_entry(F const& func)
+    {
+        return for_each_struct_entry_impl<T>(func, nstl::make_index_sequence<tiny_ctti::struct_size_v<T>>{});
+    }
+}
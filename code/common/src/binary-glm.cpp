@@ -0,0 +1,33 @@
+#include "common/binary-glm.h"
+
+#include "tglm/tglm.h"
+
+void common::binary_serializer<tglm::vec3>::write(binary_writer& writer, tglm::vec3 const& value)
+{
+    writer.write(value.data, sizeof(value.data));
+}
+
+bool common::binary_serializer<tglm::vec3>::read(binary_reader& reader, tglm::vec3& value)
+{
+    return reader.read(value.data, sizeof(value.data));
+}
+
+void common::binary_serializer<tglm::vec4>::write(binary_writer& writer, tglm::vec4 const& value)
+{
+    writer.write(value.data, sizeof(value.data));
+}
+
+bool common::binary_serializer<tglm::vec4>::read(binary_reader& reader, tglm::vec4& value)
+{
+    return reader.read(value.data, sizeof(value.data));
+}
+
+void common::binary_serializer<tglm::quat>::write(binary_writer& writer, tglm::quat const& value)
+{
+    writer.write(value.data, sizeof(value.data));
+}
+
+bool common::binary_serializer<tglm::quat>::read(binary_reader& reader, tglm::quat& value)
+{
+    return reader.read(value.data, sizeof(value.data));
+}
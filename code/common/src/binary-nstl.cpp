@@ -0,0 +1,18 @@
+#include "common/binary-nstl.h"
+
+void common::binary_serializer<nstl::string>::write(binary_writer& writer, nstl::string const& value)
+{
+    uint32_t length = static_cast<uint32_t>(value.length());
+    binary_write(writer, length);
+    writer.write(value.data(), value.length());
+}
+
+bool common::binary_serializer<nstl::string>::read(binary_reader& reader, nstl::string& value)
+{
+    uint32_t length = 0;
+    if (!binary_read(reader, length) || length > reader.get_remaining_size())
+        return false;
+
+    value.resize(length);
+    return reader.read(value.data(), length);
+}
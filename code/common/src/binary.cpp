@@ -0,0 +1,51 @@
+#include "common/binary.h"
+
+#include "nstl/alignment.h"
+
+#include <string.h>
+
+void common::binary_writer::write(void const* data, size_t size)
+{
+    size_t offset = m_bytes.size();
+    m_bytes.resize(offset + size);
+    if (size > 0)
+        memcpy(m_bytes.data() + offset, data, size);
+}
+
+void common::binary_writer::align(size_t alignment)
+{
+    size_t offset = m_bytes.size();
+    size_t aligned_offset = nstl::align_up(offset, alignment);
+
+    m_bytes.resize(aligned_offset);
+    if (aligned_offset > offset)
+        memset(m_bytes.data() + offset, 0, aligned_offset - offset);
+}
+
+bool common::binary_reader::read(void* data, size_t size)
+{
+    if (size > get_remaining_size())
+        return false;
+
+    if (size > 0)
+        memcpy(data, m_bytes.ucdata() + m_offset, size);
+    m_offset += size;
+
+    return true;
+}
+
+void common::binary_serializer<bool>::write(binary_writer& writer, bool const& value)
+{
+    uint8_t byte = value ? 1 : 0;
+    writer.write(&byte, sizeof(byte));
+}
+
+bool common::binary_serializer<bool>::read(binary_reader& reader, bool& value)
+{
+    uint8_t byte = 0;
+    if (!reader.read(&byte, sizeof(byte)) || byte > 1)
+        return false;
+
+    value = byte != 0;
+    return true;
+}
@@ -1,5 +1,7 @@
 #include "common/fmt.h"
 
+#include <string.h>
+
 namespace
 {
     struct StringAppender : public picofmt::writer
@@ -12,6 +14,14 @@ namespace
             return true;
         }
 
+        bool write(char c, size_t count) override
+        {
+            size_t offset = m_str.size();
+            m_str.resize(offset + count);
+            memset(m_str.data() + offset, c, count);
+            return true;
+        }
+
         void report_error(nstl::string_view) override
         {
             // TODO make use of the error message
@@ -48,12 +58,15 @@ bool common::detail::string_case_formatter::format(nstl::string_view const& valu
     return picofmt::formatter<nstl::string_view>::format(value, ctx);
 }
 
-nstl::string common::vformat(nstl::string_view format, picofmt::args_list const& args)
+void common::vformat_to(nstl::string& buffer, picofmt::format_string_view format, picofmt::args_list const& args)
 {
-    nstl::string result;
-
-    StringAppender ctx{ result };
+    StringAppender ctx{ buffer };
     picofmt::vformat_to(ctx, format, args);
+}
 
+nstl::string common::vformat(picofmt::format_string_view format, picofmt::args_list const& args)
+{
+    nstl::string result;
+    vformat_to(result, format, args);
     return result;
 }
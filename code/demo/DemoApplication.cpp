@@ -27,6 +27,7 @@
 
 #include "editor/assets/AssetDatabase.h"
 #include "editor/assets/AssetData.h"
+#include "editor/assets/AssetFile.h"
 
 #include "common/Utils.h"
 #include "common/tiny_ctti.h"
@@ -35,9 +36,12 @@
 
 #include "memory/tracking.h"
 #include "memory/memory.h"
+#include "memory_snapshot/snapshot.h"
 
 #include "fs/file.h"
 
+#include "mt/job_system.h"
+
 #include "nstl/array.h"
 #include "nstl/span.h"
 #include "nstl/optional.h"
@@ -306,7 +310,8 @@ bool DemoApplication::init(int argc, char** argv)
     m_debugConsole = ui::DebugConsoleWidget{ m_services };
     m_memoryViewer = ui::MemoryViewerWindow{ m_services };
 
-    m_assetDatabase = nstl::make_unique<editor::assets::AssetDatabase>();
+    m_jobSystem = nstl::make_unique<mt::job_system>();
+    m_assetDatabase = nstl::make_unique<editor::assets::AssetDatabase>(*m_jobSystem);
 
     init();
 
@@ -390,8 +395,21 @@ void DemoApplication::init()
     m_commands["vulkan.enable-validation"].description("Enable Vulkan validation layers") = coil::variable(&m_validationEnabled);
 
     m_commands["window.memory-viewer"].description("Memory viewer window") = [this]() { m_memoryViewer->toggle(); };
+    m_commands["memory.callstack-sampling"].description("Capture the callstack of every N-th allocation, 0 disables the capture").arguments("period") = [](int period) {
+        memory::tracking::set_callstack_sampling_period(period > 0 ? static_cast<size_t>(period) : 0);
+    };
+    m_commands["memory.dump-allocations"].description("Log outstanding allocations grouped by callstack") = []() { memory::tracking::dump_outstanding_allocations(); };
+    m_commands["memory.save-snapshot"].description("Save memory statistics to a JSON file").arguments("path", "label") = [](coil::Context context, nstl::string_view path, nstl::string_view label) {
+        if (!memory_snapshot::save(memory_snapshot::capture(label), path))
+            context.reportError("Failed to save the memory snapshot to '" + coil::fromNstlStringView(path) + "'");
+    };
 
     m_commands["assets.import"] = [this](nstl::string_view path) { m_assetDatabase->importAsset(path); };
+    m_commands["assets.export-json"].description("Also write the descriptions of the imported assets as JSON for debugging") = coil::property([this]() {
+        return m_assetDatabase->isJsonExportEnabled();
+    }, [this](bool enabled) {
+        m_assetDatabase->setJsonExportEnabled(enabled);
+    });
 
     m_commands["scene.load-editor"].description("Load scene from the asset").arguments("id") = [this](coil::Context context, editor::assets::Uuid id) {
         if (!editorLoadScene(id))
@@ -421,6 +439,10 @@ void DemoApplication::init()
             .max_sets_per_pool = 2048 * 16,
             .max_descriptors_per_type_per_pool = 4 * 2048 * 16,
         },
+
+        .pipeline_cache = {
+            .path = "data/pipeline_cache.bin",
+        },
     };
     auto backend = nstl::make_unique<gfx_vk::backend>(surfaceFactory, m_window->get_framebuffer_width(), m_window->get_framebuffer_height(), config);
     m_renderer = nstl::make_unique<gfx::renderer>(nstl::move(backend));
@@ -809,6 +831,8 @@ bool DemoApplication::loadGltfModel(nstl::string_view basePath, cgltf_data const
                     params.hasNormal = true;
                 if (name == "TANGENT")
                     params.hasTangent = true;
+                if (name == "POSITION" && gltfVertexAccessor->has_min && gltfVertexAccessor->has_max)
+                    params.bounds = { tglm::vec3{ gltfVertexAccessor->min, 3 }, tglm::vec3{ gltfVertexAccessor->max, 3 } };
 
                 gfx::attribute_type attributeType = findAttributeType(gltfVertexAccessor->type, gltfVertexAccessor->component_type);
 
@@ -960,6 +984,7 @@ void DemoApplication::editorLoadMesh(editor::assets::Uuid id)
         params.indexBufferOffset = primitiveData.indices.bufferOffset;
         params.indexType = findIndexType(primitiveData.indices.componentType);
         params.indexCount = primitiveData.indices.count;
+        params.bounds = { primitiveData.boundsMin, primitiveData.boundsMax };
 
         for (editor::assets::VertexAttributeDescription const& attributeData : primitiveData.vertexAttributes)
         {
@@ -996,9 +1021,9 @@ void DemoApplication::editorLoadMesh(editor::assets::Uuid id)
         }
     }
 
-    nstl::blob data = m_assetDatabase->loadMeshData(id);
+    editor::assets::AssetFileRange buffer = m_assetDatabase->getMeshBufferRange(id);
 
-    m_editorGltfResources->demoMeshes[id] = m_sceneDrawer->createMesh(data, primitiveParams);
+    m_editorGltfResources->demoMeshes[id] = m_sceneDrawer->createMesh(buffer.path, buffer.offset, buffer.size, primitiveParams);
 }
 
 void DemoApplication::updateUI(float frameTime)
@@ -1043,6 +1068,13 @@ void DemoApplication::updateUI(float frameTime)
         ImGui::Begin("Debug", nullptr, fpsWindowFlags);
         ImGui::Text("Frame time %.3f ms", frameTime * 1000.0f);
         ImGui::Text("Uptime %.3f", m_time);
+        if (m_sceneDrawer)
+        {
+            DemoSceneDrawer::VisibilityStatistics const& defaultVisibility = m_sceneDrawer->getVisibilityStatistics(false);
+            DemoSceneDrawer::VisibilityStatistics const& shadowVisibility = m_sceneDrawer->getVisibilityStatistics(true);
+            ImGui::Text("Visible objects %zu/%zu", defaultVisibility.visibleCount, defaultVisibility.testedCount);
+            ImGui::Text("Visible shadow casters %zu/%zu", shadowVisibility.visibleCount, shadowVisibility.testedCount);
+        }
         if (ImGui::Button(m_paused ? "Unpause" : "Pause"))
         {
             m_paused = !m_paused;
@@ -1150,6 +1182,9 @@ void DemoApplication::draw()
 
     m_renderer->begin_resource_update();
 
+    tglm::mat4 shadowmapViewProjection;
+    tglm::mat4 cameraViewProjection;
+
     {
         auto aspectRatio = m_renderer->get_main_framebuffer_aspect();
 
@@ -1173,8 +1208,11 @@ void DemoApplication::draw()
 
         m_renderer->buffer_upload_sync(m_viewProjectionData, { &viewProjectionData, sizeof(viewProjectionData) });
 
+        shadowmapViewProjection = shadowmapViewProjectionData.projection * shadowmapViewProjectionData.view;
+        cameraViewProjection = viewProjectionData.projection * viewProjectionData.view;
+
         ShaderLightData lightData = {
-            .lightViewProjection = shadowmapViewProjectionData.projection * shadowmapViewProjectionData.view,
+            .lightViewProjection = shadowmapViewProjection,
             .lightPosition = viewProjectionData.view * tglm::vec4(m_lightParameters.position, 1.0f),
             .lightColor = m_lightParameters.intensity * m_lightParameters.color,
         };
@@ -1196,7 +1234,7 @@ void DemoApplication::draw()
         .framebuffer = m_shadowFramebuffer,
     });
 
-    m_sceneDrawer->draw(true, m_cameraDescriptorGroup, m_shadowmapCameraDescriptorGroup);
+    m_sceneDrawer->draw(true, m_cameraDescriptorGroup, m_shadowmapCameraDescriptorGroup, m_lightParameters.position, shadowmapViewProjection);
 
     m_renderer->renderpass_end();
 
@@ -1205,7 +1243,7 @@ void DemoApplication::draw()
         .framebuffer = m_renderer->acquire_main_framebuffer(),
     });
 
-    m_sceneDrawer->draw(false, m_cameraDescriptorGroup, m_shadowmapCameraDescriptorGroup);
+    m_sceneDrawer->draw(false, m_cameraDescriptorGroup, m_shadowmapCameraDescriptorGroup, m_cameraTransform.position, cameraViewProjection);
 
     m_services.debugDraw().draw(*m_renderer, m_cameraDescriptorGroup);
 
@@ -38,6 +38,11 @@ namespace gfx
     class renderer;
 }
 
+namespace mt
+{
+    class job_system;
+}
+
 struct cgltf_data;
 struct cgltf_scene;
 
@@ -190,5 +195,6 @@ private:
     DemoCameraParameters m_cameraParameters;
     DemoLightParameters m_lightParameters;
 
+    nstl::unique_ptr<mt::job_system> m_jobSystem;
     nstl::unique_ptr<editor::assets::AssetDatabase> m_assetDatabase;
 };
@@ -6,6 +6,9 @@
 
 #include "memory/tracking.h"
 
+#include "tglm/bounds.h"
+#include "tglm/camera.h"
+
 #include "fs/file.h"
 
 #include "nstl/array.h"
@@ -183,6 +186,31 @@ namespace
 
         return {};
     }
+
+    // Reads a part of the file, so the data can be uploaded without loading the whole file first
+    struct file_reader : gfx::data_reader
+    {
+        file_reader(nstl::string_view path, size_t offset, size_t size) : m_offset(offset), m_size(size)
+        {
+            m_file.open(path, fs::open_mode::read);
+            assert(m_offset + m_size <= m_file.size());
+        }
+
+        size_t get_size() const override { return m_size; }
+
+        bool read(void* destination, size_t size) override
+        {
+            assert(m_position + size <= m_size);
+            bool result = m_file.try_read(destination, size, m_offset + m_position);
+            m_position += size;
+            return result;
+        }
+
+        fs::file m_file;
+        size_t m_offset = 0;
+        size_t m_size = 0;
+        size_t m_position = 0;
+    };
 }
 
 DemoSceneDrawer::DemoSceneDrawer(gfx::renderer& renderer, gfx::renderpass_handle shadowRenderpass)
@@ -250,27 +278,6 @@ DemoTexture* DemoSceneDrawer::createTexture(nstl::string_view path)
 
     ImageData::MipData const& mipData = imageData->mips[0];
 
-    struct file_reader : gfx::data_reader
-    {
-        file_reader(nstl::string_view path, size_t offset, size_t size) : m_offset(offset), m_size(size)
-        {
-            m_file.open(path, fs::open_mode::read);
-            assert(m_offset + m_size <= m_file.size());
-        }
-
-        size_t get_size() const override { return m_size; }
-
-        bool read(void* destination, size_t size) override
-        {
-            assert(size <= m_size);
-            return m_file.try_read(destination, size, m_offset);
-        }
-
-        fs::file m_file;
-        size_t m_offset = 0;
-        size_t m_size = 0;
-    };
-
     file_reader reader{ path, mipData.offset, mipData.size };
 
     auto image = m_renderer.create_image({
@@ -293,6 +300,7 @@ DemoMaterial* DemoSceneDrawer::createMaterial(tglm::vec4 color, DemoTexture* alb
 {
     m_materials.push_back(nstl::make_unique<DemoMaterial>());
     DemoMaterial* material = m_materials.back().get();
+    material->sortId = static_cast<uint16_t>(m_materials.size() - 1);
 
     material->buffer = m_renderer.create_buffer({
         .size = sizeof(color),
@@ -336,17 +344,29 @@ DemoMaterial* DemoSceneDrawer::createMaterial(tglm::vec4 color, DemoTexture* alb
 }
 
 DemoMesh* DemoSceneDrawer::createMesh(nstl::blob_view bytes, nstl::span<PrimitiveParams> primitiveParams)
+{
+    gfx::memory_reader reader{ bytes };
+    return createMesh(reader, primitiveParams);
+}
+
+DemoMesh* DemoSceneDrawer::createMesh(nstl::string_view path, size_t offset, size_t size, nstl::span<PrimitiveParams> primitiveParams)
+{
+    file_reader reader{ path, offset, size };
+    return createMesh(reader, primitiveParams);
+}
+
+DemoMesh* DemoSceneDrawer::createMesh(gfx::data_reader& reader, nstl::span<PrimitiveParams> primitiveParams)
 {
     m_meshes.push_back(nstl::make_unique<DemoMesh>());
     DemoMesh* mesh = m_meshes.back().get();
 
     mesh->buffer = m_renderer.create_buffer({
-        .size = bytes.size(),
+        .size = reader.get_size(),
         .usage = gfx::buffer_usage::vertex_index,
         .location = gfx::buffer_location::device_local,
         .is_mutable = false,
     });
-    m_renderer.buffer_upload_sync(mesh->buffer, bytes);
+    m_renderer.buffer_upload_sync(mesh->buffer, reader);
 
     for (PrimitiveParams const& params : primitiveParams)
     {
@@ -356,6 +376,7 @@ DemoMesh* DemoSceneDrawer::createMesh(nstl::blob_view bytes, nstl::span<Primitiv
         demoPrimitive.indexBuffer = { mesh->buffer, params.indexBufferOffset };
         demoPrimitive.indexType = params.indexType;
         demoPrimitive.indexCount = params.indexCount;
+        demoPrimitive.bounds = params.bounds;
 
         demoPrimitive.hasColor = params.hasColor;
         demoPrimitive.hasUv = params.hasUv;
@@ -488,6 +509,11 @@ void DemoSceneDrawer::addMeshInstance(DemoMesh* mesh, tglm::mat4 matrix, tglm::v
 
         object->mesh = mesh;
         object->primitiveIndex = i;
+
+        object->position = { matrix.data[3][0], matrix.data[3][1], matrix.data[3][2] };
+        object->worldBounds = tglm::transformed(primitive.bounds, matrix);
+        object->defaultRenderstateSortId = getRenderstateSortId(object->defaultRenderstate);
+        object->shadowRenderstateSortId = getRenderstateSortId(object->shadowRenderstate);
     }
 }
 
@@ -496,19 +522,40 @@ void DemoSceneDrawer::updateResources()
 
 }
 
-void DemoSceneDrawer::draw(bool shadow, gfx::descriptorgroup_handle defaultFrameDescriptorGroup, gfx::descriptorgroup_handle shadowFrameDescriptorGroup)
+void DemoSceneDrawer::draw(bool shadow, gfx::descriptorgroup_handle defaultFrameDescriptorGroup, gfx::descriptorgroup_handle shadowFrameDescriptorGroup, tglm::vec3 viewPosition, tglm::mat4 const& viewProjection)
 {
+    tglm::frustum frustum = tglm::extract_frustum(viewProjection);
+
+    VisibilityStatistics& statistics = shadow ? m_shadowVisibilityStatistics : m_defaultVisibilityStatistics;
+    statistics = {};
+
     for (auto const& objectPtr : m_objects)
     {
         DemoObject const& object = *objectPtr;
         DemoPrimitive& primitive = object.mesh->primitives[object.primitiveIndex];
 
+        statistics.testedCount++;
+        if (!object.worldBounds.is_empty() && !tglm::intersects(frustum, object.worldBounds))
+            continue;
+        statistics.visibleCount++;
+
         nstl::array defaultDescriptorGroups = { defaultFrameDescriptorGroup, primitive.material->descriptorGroup, object.descriptorGroup };
         nstl::array shadowDescriptorGroups = { shadowFrameDescriptorGroup, object.descriptorGroup };
         nstl::span<gfx::descriptorgroup_handle const> defaultDescriptorGroupsView = defaultDescriptorGroups;
         nstl::span<gfx::descriptorgroup_handle const> shadowDescriptorGroupsView = shadowDescriptorGroups;
 
-        m_renderer.draw_indexed({
+        float dx = object.position.x - viewPosition.x;
+        float dy = object.position.y - viewPosition.y;
+        float dz = object.position.z - viewPosition.z;
+
+        uint64_t sortKey = gfx::make_draw_sort_key({
+            .translucent = !shadow && primitive.material->renderstateFlags.alpha_blending,
+            .renderstate = shadow ? object.shadowRenderstateSortId : object.defaultRenderstateSortId,
+            .material = shadow ? uint16_t{ 0 } : primitive.material->sortId, // the shadow pass doesn't bind materials
+            .depth = dx * dx + dy * dy + dz * dz, // squared distance has the same order
+        });
+
+        m_drawQueue.submit(sortKey, {
             .renderstate = shadow ? object.shadowRenderstate : object.defaultRenderstate,
             .descriptorgroups = shadow ? shadowDescriptorGroupsView : defaultDescriptorGroupsView,
 
@@ -521,4 +568,24 @@ void DemoSceneDrawer::draw(bool shadow, gfx::descriptorgroup_handle defaultFrame
             .vertex_offset = 0,
         });
     }
+
+    m_drawQueue.flush(m_renderer);
+}
+
+DemoSceneDrawer::VisibilityStatistics const& DemoSceneDrawer::getVisibilityStatistics(bool shadow) const
+{
+    return shadow ? m_shadowVisibilityStatistics : m_defaultVisibilityStatistics;
+}
+
+uint16_t DemoSceneDrawer::getRenderstateSortId(gfx::renderstate_handle renderstate)
+{
+    auto it = m_renderstateSortIds.find(renderstate.ptr);
+    if (it != m_renderstateSortIds.end())
+        return it->value();
+
+    // Renderstates are shared, so there are only a handful of them
+    assert(m_renderstateSortIds.size() <= UINT16_MAX);
+    uint16_t id = static_cast<uint16_t>(m_renderstateSortIds.size());
+    m_renderstateSortIds.insert_or_assign(renderstate.ptr, id);
+    return id;
 }
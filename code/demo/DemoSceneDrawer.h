@@ -2,8 +2,11 @@
 
 #include "ShaderPackage.h"
 
+#include "gfx/draw_queue.h"
 #include "gfx/renderer.h"
 
+#include "tglm/types.h"
+
 #include "nstl/blob_view.h"
 #include "nstl/span.h"
 #include "nstl/unique_ptr.h"
@@ -27,6 +30,8 @@ struct DemoMaterial
     bool hasNormalTexture = false;
     bool cullBackfaces = false;
     bool wireframe = false;
+
+    uint16_t sortId = 0;
 };
 
 struct DemoPrimitive
@@ -40,6 +45,8 @@ struct DemoPrimitive
 
     gfx::vertex_configuration_storage vertexConfig;
 
+    tglm::aabb bounds = tglm::aabb::empty();
+
     bool hasColor = false;
     bool hasUv = false;
     bool hasNormal = false;
@@ -60,6 +67,11 @@ struct DemoObject
 
     DemoMesh* mesh = nullptr;
     size_t primitiveIndex = 0;
+
+    tglm::vec3 position;
+    tglm::aabb worldBounds = tglm::aabb::empty();
+    uint16_t defaultRenderstateSortId = 0;
+    uint16_t shadowRenderstateSortId = 0;
 };
 
 class DemoSceneDrawer
@@ -88,17 +100,32 @@ public:
 
         nstl::vector<AttributeParams> attributes;
 
+        tglm::aabb bounds = tglm::aabb::empty(); // Empty bounds disable culling
+
         bool hasColor = false;
         bool hasUv = false;
         bool hasNormal = false;
         bool hasTangent = false;
     };
     DemoMesh* createMesh(nstl::blob_view bytes, nstl::span<PrimitiveParams> params);
+    DemoMesh* createMesh(nstl::string_view path, size_t offset, size_t size, nstl::span<PrimitiveParams> params); // Uploads a part of the file without loading it into memory first
 
     void addMeshInstance(DemoMesh* mesh, tglm::mat4 matrix, tglm::vec4 color);
 
     void updateResources();
-    void draw(bool shadow, gfx::descriptorgroup_handle defaultFrameDescriptorGroup, gfx::descriptorgroup_handle shadowFrameDescriptorGroup);
+    void draw(bool shadow, gfx::descriptorgroup_handle defaultFrameDescriptorGroup, gfx::descriptorgroup_handle shadowFrameDescriptorGroup, tglm::vec3 viewPosition, tglm::mat4 const& viewProjection);
+
+    struct VisibilityStatistics
+    {
+        size_t testedCount = 0;
+        size_t visibleCount = 0;
+    };
+    VisibilityStatistics const& getVisibilityStatistics(bool shadow) const;
+
+private:
+    DemoMesh* createMesh(gfx::data_reader& reader, nstl::span<PrimitiveParams> params);
+
+    uint16_t getRenderstateSortId(gfx::renderstate_handle renderstate);
 
 private:
     gfx::renderer& m_renderer;
@@ -123,4 +150,10 @@ private:
     nstl::vector<nstl::unique_ptr<DemoMaterial>> m_materials;
     nstl::vector<nstl::unique_ptr<DemoMesh>> m_meshes;
     nstl::vector<nstl::unique_ptr<DemoObject>> m_objects;
+
+    nstl::unordered_map<void*, uint16_t> m_renderstateSortIds;
+    gfx::draw_queue m_drawQueue;
+
+    VisibilityStatistics m_defaultVisibilityStatistics;
+    VisibilityStatistics m_shadowVisibilityStatistics;
 };
@@ -1,11 +1,27 @@
 #include "DemoApplication.h"
 
+#include "fs/directory.h"
+
+#include "logging/logging.h"
+#include "logging/sinks.h"
+
 #include "platform/startup.h"
 
+#include "nstl/scope_exit.h"
+#include "nstl/unique_ptr.h"
+
 #include "stdlib.h"
 
 int run(int argc, char** argv)
 {
+    fs::create_directories("logs");
+
+    logging::init({ .crash_output_path = "logs/crash.log" });
+    nstl::scope_exit shutdownLogging = []() { logging::shutdown(); };
+
+    logging::add_sink(nstl::make_unique<logging::debug_output_sink>());
+    logging::add_sink(nstl::make_unique<logging::rotating_file_sink>("logs/demo", 16 * 1024 * 1024, 4));
+
     DemoApplication app;
 
     if (!app.init(argc, argv))
@@ -12,11 +12,14 @@
 #include "nstl/vector.h"
 #include "nstl/string.h"
 
+#include <float.h>
+#include <stdint.h>
+
 namespace editor::assets
 {
     // TODO move somewhere else?
     constexpr uint16_t materialAssetVersion = 1;
-    constexpr uint16_t meshAssetVersion = 1;
+    constexpr uint16_t meshAssetVersion = 2;
     constexpr uint16_t sceneAssetVersion = 1;
 
     //////////////////////////////////////////////////////////////////////////
@@ -124,20 +127,21 @@ namespace editor::assets
     };
     TINY_CTTI_DESCRIBE_ENUM(AttributeSemantic, Position, Color, Normal, Tangent, Texcoord);
 
+    // The descriptions are stored in the asset files, so the counts, sizes and indices have fixed-width types
     struct DataAccessorDescription
     {
         DataType type = DataType::Scalar;
         DataComponentType componentType = DataComponentType::Float;
-        size_t count = 0;
-        size_t stride = 0;
-        size_t bufferOffset = 0;
+        uint64_t count = 0;
+        uint64_t stride = 0;
+        uint64_t bufferOffset = 0;
     };
     TINY_CTTI_DESCRIBE_STRUCT(DataAccessorDescription, type, componentType, count, stride, bufferOffset);
 
     struct VertexAttributeDescription
     {
         AttributeSemantic semantic;
-        size_t index = 0;
+        uint64_t index = 0;
         DataAccessorDescription accessor;
     };
     TINY_CTTI_DESCRIBE_STRUCT(VertexAttributeDescription, semantic, index, accessor);
@@ -149,8 +153,12 @@ namespace editor::assets
 
         DataAccessorDescription indices;
         nstl::vector<VertexAttributeDescription> vertexAttributes;
+
+        // Object space bounds of the positions, inverted (empty) if they are unknown
+        tglm::vec3 boundsMin = { FLT_MAX, FLT_MAX, FLT_MAX };
+        tglm::vec3 boundsMax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
     };
-    TINY_CTTI_DESCRIBE_STRUCT(PrimitiveDescription, material, topology, indices, vertexAttributes);
+    TINY_CTTI_DESCRIBE_STRUCT(PrimitiveDescription, material, topology, indices, vertexAttributes, boundsMin, boundsMax);
 
     struct MeshData
     {
@@ -215,8 +223,8 @@ namespace editor::assets
     {
         nstl::string name;
 
-        nstl::optional<size_t> parentIndex;
-        nstl::vector<size_t> childrenIndices;
+        nstl::optional<uint64_t> parentIndex;
+        nstl::vector<uint64_t> childrenIndices;
 
         nstl::optional<TransformParams> transform;
         nstl::optional<MeshParams> mesh;
@@ -4,12 +4,17 @@
 
 #include "common/tiny_ctti.h"
 
+#include "mt/mutex.h"
+
+#include "nstl/flat_hash_map.h"
+#include "nstl/flat_hash_set.h"
 #include "nstl/vector.h"
 #include "nstl/string_view.h"
 #include "nstl/unique_ptr.h"
 #include "nstl/string.h"
 #include "nstl/unordered_map.h"
 #include "nstl/optional.h"
+#include "nstl/span.h"
 
 namespace nstl
 {
@@ -17,6 +22,11 @@ namespace nstl
     class blob_view;
 }
 
+namespace mt
+{
+    class job_system;
+}
+
 namespace editor::assets
 {
     enum class AssetType
@@ -33,9 +43,11 @@ namespace editor::assets
         uint16_t version = 0;
         nstl::string name;
         AssetType type = AssetType::Image;
+        nstl::string sourcePath; // File the asset was imported from
+        uint64_t contentHash = 0; // Combined hash of the asset files
         nstl::vector<nstl::string> files;
     };
-    TINY_CTTI_DESCRIBE_STRUCT(AssetMetadata, version, name, type, files);
+    TINY_CTTI_DESCRIBE_STRUCT(AssetMetadata, version, name, type, sourcePath, contentHash, files);
 }
 
 namespace editor::assets
@@ -47,17 +59,35 @@ namespace editor::assets
     struct SceneData;
     struct MeshData;
     struct MaterialData;
+    struct AssetFileRange;
 
     class AssetDatabase
     {
     public:
-        AssetDatabase();
+        // The importers run their work as jobs, the job system has to outlive the database
+        AssetDatabase(mt::job_system& jobs);
         ~AssetDatabase();
 
         nstl::vector<Uuid> importAsset(nstl::string_view path);
         nstl::vector<Uuid> importAsset(ImportDescription const& desc);
 
-        Uuid createAsset(AssetType type, nstl::string_view name);
+        // Imports the image into an existing asset, so the ids can be created before importing in parallel.
+        // Calls for different assets can run concurrently
+        void importImage(Uuid id, nstl::string_view path);
+
+        // The metadata changes are kept in memory until the outermost transaction ends, then the metadata files
+        // and the index are written together. Changes outside of a transaction are written immediately
+        void beginTransaction();
+        void endTransaction();
+
+        // Reads the metadata files of all assets again
+        void rebuildIndex();
+
+        // The importers additionally write the asset descriptions as JSON, which is only used for debugging
+        void setJsonExportEnabled(bool enabled) { m_isJsonExportEnabled = enabled; }
+        bool isJsonExportEnabled() const { return m_isJsonExportEnabled; }
+
+        Uuid createAsset(AssetType type, nstl::string_view name, nstl::string_view sourcePath = {});
         void addAssetFile(Uuid id, nstl::blob_view bytes, nstl::string_view filename);
         void addAssetFile(Uuid id, nstl::string_view bytes, nstl::string_view filename); // TODO this is here to allow string -> blob_view conversion. Remove?
         void addAssetFile(Uuid id, nstl::span<unsigned char const> bytes, nstl::string_view filename); // TODO this is here to allow vector -> blob_view conversion. Remove?
@@ -67,18 +97,32 @@ namespace editor::assets
         // TODO return a wrapper object that contains logic for the asset type (encapsulating various requirements, e.g. number/type of files)
         SceneData loadScene(Uuid id) const;
         MeshData loadMesh(Uuid id) const;
-        nstl::blob loadMeshData(Uuid id) const;
+        AssetFileRange getMeshBufferRange(Uuid id) const; // Vertex and index data, which can be uploaded directly from the file
         MaterialData loadMaterial(Uuid id) const;
         nstl::string getImagePath(Uuid id) const;
 
     private:
         AssetMetadata getMetadata(Uuid id) const;
 
+        void loadIndex();
+        void rebuildIndex(nstl::span<Uuid const> ids);
+        void saveIndex();
+        void markModified(Uuid id);
+
         nstl::optional<AssetMetadata> loadMetadataFile(Uuid id) const;
         void saveMetadataFile(Uuid id, AssetMetadata const& metadata) const;
 
     private:
         nstl::unique_ptr<AssetImporterGltf> m_assetImporterGltf;
         nstl::unique_ptr<AssetImporterImage> m_assetImporterImage;
+
+        // Guards the index, since the importers create assets from multiple threads
+        mutable mt::mutex m_mutex;
+        nstl::flat_hash_map<Uuid, AssetMetadata> m_assets;
+        nstl::flat_hash_set<Uuid> m_modifiedAssets;
+        size_t m_transactionDepth = 0;
+        bool m_isIndexSaved = false;
+
+        bool m_isJsonExportEnabled = false;
     };
 }
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "nstl/blob_view.h"
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+#include "nstl/vector.h"
+
+// On-disk format of the material, mesh and scene assets: a header, the asset description serialized through
+// its tiny_ctti description, and the raw data of the asset. The sections are aligned, so the data
+// can be uploaded straight from the file without parsing or copying it first
+
+namespace editor::assets
+{
+    struct MaterialData;
+    struct MeshData;
+    struct SceneData;
+
+    // Names of the asset files in the asset directories
+    constexpr char const* materialAssetFilename = "material.bin";
+    constexpr char const* meshAssetFilename = "mesh.bin";
+    constexpr char const* sceneAssetFilename = "scene.bin";
+
+    // Part of an asset file, e.g. the vertex and index data of a mesh
+    struct AssetFileRange
+    {
+        nstl::string path;
+        size_t offset = 0;
+        size_t size = 0;
+    };
+
+    enum class AssetFileReadCode
+    {
+        Success,
+        ErrorCantOpen,
+        ErrorTooSmall,
+        ErrorInvalidMagic,
+        ErrorUnsupportedVersion,
+        ErrorTypeMismatch,
+        ErrorInvalidSection,
+        ErrorHashMismatch,
+        ErrorCorrupted,
+    };
+
+    nstl::vector<unsigned char> writeAssetFile(MaterialData const& material);
+    nstl::vector<unsigned char> writeAssetFile(MeshData const& mesh, nstl::blob_view buffer);
+    nstl::vector<unsigned char> writeAssetFile(SceneData const& scene);
+
+    [[nodiscard]] AssetFileReadCode readAssetFile(nstl::string_view path, MaterialData& material);
+    [[nodiscard]] AssetFileReadCode readAssetFile(nstl::string_view path, MeshData& mesh);
+    [[nodiscard]] AssetFileReadCode readAssetFile(nstl::string_view path, SceneData& scene);
+
+    // Only reads the header, so that the vertex and index data can be uploaded from the file directly
+    [[nodiscard]] AssetFileReadCode readMeshBufferRange(nstl::string_view path, AssetFileRange& buffer);
+
+    char const* toString(AssetFileReadCode code);
+}
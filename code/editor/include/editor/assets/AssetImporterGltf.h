@@ -5,6 +5,11 @@
 
 struct cgltf_data;
 
+namespace mt
+{
+    class job_system;
+}
+
 namespace editor::assets
 {
     class AssetDatabase;
@@ -14,7 +19,7 @@ namespace editor::assets
     class AssetImporterGltf
     {
     public:
-        AssetImporterGltf(AssetDatabase& database);
+        AssetImporterGltf(AssetDatabase& database, mt::job_system& jobs);
 
         nstl::vector<Uuid> importAsset(ImportDescription const& desc) const;
 
@@ -22,5 +27,6 @@ namespace editor::assets
         nstl::vector<Uuid> parseGltfData(cgltf_data const& data, ImportDescription const& desc) const;
 
         AssetDatabase& m_database;
+        mt::job_system& m_jobs;
     };
 }
@@ -15,6 +15,7 @@ namespace editor::assets
         AssetImporterImage(AssetDatabase& database);
 
         nstl::vector<Uuid> importAsset(ImportDescription const& desc) const;
+        void importAsset(Uuid id, ImportDescription const& desc) const;
 
     private:
         AssetDatabase& m_database;
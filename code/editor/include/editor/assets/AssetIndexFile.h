@@ -0,0 +1,35 @@
+#pragma once
+
+#include "editor/assets/AssetDatabase.h"
+#include "editor/assets/Uuid.h"
+
+#include "nstl/blob_view.h"
+#include "nstl/span.h"
+#include "nstl/vector.h"
+
+// On-disk format of the asset index: the metadata of all assets in a single binary file
+
+namespace editor::assets
+{
+    struct AssetIndexEntry
+    {
+        Uuid id;
+        AssetMetadata metadata;
+    };
+
+    enum class AssetIndexReadCode
+    {
+        Success,
+        ErrorTooSmall,
+        ErrorInvalidMagic,
+        ErrorUnsupportedVersion,
+        ErrorSizeMismatch,
+        ErrorHashMismatch,
+        ErrorCorrupted,
+    };
+
+    nstl::vector<unsigned char> writeAssetIndexFile(nstl::span<AssetIndexEntry const> entries);
+    [[nodiscard]] AssetIndexReadCode readAssetIndexFile(nstl::blob_view file, nstl::vector<AssetIndexEntry>& entries);
+
+    char const* toString(AssetIndexReadCode code);
+}
@@ -8,6 +8,7 @@ namespace editor::assets
     struct ImportDescription
     {
         nstl::blob_view content;
+        nstl::string_view path; // Stored as the source path of the imported assets
         nstl::string_view parentDirectory;
         nstl::string_view name;
         nstl::string_view extension; // TODO change to "typeId"?
@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 
+#include "common/binary.h"
 #include "common/fmt.h"
 
 #include "nstl/hash.h"
@@ -46,6 +47,9 @@ struct yyjsoncpp::serializer<editor::assets::Uuid>
     static mutable_value_ref to_json(mutable_doc& doc, editor::assets::Uuid const& value);
 };
 
+template<>
+struct common::binary_serializer<editor::assets::Uuid> : common::binary_trivial_serializer<editor::assets::Uuid> {};
+
 template<>
 struct picofmt::formatter<editor::assets::Uuid> : public picofmt::formatter<nstl::string_view>
 {
@@ -4,7 +4,10 @@
 #include "editor/assets/AssetImporterGltf.h"
 #include "editor/assets/AssetImporterImage.h"
 #include "editor/assets/AssetData.h"
+#include "editor/assets/AssetIndexFile.h"
+#include "editor/assets/AssetFile.h"
 
+#include "common/Timer.h"
 #include "common/Utils.h"
 #include "common/json-nstl.h"
 #include "common/json-tiny-ctti.h"
@@ -15,14 +18,18 @@
 #include "path/path.h"
 #include "yyjsoncpp/yyjsoncpp.h"
 #include "logging/logging.h"
+#include "mt/lock_guard.h"
 
 #include "nstl/blob_view.h"
+#include "nstl/hash.h"
+#include "nstl/scope_exit.h"
 
 namespace
 {
     nstl::string_view assetsRoot = "data/assets";
+    nstl::string_view indexFilename = "index.bin";
 
-    uint16_t assetMetadataVersion = 1;
+    uint16_t assetMetadataVersion = 2;
 
     // TODO merge these 2 functions
     // TODO find a better name? It constructs a path and creates directories
@@ -38,34 +45,77 @@ namespace
     {
         return path::join(assetsRoot, id.toString(), filename);
     }
+
+    nstl::blob readFile(nstl::string_view path)
+    {
+        fs::file f{ path, fs::open_mode::read };
+        nstl::blob content{ f.size() };
+        f.read(content.data(), content.size());
+
+        return content;
+    }
+
+    editor::assets::ImportDescription createImportDescription(nstl::blob_view content, nstl::string_view path)
+    {
+        path::parts parts = path::split_into_parts(path);
+
+        return {
+            .content = content,
+            .path = path,
+            .parentDirectory = parts.parent_path,
+            .name = parts.name_without_extension,
+            .extension = parts.extension,
+        };
+    }
+
+    nstl::vector<editor::assets::Uuid> listAssetDirectories()
+    {
+        nstl::vector<editor::assets::Uuid> ids;
+
+        for (nstl::string const& name : fs::list_directory(assetsRoot))
+        {
+            editor::assets::Uuid id;
+            if (editor::assets::tryParseUuid(name, id))
+                ids.push_back(id);
+        }
+
+        return ids;
+    }
+
+    uint64_t hashAssetFiles(editor::assets::Uuid id, nstl::span<nstl::string const> files)
+    {
+        size_t hash = 0;
+
+        for (nstl::string const& filename : files)
+        {
+            nstl::blob content = readFile(constructAssetPath(id, filename));
+            nstl::hash_combine(hash, nstl::hash_bytes(content.data(), content.size()));
+        }
+
+        return hash;
+    }
 }
 
-editor::assets::AssetDatabase::AssetDatabase()
+editor::assets::AssetDatabase::AssetDatabase(mt::job_system& jobs)
 {
-    m_assetImporterGltf = nstl::make_unique<AssetImporterGltf>(*this);
+    m_assetImporterGltf = nstl::make_unique<AssetImporterGltf>(*this, jobs);
     m_assetImporterImage = nstl::make_unique<AssetImporterImage>(*this);
+
+    loadIndex();
 }
 
-editor::assets::AssetDatabase::~AssetDatabase() = default;
+editor::assets::AssetDatabase::~AssetDatabase()
+{
+    assert(m_transactionDepth == 0);
+}
 
 nstl::vector<editor::assets::Uuid> editor::assets::AssetDatabase::importAsset(nstl::string_view path)
 {
     if (path.empty())
         return {};
 
-    fs::file f{ path, fs::open_mode::read };
-    nstl::blob content{ f.size() };
-    f.read(content.data(), content.size());
-    f.close();
-
-    path::parts parts = path::split_into_parts(path);
-
-    ImportDescription desc = {
-        .content = content,
-        .parentDirectory = parts.parent_path,
-        .name = parts.name_without_extension,
-        .extension = parts.extension,
-    };
+    nstl::blob content = readFile(path);
+    ImportDescription desc = createImportDescription(content, path);
 
     return importAsset(desc);
 }
@@ -74,6 +124,9 @@ nstl::vector<editor::assets::Uuid> editor::assets::AssetDatabase::importAsset(Im
 {
     logging::info("Importing {} ({})", desc.name, desc.extension);
 
+    beginTransaction();
+    nstl::scope_exit endImportTransaction = [this]() { endTransaction(); };
+
     // TODO implement properly
     // TODO make sure uppercase extension also works
 
@@ -87,7 +140,39 @@ nstl::vector<editor::assets::Uuid> editor::assets::AssetDatabase::importAsset(Im
     return {};
 }
 
-editor::assets::Uuid editor::assets::AssetDatabase::createAsset(AssetType type, nstl::string_view name)
+void editor::assets::AssetDatabase::importImage(Uuid id, nstl::string_view path)
+{
+    nstl::blob content = readFile(path);
+    ImportDescription desc = createImportDescription(content, path);
+
+    logging::info("Importing {} ({})", desc.name, desc.extension);
+
+    m_assetImporterImage->importAsset(id, desc);
+}
+
+void editor::assets::AssetDatabase::beginTransaction()
+{
+    mt::lock_guard lock{ m_mutex };
+    m_transactionDepth++;
+}
+
+void editor::assets::AssetDatabase::endTransaction()
+{
+    mt::lock_guard lock{ m_mutex };
+
+    assert(m_transactionDepth > 0);
+    m_transactionDepth--;
+
+    if (m_transactionDepth == 0 && !m_isIndexSaved)
+        saveIndex();
+}
+
+void editor::assets::AssetDatabase::rebuildIndex()
+{
+    rebuildIndex(listAssetDirectories());
+}
+
+editor::assets::Uuid editor::assets::AssetDatabase::createAsset(AssetType type, nstl::string_view name, nstl::string_view sourcePath)
 {
     Uuid id = generateUuid();
 
@@ -95,10 +180,15 @@ editor::assets::Uuid editor::assets::AssetDatabase::createAsset(AssetType type,
         .version = assetMetadataVersion,
         .name = name,
         .type = type,
+        .sourcePath = sourcePath,
+        .contentHash = 0,
         .files = {},
     };
 
-    saveMetadataFile(id, metadata);
+    mt::lock_guard lock{ m_mutex };
+
+    m_assets.insert_or_assign(id, nstl::move(metadata));
+    markModified(id);
 
     return id;
 }
@@ -111,11 +201,21 @@ void editor::assets::AssetDatabase::addAssetFile(Uuid id, nstl::blob_view bytes,
         fs::file f{ filePath, fs::open_mode::write };
         f.write(bytes.data(), bytes.size());
     }
-    
-    // TODO avoid loading/saving metadata file for every asset modification
-    AssetMetadata metadata = getMetadata(id);
+
+    size_t fileHash = nstl::hash_bytes(bytes.data(), bytes.size());
+
+    mt::lock_guard lock{ m_mutex };
+
+    auto it = m_assets.find(id);
+    assert(it != m_assets.end());
+    AssetMetadata& metadata = it->value();
+
+    size_t contentHash = static_cast<size_t>(metadata.contentHash);
+    nstl::hash_combine(contentHash, fileHash);
+    metadata.contentHash = contentHash;
+
     metadata.files.push_back(filename);
-    saveMetadataFile(id, metadata);
+    markModified(id);
 }
 
 void editor::assets::AssetDatabase::addAssetFile(Uuid id, nstl::string_view bytes, nstl::string_view filename)
@@ -130,12 +230,168 @@ void editor::assets::AssetDatabase::addAssetFile(Uuid id, nstl::span<unsigned ch
 
 editor::assets::AssetMetadata editor::assets::AssetDatabase::getMetadata(Uuid id) const
 {
-    nstl::optional<AssetMetadata> metadata = loadMetadataFile(id);
+    mt::lock_guard lock{ m_mutex };
+
+    auto it = m_assets.find(id);
+    assert(it != m_assets.end());
+    assert(it->value().version == assetMetadataVersion);
+
+    return it->value();
+}
+
+void editor::assets::AssetDatabase::loadIndex()
+{
+    vkc::Timer timer;
+
+    mt::lock_guard lock{ m_mutex };
+
+    nstl::vector<Uuid> ids = listAssetDirectories();
+
+    fs::file f;
+    if (!f.try_open(path::join(assetsRoot, indexFilename), fs::open_mode::read))
+    {
+        logging::info("Asset index doesn't exist, building it");
+        rebuildIndex(ids);
+        return;
+    }
+
+    nstl::blob content{ f.size() };
+    f.read(content.data(), content.size());
+    f.close();
+
+    nstl::vector<AssetIndexEntry> entries;
+    AssetIndexReadCode code = readAssetIndexFile(content, entries);
+    if (code != AssetIndexReadCode::Success)
+    {
+        logging::warn("Asset index is invalid ({}), rebuilding it", toString(code));
+        rebuildIndex(ids);
+        return;
+    }
+
+    m_assets.clear();
+    m_assets.reserve(entries.size());
+    for (AssetIndexEntry& entry : entries)
+        m_assets.insert_or_assign(entry.id, nstl::move(entry.metadata));
+
+    // Assets that were added or removed without going through the database. Directories without valid
+    // metadata are skipped when the index is built, so they are only checked when they aren't in the index
+    bool isUpToDate = true;
+    size_t indexedCount = 0;
+    for (Uuid const& id : ids)
+    {
+        if (m_assets.find(id) != m_assets.end())
+            indexedCount++;
+        else if (loadMetadataFile(id))
+            isUpToDate = false;
+    }
+    isUpToDate = isUpToDate && indexedCount == m_assets.size();
+
+    if (!isUpToDate)
+    {
+        logging::warn("Asset index is out of date, rebuilding it");
+        rebuildIndex(ids);
+        return;
+    }
+
+    m_isIndexSaved = true;
+
+    logging::info("Loaded asset index with {} assets in {:.3f} s", m_assets.size(), timer.getTime());
+}
+
+void editor::assets::AssetDatabase::rebuildIndex(nstl::span<Uuid const> ids)
+{
+    vkc::Timer timer;
+
+    mt::lock_guard lock{ m_mutex };
+
+    m_assets.clear();
+    m_modifiedAssets.clear();
+
+    for (Uuid const& id : ids)
+    {
+        nstl::optional<AssetMetadata> metadata = loadMetadataFile(id);
+        if (!metadata)
+        {
+            logging::warn("Asset {} doesn't have valid metadata, skipping it", id);
+            continue;
+        }
+
+        // Older versions are upgraded when the index is saved
+        if (metadata->version != assetMetadataVersion)
+        {
+            metadata->version = assetMetadataVersion;
+            metadata->contentHash = hashAssetFiles(id, metadata->files);
+            m_modifiedAssets.insert(id);
+        }
+
+        m_assets.insert_or_assign(id, *nstl::move(metadata));
+    }
+
+    saveIndex();
+
+    logging::info("Built asset index with {} assets in {:.3f} s", m_assets.size(), timer.getTime());
+}
+
+void editor::assets::AssetDatabase::saveIndex()
+{
+    mt::lock_guard lock{ m_mutex };
+
+    // The metadata files are the source of truth, so they are written before the index
+    for (Uuid const& id : m_modifiedAssets)
+    {
+        auto it = m_assets.find(id);
+        assert(it != m_assets.end());
+        saveMetadataFile(id, it->value());
+    }
+    m_modifiedAssets.clear();
+
+    nstl::vector<AssetIndexEntry> entries;
+    entries.reserve(m_assets.size());
+    for (auto const& pair : m_assets)
+        entries.push_back({ pair.key(), pair.value() });
+
+    nstl::vector<unsigned char> file = writeAssetIndexFile(entries);
+
+    fs::create_directories(assetsRoot);
+
+    // The index is written to a temporary file first and then renamed over the old one,
+    // so a crash never leaves a partially written index behind
+    nstl::string path = path::join(assetsRoot, indexFilename);
+    nstl::string temporaryPath = path + ".tmp";
+
+    {
+        fs::file f;
+        if (!f.try_open(temporaryPath, fs::open_mode::write) || !f.try_write(file.data(), file.size()))
+        {
+            logging::warn("Failed to write the asset index '{}'", temporaryPath);
+            return;
+        }
+    }
 
-    assert(metadata);
-    assert(metadata->version == assetMetadataVersion);
+    if (!fs::rename_file(temporaryPath, path))
+    {
+        logging::warn("Failed to replace the asset index '{}'", path);
+        return;
+    }
 
-    return *metadata;
+    m_isIndexSaved = true;
+}
+
+void editor::assets::AssetDatabase::markModified(Uuid id)
+{
+    // Has to be called with the mutex locked
+    if (m_isIndexSaved)
+    {
+        // The index file doesn't match the changes anymore. If the application stops
+        // before the changes are saved, the next start rebuilds the index from the metadata files
+        [[maybe_unused]] bool removed = fs::remove_file(path::join(assetsRoot, indexFilename));
+        m_isIndexSaved = false;
+    }
+
+    m_modifiedAssets.insert(id);
+
+    if (m_transactionDepth == 0)
+        saveIndex();
 }
 
 nstl::optional<editor::assets::AssetMetadata> editor::assets::AssetDatabase::loadMetadataFile(Uuid id) const
@@ -144,7 +400,10 @@ nstl::optional<editor::assets::AssetMetadata> editor::assets::AssetDatabase::loa
 
     nstl::string path = constructAssetPath(id, "asset.json");
 
-    fs::file f{ path, fs::open_mode::read };
+    fs::file f;
+    if (!f.try_open(path, fs::open_mode::read))
+        return {};
+
     nstl::blob content{ f.size() };
     f.read(content.data(), content.size());
     f.close();
@@ -153,7 +412,29 @@ nstl::optional<editor::assets::AssetMetadata> editor::assets::AssetDatabase::loa
     if (!doc.read(content.cdata(), content.size()))
         return {};
 
-    return doc.get_root().get<AssetMetadata>();
+    json::value_ref root = doc.get_root();
+
+    nstl::optional<uint16_t> version = root["version"].try_get<uint16_t>();
+    if (!version)
+        return {};
+
+    // Version 1 doesn't have the source path and the content hash
+    if (*version == 1)
+    {
+        return AssetMetadata{
+            .version = *version,
+            .name = root["name"].get<nstl::string>(),
+            .type = root["type"].get<AssetType>(),
+            .sourcePath = {},
+            .contentHash = 0,
+            .files = root["files"].get<nstl::vector<nstl::string>>(),
+        };
+    }
+
+    if (*version != assetMetadataVersion)
+        return {};
+
+    return root.get<AssetMetadata>();
 }
 
 void editor::assets::AssetDatabase::saveMetadataFile(Uuid id, AssetMetadata const& metadata) const
@@ -191,20 +472,46 @@ namespace
 
         return doc;
     }
+
+    bool hasFile(editor::assets::AssetMetadata const& metadata, nstl::string_view filename)
+    {
+        for (nstl::string const& file : metadata.files)
+            if (file == filename)
+                return true;
+
+        return false;
+    }
+
+    template<typename T>
+    T loadAssetFile(editor::assets::Uuid id, nstl::string_view filename)
+    {
+        T data;
+
+        editor::assets::AssetFileReadCode code = editor::assets::readAssetFile(constructAssetPath(id, filename), data);
+        if (code != editor::assets::AssetFileReadCode::Success)
+            logging::error("Failed to read '{}' of the asset {}: {}", filename, id, editor::assets::toString(code));
+        assert(code == editor::assets::AssetFileReadCode::Success);
+
+        return data;
+    }
+
+    // Assets imported before the binary format have the description in a JSON file
+    template<typename T>
+    T loadLegacyJsonFile(editor::assets::Uuid id, nstl::string_view filename)
+    {
+        yyjsoncpp::doc doc = readJson(constructAssetPath(id, filename));
+
+        yyjsoncpp::value_ref root = doc.get_root();
+        return root.get<T>();
+    }
 }
 
 editor::assets::SceneData editor::assets::AssetDatabase::loadScene(Uuid id) const
 {
-    auto metadata = loadMetadataFile(id);
-    assert(metadata);
-    assert(metadata->type == AssetType::Scene);
-    assert(metadata->files.size() == 1);
+    auto metadata = getMetadata(id);
+    assert(metadata.type == AssetType::Scene);
 
-    nstl::string path = constructAssetPath(id, metadata->files[0]);
-    yyjsoncpp::doc doc = readJson(path);
-
-    yyjsoncpp::value_ref root = doc.get_root();
-    SceneData data = root.get<SceneData>();
+    SceneData data = hasFile(metadata, sceneAssetFilename) ? loadAssetFile<SceneData>(id, sceneAssetFilename) : loadLegacyJsonFile<SceneData>(id, "scene.json");
 
     assert(data.version == sceneAssetVersion);
 
@@ -213,50 +520,47 @@ editor::assets::SceneData editor::assets::AssetDatabase::loadScene(Uuid id) cons
 
 editor::assets::MeshData editor::assets::AssetDatabase::loadMesh(Uuid id) const
 {
-    auto metadata = loadMetadataFile(id);
-    assert(metadata);
-    assert(metadata->type == AssetType::Mesh);
-    assert(metadata->files.size() == 2);
-
-    nstl::string path = constructAssetPath(id, metadata->files[0]);
-    yyjsoncpp::doc doc = readJson(path);
+    auto metadata = getMetadata(id);
+    assert(metadata.type == AssetType::Mesh);
 
-    yyjsoncpp::value_ref root = doc.get_root();
-    MeshData data = root.get<MeshData>();
+    MeshData data = hasFile(metadata, meshAssetFilename) ? loadAssetFile<MeshData>(id, meshAssetFilename) : loadLegacyJsonFile<MeshData>(id, "mesh.json");
 
     assert(data.version == meshAssetVersion);
 
     return data;
 }
 
-nstl::blob editor::assets::AssetDatabase::loadMeshData(Uuid id) const
+editor::assets::AssetFileRange editor::assets::AssetDatabase::getMeshBufferRange(Uuid id) const
 {
-    auto metadata = loadMetadataFile(id);
-    assert(metadata);
-    assert(metadata->type == AssetType::Mesh);
-    assert(metadata->files.size() == 2);
+    auto metadata = getMetadata(id);
+    assert(metadata.type == AssetType::Mesh);
 
-    nstl::string path = constructAssetPath(id, metadata->files[1]);
+    if (!hasFile(metadata, meshAssetFilename))
+    {
+        nstl::string path = constructAssetPath(id, "buffer.bin");
 
-    fs::file f{ path, fs::open_mode::read };
-    nstl::blob data{ f.size() };
-    f.read(data.data(), data.size());
+        fs::file f{ path, fs::open_mode::read };
+        size_t size = f.size();
 
-    return data;
+        return { .path = nstl::move(path), .offset = 0, .size = size };
+    }
+
+    AssetFileRange range;
+
+    AssetFileReadCode code = readMeshBufferRange(constructAssetPath(id, meshAssetFilename), range);
+    if (code != AssetFileReadCode::Success)
+        logging::error("Failed to read '{}' of the asset {}: {}", meshAssetFilename, id, toString(code));
+    assert(code == AssetFileReadCode::Success);
+
+    return range;
 }
 
 editor::assets::MaterialData editor::assets::AssetDatabase::loadMaterial(Uuid id) const
 {
-    auto metadata = loadMetadataFile(id);
-    assert(metadata);
-    assert(metadata->type == AssetType::Material);
-    assert(metadata->files.size() == 1);
-
-    nstl::string path = constructAssetPath(id, metadata->files[0]);
-    yyjsoncpp::doc doc = readJson(path);
+    auto metadata = getMetadata(id);
+    assert(metadata.type == AssetType::Material);
 
-    yyjsoncpp::value_ref root = doc.get_root();
-    MaterialData data = root.get<MaterialData>();
+    MaterialData data = hasFile(metadata, materialAssetFilename) ? loadAssetFile<MaterialData>(id, materialAssetFilename) : loadLegacyJsonFile<MaterialData>(id, "material.json");
 
     assert(data.version == materialAssetVersion);
 
@@ -265,10 +569,9 @@ editor::assets::MaterialData editor::assets::AssetDatabase::loadMaterial(Uuid id
 
 nstl::string editor::assets::AssetDatabase::getImagePath(Uuid id) const
 {
-    auto metadata = loadMetadataFile(id);
-    assert(metadata);
-    assert(metadata->type == AssetType::Image);
-    assert(metadata->files.size() == 1);
+    auto metadata = getMetadata(id);
+    assert(metadata.type == AssetType::Image);
+    assert(metadata.files.size() == 1);
 
-    return constructAssetPath(id, metadata->files[0]);
+    return constructAssetPath(id, metadata.files[0]);
 }
@@ -0,0 +1,198 @@
+#include "editor/assets/AssetFile.h"
+
+#include "editor/assets/AssetDatabase.h"
+#include "editor/assets/AssetData.h"
+
+#include "common/binary.h"
+#include "common/binary-nstl.h"
+#include "common/binary-tiny-ctti.h"
+#include "common/binary-glm.h"
+
+#include "fs/file.h"
+
+#include "nstl/blob.h"
+#include "nstl/hash.h"
+
+#include <string.h>
+
+namespace
+{
+    constexpr uint32_t fileMagic = 0x54455341; // "ASET"
+    constexpr uint16_t fileVersion = 1;
+
+    // Vertex and index data only needs 4 bytes, the larger alignment lets the data be read into any upload buffer directly
+    constexpr size_t sectionAlignment = 16;
+
+    struct FileHeader
+    {
+        uint32_t magic = 0;
+        uint16_t version = 0;
+        uint16_t sectionAlignment = 0;
+
+        uint16_t assetType = 0;
+        uint16_t assetVersion = 0;
+        uint32_t reserved = 0;
+
+        uint64_t descriptionOffset = 0;
+        uint64_t descriptionSize = 0;
+        uint64_t descriptionHash = 0;
+
+        uint64_t dataOffset = 0;
+        uint64_t dataSize = 0;
+    };
+
+    static_assert(sizeof(FileHeader) == 56);
+
+    template<typename T>
+    nstl::vector<unsigned char> writeFile(editor::assets::AssetType type, T const& description, nstl::blob_view data)
+    {
+        nstl::vector<unsigned char> file;
+        common::binary_writer writer{ file };
+
+        FileHeader header;
+        writer.write(&header, sizeof(header));
+
+        writer.align(sectionAlignment);
+        size_t descriptionOffset = writer.get_size();
+        common::binary_write(writer, description);
+        size_t descriptionSize = writer.get_size() - descriptionOffset;
+
+        writer.align(sectionAlignment);
+        size_t dataOffset = writer.get_size();
+        writer.write(data.data(), data.size());
+
+        header = {
+            .magic = fileMagic,
+            .version = fileVersion,
+            .sectionAlignment = static_cast<uint16_t>(sectionAlignment),
+            .assetType = static_cast<uint16_t>(type),
+            .assetVersion = description.version,
+            .reserved = 0,
+            .descriptionOffset = descriptionOffset,
+            .descriptionSize = descriptionSize,
+            .descriptionHash = nstl::hash_bytes(file.data() + descriptionOffset, descriptionSize),
+            .dataOffset = dataOffset,
+            .dataSize = data.size(),
+        };
+        memcpy(file.data(), &header, sizeof(header));
+
+        return file;
+    }
+
+    bool isValidSection(uint64_t offset, uint64_t size, size_t fileSize)
+    {
+        return offset >= sizeof(FileHeader) && offset % sectionAlignment == 0 && offset <= fileSize && size <= fileSize - offset;
+    }
+
+    editor::assets::AssetFileReadCode readHeader(fs::file& f, nstl::string_view path, editor::assets::AssetType type, uint16_t version, FileHeader& header)
+    {
+        using editor::assets::AssetFileReadCode;
+
+        if (!f.try_open(path, fs::open_mode::read))
+            return AssetFileReadCode::ErrorCantOpen;
+
+        size_t fileSize = f.size();
+
+        if (fileSize < sizeof(header) || !f.try_read(&header, sizeof(header)))
+            return AssetFileReadCode::ErrorTooSmall;
+
+        if (header.magic != fileMagic)
+            return AssetFileReadCode::ErrorInvalidMagic;
+        if (header.version != fileVersion || header.sectionAlignment != sectionAlignment || header.assetVersion != version)
+            return AssetFileReadCode::ErrorUnsupportedVersion;
+        if (header.assetType != static_cast<uint16_t>(type))
+            return AssetFileReadCode::ErrorTypeMismatch;
+        if (!isValidSection(header.descriptionOffset, header.descriptionSize, fileSize) || !isValidSection(header.dataOffset, header.dataSize, fileSize))
+            return AssetFileReadCode::ErrorInvalidSection;
+
+        return AssetFileReadCode::Success;
+    }
+
+    template<typename T>
+    editor::assets::AssetFileReadCode readDescription(nstl::string_view path, editor::assets::AssetType type, uint16_t version, T& description)
+    {
+        using editor::assets::AssetFileReadCode;
+
+        fs::file f;
+        FileHeader header;
+        if (AssetFileReadCode code = readHeader(f, path, type, version, header); code != AssetFileReadCode::Success)
+            return code;
+
+        nstl::blob descriptionBytes{ header.descriptionSize };
+        if (!f.try_read(descriptionBytes.data(), descriptionBytes.size(), header.descriptionOffset))
+            return AssetFileReadCode::ErrorTooSmall;
+
+        if (header.descriptionHash != nstl::hash_bytes(descriptionBytes.data(), descriptionBytes.size()))
+            return AssetFileReadCode::ErrorHashMismatch;
+
+        common::binary_reader reader{ descriptionBytes };
+        if (!common::binary_read(reader, description) || !reader.is_at_end())
+            return AssetFileReadCode::ErrorCorrupted;
+
+        return AssetFileReadCode::Success;
+    }
+}
+
+nstl::vector<unsigned char> editor::assets::writeAssetFile(MaterialData const& material)
+{
+    return writeFile(AssetType::Material, material, {});
+}
+
+nstl::vector<unsigned char> editor::assets::writeAssetFile(MeshData const& mesh, nstl::blob_view buffer)
+{
+    return writeFile(AssetType::Mesh, mesh, buffer);
+}
+
+nstl::vector<unsigned char> editor::assets::writeAssetFile(SceneData const& scene)
+{
+    return writeFile(AssetType::Scene, scene, {});
+}
+
+editor::assets::AssetFileReadCode editor::assets::readAssetFile(nstl::string_view path, MaterialData& material)
+{
+    return readDescription(path, AssetType::Material, materialAssetVersion, material);
+}
+
+editor::assets::AssetFileReadCode editor::assets::readAssetFile(nstl::string_view path, MeshData& mesh)
+{
+    return readDescription(path, AssetType::Mesh, meshAssetVersion, mesh);
+}
+
+editor::assets::AssetFileReadCode editor::assets::readAssetFile(nstl::string_view path, SceneData& scene)
+{
+    return readDescription(path, AssetType::Scene, sceneAssetVersion, scene);
+}
+
+editor::assets::AssetFileReadCode editor::assets::readMeshBufferRange(nstl::string_view path, AssetFileRange& buffer)
+{
+    fs::file f;
+    FileHeader header;
+    if (AssetFileReadCode code = readHeader(f, path, AssetType::Mesh, meshAssetVersion, header); code != AssetFileReadCode::Success)
+        return code;
+
+    buffer = {
+        .path = path,
+        .offset = header.dataOffset,
+        .size = header.dataSize,
+    };
+
+    return AssetFileReadCode::Success;
+}
+
+char const* editor::assets::toString(AssetFileReadCode code)
+{
+    switch (code)
+    {
+    case AssetFileReadCode::Success: return "success";
+    case AssetFileReadCode::ErrorCantOpen: return "file can't be opened";
+    case AssetFileReadCode::ErrorTooSmall: return "file is too small";
+    case AssetFileReadCode::ErrorInvalidMagic: return "invalid magic";
+    case AssetFileReadCode::ErrorUnsupportedVersion: return "unsupported version";
+    case AssetFileReadCode::ErrorTypeMismatch: return "asset type mismatch";
+    case AssetFileReadCode::ErrorInvalidSection: return "section is out of bounds";
+    case AssetFileReadCode::ErrorHashMismatch: return "description hash mismatch";
+    case AssetFileReadCode::ErrorCorrupted: return "corrupted description";
+    }
+
+    return "unknown";
+}
@@ -3,8 +3,10 @@
 #include "editor/assets/AssetDatabase.h"
 #include "editor/assets/ImportDescription.h"
 #include "editor/assets/AssetData.h"
+#include "editor/assets/AssetFile.h"
 
 #include "memory/tracking.h"
+#include "common/Timer.h"
 #include "common/Utils.h"
 #include "common/json-tiny-ctti.h"
 #include "common/json-nstl.h"
@@ -16,6 +18,9 @@
 
 #include "fs/file.h"
 
+#include "mt/atomic.h"
+#include "mt/job_system.h"
+
 #include "nstl/alignment.h"
 #include "nstl/span.h"
 #include "nstl/scope_exit.h"
@@ -28,6 +33,13 @@
 
 namespace
 {
+    memory::tracking::scope_id getScopeId()
+    {
+        static auto scopeId = memory::tracking::create_scope_id("AssetImporter/GLTF");
+        return scopeId;
+    }
+
+    // The ids of all assets are created before the import starts, so the jobs only read them
     struct GltfResources
     {
         nstl::vector<nstl::blob> bufferData;
@@ -38,6 +50,34 @@ namespace
         nstl::vector<editor::assets::Uuid> scenes;
     };
 
+    // Time spent in the jobs of each stage, summed over all threads
+    struct GltfImportTimings
+    {
+        nstl::vector<float> buffers;
+        nstl::vector<float> images;
+        nstl::vector<float> materials;
+        nstl::vector<float> meshes;
+        nstl::vector<float> scenes;
+    };
+
+    // Jobs run on the worker threads, so the tracking scope has to be set for each of them
+    template<typename Func>
+    void runJob(mt::job_system& jobs, mt::job_counter& counter, Func func)
+    {
+        jobs.run(counter, [func = nstl::move(func)]() {
+            MEMORY_TRACKING_SCOPE(getScopeId());
+            func();
+        });
+    }
+
+    float sum(nstl::vector<float> const& values)
+    {
+        float result = 0.0f;
+        for (float value : values)
+            result += value;
+        return result;
+    }
+
     template<typename T>
     size_t findIndex(T const* object, T const* first, [[maybe_unused]] size_t count)
     {
@@ -63,18 +103,14 @@ namespace
 // Textures
 namespace
 {
-    editor::assets::Uuid importImage(size_t i, cgltf_data const& data, editor::assets::ImportDescription const& desc, GltfResources const&, editor::assets::AssetDatabase& database)
+    nstl::string getImagePath(cgltf_image const& image, editor::assets::ImportDescription const& desc)
     {
-        cgltf_image const& image = data.images[i];
-
         if (image.uri)
         {
             nstl::string_view uri = image.uri;
             assert(!uri.starts_with("data:")); // TODO implement
 
-            nstl::vector<editor::assets::Uuid> importedImages = database.importAsset(path::join(desc.parentDirectory, uri));
-            assert(importedImages.size() == 1);
-            return importedImages[0];
+            return path::join(desc.parentDirectory, uri);
         }
         else if (image.buffer_view)
         {
@@ -85,6 +121,17 @@ namespace
         assert(false);
         return {};
     }
+
+    editor::assets::Uuid createImageAsset(size_t i, cgltf_data const& data, editor::assets::ImportDescription const& desc, editor::assets::AssetDatabase& database)
+    {
+        nstl::string imagePath = getImagePath(data.images[i], desc);
+        return database.createAsset(editor::assets::AssetType::Image, path::split_into_parts(imagePath).name_without_extension, imagePath);
+    }
+
+    void importImage(size_t i, cgltf_data const& data, editor::assets::ImportDescription const& desc, GltfResources const& resources, editor::assets::AssetDatabase& database)
+    {
+        database.importImage(resources.images[i], getImagePath(data.images[i], desc));
+    }
 }
 
 // Materials
@@ -146,7 +193,15 @@ namespace
         return editor::assets::SamplerWrapMode::Repeat;
     };
 
-    editor::assets::Uuid importMaterial(size_t i, cgltf_data const& data, editor::assets::ImportDescription const& desc, GltfResources const& resources, editor::assets::AssetDatabase& database)
+    editor::assets::Uuid createMaterialAsset(size_t i, cgltf_data const& data, editor::assets::ImportDescription const& desc, editor::assets::AssetDatabase& database)
+    {
+        cgltf_material const& material = data.materials[i];
+
+        nstl::string name = material.name ? material.name : nstl::sprintf("%.*s material %zu", desc.name.slength(), desc.name.data(), i);
+        return database.createAsset(editor::assets::AssetType::Material, name, desc.path);
+    }
+
+    void importMaterial(size_t i, cgltf_data const& data, GltfResources const& resources, editor::assets::AssetDatabase& database)
     {
         cgltf_material const& material = data.materials[i];
 
@@ -191,11 +246,9 @@ namespace
         if (auto texture = material.normal_texture.texture)
             materialData.normalTexture = createTextureData(*texture);
 
-        nstl::string name = material.name ? material.name : nstl::sprintf("%.*s material %zu", desc.name.slength(), desc.name.data(), i);
-        editor::assets::Uuid id = database.createAsset(editor::assets::AssetType::Material, name);
-        database.addAssetFile(id, serializeToJson(materialData), "material.json");
-
-        return id;
+        database.addAssetFile(resources.materials[i], editor::assets::writeAssetFile(materialData), editor::assets::materialAssetFilename);
+        if (database.isJsonExportEnabled())
+            database.addAssetFile(resources.materials[i], serializeToJson(materialData), "material.json");
     }
 }
 
@@ -346,22 +399,60 @@ namespace
         return destination;
     }
 
+    // The layout of the whole buffer is calculated first, then the chunks are copied in parallel
     struct DataBuffer
     {
+        struct Copy
+        {
+            nstl::blob_view source;
+            size_t count = 0;
+            size_t chunk_size = 0;
+            size_t stride = 0;
+            size_t destination_offset = 0;
+        };
+
         size_t append(nstl::blob_view source, size_t count, size_t chunk_size, size_t stride)
         {
             assert(stride * (count - 1) + chunk_size <= source.size());
 
             size_t alignment = chunk_size; // TODO double-check?
 
-            size_t destination_offset = nstl::align_up(buffer.size(), alignment);
-            size_t destination_stride = chunk_size;
-            buffer.resize(destination_offset + chunk_size * count);
-            memcpy_stride(buffer.data() + destination_offset, source.data(), count, chunk_size, destination_stride, stride);
+            size_t destination_offset = nstl::align_up(size, alignment);
+            size = destination_offset + chunk_size * count;
+            copies.push_back({ source, count, chunk_size, stride, destination_offset });
 
             return destination_offset;
         }
 
+        void build(mt::job_system& jobs)
+        {
+            buffer.resize(size);
+
+            // The resize doesn't initialize the memory, so the alignment padding is cleared to keep the output deterministic
+            size_t padding_offset = 0;
+            for (Copy const& copy : copies)
+            {
+                memset(buffer.data() + padding_offset, 0, copy.destination_offset - padding_offset);
+                padding_offset = copy.destination_offset + copy.chunk_size * copy.count;
+            }
+
+            jobs.parallel_for(copies.size(), 1, [this](size_t begin, size_t end)
+            {
+                MEMORY_TRACKING_SCOPE(getScopeId());
+
+                for (size_t i = begin; i < end; i++)
+                {
+                    Copy const& copy = copies[i];
+                    size_t destination_stride = copy.chunk_size;
+                    memcpy_stride(buffer.data() + copy.destination_offset, copy.source.data(), copy.count, copy.chunk_size, destination_stride, copy.stride);
+                }
+            });
+
+            copies.clear();
+        }
+
+        size_t size = 0;
+        nstl::vector<Copy> copies;
         nstl::vector<unsigned char> buffer;
     };
 
@@ -398,6 +489,26 @@ namespace
         return layout;
     }
 
+    tglm::aabb calculateBounds(cgltf_accessor const& accessor)
+    {
+        assert(accessor.type == cgltf_type_vec3);
+
+        // The spec requires POSITION accessors to have min and max
+        if (accessor.has_min && accessor.has_max)
+            return { tglm::vec3{ accessor.min, 3 }, tglm::vec3{ accessor.max, 3 } };
+
+        tglm::aabb bounds = tglm::aabb::empty();
+        for (size_t i = 0; i < accessor.count; i++)
+        {
+            tglm::vec3 position;
+            [[maybe_unused]] bool result = cgltf_accessor_read_float(&accessor, i, position.data, 3);
+            assert(result);
+            bounds.expand(position);
+        }
+
+        return bounds;
+    }
+
     editor::assets::PrimitiveDescription appendPrimitive(cgltf_primitive const& primitive, cgltf_data const& data, GltfResources const& resources, DataBuffer& buffer)
     {
         auto appendChunk = [&resources, &buffer](DataLayout const& layout)
@@ -443,12 +554,27 @@ namespace
             vertexAttributeDescription.index = static_cast<size_t>(attribute.index);
 
             vertexAttributeDescription.accessor = appendChunk(layout);
+
+            if (attribute.type == cgltf_attribute_type_position && attribute.index == 0)
+            {
+                tglm::aabb bounds = calculateBounds(*attribute.data);
+                description.boundsMin = bounds.min;
+                description.boundsMax = bounds.max;
+            }
         }
 
         return description;
     }
 
-    editor::assets::Uuid importMesh(size_t i, cgltf_data const& data, editor::assets::ImportDescription const& desc, GltfResources const& resources, editor::assets::AssetDatabase& database)
+    editor::assets::Uuid createMeshAsset(size_t i, cgltf_data const& data, editor::assets::ImportDescription const& desc, editor::assets::AssetDatabase& database)
+    {
+        cgltf_mesh const& mesh = data.meshes[i];
+
+        nstl::string name = mesh.name ? mesh.name : nstl::sprintf("%.*s mesh %zu", desc.name.slength(), desc.name.data(), i);
+        return database.createAsset(editor::assets::AssetType::Mesh, name, desc.path);
+    }
+
+    void importMesh(size_t i, cgltf_data const& data, GltfResources const& resources, editor::assets::AssetDatabase& database, mt::job_system& jobs)
     {
         cgltf_mesh const& mesh = data.meshes[i];
 
@@ -459,17 +585,16 @@ namespace
         for (size_t j = 0; j < mesh.primitives_count; j++)
             primitives.push_back(appendPrimitive(mesh.primitives[j], data, resources, buffer));
 
+        buffer.build(jobs);
+
         editor::assets::MeshData meshData = {
             .version = editor::assets::meshAssetVersion,
             .primitives = nstl::move(primitives),
         };
 
-        nstl::string name = mesh.name ? mesh.name : nstl::sprintf("%.*s mesh %zu", desc.name.slength(), desc.name.data(), i);
-        editor::assets::Uuid id = database.createAsset(editor::assets::AssetType::Mesh, name);
-        database.addAssetFile(id, serializeToJson(meshData), "mesh.json");
-        database.addAssetFile(id, buffer.buffer, "buffer.bin");
-
-        return id;
+        database.addAssetFile(resources.meshes[i], editor::assets::writeAssetFile(meshData, { buffer.buffer.data(), buffer.buffer.size() }), editor::assets::meshAssetFilename);
+        if (database.isJsonExportEnabled())
+            database.addAssetFile(resources.meshes[i], serializeToJson(meshData), "mesh.json");
     }
 }
 
@@ -585,7 +710,16 @@ namespace
         return objectDataIndex;
     }
 
-    editor::assets::Uuid importScene(size_t i, cgltf_data const& data, editor::assets::ImportDescription const& desc, GltfResources const& resources, editor::assets::AssetDatabase& database)
+    editor::assets::Uuid createSceneAsset(size_t i, cgltf_data const& data, editor::assets::ImportDescription const& desc, editor::assets::AssetDatabase& database)
+    {
+        assert(i < data.scenes_count);
+        cgltf_scene const& scene = data.scenes[i];
+
+        nstl::string name = scene.name ? scene.name : nstl::sprintf("%.*s scene %zu", desc.name.slength(), desc.name.data(), i);
+        return database.createAsset(editor::assets::AssetType::Scene, name, desc.path);
+    }
+
+    void importScene(size_t i, cgltf_data const& data, GltfResources const& resources, editor::assets::AssetDatabase& database)
     {
         assert(i < data.scenes_count);
         cgltf_scene const& scene = data.scenes[i];
@@ -599,23 +733,45 @@ namespace
         for (size_t index = 0; index < scene.nodes_count; index++)
             addObjectsRecursive(*scene.nodes[index], data, sceneData, resources);
 
-        nstl::string name = scene.name ? scene.name : nstl::sprintf("%.*s scene %zu", desc.name.slength(), desc.name.data(), i);
-        editor::assets::Uuid id = database.createAsset(editor::assets::AssetType::Scene, name);
-        database.addAssetFile(id, serializeToJson(sceneData), "scene.json");
+        database.addAssetFile(resources.scenes[i], editor::assets::writeAssetFile(sceneData), editor::assets::sceneAssetFilename);
+        if (database.isJsonExportEnabled())
+            database.addAssetFile(resources.scenes[i], serializeToJson(sceneData), "scene.json");
+    }
 
-        return id;
+    nstl::blob loadBuffer(size_t i, cgltf_data const& data, editor::assets::ImportDescription const& desc)
+    {
+        cgltf_buffer const& buffer = data.buffers[i];
+
+        nstl::string_view uri = buffer.uri;
+
+        [[maybe_unused]] bool isDataUri = uri.starts_with("data:");
+        [[maybe_unused]] bool hasSchema = uri.find("://") != nstl::string_view::npos;
+
+        assert(!isDataUri); // TODO implement
+        assert(!hasSchema); // TODO implement?
+
+        nstl::string path = path::join(desc.parentDirectory, uri);
+
+        fs::file f;
+        f.open(path, fs::open_mode::read);
+        assert(f.is_open());
+
+        nstl::blob bytes{ f.size() };
+        f.read(bytes.data(), bytes.size());
+        f.close();
+
+        return bytes;
     }
 }
 
-editor::assets::AssetImporterGltf::AssetImporterGltf(AssetDatabase& database) : m_database(database)
+editor::assets::AssetImporterGltf::AssetImporterGltf(AssetDatabase& database, mt::job_system& jobs) : m_database(database), m_jobs(jobs)
 {
 
 }
 
 nstl::vector<editor::assets::Uuid> editor::assets::AssetImporterGltf::importAsset(ImportDescription const& desc) const
 {
-    static auto scopeId = memory::tracking::create_scope_id("AssetImporter/GLTF");
-    MEMORY_TRACKING_SCOPE(scopeId);
+    MEMORY_TRACKING_SCOPE(getScopeId());
 
     cgltf_options options = {};
     cgltf_data* data = nullptr;
@@ -634,74 +790,130 @@ nstl::vector<editor::assets::Uuid> editor::assets::AssetImporterGltf::importAsse
 
 nstl::vector<editor::assets::Uuid> editor::assets::AssetImporterGltf::parseGltfData(cgltf_data const& data, ImportDescription const& desc) const
 {
-    nstl::vector<Uuid> result;
+    vkc::Timer timer;
+
+    mt::job_system& jobs = m_jobs;
 
     GltfResources resources;
+    GltfImportTimings timings;
 
     for (size_t i = 0; i < data.extensions_required_count; i++)
         logging::warn("GLTF requires extension '{}'", data.extensions_required[i]);
 
-    for (size_t i = 0; i < data.buffers_count; i++)
-    {
-       cgltf_buffer const& buffer = data.buffers[i];
-
-       nstl::string_view uri = buffer.uri;
+    // The assets are created in the same order as the serial import did, everything else
+    // only depends on the ids, so the output doesn't depend on the order in which the jobs run
+    for (size_t i = 0; i < data.images_count; i++)
+        resources.images.push_back(createImageAsset(i, data, desc, m_database));
+    for (size_t i = 0; i < data.materials_count; i++)
+        resources.materials.push_back(createMaterialAsset(i, data, desc, m_database));
+    for (size_t i = 0; i < data.meshes_count; i++)
+        resources.meshes.push_back(createMeshAsset(i, data, desc, m_database));
+    for (size_t i = 0; i < data.scenes_count; i++)
+        resources.scenes.push_back(createSceneAsset(i, data, desc, m_database));
 
-       [[maybe_unused]] bool isDataUri = uri.starts_with("data:");
-       [[maybe_unused]] bool hasSchema = uri.find("://") != nstl::string_view::npos;
+    resources.bufferData.resize(data.buffers_count);
 
-       assert(!isDataUri); // TODO implement
-       assert(!hasSchema); // TODO implement?
+    timings.buffers.resize(data.buffers_count);
+    timings.images.resize(data.images_count);
+    timings.materials.resize(data.materials_count);
+    timings.meshes.resize(data.meshes_count);
+    timings.scenes.resize(data.scenes_count);
 
-       nstl::string path = path::join(desc.parentDirectory, uri);
+    mt::job_counter counter;
 
-       fs::file f;
-       f.open(path, fs::open_mode::read);
-       assert(f.is_open());
+    auto startMeshJobs = [&]()
+    {
+        for (size_t i = 0; i < data.meshes_count; i++)
+        {
+            runJob(jobs, counter, [&, i]()
+            {
+                vkc::Timer jobTimer;
+                importMesh(i, data, resources, m_database, jobs);
+                timings.meshes[i] = jobTimer.getTime();
+            });
+        }
+    };
 
-       nstl::blob bytes{ f.size() };
-       f.read(bytes.data(), bytes.size());
-       f.close();
+    // Meshes are the only assets that need the buffers, they are started by the job that loads the last one
+    mt::atomic<uint64_t> remainingBuffers{ data.buffers_count };
+    for (size_t i = 0; i < data.buffers_count; i++)
+    {
+        runJob(jobs, counter, [&, i]()
+        {
+            vkc::Timer jobTimer;
+            resources.bufferData[i] = loadBuffer(i, data, desc);
+            timings.buffers[i] = jobTimer.getTime();
 
-       resources.bufferData.push_back(nstl::move(bytes));
+            if (remainingBuffers.fetch_sub(1) == 1)
+                startMeshJobs();
+        });
     }
 
-    result.reserve(result.size() + data.images_count);
+    if (data.buffers_count == 0)
+        startMeshJobs();
+
     for (size_t i = 0; i < data.images_count; i++)
     {
-        Uuid asset = importImage(i, data, desc, resources, m_database);
-        resources.images.push_back(asset);
-        result.push_back(asset);
-
-        logging::info("Imported image {} ({}) as {}", i, data.images[i].name, asset);
+        runJob(jobs, counter, [&, i]()
+        {
+            vkc::Timer jobTimer;
+            importImage(i, data, desc, resources, m_database);
+            timings.images[i] = jobTimer.getTime();
+        });
     }
 
     for (size_t i = 0; i < data.materials_count; i++)
     {
-        Uuid asset = importMaterial(i, data, desc, resources, m_database);
-        resources.materials.push_back(asset);
-        result.push_back(asset);
+        runJob(jobs, counter, [&, i]()
+        {
+            vkc::Timer jobTimer;
+            importMaterial(i, data, resources, m_database);
+            timings.materials[i] = jobTimer.getTime();
+        });
+    }
 
-        logging::info("Imported material {} ({}) as {}", i, data.materials[i].name, asset);
+    for (size_t i = 0; i < data.scenes_count; i++)
+    {
+        runJob(jobs, counter, [&, i]()
+        {
+            vkc::Timer jobTimer;
+            importScene(i, data, resources, m_database);
+            timings.scenes[i] = jobTimer.getTime();
+        });
     }
 
-    for (size_t i = 0; i < data.meshes_count; i++)
+    jobs.wait(counter);
+
+    nstl::vector<Uuid> result;
+    result.reserve(resources.images.size() + resources.materials.size() + resources.meshes.size() + resources.scenes.size());
+
+    for (size_t i = 0; i < resources.images.size(); i++)
     {
-        Uuid asset = importMesh(i, data, desc, resources, m_database);
-        resources.meshes.push_back(asset);
-        result.push_back(asset);
+        result.push_back(resources.images[i]);
+        logging::info("Imported image {} ({}) as {}", i, data.images[i].name, resources.images[i]);
+    }
 
-        logging::info("Imported mesh {} ({}) as {}", i, data.meshes[i].name, asset);
+    for (size_t i = 0; i < resources.materials.size(); i++)
+    {
+        result.push_back(resources.materials[i]);
+        logging::info("Imported material {} ({}) as {}", i, data.materials[i].name, resources.materials[i]);
     }
 
-    for (size_t i = 0; i < data.scenes_count; i++)
+    for (size_t i = 0; i < resources.meshes.size(); i++)
     {
-        Uuid asset = importScene(i, data, desc, resources, m_database);
-        resources.scenes.push_back(asset);
-        result.push_back(asset);
+        result.push_back(resources.meshes[i]);
+        logging::info("Imported mesh {} ({}) as {}", i, data.meshes[i].name, resources.meshes[i]);
+    }
 
-        logging::info("Imported scene {} ({}) as {}", i, data.scenes[i].name, asset);
+    for (size_t i = 0; i < resources.scenes.size(); i++)
+    {
+        result.push_back(resources.scenes[i]);
+        logging::info("Imported scene {} ({}) as {}", i, data.scenes[i].name, resources.scenes[i]);
     }
 
+    logging::info("Imported {} in {:.3f} s using {} threads. Job time: buffers {:.3f} s, images {:.3f} s, materials {:.3f} s, meshes {:.3f} s, scenes {:.3f} s",
+        desc.name, timer.getTime(), jobs.get_worker_count() + 1,
+        sum(timings.buffers), sum(timings.images), sum(timings.materials), sum(timings.meshes), sum(timings.scenes));
+
     return result;
 }
@@ -111,11 +111,15 @@ editor::assets::AssetImporterImage::AssetImporterImage(AssetDatabase& database)
 
 nstl::vector<editor::assets::Uuid> editor::assets::AssetImporterImage::importAsset(ImportDescription const& desc) const
 {
-    Uuid id = m_database.createAsset(AssetType::Image, desc.name);
+    Uuid id = m_database.createAsset(AssetType::Image, desc.name, desc.path);
+    importAsset(id, desc);
 
+    return { id };
+}
+
+void editor::assets::AssetImporterImage::importAsset(Uuid id, ImportDescription const& desc) const
+{
     nstl::vector<unsigned char> bytes = createImage(desc.content);
     nstl::string filename = "texture.ktx2";
     m_database.addAssetFile(id, bytes, filename);
-
-    return { id };
 }
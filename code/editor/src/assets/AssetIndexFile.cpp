@@ -0,0 +1,139 @@
+#include "editor/assets/AssetIndexFile.h"
+
+#include "common/binary.h"
+#include "common/binary-nstl.h"
+
+#include "nstl/hash.h"
+
+#include <string.h>
+
+namespace
+{
+    constexpr uint32_t fileMagic = 0x58444941; // "AIDX"
+    constexpr uint32_t fileVersion = 1;
+
+    struct FileHeader
+    {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+
+        uint64_t entryCount = 0;
+        uint64_t dataSize = 0;
+        uint64_t dataHash = 0;
+    };
+
+    static_assert(sizeof(FileHeader) == 32);
+
+    void writeEntry(common::binary_writer& writer, editor::assets::AssetIndexEntry const& entry)
+    {
+        editor::assets::AssetMetadata const& metadata = entry.metadata;
+
+        common::binary_write(writer, entry.id);
+        common::binary_write(writer, metadata.version);
+        common::binary_write(writer, static_cast<uint16_t>(metadata.type));
+        common::binary_write(writer, metadata.contentHash);
+        common::binary_write(writer, metadata.name);
+        common::binary_write(writer, metadata.sourcePath);
+        common::binary_write(writer, metadata.files);
+    }
+
+    bool readEntry(common::binary_reader& reader, editor::assets::AssetIndexEntry& entry)
+    {
+        editor::assets::AssetMetadata& metadata = entry.metadata;
+
+        uint16_t type = 0;
+
+        bool success = common::binary_read(reader, entry.id)
+            && common::binary_read(reader, metadata.version)
+            && common::binary_read(reader, type)
+            && common::binary_read(reader, metadata.contentHash)
+            && common::binary_read(reader, metadata.name)
+            && common::binary_read(reader, metadata.sourcePath)
+            && common::binary_read(reader, metadata.files);
+
+        if (!success)
+            return false;
+
+        if (type > static_cast<uint16_t>(editor::assets::AssetType::Scene))
+            return false;
+        metadata.type = static_cast<editor::assets::AssetType>(type);
+
+        return true;
+    }
+}
+
+nstl::vector<unsigned char> editor::assets::writeAssetIndexFile(nstl::span<AssetIndexEntry const> entries)
+{
+    nstl::vector<unsigned char> file;
+    file.resize(sizeof(FileHeader));
+
+    common::binary_writer writer{ file };
+    for (AssetIndexEntry const& entry : entries)
+        writeEntry(writer, entry);
+
+    nstl::blob_view data = nstl::blob_view{ file.data(), file.size() }.subview(sizeof(FileHeader));
+
+    FileHeader header{
+        .magic = fileMagic,
+        .version = fileVersion,
+        .entryCount = entries.size(),
+        .dataSize = data.size(),
+        .dataHash = nstl::hash_bytes(data.data(), data.size()),
+    };
+    memcpy(file.data(), &header, sizeof(header));
+
+    return file;
+}
+
+editor::assets::AssetIndexReadCode editor::assets::readAssetIndexFile(nstl::blob_view file, nstl::vector<AssetIndexEntry>& entries)
+{
+    if (file.size() < sizeof(FileHeader))
+        return AssetIndexReadCode::ErrorTooSmall;
+
+    FileHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+
+    if (header.magic != fileMagic)
+        return AssetIndexReadCode::ErrorInvalidMagic;
+    if (header.version != fileVersion)
+        return AssetIndexReadCode::ErrorUnsupportedVersion;
+
+    nstl::blob_view data = file.subview(sizeof(FileHeader));
+    if (header.dataSize != data.size())
+        return AssetIndexReadCode::ErrorSizeMismatch;
+    if (header.dataHash != nstl::hash_bytes(data.data(), data.size()))
+        return AssetIndexReadCode::ErrorHashMismatch;
+
+    // Every entry takes at least 40 bytes, which bounds the reservation for a corrupted count
+    if (header.entryCount > data.size() / 40)
+        return AssetIndexReadCode::ErrorCorrupted;
+
+    entries.clear();
+    entries.reserve(header.entryCount);
+
+    common::binary_reader reader{ data };
+    for (uint64_t i = 0; i < header.entryCount; i++)
+        if (!readEntry(reader, entries.emplace_back()))
+            return AssetIndexReadCode::ErrorCorrupted;
+
+    if (!reader.is_at_end())
+        return AssetIndexReadCode::ErrorCorrupted;
+
+    return AssetIndexReadCode::Success;
+}
+
+char const* editor::assets::toString(AssetIndexReadCode code)
+{
+    switch (code)
+    {
+    case AssetIndexReadCode::Success: return "success";
+    case AssetIndexReadCode::ErrorTooSmall: return "file is too small";
+    case AssetIndexReadCode::ErrorInvalidMagic: return "invalid magic";
+    case AssetIndexReadCode::ErrorUnsupportedVersion: return "unsupported version";
+    case AssetIndexReadCode::ErrorSizeMismatch: return "data size mismatch";
+    case AssetIndexReadCode::ErrorHashMismatch: return "data hash mismatch";
+    case AssetIndexReadCode::ErrorCorrupted: return "corrupted entries";
+    }
+
+    return "unknown";
+}
@@ -28,7 +28,7 @@ editor::assets::Uuid editor::assets::generateUuid()
 
 size_t nstl::hash<editor::assets::Uuid>::operator()(editor::assets::Uuid const& value) const
 {
-    return nstl::hash_values(value.bytes);
+    return nstl::hash_bytes(value.bytes, sizeof(value.bytes));
 }
 
 yyjsoncpp::optional<editor::assets::Uuid> yyjsoncpp::serializer<editor::assets::Uuid>::from_json(yyjsoncpp::value_ref obj)
@@ -1,9 +1,14 @@
 #pragma once
 
+#include "nstl/string.h"
 #include "nstl/string_view.h"
+#include "nstl/vector.h"
 
 namespace fs
 {
     void create_directory(nstl::string_view path);
     void create_directories(nstl::string_view path);
+    [[nodiscard]] bool remove_directory(nstl::string_view path); // Only removes empty directories
+
+    nstl::vector<nstl::string> list_directory(nstl::string_view path);
 }
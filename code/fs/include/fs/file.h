@@ -35,4 +35,8 @@ namespace fs
         platform::file_storage_t m_storage;
         bool m_is_open = false;
     };
+
+    // Replaces the destination file if it exists
+    [[nodiscard]] bool rename_file(nstl::string_view from, nstl::string_view to);
+    [[nodiscard]] bool remove_file(nstl::string_view path);
 }
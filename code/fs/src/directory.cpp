@@ -14,3 +14,13 @@ void fs::create_directories(nstl::string_view path)
     for (nstl::string_view part : path::walker{ path })
         create_directory(part);
 }
+
+bool fs::remove_directory(nstl::string_view path)
+{
+    return platform::remove_directory(path);
+}
+
+nstl::vector<nstl::string> fs::list_directory(nstl::string_view path)
+{
+    return platform::list_directory(path);
+}
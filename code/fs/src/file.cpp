@@ -71,3 +71,13 @@ void fs::file::write(void const* data, size_t size, size_t offset)
     [[maybe_unused]] bool res = try_write(data, size, offset);
     assert(res);
 }
+
+bool fs::rename_file(nstl::string_view from, nstl::string_view to)
+{
+    return platform::rename_file(from, to);
+}
+
+bool fs::remove_file(nstl::string_view path)
+{
+    return platform::remove_file(path);
+}
@@ -22,11 +22,18 @@ namespace gfx
         [[nodiscard]] virtual descriptorgroup_handle create_descriptorgroup(descriptorgroup_params const& params) = 0;
         [[nodiscard]] virtual shader_handle create_shader(shader_params const& params) = 0;
         [[nodiscard]] virtual renderstate_handle create_renderstate(renderstate_params const& params) = 0;
+        virtual void destroy_renderstate(renderstate_handle handle) = 0;
 
         virtual void begin_resource_update() = 0;
         virtual void buffer_upload_sync(buffer_handle handle, gfx::data_reader& reader, size_t offset) = 0;
         virtual void image_upload_sync(gfx::image_handle handle, data_reader& reader) = 0;
 
+        // The data is consumed immediately, only the copy to the resource is asynchronous
+        [[nodiscard]] virtual upload_ticket buffer_upload_async(buffer_handle handle, gfx::data_reader& reader, size_t offset) = 0;
+        [[nodiscard]] virtual upload_ticket image_upload_async(gfx::image_handle handle, data_reader& reader) = 0;
+        [[nodiscard]] virtual bool is_upload_complete(upload_ticket ticket) = 0;
+        virtual void wait_for_upload(upload_ticket ticket) = 0;
+
         [[nodiscard]] virtual renderpass_handle get_main_renderpass() = 0;
         [[nodiscard]] virtual framebuffer_handle acquire_main_framebuffer() = 0;
         [[nodiscard]] virtual float get_main_framebuffer_aspect() = 0;
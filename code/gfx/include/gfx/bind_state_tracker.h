@@ -0,0 +1,64 @@
+#pragma once
+
+#include "gfx/resources.h"
+
+#include "nstl/optional.h"
+#include "nstl/span.h"
+#include "nstl/vector.h"
+
+#include <stdint.h>
+
+namespace gfx
+{
+    struct bind_counter
+    {
+        size_t issued_count = 0;
+        size_t skipped_count = 0;
+    };
+
+    struct bind_statistics
+    {
+        bind_counter renderstates;
+        bind_counter descriptorgroups; // counted per group
+        bind_counter vertex_buffers; // counted per binding
+        bind_counter index_buffers;
+        bind_counter scissors;
+    };
+
+    // Backend-agnostic tracking of the state bound to a command buffer,
+    // so that the backends only issue the binds that actually change something
+    class bind_state_tracker
+    {
+    public:
+        // Forgets everything that was bound, e.g. at the renderpass boundaries
+        void reset();
+
+        // layout_id identifies the descriptor layout of the renderstate: descriptorgroups are invalidated when it changes
+        [[nodiscard]] bool bind_renderstate(renderstate_handle renderstate, uint64_t layout_id);
+
+        // Return the index of the first slot that has to be rebound: all slots starting from it should be bound
+        [[nodiscard]] nstl::optional<size_t> bind_descriptorgroups(nstl::span<descriptorgroup_handle const> descriptorgroups);
+        [[nodiscard]] nstl::optional<size_t> bind_vertex_buffers(nstl::span<buffer_with_offset const> vertex_buffers);
+
+        [[nodiscard]] bool bind_index_buffer(buffer_with_offset const& index_buffer, index_type type);
+        [[nodiscard]] bool set_scissor(nstl::optional<rect> const& scissor);
+
+        bind_statistics const& get_statistics() const { return m_statistics; }
+        void reset_statistics() { m_statistics = {}; }
+
+    private:
+        nstl::optional<renderstate_handle> m_renderstate;
+        uint64_t m_layout_id = 0;
+
+        nstl::vector<descriptorgroup_handle> m_descriptorgroups;
+        nstl::vector<buffer_with_offset> m_vertex_buffers;
+
+        nstl::optional<buffer_with_offset> m_index_buffer;
+        index_type m_index_type = index_type::uint16;
+
+        bool m_has_scissor = false;
+        nstl::optional<rect> m_scissor;
+
+        bind_statistics m_statistics;
+    };
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "gfx/resources.h"
+
+#include "nstl/optional.h"
+#include "nstl/span.h"
+#include "nstl/vector.h"
+
+#include <stdint.h>
+
+namespace gfx
+{
+    class renderer;
+
+    struct draw_sort_key_params
+    {
+        uint8_t pass = 0; // 4 bits, passes are replayed in ascending order
+        bool translucent = false; // translucent draws go after the opaque ones of the same pass
+        uint16_t renderstate = 0; // caller-assigned ids: draws sharing them are grouped together
+        uint16_t material = 0;
+        float depth = 0.0f; // distance to the viewer: opaque draws are sorted front-to-back, translucent ones back-to-front
+    };
+
+    // Opaque:      pass:4 | 0:1 | renderstate:16 | material:16 | depth:27
+    // Translucent: pass:4 | 1:1 | ~depth:27 | renderstate:16 | material:16
+    [[nodiscard]] uint64_t make_draw_sort_key(draw_sort_key_params const& params);
+
+    // Collects draw packets and replays them onto the renderer in the order of their sort keys,
+    // so that the state changes are minimized. Draws with equal keys keep their submission order
+    class draw_queue
+    {
+    public:
+        // The spans of the args are copied, so they don't have to outlive the call
+        void submit(uint64_t sort_key, draw_indexed_args const& args);
+
+        // Replays the packets sorted by their keys and clears the queue
+        void flush(renderer& renderer);
+
+        void clear();
+
+        size_t size() const { return m_packets.size(); }
+        bool empty() const { return m_packets.empty(); }
+
+        // Indices of the submitted packets in the replay order
+        nstl::span<uint32_t const> sort();
+
+    private:
+        struct packet
+        {
+            uint64_t sort_key = 0;
+
+            renderstate_handle renderstate = nullptr;
+            size_t descriptorgroups_offset = 0;
+            size_t descriptorgroups_count = 0;
+            nstl::optional<rect> scissor;
+
+            size_t vertex_buffers_offset = 0;
+            size_t vertex_buffers_count = 0;
+            buffer_with_offset index_buffer;
+            index_type index_type = index_type::uint16;
+
+            size_t index_count = 0;
+            size_t first_index = 0;
+            size_t vertex_offset = 0;
+
+            size_t instance_count = 1;
+        };
+
+    private:
+        nstl::vector<packet> m_packets;
+        nstl::vector<descriptorgroup_handle> m_descriptorgroups;
+        nstl::vector<buffer_with_offset> m_vertex_buffers;
+
+        nstl::vector<uint32_t> m_order;
+        nstl::vector<uint32_t> m_order_scratch;
+    };
+}
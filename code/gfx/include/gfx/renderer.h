@@ -1,6 +1,7 @@
 #pragma once
 
 #include "gfx/backend.h"
+#include "gfx/renderstate_cache.h"
 #include "gfx/resources.h"
 
 #include "nstl/span.h"
@@ -27,6 +28,7 @@ namespace gfx
     // * renderpass_begin/renderpass_end with the main framebuffer is called exactly once per frame
     // * if a resource is mutable, then it should be fully updated each frame it's used (no incremental frame-to-frame modifications, no skipping frames)
     // * Images that are uploaded and sampled should have usage "upload_sampled"
+    // * A resource updated with an async upload isn't used for drawing until its ticket is complete
     // * attribute_description::buffer_binding_index is a valid index into vertex_configuration_view::buffer_bindings
     // * attribute_description::location is unique
     //////////////////////////////////////////////////////////////////////////
@@ -49,15 +51,23 @@ namespace gfx
         [[nodiscard]] framebuffer_handle create_framebuffer(framebuffer_params const& params) { return m_backend->create_framebuffer(params); }
         [[nodiscard]] descriptorgroup_handle create_descriptorgroup(descriptorgroup_params const& params) { return m_backend->create_descriptorgroup(params); }
         [[nodiscard]] shader_handle create_shader(shader_params const& params) { return m_backend->create_shader(params); }
-        [[nodiscard]] renderstate_handle create_renderstate(renderstate_params const& params) { return m_backend->create_renderstate(params); }
+        [[nodiscard]] renderstate_handle create_renderstate(renderstate_params const& params); // identical renderstates are shared
+        void destroy_renderstate(renderstate_handle handle);
 
         // Resource update
         void begin_resource_update() { return m_backend->begin_resource_update(); }
-        void buffer_upload_sync(buffer_handle handle, gfx::data_reader& reader, size_t offset = 0) { return m_backend->buffer_upload_sync(handle, reader, offset); } // TODO: add async upload
+        void buffer_upload_sync(buffer_handle handle, gfx::data_reader& reader, size_t offset = 0) { return m_backend->buffer_upload_sync(handle, reader, offset); }
         void buffer_upload_sync(buffer_handle handle, nstl::blob_view bytes, size_t offset = 0);
-        void image_upload_sync(image_handle handle, data_reader& reader) { return m_backend->image_upload_sync(handle, reader); } // TODO: add async upload
+        void image_upload_sync(image_handle handle, data_reader& reader) { return m_backend->image_upload_sync(handle, reader); }
         void image_upload_sync(image_handle handle, nstl::blob_view bytes);
 
+        [[nodiscard]] upload_ticket buffer_upload_async(buffer_handle handle, gfx::data_reader& reader, size_t offset = 0) { return m_backend->buffer_upload_async(handle, reader, offset); }
+        [[nodiscard]] upload_ticket buffer_upload_async(buffer_handle handle, nstl::blob_view bytes, size_t offset = 0);
+        [[nodiscard]] upload_ticket image_upload_async(image_handle handle, data_reader& reader) { return m_backend->image_upload_async(handle, reader); }
+        [[nodiscard]] upload_ticket image_upload_async(image_handle handle, nstl::blob_view bytes);
+        [[nodiscard]] bool is_upload_complete(upload_ticket ticket) { return m_backend->is_upload_complete(ticket); }
+        void wait_for_upload(upload_ticket ticket) { return m_backend->wait_for_upload(ticket); }
+
         // Main framebuffer resources
         [[nodiscard]] renderpass_handle get_main_renderpass() { return m_backend->get_main_renderpass(); }
         [[nodiscard]] framebuffer_handle acquire_main_framebuffer() { return m_backend->acquire_main_framebuffer(); }
@@ -73,7 +83,10 @@ namespace gfx
 
         void submit() { return m_backend->submit(); }
 
+        renderstate_cache_statistics const& get_renderstate_cache_statistics() const { return m_renderstates.get_statistics(); }
+
     private:
         nstl::unique_ptr<backend> m_backend;
+        renderstate_cache m_renderstates;
     };
 }
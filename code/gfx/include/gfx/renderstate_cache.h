@@ -0,0 +1,59 @@
+#pragma once
+
+#include "gfx/resources.h"
+
+#include "nstl/optional.h"
+#include "nstl/unordered_map.h"
+#include "nstl/vector.h"
+
+namespace gfx
+{
+    struct renderstate_cache_statistics
+    {
+        size_t request_count = 0; // calls to create_renderstate
+        size_t hit_count = 0; // requests served with an existing renderstate
+        size_t unique_count = 0; // renderstates currently alive in the backend
+    };
+
+    // Hash-consing of renderstate descriptions: identical descriptions share
+    // a single backend renderstate, which is kept alive while it has references
+    class renderstate_cache
+    {
+    public:
+        // Returns the existing renderstate and adds a reference to it
+        [[nodiscard]] renderstate_handle acquire(renderstate_params const& params);
+        void add(renderstate_params const& params, renderstate_handle handle);
+
+        // Returns true if it was the last reference and the renderstate should be destroyed
+        [[nodiscard]] bool release(renderstate_handle handle);
+
+        renderstate_cache_statistics const& get_statistics() const { return m_statistics; }
+
+    private:
+        struct entry
+        {
+            size_t hash = 0;
+
+            nstl::vector<shader_handle> shaders;
+            renderpass_handle renderpass = nullptr;
+            vertex_configuration_storage vertex_config;
+            nstl::vector<descriptorgroup_layout_storage> descriptorgroup_layouts;
+            renderstate_flags flags;
+
+            renderstate_handle handle = nullptr;
+            size_t ref_count = 0;
+        };
+
+    private:
+        nstl::optional<size_t> find(renderstate_params const& params, size_t hash) const;
+
+    private:
+        nstl::vector<entry> m_entries;
+        nstl::vector<size_t> m_free_entries;
+
+        nstl::unordered_map<size_t, nstl::vector<size_t>> m_entries_by_hash;
+        nstl::unordered_map<void*, size_t> m_entries_by_handle;
+
+        renderstate_cache_statistics m_statistics;
+    };
+}
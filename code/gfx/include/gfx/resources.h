@@ -24,7 +24,7 @@ namespace gfx
     {
         // TODO add alignment requirements
         virtual size_t get_size() const = 0;
-        virtual bool read(void* destination, size_t size) = 0;
+        virtual bool read(void* destination, size_t size) = 0; // reads the next `size` bytes, so that big uploads can be split into chunks
     };
 
     struct memory_reader : gfx::data_reader
@@ -34,12 +34,25 @@ namespace gfx
         size_t get_size() const override { return bytes.size(); }
         bool read(void* destination, size_t size) override
         {
-            assert(size <= get_size());
-            memcpy(destination, bytes.data(), size);
+            assert(position + size <= get_size());
+            memcpy(destination, static_cast<unsigned char const*>(bytes.data()) + position, size);
+            position += size;
             return true;
         }
 
         nstl::blob_view bytes;
+        size_t position = 0;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+
+    // Identifies an asynchronous upload. An empty ticket is always complete
+    struct upload_ticket
+    {
+        uint64_t value = 0;
+
+        explicit operator bool() const { return value != 0; }
+        bool operator==(upload_ticket const& rhs) const = default;
     };
 
     //////////////////////////////////////////////////////////////////////////
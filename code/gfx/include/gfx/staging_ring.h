@@ -0,0 +1,52 @@
+#pragma once
+
+#include "nstl/optional.h"
+#include "nstl/vector.h"
+
+#include <stdint.h>
+
+namespace gfx
+{
+    // Backend-agnostic bookkeeping of a ring-buffered staging memory.
+    // Allocations are grouped into batches identified by a monotonically increasing ticket;
+    // the memory of a batch is reclaimed once the backend reports its ticket as completed
+    class staging_ring
+    {
+    public:
+        staging_ring(size_t size);
+
+        // Returns the offset of a contiguous range, or an empty optional if the ring
+        // doesn't have enough free space until some batches are retired.
+        // The alignment doesn't have to be a power of 2 (e.g. 3-byte texel formats)
+        [[nodiscard]] nstl::optional<size_t> allocate(size_t size, size_t alignment = 1);
+
+        // Assigns all allocations made since the previous call to the given ticket
+        void close_batch(uint64_t ticket);
+
+        // Reclaims the memory of all closed batches with tickets up to completed_ticket
+        void retire(uint64_t completed_ticket);
+
+        size_t get_size() const { return m_size; }
+        size_t get_used_size() const { return m_used_size; }
+        size_t get_pending_batch_count() const { return m_batches.size(); }
+        bool has_open_allocations() const { return m_open_size > 0; }
+
+    private:
+        struct batch
+        {
+            uint64_t ticket = 0;
+            size_t end = 0;
+            size_t size = 0;
+        };
+
+    private:
+        size_t m_size = 0;
+
+        size_t m_head = 0; // next allocation starts here
+        size_t m_tail = 0; // oldest allocation in use starts here
+        size_t m_used_size = 0;
+        size_t m_open_size = 0;
+
+        nstl::vector<batch> m_batches; // TODO use a ring buffer instead
+    };
+}
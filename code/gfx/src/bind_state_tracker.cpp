@@ -0,0 +1,110 @@
+#include "gfx/bind_state_tracker.h"
+
+namespace
+{
+    bool operator==(gfx::buffer_with_offset const& lhs, gfx::buffer_with_offset const& rhs)
+    {
+        return lhs.buffer == rhs.buffer && lhs.offset == rhs.offset;
+    }
+
+    bool operator==(gfx::rect const& lhs, gfx::rect const& rhs)
+    {
+        return lhs.offset.x == rhs.offset.x && lhs.offset.y == rhs.offset.y && lhs.size.x == rhs.size.x && lhs.size.y == rhs.size.y;
+    }
+
+    template<typename T>
+    nstl::optional<size_t> bind_slots(nstl::vector<T>& bound, nstl::span<T const> values, gfx::bind_counter& counter)
+    {
+        size_t first_dirty = 0;
+        while (first_dirty < values.size() && first_dirty < bound.size() && bound[first_dirty] == values[first_dirty])
+            first_dirty++;
+
+        counter.skipped_count += first_dirty;
+        counter.issued_count += values.size() - first_dirty;
+
+        if (first_dirty == values.size())
+            return {};
+
+        // Slots after the new ones stay bound, so only the ones that are used are replaced
+        if (bound.size() < values.size())
+            bound.resize(values.size());
+        for (size_t i = first_dirty; i < values.size(); i++)
+            bound[i] = values[i];
+
+        return first_dirty;
+    }
+}
+
+void gfx::bind_state_tracker::reset()
+{
+    m_renderstate = {};
+    m_layout_id = 0;
+
+    m_descriptorgroups.clear();
+    m_vertex_buffers.clear();
+
+    m_index_buffer = {};
+
+    m_has_scissor = false;
+    m_scissor = {};
+}
+
+bool gfx::bind_state_tracker::bind_renderstate(renderstate_handle renderstate, uint64_t layout_id)
+{
+    if (m_renderstate && *m_renderstate == renderstate)
+    {
+        m_statistics.renderstates.skipped_count++;
+        return false;
+    }
+
+    // Descriptor sets are kept only while the layouts are compatible; identical layouts are the only case tracked here
+    if (!m_renderstate || m_layout_id != layout_id)
+        m_descriptorgroups.clear();
+
+    m_renderstate = renderstate;
+    m_layout_id = layout_id;
+
+    m_statistics.renderstates.issued_count++;
+    return true;
+}
+
+nstl::optional<size_t> gfx::bind_state_tracker::bind_descriptorgroups(nstl::span<descriptorgroup_handle const> descriptorgroups)
+{
+    return bind_slots(m_descriptorgroups, descriptorgroups, m_statistics.descriptorgroups);
+}
+
+nstl::optional<size_t> gfx::bind_state_tracker::bind_vertex_buffers(nstl::span<buffer_with_offset const> vertex_buffers)
+{
+    return bind_slots(m_vertex_buffers, vertex_buffers, m_statistics.vertex_buffers);
+}
+
+bool gfx::bind_state_tracker::bind_index_buffer(buffer_with_offset const& index_buffer, index_type type)
+{
+    if (m_index_buffer && *m_index_buffer == index_buffer && m_index_type == type)
+    {
+        m_statistics.index_buffers.skipped_count++;
+        return false;
+    }
+
+    m_index_buffer = index_buffer;
+    m_index_type = type;
+
+    m_statistics.index_buffers.issued_count++;
+    return true;
+}
+
+bool gfx::bind_state_tracker::set_scissor(nstl::optional<rect> const& scissor)
+{
+    bool is_same = m_has_scissor && m_scissor.has_value() == scissor.has_value() && (!scissor || *m_scissor == *scissor);
+    if (is_same)
+    {
+        m_statistics.scissors.skipped_count++;
+        return false;
+    }
+
+    m_has_scissor = true;
+    m_scissor = scissor;
+
+    m_statistics.scissors.issued_count++;
+    return true;
+}
@@ -0,0 +1,162 @@
+#include "gfx/draw_queue.h"
+
+#include "gfx/renderer.h"
+
+#include "nstl/array.h"
+
+#include <string.h>
+
+namespace
+{
+    constexpr size_t depth_bits = 27;
+    constexpr uint64_t depth_mask = (uint64_t{ 1 } << depth_bits) - 1;
+
+    uint64_t quantize_depth(float depth)
+    {
+        // Bit patterns of non-negative floats are ordered the same way as the values
+        if (!(depth > 0.0f))
+            return 0;
+
+        uint32_t bits = 0;
+        static_assert(sizeof(bits) == sizeof(depth));
+        memcpy(&bits, &depth, sizeof(bits));
+
+        return (bits >> (31 - depth_bits)) & depth_mask;
+    }
+}
+
+uint64_t gfx::make_draw_sort_key(draw_sort_key_params const& params)
+{
+    assert(params.pass < 16);
+
+    uint64_t pass = uint64_t{ params.pass } & 0xf;
+    uint64_t renderstate = params.renderstate;
+    uint64_t material = params.material;
+    uint64_t depth = quantize_depth(params.depth);
+
+    if (params.translucent)
+        return (pass << 60) | (uint64_t{ 1 } << 59) | ((~depth & depth_mask) << 32) | (renderstate << 16) | material;
+
+    return (pass << 60) | (renderstate << 43) | (material << 27) | depth;
+}
+
+void gfx::draw_queue::submit(uint64_t sort_key, draw_indexed_args const& args)
+{
+    assert(m_packets.size() < UINT32_MAX);
+
+    m_packets.push_back({
+        .sort_key = sort_key,
+
+        .renderstate = args.renderstate,
+        .descriptorgroups_offset = m_descriptorgroups.size(),
+        .descriptorgroups_count = args.descriptorgroups.size(),
+        .scissor = args.scissor,
+
+        .vertex_buffers_offset = m_vertex_buffers.size(),
+        .vertex_buffers_count = args.vertex_buffers.size(),
+        .index_buffer = args.index_buffer,
+        .index_type = args.index_type,
+
+        .index_count = args.index_count,
+        .first_index = args.first_index,
+        .vertex_offset = args.vertex_offset,
+
+        .instance_count = args.instance_count,
+    });
+
+    for (descriptorgroup_handle handle : args.descriptorgroups)
+        m_descriptorgroups.push_back(handle);
+    for (buffer_with_offset const& buffer : args.vertex_buffers)
+        m_vertex_buffers.push_back(buffer);
+}
+
+void gfx::draw_queue::flush(renderer& renderer)
+{
+    for (uint32_t index : sort())
+    {
+        packet const& p = m_packets[index];
+
+        renderer.draw_indexed({
+            .renderstate = p.renderstate,
+            .descriptorgroups = nstl::span<descriptorgroup_handle const>{ m_descriptorgroups }.subspan(p.descriptorgroups_offset, p.descriptorgroups_count),
+            .scissor = p.scissor,
+
+            .vertex_buffers = nstl::span<buffer_with_offset const>{ m_vertex_buffers }.subspan(p.vertex_buffers_offset, p.vertex_buffers_count),
+            .index_buffer = p.index_buffer,
+            .index_type = p.index_type,
+
+            .index_count = p.index_count,
+            .first_index = p.first_index,
+            .vertex_offset = p.vertex_offset,
+
+            .instance_count = p.instance_count,
+        });
+    }
+
+    clear();
+}
+
+void gfx::draw_queue::clear()
+{
+    m_packets.clear();
+    m_descriptorgroups.clear();
+    m_vertex_buffers.clear();
+}
+
+nstl::span<uint32_t const> gfx::draw_queue::sort()
+{
+    // LSD radix sort by 8-bit digits. It's stable, so equal keys keep the submission order
+
+    constexpr size_t digit_bits = 8;
+    constexpr size_t digit_count = 64 / digit_bits;
+    constexpr size_t bucket_count = size_t{ 1 } << digit_bits;
+
+    size_t count = m_packets.size();
+
+    m_order.resize(count);
+    m_order_scratch.resize(count);
+    for (size_t i = 0; i < count; i++)
+        m_order[i] = static_cast<uint32_t>(i);
+
+    // Histograms of all digits are built in a single pass over the keys
+    nstl::array<nstl::array<uint32_t, bucket_count>, digit_count> histograms{};
+    for (packet const& p : m_packets)
+        for (size_t digit = 0; digit < digit_count; digit++)
+            histograms[digit][(p.sort_key >> (digit * digit_bits)) & (bucket_count - 1)]++;
+
+    for (size_t digit = 0; digit < digit_count; digit++)
+    {
+        nstl::array<uint32_t, bucket_count>& histogram = histograms[digit];
+
+        // Skip the digits which are the same in all keys, e.g. unused passes or ids
+        bool is_trivial = true;
+        for (uint32_t bucket_size : histogram)
+        {
+            if (bucket_size == 0)
+                continue;
+
+            is_trivial = bucket_size == count;
+            break;
+        }
+        if (is_trivial)
+            continue;
+
+        uint32_t offset = 0;
+        for (uint32_t& bucket : histogram)
+        {
+            uint32_t bucket_size = bucket;
+            bucket = offset;
+            offset += bucket_size;
+        }
+
+        for (uint32_t index : m_order)
+        {
+            size_t bucket = (m_packets[index].sort_key >> (digit * digit_bits)) & (bucket_count - 1);
+            m_order_scratch[histogram[bucket]++] = index;
+        }
+
+        nstl::exchange(m_order, m_order_scratch);
+    }
+
+    return m_order;
+}
@@ -12,6 +12,22 @@ void gfx::renderer::set_backend(nstl::unique_ptr<backend> backend)
     m_backend = nstl::move(backend);
 }
 
+gfx::renderstate_handle gfx::renderer::create_renderstate(renderstate_params const& params)
+{
+    if (renderstate_handle handle = m_renderstates.acquire(params))
+        return handle;
+
+    renderstate_handle handle = m_backend->create_renderstate(params);
+    m_renderstates.add(params, handle);
+    return handle;
+}
+
+void gfx::renderer::destroy_renderstate(renderstate_handle handle)
+{
+    if (m_renderstates.release(handle))
+        m_backend->destroy_renderstate(handle);
+}
+
 void gfx::renderer::buffer_upload_sync(buffer_handle handle, nstl::blob_view bytes, size_t offset)
 {
     memory_reader reader{ bytes };
@@ -23,3 +39,15 @@ void gfx::renderer::image_upload_sync(image_handle handle, nstl::blob_view bytes
     memory_reader reader{ bytes };
     return image_upload_sync(handle, reader);
 }
+
+gfx::upload_ticket gfx::renderer::buffer_upload_async(buffer_handle handle, nstl::blob_view bytes, size_t offset)
+{
+    memory_reader reader{ bytes };
+    return buffer_upload_async(handle, reader, offset);
+}
+
+gfx::upload_ticket gfx::renderer::image_upload_async(image_handle handle, nstl::blob_view bytes)
+{
+    memory_reader reader{ bytes };
+    return image_upload_async(handle, reader);
+}
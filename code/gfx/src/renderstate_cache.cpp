@@ -0,0 +1,187 @@
+#include "gfx/renderstate_cache.h"
+
+#include "nstl/hash.h"
+
+namespace
+{
+    void hash_enum(size_t& hash, auto value)
+    {
+        nstl::hash_combine(hash, static_cast<size_t>(value));
+    }
+
+    size_t hash_params(gfx::renderstate_params const& params)
+    {
+        size_t hash = 0;
+
+        for (gfx::shader_handle shader : params.shaders)
+            nstl::hash_combine(hash, shader.ptr);
+        nstl::hash_combine(hash, params.renderpass.ptr);
+
+        for (gfx::buffer_binding_description const& binding : params.vertex_config.buffer_bindings)
+        {
+            nstl::hash_combine(hash, binding.buffer_index);
+            nstl::hash_combine(hash, binding.stride);
+        }
+        for (gfx::attribute_description const& attribute : params.vertex_config.attributes)
+        {
+            nstl::hash_combine(hash, attribute.location);
+            nstl::hash_combine(hash, attribute.buffer_binding_index);
+            nstl::hash_combine(hash, attribute.offset);
+            hash_enum(hash, attribute.type);
+        }
+        hash_enum(hash, params.vertex_config.topology);
+
+        for (gfx::descriptorgroup_layout_view const& layout : params.descriptorgroup_layouts)
+        {
+            nstl::hash_combine(hash, layout.entries.size());
+            for (gfx::descriptor_layout_entry const& entry : layout.entries)
+            {
+                nstl::hash_combine(hash, entry.location);
+                hash_enum(hash, entry.type);
+            }
+        }
+
+        nstl::hash_combine(hash, params.flags.cull_backfaces);
+        nstl::hash_combine(hash, params.flags.wireframe);
+        nstl::hash_combine(hash, params.flags.depth_test);
+        nstl::hash_combine(hash, params.flags.alpha_blending);
+        nstl::hash_combine(hash, params.flags.depth_bias);
+
+        return hash;
+    }
+}
+
+gfx::renderstate_handle gfx::renderstate_cache::acquire(renderstate_params const& params)
+{
+    m_statistics.request_count++;
+
+    nstl::optional<size_t> index = find(params, hash_params(params));
+    if (!index)
+        return nullptr;
+
+    m_statistics.hit_count++;
+
+    entry& e = m_entries[*index];
+    e.ref_count++;
+    return e.handle;
+}
+
+void gfx::renderstate_cache::add(renderstate_params const& params, renderstate_handle handle)
+{
+    assert(handle);
+    assert(m_entries_by_handle.find(handle.ptr) == m_entries_by_handle.end());
+
+    nstl::vector<descriptorgroup_layout_storage> layouts;
+    for (descriptorgroup_layout_view const& layout : params.descriptorgroup_layouts)
+        layouts.push_back(descriptorgroup_layout_storage::from_view(layout));
+
+    entry e{
+        .hash = hash_params(params),
+
+        .shaders = { params.shaders.begin(), params.shaders.end() },
+        .renderpass = params.renderpass,
+        .vertex_config = vertex_configuration_storage::from_view(params.vertex_config),
+        .descriptorgroup_layouts = nstl::move(layouts),
+        .flags = params.flags,
+
+        .handle = handle,
+        .ref_count = 1,
+    };
+
+    size_t index = m_entries.size();
+    if (!m_free_entries.empty())
+    {
+        index = m_free_entries.back();
+        m_free_entries.pop_back();
+        m_entries[index] = nstl::move(e);
+    }
+    else
+    {
+        m_entries.push_back(nstl::move(e));
+    }
+
+    size_t hash = m_entries[index].hash;
+    auto it = m_entries_by_hash.find(hash);
+    if (it == m_entries_by_hash.end())
+        it = m_entries_by_hash.insert_or_assign(hash, {});
+    it->value().push_back(index);
+
+    m_entries_by_handle.insert_or_assign(handle.ptr, index);
+
+    m_statistics.unique_count++;
+}
+
+bool gfx::renderstate_cache::release(renderstate_handle handle)
+{
+    auto handle_it = m_entries_by_handle.find(handle.ptr);
+    assert(handle_it != m_entries_by_handle.end());
+    if (handle_it == m_entries_by_handle.end())
+        return false;
+
+    size_t index = handle_it->value();
+    entry& e = m_entries[index];
+
+    assert(e.ref_count > 0);
+    e.ref_count--;
+    if (e.ref_count > 0)
+        return false;
+
+    auto hash_it = m_entries_by_hash.find(e.hash);
+    assert(hash_it != m_entries_by_hash.end());
+    nstl::vector<size_t>& bucket = hash_it->value();
+    for (size_t i = 0; i < bucket.size(); i++)
+    {
+        if (bucket[i] == index)
+        {
+            bucket[i] = bucket.back();
+            bucket.pop_back();
+            break;
+        }
+    }
+    if (bucket.empty())
+        m_entries_by_hash.erase(e.hash);
+
+    m_entries_by_handle.erase(handle.ptr);
+
+    e = {};
+    m_free_entries.push_back(index);
+
+    assert(m_statistics.unique_count > 0);
+    m_statistics.unique_count--;
+
+    return true;
+}
+
+nstl::optional<size_t> gfx::renderstate_cache::find(renderstate_params const& params, size_t hash) const
+{
+    auto it = m_entries_by_hash.find(hash);
+    if (it == m_entries_by_hash.end())
+        return {};
+
+    for (size_t index : it->value())
+    {
+        entry const& e = m_entries[index];
+
+        if (nstl::span<shader_handle const>{ e.shaders } != params.shaders)
+            continue;
+        if (e.renderpass != params.renderpass)
+            continue;
+        if (static_cast<vertex_configuration_view>(e.vertex_config) != params.vertex_config)
+            continue;
+        if (!(e.flags == params.flags))
+            continue;
+
+        if (e.descriptorgroup_layouts.size() != params.descriptorgroup_layouts.size())
+            continue;
+
+        bool same_layouts = true;
+        for (size_t i = 0; i < e.descriptorgroup_layouts.size(); i++)
+            same_layouts = same_layouts && static_cast<descriptorgroup_layout_view>(e.descriptorgroup_layouts[i]) == params.descriptorgroup_layouts[i];
+        if (!same_layouts)
+            continue;
+
+        return index;
+    }
+
+    return {};
+}
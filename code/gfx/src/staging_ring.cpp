@@ -0,0 +1,111 @@
+#include "gfx/staging_ring.h"
+
+#include <assert.h>
+
+namespace
+{
+    size_t round_up(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+gfx::staging_ring::staging_ring(size_t size) : m_size(size)
+{
+    assert(size > 0);
+}
+
+nstl::optional<size_t> gfx::staging_ring::allocate(size_t size, size_t alignment)
+{
+    assert(alignment > 0);
+
+    if (size == 0 || size > m_size)
+        return {};
+
+    if (m_used_size == 0)
+    {
+        // Nothing is in use, so start from the beginning to get the largest contiguous range
+        m_head = 0;
+        m_tail = 0;
+    }
+
+    bool is_full = m_used_size > 0 && m_head == m_tail;
+    if (is_full)
+        return {};
+
+    size_t offset = round_up(m_head, alignment);
+    size_t consumed = 0;
+
+    if (m_head >= m_tail)
+    {
+        // Free space is [head, size) and [0, tail)
+        if (offset + size <= m_size)
+        {
+            consumed = offset + size - m_head;
+        }
+        else if (size <= m_tail)
+        {
+            // The end of the ring is wasted until the batch retires
+            offset = 0;
+            consumed = m_size - m_head + size;
+        }
+        else
+        {
+            return {};
+        }
+    }
+    else
+    {
+        // Free space is [head, tail)
+        if (offset + size > m_tail)
+            return {};
+
+        consumed = offset + size - m_head;
+    }
+
+    m_head = offset + size;
+    if (m_head == m_size)
+        m_head = 0;
+
+    m_used_size += consumed;
+    m_open_size += consumed;
+
+    assert(m_used_size <= m_size);
+
+    return offset;
+}
+
+void gfx::staging_ring::close_batch(uint64_t ticket)
+{
+    if (m_open_size == 0)
+        return;
+
+    assert(m_batches.empty() || m_batches.back().ticket < ticket);
+
+    m_batches.push_back({
+        .ticket = ticket,
+        .end = m_head,
+        .size = m_open_size,
+    });
+
+    m_open_size = 0;
+}
+
+void gfx::staging_ring::retire(uint64_t completed_ticket)
+{
+    size_t retired_count = 0;
+    for (batch const& b : m_batches)
+    {
+        if (b.ticket > completed_ticket)
+            break;
+
+        assert(m_used_size >= b.size);
+        m_used_size -= b.size;
+        m_tail = b.end;
+
+        retired_count++;
+    }
+
+    if (retired_count > 0)
+        m_batches.erase(m_batches.begin(), m_batches.begin() + retired_count);
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "gfx_null/command_stream.h"
+
+#include "gfx/backend.h"
+#include "gfx/bind_state_tracker.h"
+#include "gfx/staging_ring.h"
+
+#include "nstl/array.h"
+#include "nstl/string_view.h"
+#include "nstl/vector.h"
+
+// Headless implementation of gfx::backend: validates the calls, tracks resources
+// and records everything into a command_stream instead of talking to a GPU
+
+namespace gfx_null
+{
+    enum class resource_type
+    {
+        buffer,
+        image,
+        sampler,
+        renderpass,
+        framebuffer,
+        descriptorgroup,
+        shader,
+        renderstate,
+
+        count,
+    };
+
+    struct config
+    {
+        size_t main_framebuffer_count = 3;
+        bool record_commands = true; // disable to measure the cost of the frontend only
+
+        size_t staging_buffer_size = 64 * 1024 * 1024;
+        size_t upload_latency_frames = 1; // async uploads complete this many resource updates after they were issued
+    };
+
+    struct resource_lifetime
+    {
+        size_t created_frame = 0;
+        size_t last_used_frame = 0;
+        size_t use_count = 0;
+    };
+
+    struct statistics
+    {
+        size_t frame_count = 0;
+        nstl::array<size_t, static_cast<size_t>(resource_type::count)> resource_counts{};
+
+        size_t renderpass_count = 0;
+        size_t draw_count = 0;
+        size_t index_count = 0;
+
+        size_t buffer_upload_count = 0;
+        size_t image_upload_count = 0;
+        size_t uploaded_bytes = 0;
+        size_t upload_stall_count = 0; // times an upload had to wait for the staging memory
+
+        size_t destroyed_renderstate_count = 0;
+
+        size_t validation_errors = 0;
+    };
+
+    class backend final : public gfx::backend
+    {
+    public:
+        backend(size_t w, size_t h, config const& config = {});
+        ~backend() override;
+
+        void resize_main_framebuffer(size_t w, size_t h) override;
+
+        [[nodiscard]] gfx::buffer_handle create_buffer(gfx::buffer_params const& params) override;
+        [[nodiscard]] gfx::image_handle create_image(gfx::image_params const& params) override;
+        [[nodiscard]] gfx::sampler_handle create_sampler(gfx::sampler_params const& params) override;
+        [[nodiscard]] gfx::renderpass_handle create_renderpass(gfx::renderpass_params const& params) override;
+        [[nodiscard]] gfx::framebuffer_handle create_framebuffer(gfx::framebuffer_params const& params) override;
+        [[nodiscard]] gfx::descriptorgroup_handle create_descriptorgroup(gfx::descriptorgroup_params const& params) override;
+        [[nodiscard]] gfx::shader_handle create_shader(gfx::shader_params const& params) override;
+        [[nodiscard]] gfx::renderstate_handle create_renderstate(gfx::renderstate_params const& params) override;
+        void destroy_renderstate(gfx::renderstate_handle handle) override;
+
+        void begin_resource_update() override;
+        void buffer_upload_sync(gfx::buffer_handle handle, gfx::data_reader& reader, size_t offset) override;
+        void image_upload_sync(gfx::image_handle handle, gfx::data_reader& reader) override;
+        [[nodiscard]] gfx::upload_ticket buffer_upload_async(gfx::buffer_handle handle, gfx::data_reader& reader, size_t offset) override;
+        [[nodiscard]] gfx::upload_ticket image_upload_async(gfx::image_handle handle, gfx::data_reader& reader) override;
+        [[nodiscard]] bool is_upload_complete(gfx::upload_ticket ticket) override;
+        void wait_for_upload(gfx::upload_ticket ticket) override;
+
+        [[nodiscard]] gfx::renderpass_handle get_main_renderpass() override;
+        [[nodiscard]] gfx::framebuffer_handle acquire_main_framebuffer() override;
+        [[nodiscard]] float get_main_framebuffer_aspect() override;
+
+        void begin_frame() override;
+
+        void renderpass_begin(gfx::renderpass_begin_params const& params) override;
+        void renderpass_end() override;
+
+        void draw_indexed(gfx::draw_indexed_args const& args) override;
+
+        void submit() override;
+
+    public:
+        command_stream const& get_command_stream() const { return m_commands; }
+        void clear_command_stream() { m_commands.clear(); }
+
+        statistics const& get_statistics() const { return m_statistics; }
+        gfx::bind_statistics const& get_bind_statistics() const { return m_bind_state.get_statistics(); }
+        void reset_statistics();
+
+        [[nodiscard]] bool is_valid(gfx::handle handle, resource_type type) const;
+        [[nodiscard]] resource_lifetime const* get_lifetime(gfx::handle handle) const;
+
+    private:
+        struct buffer_resource
+        {
+            gfx::buffer_params params;
+            resource_lifetime lifetime;
+        };
+
+        struct image_resource
+        {
+            gfx::image_params params;
+            resource_lifetime lifetime;
+        };
+
+        struct framebuffer_resource
+        {
+            gfx::renderpass_handle renderpass = nullptr;
+            resource_lifetime lifetime;
+        };
+
+        struct renderstate_resource
+        {
+            gfx::renderpass_handle renderpass = nullptr;
+            size_t descriptorgroup_layout_count = 0;
+            size_t buffer_binding_count = 0;
+            uint64_t layout_id = 0; // identical descriptorgroup layouts share the id, like the pipeline layouts do in Vulkan
+            bool destroyed = false;
+            resource_lifetime lifetime;
+        };
+
+        struct pending_upload
+        {
+            uint64_t ticket = 0;
+            size_t frame_index = 0;
+        };
+
+    private:
+        [[nodiscard]] resource_lifetime* find_lifetime(gfx::handle handle);
+        [[nodiscard]] resource_lifetime create_lifetime();
+        void mark_used(gfx::handle handle);
+
+        [[nodiscard]] bool validate(gfx::handle handle, resource_type type, nstl::string_view what);
+        [[nodiscard]] bool validate(bool condition, nstl::string_view what);
+
+        void record(command_type type, gfx::handle resource = nullptr, size_t payload_index = 0);
+
+        [[nodiscard]] gfx::upload_ticket stage_upload(gfx::data_reader& reader, nstl::string_view read_error);
+        void complete_uploads(uint64_t ticket);
+
+    private:
+        config m_config;
+
+        size_t m_width = 0;
+        size_t m_height = 0;
+
+        nstl::vector<buffer_resource> m_buffers;
+        nstl::vector<image_resource> m_images;
+        nstl::vector<resource_lifetime> m_samplers;
+        nstl::vector<resource_lifetime> m_renderpasses;
+        nstl::vector<framebuffer_resource> m_framebuffers;
+        nstl::vector<resource_lifetime> m_descriptorgroups;
+        nstl::vector<resource_lifetime> m_shaders;
+        nstl::vector<renderstate_resource> m_renderstates;
+
+        gfx::renderpass_handle m_main_renderpass = nullptr;
+        nstl::vector<gfx::framebuffer_handle> m_main_framebuffers;
+        size_t m_main_framebuffer_index = 0;
+
+        size_t m_frame_index = 0;
+        bool m_in_frame = false;
+        gfx::renderpass_handle m_current_renderpass = nullptr;
+        gfx::framebuffer_handle m_current_framebuffer = nullptr;
+
+        gfx::bind_state_tracker m_bind_state;
+
+        nstl::vector<unsigned char> m_upload_scratch;
+        gfx::staging_ring m_staging_ring;
+        nstl::vector<pending_upload> m_pending_uploads;
+        uint64_t m_next_upload_ticket = 1;
+        uint64_t m_completed_upload_ticket = 0;
+
+        command_stream m_commands;
+        statistics m_statistics;
+    };
+}
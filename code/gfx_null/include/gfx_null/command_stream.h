@@ -0,0 +1,116 @@
+#pragma once
+
+#include "gfx/resources.h"
+
+#include "nstl/optional.h"
+#include "nstl/span.h"
+#include "nstl/vector.h"
+
+#include <stdint.h>
+
+namespace gfx_null
+{
+    enum class command_type
+    {
+        create_buffer,
+        create_image,
+        create_sampler,
+        create_renderpass,
+        create_framebuffer,
+        create_descriptorgroup,
+        create_shader,
+        create_renderstate,
+        destroy_renderstate,
+
+        begin_resource_update,
+        buffer_upload,
+        image_upload,
+
+        acquire_main_framebuffer,
+        begin_frame,
+        renderpass_begin,
+        renderpass_end,
+        draw_indexed,
+        submit,
+    };
+
+    struct upload_command
+    {
+        gfx::handle resource = nullptr;
+        size_t size = 0;
+        size_t offset = 0;
+        gfx::upload_ticket ticket;
+    };
+
+    struct renderpass_begin_command
+    {
+        gfx::renderpass_handle renderpass = nullptr;
+        gfx::framebuffer_handle framebuffer = nullptr;
+    };
+
+    // Spans of the draw arguments are flattened into the pools of the command stream
+    struct draw_indexed_command
+    {
+        gfx::renderstate_handle renderstate = nullptr;
+
+        size_t first_descriptorgroup = 0;
+        size_t descriptorgroup_count = 0;
+
+        size_t first_vertex_buffer = 0;
+        size_t vertex_buffer_count = 0;
+
+        nstl::optional<gfx::rect> scissor;
+
+        gfx::buffer_with_offset index_buffer;
+        gfx::index_type index_type = gfx::index_type::uint16;
+
+        size_t index_count = 0;
+        size_t first_index = 0;
+        size_t vertex_offset = 0;
+
+        size_t instance_count = 1;
+    };
+
+    struct command
+    {
+        command_type type = command_type::submit;
+        size_t frame_index = 0;
+
+        // The created resource for create_* commands, the target resource otherwise
+        gfx::handle resource = nullptr;
+
+        // Index into the command-specific array of the stream (uploads, renderpass_begins or draws)
+        size_t payload_index = 0;
+    };
+
+    class command_stream
+    {
+    public:
+        void add(command_type type, size_t frame_index, gfx::handle resource = nullptr, size_t payload_index = 0);
+        size_t add_upload(upload_command const& upload);
+        size_t add_renderpass_begin(renderpass_begin_command const& begin);
+        size_t add_draw_indexed(gfx::draw_indexed_args const& args);
+
+        void clear();
+
+        nstl::span<command const> get_commands() const { return m_commands; }
+        size_t count(command_type type) const;
+
+        upload_command const& get_upload(command const& command) const;
+        renderpass_begin_command const& get_renderpass_begin(command const& command) const;
+        draw_indexed_command const& get_draw_indexed(command const& command) const;
+
+        nstl::span<gfx::descriptorgroup_handle const> get_descriptorgroups(draw_indexed_command const& draw) const;
+        nstl::span<gfx::buffer_with_offset const> get_vertex_buffers(draw_indexed_command const& draw) const;
+
+    private:
+        nstl::vector<command> m_commands;
+
+        nstl::vector<upload_command> m_uploads;
+        nstl::vector<renderpass_begin_command> m_renderpass_begins;
+        nstl::vector<draw_indexed_command> m_draws;
+
+        nstl::vector<gfx::descriptorgroup_handle> m_descriptorgroups;
+        nstl::vector<gfx::buffer_with_offset> m_vertex_buffers;
+    };
+}
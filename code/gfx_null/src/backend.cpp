@@ -0,0 +1,624 @@
+#include "gfx_null/backend.h"
+
+#include "logging/logging.h"
+
+#include "nstl/algorithm.h"
+#include "nstl/hash.h"
+#include "nstl/optional.h"
+
+namespace
+{
+    // Handles don't point to anything: they encode the resource type and the index
+    // into the corresponding container, so that they can be validated in O(1)
+    constexpr uintptr_t handle_type_bits = 4;
+    constexpr uintptr_t handle_type_mask = (uintptr_t{ 1 } << handle_type_bits) - 1;
+
+    static_assert(static_cast<uintptr_t>(gfx_null::resource_type::count) <= handle_type_mask);
+
+    struct decoded_handle
+    {
+        gfx_null::resource_type type;
+        size_t index;
+    };
+
+    template<typename H>
+    H encode_handle(gfx_null::resource_type type, size_t index)
+    {
+        uintptr_t value = ((static_cast<uintptr_t>(index) + 1) << handle_type_bits) | static_cast<uintptr_t>(type);
+        return H{ reinterpret_cast<void*>(value) };
+    }
+
+    uint64_t get_layout_id(nstl::span<gfx::descriptorgroup_layout_view const> layouts)
+    {
+        size_t hash = 0;
+        for (gfx::descriptorgroup_layout_view const& layout : layouts)
+        {
+            nstl::hash_combine(hash, layout.entries.size());
+            for (gfx::descriptor_layout_entry const& entry : layout.entries)
+            {
+                nstl::hash_combine(hash, entry.location);
+                nstl::hash_combine(hash, static_cast<size_t>(entry.type));
+            }
+        }
+        return hash;
+    }
+
+    nstl::optional<decoded_handle> decode_handle(gfx::handle handle)
+    {
+        uintptr_t value = reinterpret_cast<uintptr_t>(handle.ptr);
+        if (value == 0)
+            return {};
+
+        uintptr_t type = value & handle_type_mask;
+        uintptr_t index = value >> handle_type_bits;
+        if (type >= static_cast<uintptr_t>(gfx_null::resource_type::count) || index == 0)
+            return {};
+
+        return decoded_handle{ static_cast<gfx_null::resource_type>(type), static_cast<size_t>(index - 1) };
+    }
+
+    size_t get_index_size(gfx::index_type type)
+    {
+        switch (type)
+        {
+        case gfx::index_type::uint16:
+            return 2;
+        case gfx::index_type::uint32:
+            return 4;
+        }
+
+        assert(false);
+        return 0;
+    }
+}
+
+gfx_null::backend::backend(size_t w, size_t h, config const& config)
+    : m_config(config)
+    , m_width(w)
+    , m_height(h)
+    , m_staging_ring(config.staging_buffer_size)
+{
+    gfx::image_format color_format = gfx::image_format::b8g8r8a8_srgb;
+    gfx::image_format depth_format = gfx::image_format::d32_float;
+
+    m_main_renderpass = create_renderpass({
+        .color_attachment_formats = nstl::array{ color_format },
+        .depth_stencil_attachment_format = depth_format,
+
+        .has_presentable_images = true,
+        .keep_depth_values_after_renderpass = false,
+    });
+
+    for (size_t i = 0; i < m_config.main_framebuffer_count; i++)
+    {
+        gfx::image_handle color_image = create_image({
+            .width = w,
+            .height = h,
+            .format = color_format,
+            .type = gfx::image_type::color,
+            .usage = gfx::image_usage::color,
+        });
+
+        gfx::image_handle depth_image = create_image({
+            .width = w,
+            .height = h,
+            .format = depth_format,
+            .type = gfx::image_type::depth,
+            .usage = gfx::image_usage::depth,
+        });
+
+        m_main_framebuffers.push_back(create_framebuffer({
+            .attachments = nstl::array{ color_image, depth_image },
+            .renderpass = m_main_renderpass,
+        }));
+    }
+}
+
+gfx_null::backend::~backend() = default;
+
+void gfx_null::backend::resize_main_framebuffer(size_t w, size_t h)
+{
+    m_width = w;
+    m_height = h;
+}
+
+gfx::buffer_handle gfx_null::backend::create_buffer(gfx::buffer_params const& params)
+{
+    [[maybe_unused]] bool valid = validate(params.size > 0, "create_buffer: buffer size is zero");
+
+    m_buffers.push_back({ .params = params, .lifetime = create_lifetime() });
+    m_statistics.resource_counts[static_cast<size_t>(resource_type::buffer)]++;
+
+    auto handle = encode_handle<gfx::buffer_handle>(resource_type::buffer, m_buffers.size() - 1);
+    record(command_type::create_buffer, handle);
+    return handle;
+}
+
+gfx::image_handle gfx_null::backend::create_image(gfx::image_params const& params)
+{
+    [[maybe_unused]] bool valid = validate(params.width > 0 && params.height > 0, "create_image: image extent is zero");
+
+    m_images.push_back({ .params = params, .lifetime = create_lifetime() });
+    m_statistics.resource_counts[static_cast<size_t>(resource_type::image)]++;
+
+    auto handle = encode_handle<gfx::image_handle>(resource_type::image, m_images.size() - 1);
+    record(command_type::create_image, handle);
+    return handle;
+}
+
+gfx::sampler_handle gfx_null::backend::create_sampler(gfx::sampler_params const&)
+{
+    m_samplers.push_back(create_lifetime());
+    m_statistics.resource_counts[static_cast<size_t>(resource_type::sampler)]++;
+
+    auto handle = encode_handle<gfx::sampler_handle>(resource_type::sampler, m_samplers.size() - 1);
+    record(command_type::create_sampler, handle);
+    return handle;
+}
+
+gfx::renderpass_handle gfx_null::backend::create_renderpass(gfx::renderpass_params const&)
+{
+    m_renderpasses.push_back(create_lifetime());
+    m_statistics.resource_counts[static_cast<size_t>(resource_type::renderpass)]++;
+
+    auto handle = encode_handle<gfx::renderpass_handle>(resource_type::renderpass, m_renderpasses.size() - 1);
+    record(command_type::create_renderpass, handle);
+    return handle;
+}
+
+gfx::framebuffer_handle gfx_null::backend::create_framebuffer(gfx::framebuffer_params const& params)
+{
+    [[maybe_unused]] bool valid = validate(params.renderpass, resource_type::renderpass, "create_framebuffer: renderpass");
+    for (gfx::image_handle attachment : params.attachments)
+        valid = validate(attachment, resource_type::image, "create_framebuffer: attachment");
+
+    m_framebuffers.push_back({ .renderpass = params.renderpass, .lifetime = create_lifetime() });
+    m_statistics.resource_counts[static_cast<size_t>(resource_type::framebuffer)]++;
+
+    auto handle = encode_handle<gfx::framebuffer_handle>(resource_type::framebuffer, m_framebuffers.size() - 1);
+    record(command_type::create_framebuffer, handle);
+    return handle;
+}
+
+gfx::descriptorgroup_handle gfx_null::backend::create_descriptorgroup(gfx::descriptorgroup_params const& params)
+{
+    for (gfx::descriptorgroup_entry const& entry : params.entries)
+    {
+        switch (entry.resource.type)
+        {
+        case gfx::descriptor_type::uniform_buffer:
+        case gfx::descriptor_type::storage_buffer:
+        {
+            [[maybe_unused]] bool valid_buffer = validate(entry.resource.buffer, resource_type::buffer, "create_descriptorgroup: buffer");
+            break;
+        }
+        case gfx::descriptor_type::combined_image_sampler:
+        {
+            [[maybe_unused]] bool valid_image = validate(entry.resource.combined_image_sampler.image, resource_type::image, "create_descriptorgroup: image");
+            [[maybe_unused]] bool valid_sampler = validate(entry.resource.combined_image_sampler.sampler, resource_type::sampler, "create_descriptorgroup: sampler");
+            break;
+        }
+        }
+    }
+
+    m_descriptorgroups.push_back(create_lifetime());
+    m_statistics.resource_counts[static_cast<size_t>(resource_type::descriptorgroup)]++;
+
+    auto handle = encode_handle<gfx::descriptorgroup_handle>(resource_type::descriptorgroup, m_descriptorgroups.size() - 1);
+    record(command_type::create_descriptorgroup, handle);
+    return handle;
+}
+
+gfx::shader_handle gfx_null::backend::create_shader(gfx::shader_params const& params)
+{
+    [[maybe_unused]] bool valid = validate(!params.filename.empty(), "create_shader: filename is empty");
+
+    m_shaders.push_back(create_lifetime());
+    m_statistics.resource_counts[static_cast<size_t>(resource_type::shader)]++;
+
+    auto handle = encode_handle<gfx::shader_handle>(resource_type::shader, m_shaders.size() - 1);
+    record(command_type::create_shader, handle);
+    return handle;
+}
+
+gfx::renderstate_handle gfx_null::backend::create_renderstate(gfx::renderstate_params const& params)
+{
+    [[maybe_unused]] bool valid = validate(params.renderpass, resource_type::renderpass, "create_renderstate: renderpass");
+    for (gfx::shader_handle shader : params.shaders)
+        valid = validate(shader, resource_type::shader, "create_renderstate: shader");
+    for (gfx::attribute_description const& attribute : params.vertex_config.attributes)
+        valid = validate(attribute.buffer_binding_index < params.vertex_config.buffer_bindings.size(), "create_renderstate: attribute buffer binding index is out of range");
+
+    m_renderstates.push_back({
+        .renderpass = params.renderpass,
+        .descriptorgroup_layout_count = params.descriptorgroup_layouts.size(),
+        .buffer_binding_count = params.vertex_config.buffer_bindings.size(),
+        .layout_id = get_layout_id(params.descriptorgroup_layouts),
+        .lifetime = create_lifetime(),
+    });
+    m_statistics.resource_counts[static_cast<size_t>(resource_type::renderstate)]++;
+
+    auto handle = encode_handle<gfx::renderstate_handle>(resource_type::renderstate, m_renderstates.size() - 1);
+    record(command_type::create_renderstate, handle);
+    return handle;
+}
+
+void gfx_null::backend::destroy_renderstate(gfx::renderstate_handle handle)
+{
+    if (!validate(handle, resource_type::renderstate, "destroy_renderstate: renderstate"))
+        return;
+
+    m_renderstates[decode_handle(handle)->index].destroyed = true;
+    m_statistics.destroyed_renderstate_count++;
+
+    record(command_type::destroy_renderstate, handle);
+}
+
+void gfx_null::backend::begin_resource_update()
+{
+    m_frame_index++;
+
+    uint64_t completed_ticket = m_completed_upload_ticket;
+    for (pending_upload const& upload : m_pending_uploads)
+        if (upload.frame_index + m_config.upload_latency_frames <= m_frame_index)
+            completed_ticket = upload.ticket;
+    complete_uploads(completed_ticket);
+
+    record(command_type::begin_resource_update);
+}
+
+void gfx_null::backend::buffer_upload_sync(gfx::buffer_handle handle, gfx::data_reader& reader, size_t offset)
+{
+    return wait_for_upload(buffer_upload_async(handle, reader, offset));
+}
+
+void gfx_null::backend::image_upload_sync(gfx::image_handle handle, gfx::data_reader& reader)
+{
+    return wait_for_upload(image_upload_async(handle, reader));
+}
+
+gfx::upload_ticket gfx_null::backend::buffer_upload_async(gfx::buffer_handle handle, gfx::data_reader& reader, size_t offset)
+{
+    size_t size = reader.get_size();
+
+    if (validate(handle, resource_type::buffer, "buffer_upload: buffer"))
+    {
+        buffer_resource const& buffer = m_buffers[decode_handle(handle)->index];
+        [[maybe_unused]] bool valid = validate(offset + size <= buffer.params.size, "buffer_upload: upload is out of the buffer bounds");
+    }
+
+    gfx::upload_ticket ticket = stage_upload(reader, "buffer_upload: failed to read the data");
+
+    mark_used(handle);
+
+    m_statistics.buffer_upload_count++;
+    m_statistics.uploaded_bytes += size;
+
+    size_t payload = m_config.record_commands ? m_commands.add_upload({ .resource = handle, .size = size, .offset = offset, .ticket = ticket }) : 0;
+    record(command_type::buffer_upload, handle, payload);
+
+    return ticket;
+}
+
+gfx::upload_ticket gfx_null::backend::image_upload_async(gfx::image_handle handle, gfx::data_reader& reader)
+{
+    size_t size = reader.get_size();
+
+    if (validate(handle, resource_type::image, "image_upload: image"))
+    {
+        image_resource const& image = m_images[decode_handle(handle)->index];
+        [[maybe_unused]] bool valid = validate(image.params.usage == gfx::image_usage::upload_sampled, "image_upload: image usage should be upload_sampled");
+    }
+
+    gfx::upload_ticket ticket = stage_upload(reader, "image_upload: failed to read the data");
+
+    mark_used(handle);
+
+    m_statistics.image_upload_count++;
+    m_statistics.uploaded_bytes += size;
+
+    size_t payload = m_config.record_commands ? m_commands.add_upload({ .resource = handle, .size = size, .offset = 0, .ticket = ticket }) : 0;
+    record(command_type::image_upload, handle, payload);
+
+    return ticket;
+}
+
+bool gfx_null::backend::is_upload_complete(gfx::upload_ticket ticket)
+{
+    [[maybe_unused]] bool valid = validate(ticket.value < m_next_upload_ticket, "is_upload_complete: unknown ticket");
+
+    return ticket.value <= m_completed_upload_ticket;
+}
+
+void gfx_null::backend::wait_for_upload(gfx::upload_ticket ticket)
+{
+    [[maybe_unused]] bool valid = validate(ticket.value < m_next_upload_ticket, "wait_for_upload: unknown ticket");
+
+    if (ticket.value > m_completed_upload_ticket)
+        complete_uploads(ticket.value);
+}
+
+gfx::renderpass_handle gfx_null::backend::get_main_renderpass()
+{
+    return m_main_renderpass;
+}
+
+gfx::framebuffer_handle gfx_null::backend::acquire_main_framebuffer()
+{
+    [[maybe_unused]] bool valid = validate(m_in_frame, "acquire_main_framebuffer: called outside of the frame");
+
+    gfx::framebuffer_handle handle = m_main_framebuffers[m_main_framebuffer_index];
+    m_main_framebuffer_index = (m_main_framebuffer_index + 1) % m_main_framebuffers.size();
+
+    record(command_type::acquire_main_framebuffer, handle);
+    return handle;
+}
+
+float gfx_null::backend::get_main_framebuffer_aspect()
+{
+    return 1.0f * m_width / m_height;
+}
+
+void gfx_null::backend::begin_frame()
+{
+    [[maybe_unused]] bool valid = validate(!m_in_frame, "begin_frame: previous frame wasn't submitted");
+
+    m_in_frame = true;
+    m_bind_state.reset();
+
+    record(command_type::begin_frame);
+}
+
+void gfx_null::backend::renderpass_begin(gfx::renderpass_begin_params const& params)
+{
+    [[maybe_unused]] bool valid = validate(m_in_frame, "renderpass_begin: called outside of the frame");
+    valid = validate(!m_current_renderpass, "renderpass_begin: previous renderpass wasn't ended");
+    valid = validate(params.renderpass, resource_type::renderpass, "renderpass_begin: renderpass");
+    valid = validate(params.framebuffer, resource_type::framebuffer, "renderpass_begin: framebuffer");
+
+    mark_used(params.renderpass);
+    mark_used(params.framebuffer);
+
+    m_current_renderpass = params.renderpass;
+    m_current_framebuffer = params.framebuffer;
+
+    m_bind_state.reset();
+
+    m_statistics.renderpass_count++;
+
+    size_t payload = m_config.record_commands ? m_commands.add_renderpass_begin({ .renderpass = params.renderpass, .framebuffer = params.framebuffer }) : 0;
+    record(command_type::renderpass_begin, params.renderpass, payload);
+}
+
+void gfx_null::backend::renderpass_end()
+{
+    [[maybe_unused]] bool valid = validate(m_current_renderpass != nullptr, "renderpass_end: no renderpass is active");
+
+    record(command_type::renderpass_end, m_current_renderpass);
+
+    m_current_renderpass = nullptr;
+    m_current_framebuffer = nullptr;
+}
+
+void gfx_null::backend::draw_indexed(gfx::draw_indexed_args const& args)
+{
+    [[maybe_unused]] bool valid = validate(m_current_renderpass != nullptr, "draw_indexed: called outside of the renderpass");
+
+    if (validate(args.renderstate, resource_type::renderstate, "draw_indexed: renderstate"))
+    {
+        renderstate_resource const& renderstate = m_renderstates[decode_handle(args.renderstate)->index];
+        valid = validate(args.descriptorgroups.size() == renderstate.descriptorgroup_layout_count, "draw_indexed: descriptorgroup count doesn't match the renderstate");
+        valid = validate(args.vertex_buffers.size() == renderstate.buffer_binding_count, "draw_indexed: vertex buffer count doesn't match the renderstate");
+    }
+
+    for (gfx::descriptorgroup_handle handle : args.descriptorgroups)
+    {
+        valid = validate(handle, resource_type::descriptorgroup, "draw_indexed: descriptorgroup");
+        mark_used(handle);
+    }
+
+    for (gfx::buffer_with_offset const& vertex_buffer : args.vertex_buffers)
+    {
+        valid = validate(vertex_buffer.buffer, resource_type::buffer, "draw_indexed: vertex buffer");
+        mark_used(vertex_buffer.buffer);
+    }
+
+    if (validate(args.index_buffer.buffer, resource_type::buffer, "draw_indexed: index buffer"))
+    {
+        buffer_resource const& buffer = m_buffers[decode_handle(args.index_buffer.buffer)->index];
+        size_t end = args.index_buffer.offset + (args.first_index + args.index_count) * get_index_size(args.index_type);
+        valid = validate(end <= buffer.params.size, "draw_indexed: index range is out of the buffer bounds");
+    }
+
+    if (args.scissor)
+        valid = validate(args.scissor->size.x > 0 && args.scissor->size.y > 0, "draw_indexed: scissor is empty");
+
+    valid = validate(args.instance_count > 0, "draw_indexed: instance count is zero");
+
+    mark_used(args.renderstate);
+    mark_used(args.index_buffer.buffer);
+
+    // Same filtering as in the Vulkan backend, so that the redundant binds can be measured headlessly
+    uint64_t layout_id = is_valid(args.renderstate, resource_type::renderstate) ? m_renderstates[decode_handle(args.renderstate)->index].layout_id : 0;
+    [[maybe_unused]] bool bound = m_bind_state.bind_renderstate(args.renderstate, layout_id);
+    [[maybe_unused]] nstl::optional<size_t> first_descriptorgroup = m_bind_state.bind_descriptorgroups(args.descriptorgroups);
+    [[maybe_unused]] nstl::optional<size_t> first_vertex_buffer = m_bind_state.bind_vertex_buffers(args.vertex_buffers);
+    bound = m_bind_state.bind_index_buffer(args.index_buffer, args.index_type);
+    bound = m_bind_state.set_scissor(args.scissor);
+
+    m_statistics.draw_count++;
+    m_statistics.index_count += args.index_count * args.instance_count;
+
+    size_t payload = m_config.record_commands ? m_commands.add_draw_indexed(args) : 0;
+    record(command_type::draw_indexed, args.renderstate, payload);
+}
+
+void gfx_null::backend::submit()
+{
+    [[maybe_unused]] bool valid = validate(m_in_frame, "submit: called outside of the frame");
+    valid = validate(!m_current_renderpass, "submit: renderpass wasn't ended");
+
+    m_in_frame = false;
+    m_statistics.frame_count++;
+
+    record(command_type::submit);
+}
+
+void gfx_null::backend::reset_statistics()
+{
+    // Resource counts describe the current state rather than the accumulated one
+    statistics statistics;
+    statistics.resource_counts = m_statistics.resource_counts;
+    m_statistics = statistics;
+
+    m_bind_state.reset_statistics();
+}
+
+bool gfx_null::backend::is_valid(gfx::handle handle, resource_type type) const
+{
+    nstl::optional<decoded_handle> decoded = decode_handle(handle);
+    if (!decoded || decoded->type != type)
+        return false;
+
+    if (decoded->index >= m_statistics.resource_counts[static_cast<size_t>(type)])
+        return false;
+
+    if (type == resource_type::renderstate && m_renderstates[decoded->index].destroyed)
+        return false;
+
+    return true;
+}
+
+gfx_null::resource_lifetime const* gfx_null::backend::get_lifetime(gfx::handle handle) const
+{
+    return const_cast<backend*>(this)->find_lifetime(handle);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+gfx_null::resource_lifetime* gfx_null::backend::find_lifetime(gfx::handle handle)
+{
+    nstl::optional<decoded_handle> decoded = decode_handle(handle);
+    if (!decoded || !is_valid(handle, decoded->type))
+        return nullptr;
+
+    size_t index = decoded->index;
+
+    switch (decoded->type)
+    {
+    case resource_type::buffer:
+        return &m_buffers[index].lifetime;
+    case resource_type::image:
+        return &m_images[index].lifetime;
+    case resource_type::sampler:
+        return &m_samplers[index];
+    case resource_type::renderpass:
+        return &m_renderpasses[index];
+    case resource_type::framebuffer:
+        return &m_framebuffers[index].lifetime;
+    case resource_type::descriptorgroup:
+        return &m_descriptorgroups[index];
+    case resource_type::shader:
+        return &m_shaders[index];
+    case resource_type::renderstate:
+        return &m_renderstates[index].lifetime;
+    case resource_type::count:
+        break;
+    }
+
+    assert(false);
+    return nullptr;
+}
+
+gfx_null::resource_lifetime gfx_null::backend::create_lifetime()
+{
+    return { .created_frame = m_frame_index, .last_used_frame = m_frame_index, .use_count = 0 };
+}
+
+void gfx_null::backend::mark_used(gfx::handle handle)
+{
+    if (resource_lifetime* lifetime = find_lifetime(handle))
+    {
+        lifetime->last_used_frame = m_frame_index;
+        lifetime->use_count++;
+    }
+}
+
+bool gfx_null::backend::validate(gfx::handle handle, resource_type type, nstl::string_view what)
+{
+    if (is_valid(handle, type))
+        return true;
+
+    m_statistics.validation_errors++;
+    logging::error("gfx_null: {}: invalid handle {}", what, reinterpret_cast<uintptr_t>(handle.ptr));
+    return false;
+}
+
+bool gfx_null::backend::validate(bool condition, nstl::string_view what)
+{
+    if (condition)
+        return true;
+
+    m_statistics.validation_errors++;
+    logging::error("gfx_null: {}", what);
+    return false;
+}
+
+void gfx_null::backend::record(command_type type, gfx::handle resource, size_t payload_index)
+{
+    if (!m_config.record_commands)
+        return;
+
+    m_commands.add(type, m_frame_index, resource, payload_index);
+}
+
+gfx::upload_ticket gfx_null::backend::stage_upload(gfx::data_reader& reader, nstl::string_view read_error)
+{
+    size_t size = reader.get_size();
+
+    // Consume the data the same way a real backend would, so that the reader cost is accounted for
+    m_upload_scratch.resize(size);
+    [[maybe_unused]] bool read = validate(reader.read(m_upload_scratch.data(), size), read_error);
+
+    gfx::upload_ticket ticket{ m_next_upload_ticket++ };
+
+    // Empty uploads don't need staging memory, but they still complete in order with the others,
+    // since completing the ticket right away would complete all the earlier ones as well
+    if (size > 0)
+    {
+        // Only the staging memory occupancy is simulated: big uploads would be split into chunks by a real backend
+        size_t staging_size = nstl::min(size, m_staging_ring.get_size());
+        while (!m_staging_ring.allocate(staging_size))
+        {
+            assert(!m_pending_uploads.empty());
+            if (m_pending_uploads.empty())
+                break;
+
+            m_statistics.upload_stall_count++;
+            complete_uploads(m_pending_uploads.front().ticket);
+        }
+
+        m_staging_ring.close_batch(ticket.value);
+    }
+
+    m_pending_uploads.push_back({ .ticket = ticket.value, .frame_index = m_frame_index });
+
+    return ticket;
+}
+
+void gfx_null::backend::complete_uploads(uint64_t ticket)
+{
+    size_t completed_count = 0;
+    for (pending_upload const& upload : m_pending_uploads)
+    {
+        if (upload.ticket > ticket)
+            break;
+        completed_count++;
+    }
+
+    if (completed_count > 0)
+        m_pending_uploads.erase(m_pending_uploads.begin(), m_pending_uploads.begin() + completed_count);
+
+    m_staging_ring.retire(ticket);
+    m_completed_upload_ticket = nstl::max(m_completed_upload_ticket, ticket);
+}
@@ -0,0 +1,103 @@
+#include "gfx_null/command_stream.h"
+
+void gfx_null::command_stream::add(command_type type, size_t frame_index, gfx::handle resource, size_t payload_index)
+{
+    m_commands.push_back({
+        .type = type,
+        .frame_index = frame_index,
+        .resource = resource,
+        .payload_index = payload_index,
+    });
+}
+
+size_t gfx_null::command_stream::add_upload(upload_command const& upload)
+{
+    m_uploads.push_back(upload);
+    return m_uploads.size() - 1;
+}
+
+size_t gfx_null::command_stream::add_renderpass_begin(renderpass_begin_command const& begin)
+{
+    m_renderpass_begins.push_back(begin);
+    return m_renderpass_begins.size() - 1;
+}
+
+size_t gfx_null::command_stream::add_draw_indexed(gfx::draw_indexed_args const& args)
+{
+    draw_indexed_command draw = {
+        .renderstate = args.renderstate,
+
+        .first_descriptorgroup = m_descriptorgroups.size(),
+        .descriptorgroup_count = args.descriptorgroups.size(),
+
+        .first_vertex_buffer = m_vertex_buffers.size(),
+        .vertex_buffer_count = args.vertex_buffers.size(),
+
+        .scissor = args.scissor,
+
+        .index_buffer = args.index_buffer,
+        .index_type = args.index_type,
+
+        .index_count = args.index_count,
+        .first_index = args.first_index,
+        .vertex_offset = args.vertex_offset,
+
+        .instance_count = args.instance_count,
+    };
+
+    for (gfx::descriptorgroup_handle handle : args.descriptorgroups)
+        m_descriptorgroups.push_back(handle);
+    for (gfx::buffer_with_offset const& buffer : args.vertex_buffers)
+        m_vertex_buffers.push_back(buffer);
+
+    m_draws.push_back(nstl::move(draw));
+    return m_draws.size() - 1;
+}
+
+void gfx_null::command_stream::clear()
+{
+    m_commands.clear();
+    m_uploads.clear();
+    m_renderpass_begins.clear();
+    m_draws.clear();
+    m_descriptorgroups.clear();
+    m_vertex_buffers.clear();
+}
+
+size_t gfx_null::command_stream::count(command_type type) const
+{
+    size_t result = 0;
+    for (command const& command : m_commands)
+        if (command.type == type)
+            result++;
+
+    return result;
+}
+
+gfx_null::upload_command const& gfx_null::command_stream::get_upload(command const& command) const
+{
+    assert(command.type == command_type::buffer_upload || command.type == command_type::image_upload);
+    return m_uploads[command.payload_index];
+}
+
+gfx_null::renderpass_begin_command const& gfx_null::command_stream::get_renderpass_begin(command const& command) const
+{
+    assert(command.type == command_type::renderpass_begin);
+    return m_renderpass_begins[command.payload_index];
+}
+
+gfx_null::draw_indexed_command const& gfx_null::command_stream::get_draw_indexed(command const& command) const
+{
+    assert(command.type == command_type::draw_indexed);
+    return m_draws[command.payload_index];
+}
+
+nstl::span<gfx::descriptorgroup_handle const> gfx_null::command_stream::get_descriptorgroups(draw_indexed_command const& draw) const
+{
+    return nstl::span<gfx::descriptorgroup_handle const>{ m_descriptorgroups }.subspan(draw.first_descriptorgroup, draw.descriptorgroup_count);
+}
+
+nstl::span<gfx::buffer_with_offset const> gfx_null::command_stream::get_vertex_buffers(draw_indexed_command const& draw) const
+{
+    return nstl::span<gfx::buffer_with_offset const>{ m_vertex_buffers }.subspan(draw.first_vertex_buffer, draw.vertex_buffer_count);
+}
@@ -3,6 +3,7 @@
 #include "gfx_vk/config.h"
 
 #include "gfx/backend.h"
+#include "gfx/bind_state_tracker.h"
 
 #include "nstl/vector.h"
 
@@ -13,6 +14,13 @@ namespace gfx_vk
     class context;
     class surface_factory;
 
+    struct pipeline_cache_statistics
+    {
+        size_t loaded_size = 0; // size of the cache data loaded from the file
+        size_t hit_count = 0;
+        size_t miss_count = 0;
+    };
+
     class backend final : public gfx::backend
     {
     public:
@@ -29,10 +37,15 @@ namespace gfx_vk
         [[nodiscard]] gfx::descriptorgroup_handle create_descriptorgroup(gfx::descriptorgroup_params const& params) override;
         [[nodiscard]] gfx::shader_handle create_shader(gfx::shader_params const& params) override;
         [[nodiscard]] gfx::renderstate_handle create_renderstate(gfx::renderstate_params const& params) override;
+        void destroy_renderstate(gfx::renderstate_handle handle) override;
 
         void begin_resource_update() override;
         void buffer_upload_sync(gfx::buffer_handle handle, gfx::data_reader& reader, size_t offset) override;
         void image_upload_sync(gfx::image_handle handle, gfx::data_reader& reader) override;
+        [[nodiscard]] gfx::upload_ticket buffer_upload_async(gfx::buffer_handle handle, gfx::data_reader& reader, size_t offset) override;
+        [[nodiscard]] gfx::upload_ticket image_upload_async(gfx::image_handle handle, gfx::data_reader& reader) override;
+        [[nodiscard]] bool is_upload_complete(gfx::upload_ticket ticket) override;
+        void wait_for_upload(gfx::upload_ticket ticket) override;
 
         [[nodiscard]] gfx::renderpass_handle get_main_renderpass() override;
         [[nodiscard]] gfx::framebuffer_handle acquire_main_framebuffer() override;
@@ -47,6 +60,9 @@ namespace gfx_vk
 
         void submit() override;
 
+        pipeline_cache_statistics const& get_pipeline_cache_statistics() const;
+        gfx::bind_statistics const& get_bind_statistics() const;
+
     private:
         nstl::unique_ptr<context> m_context;
     };
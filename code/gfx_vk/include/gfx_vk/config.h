@@ -10,6 +10,23 @@ namespace gfx_vk
         uint32_t max_descriptors_per_type_per_pool = 4 * 1024;
     };
 
+    struct memory_config
+    {
+        size_t block_size = 64 * 1024 * 1024;
+        size_t dedicated_allocation_threshold = 32 * 1024 * 1024; // bigger allocations get their own VkDeviceMemory
+    };
+
+    struct transfers_config
+    {
+        size_t staging_buffer_size = 64 * 1024 * 1024;
+        size_t max_chunk_size = 16 * 1024 * 1024; // bigger uploads are split and submitted chunk by chunk
+    };
+
+    struct pipeline_cache_config
+    {
+        char const* path = nullptr; // the cache isn't persisted if null
+    };
+
     struct renderer_config
     {
         size_t max_frames_in_flight = 3; // also the mutable resource multiplier
@@ -21,6 +38,9 @@ namespace gfx_vk
         bool enable_validation;
 
         descriptors_config descriptors;
+        memory_config memory;
+        transfers_config transfers;
+        pipeline_cache_config pipeline_cache;
         renderer_config renderer;
     };
 }
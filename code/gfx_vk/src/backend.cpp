@@ -4,6 +4,7 @@
 
 #include "buffer.h"
 #include "image.h"
+#include "pipeline_cache.h"
 
 gfx_vk::backend::backend(surface_factory& factory, size_t w, size_t h, config const& config)
     : m_context(nstl::make_unique<context>(factory, w, h, config))
@@ -61,6 +62,16 @@ gfx::renderstate_handle gfx_vk::backend::create_renderstate(gfx::renderstate_par
     return m_context->get_resources().create_renderstate(params);
 }
 
+void gfx_vk::backend::destroy_renderstate(gfx::renderstate_handle handle)
+{
+    // The renderer only destroys a renderstate after its last reference is released, which is rare (e.g. reloading shaders),
+    // so the frames in flight which might still use the pipeline are waited for instead of deferring the destruction
+    m_context->get_instance().wait_idle();
+
+    [[maybe_unused]] bool destroyed = m_context->get_resources().destroy_renderstate(handle);
+    assert(destroyed);
+}
+
 void gfx_vk::backend::begin_resource_update()
 {
     return m_context->get_renderer().begin_resource_update();
@@ -68,12 +79,32 @@ void gfx_vk::backend::begin_resource_update()
 
 void gfx_vk::backend::buffer_upload_sync(gfx::buffer_handle handle, gfx::data_reader& reader, size_t offset)
 {
-    return m_context->get_resources().get_buffer(handle).upload_sync(reader, offset);
+    return wait_for_upload(buffer_upload_async(handle, reader, offset));
 }
 
 void gfx_vk::backend::image_upload_sync(gfx::image_handle handle, gfx::data_reader& reader)
 {
-    return m_context->get_resources().get_image(handle).upload_sync(reader);
+    return wait_for_upload(image_upload_async(handle, reader));
+}
+
+gfx::upload_ticket gfx_vk::backend::buffer_upload_async(gfx::buffer_handle handle, gfx::data_reader& reader, size_t offset)
+{
+    return m_context->get_resources().get_buffer(handle).upload_async(reader, offset);
+}
+
+gfx::upload_ticket gfx_vk::backend::image_upload_async(gfx::image_handle handle, gfx::data_reader& reader)
+{
+    return m_context->get_resources().get_image(handle).upload_async(reader);
+}
+
+bool gfx_vk::backend::is_upload_complete(gfx::upload_ticket ticket)
+{
+    return m_context->get_transfers().is_complete(ticket);
+}
+
+void gfx_vk::backend::wait_for_upload(gfx::upload_ticket ticket)
+{
+    return m_context->get_transfers().wait(ticket);
 }
 
 gfx::renderpass_handle gfx_vk::backend::get_main_renderpass()
@@ -115,3 +146,13 @@ void gfx_vk::backend::submit()
 {
     return m_context->get_renderer().submit();
 }
+
+gfx_vk::pipeline_cache_statistics const& gfx_vk::backend::get_pipeline_cache_statistics() const
+{
+    return m_context->get_pipeline_cache().get_statistics();
+}
+
+gfx::bind_statistics const& gfx_vk::backend::get_bind_statistics() const
+{
+    return m_context->get_renderer().get_bind_statistics();
+}
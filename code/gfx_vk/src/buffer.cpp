@@ -85,7 +85,7 @@ gfx_vk::buffer::buffer(context& context, gfx::buffer_params const& params)
 
     requirements.size = m_aligned_size * resource_count;
 
-    m_allocation = m_context.get_memory().allocate(requirements, get_memory_flags(params.location));
+    m_allocation = m_context.get_memory().allocate(requirements, get_memory_flags(params.location), memory_tiling::linear);
     allocation_data const* data = m_context.get_memory().get_data(m_allocation);
     assert(data);
 
@@ -113,7 +113,7 @@ VkBuffer gfx_vk::buffer::get_current_handle() const
     return get_handle(index);
 }
 
-void gfx_vk::buffer::upload_sync(gfx::data_reader& reader, size_t offset)
+gfx::upload_ticket gfx_vk::buffer::upload_async(gfx::data_reader& reader, size_t offset)
 {
     // TODO prevent calling this function on immutable resource
 
@@ -121,16 +121,7 @@ void gfx_vk::buffer::upload_sync(gfx::data_reader& reader, size_t offset)
 
     if (m_params.location == gfx::buffer_location::device_local)
     {
-        transfer_data data = m_context.get_transfers().begin_transfer(reader);
-
-        VkBufferCopy region{
-            .srcOffset = data.buffer_offset,
-            .dstOffset = offset,
-            .size = reader.get_size(),
-        };
-        vkCmdCopyBuffer(data.command_buffer, data.buffer, m_buffers[subresource_index].handle, 1, &region);
-
-        m_context.get_transfers().submit_and_wait(data.index);
+        return m_context.get_transfers().upload_buffer(m_buffers[subresource_index].handle, offset, reader);
     }
     else
     {
@@ -143,5 +134,7 @@ void gfx_vk::buffer::upload_sync(gfx::data_reader& reader, size_t offset)
         if (!reader.read(static_cast<unsigned char*>(data->ptr) + memory_offset, reader.get_size()))
             assert(false);
 //         memcpy(static_cast<unsigned char*>(data->ptr) + memory_offset, bytes.data(), bytes.size());
+
+        return {}; // host visible memory is written directly
     }
 }
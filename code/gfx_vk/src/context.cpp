@@ -2,8 +2,9 @@
 
 gfx_vk::context::context(surface_factory& factory, size_t w, size_t h, config const& config)
     : m_instance(factory, config)
-    , m_memory(*this)
-    , m_transfers(*this)
+    , m_memory(*this, config.memory)
+    , m_pipeline_cache(*this, config.pipeline_cache)
+    , m_transfers(*this, config.transfers)
     , m_resources(*this)
     , m_descriptor_allocator(*this, config.descriptors)
     , m_renderer(*this, w, h, config.renderer)
@@ -2,6 +2,7 @@
 
 #include "instance.h"
 #include "memory.h"
+#include "pipeline_cache.h"
 #include "transfers.h"
 #include "resource_container.h"
 #include "descriptor_allocator.h"
@@ -26,6 +27,8 @@ namespace gfx_vk
 
         instance& get_instance() { return m_instance; }
         memory& get_memory() { return m_memory; }
+        pipeline_cache& get_pipeline_cache() { return m_pipeline_cache; }
+        pipeline_cache const& get_pipeline_cache() const { return m_pipeline_cache; }
         transfers& get_transfers() { return m_transfers; }
         resource_container& get_resources() { return m_resources; }
         descriptor_allocator& get_descriptor_allocator() { return m_descriptor_allocator; }
@@ -41,6 +44,7 @@ namespace gfx_vk
     private:
         instance m_instance;
         memory m_memory;
+        pipeline_cache m_pipeline_cache;
         transfers m_transfers;
         resource_container m_resources;
         descriptor_allocator m_descriptor_allocator;
@@ -37,7 +37,7 @@ gfx_vk::image::image(context& context, gfx::image_params const& params, VkImage
 
         m_memory_size = requirements.size;
 
-        m_allocation = m_context.get_memory().allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        m_allocation = m_context.get_memory().allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memory_tiling::optimal);
         allocation_data const* data = m_context.get_memory().get_data(m_allocation);
         assert(data);
 
@@ -80,84 +80,9 @@ gfx_vk::image::~image()
     m_allocation = {};
 }
 
-void gfx_vk::image::upload_sync(gfx::data_reader& reader)
+gfx::upload_ticket gfx_vk::image::upload_async(gfx::data_reader& reader)
 {
     assert(reader.get_size() <= m_memory_size);
 
-    auto width = static_cast<uint32_t>(m_params.width);
-    auto height = static_cast<uint32_t>(m_params.height);
-
-    transfer_data data = m_context.get_transfers().begin_transfer(reader);
-
-    VkImageMemoryBarrier barrier{
-        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .image = m_handle.get(),
-        .subresourceRange = {
-            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-            .baseMipLevel = 0,
-            .levelCount = 1,
-            .baseArrayLayer = 0,
-            .layerCount = 1,
-        },
-    };
-
-    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier.srcAccessMask = 0;
-    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    vkCmdPipelineBarrier(
-        data.command_buffer,
-        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &barrier
-    );
-    
-    assert(data.buffer_offset == 0); // TODO test non-zero offsets
-    VkBufferImageCopy region{
-        .bufferOffset = data.buffer_offset,
-        .bufferRowLength = 0,
-        .bufferImageHeight = 0,
-
-        .imageSubresource = {
-            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-            .mipLevel = 0,
-            .baseArrayLayer = 0,
-            .layerCount = 1,
-        },
-
-        .imageOffset = { 0, 0, 0 },
-        .imageExtent = {
-            width,
-            height,
-            1
-        },
-    };
-
-    vkCmdCopyBufferToImage(
-        data.command_buffer,
-        data.buffer,
-        m_handle.get(),
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        1,
-        &region
-    );
-
-    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    vkCmdPipelineBarrier(
-        data.command_buffer,
-        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &barrier
-    );
-
-    m_context.get_transfers().submit_and_wait(data.index);
+    return m_context.get_transfers().upload_image(m_handle, m_params, reader);
 }
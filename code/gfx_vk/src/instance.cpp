@@ -21,6 +21,8 @@ namespace
 {
     static auto scope_id = memory::tracking::create_scope_id("Rendering/Vulkan/Driver");
 
+    logging::category validation_category{ "Vulkan" };
+
     void* allocate(void*, size_t size, size_t alignment, VkSystemAllocationScope)
     {
         MEMORY_TRACKING_SCOPE(scope_id);
@@ -121,13 +123,13 @@ namespace
     void on_debug_message(gfx::debug_message_level level, nstl::string_view, nstl::string_view text)
     {
         if (level == gfx::debug_message_level::verbose)
-            logging::info("{}", text);
+            logging::info(validation_category, "{}", text);
         if (level == gfx::debug_message_level::info)
-            logging::info("{}", text);
+            logging::info(validation_category, "{}", text);
         if (level == gfx::debug_message_level::warning)
-            logging::warn("{}", text);
+            logging::warn(validation_category, "{}", text);
         if (level == gfx::debug_message_level::error)
-            logging::error("{}", text);
+            logging::error(validation_category, "{}", text);
 
         assert(level != gfx::debug_message_level::error);
     }
@@ -1,6 +1,9 @@
 #include "memory.h"
 
 #include "context.h"
+#include "tlsf.h"
+
+#include "nstl/alignment.h"
 
 namespace
 {
@@ -31,37 +34,61 @@ namespace
 
 struct gfx_vk::memory::allocation
 {
-    unique_handle<VkDeviceMemory> handle;
+    bool is_used = false;
+
+    unique_handle<VkDeviceMemory> dedicated_handle;
+
+    nstl::optional<size_t> block_index;
+    tlsf_allocator::allocation suballocation;
+
     allocation_data data;
 };
 
-gfx_vk::memory::memory(context& context) : m_context(context)
+struct gfx_vk::memory::block
 {
+    uint32_t memory_type_index = 0;
+    gfx_vk::memory_tiling tiling = gfx_vk::memory_tiling::linear;
+    unique_handle<VkDeviceMemory> handle;
+    void* ptr = nullptr; // persistently mapped if the memory type is host visible
+
+    nstl::optional<tlsf_allocator> allocator;
+};
 
+gfx_vk::memory::memory(context& context, memory_config const& config) : m_context(context), m_config(config)
+{
+    assert(m_config.dedicated_allocation_threshold <= m_config.block_size);
 }
 
-gfx_vk::memory::~memory() = default;
+gfx_vk::memory::~memory()
+{
+    for (size_t i = 0; i < m_allocations.size(); i++)
+        free({ i });
+
+    for (size_t i = 0; i < m_blocks.size(); i++)
+        destroy_block(i);
+}
 
-gfx_vk::allocation_handle gfx_vk::memory::allocate(VkMemoryRequirements requirements, VkMemoryPropertyFlags flags)
+gfx_vk::allocation_handle gfx_vk::memory::allocate(VkMemoryRequirements requirements, VkMemoryPropertyFlags flags, memory_tiling tiling)
 {
-    allocation_handle handle = { m_allocations.size() };
-    allocation& alloc = m_allocations.emplace_back();
+    uint32_t memory_type_index = find_memory_type(m_context, requirements.memoryTypeBits, flags);
+    bool mappable = is_mappable(flags);
 
-    VkMemoryAllocateInfo info{
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = requirements.size,
-        .memoryTypeIndex = find_memory_type(m_context, requirements.memoryTypeBits, flags),
-    };
-    GFX_VK_VERIFY(vkAllocateMemory(m_context.get_device_handle(), &info, &m_context.get_allocator(), &alloc.handle.get()));
-    
-    alloc.data = {
-        .handle = alloc.handle,
-        .offset = 0,
-        .ptr = nullptr,
-    };
+    // Linear and optimal resources are suballocated from separate blocks, so they never share a granularity page
+    // and don't need any padding. Without the granularity restriction all resources share the same blocks
+    VkDeviceSize granularity = m_context.get_physical_device_props().properties.limits.bufferImageGranularity;
+    if (granularity <= 1)
+        tiling = memory_tiling::linear;
+
+    allocation_handle handle = create_allocation();
+    allocation& alloc = get_allocation(handle);
+
+    bool success = false;
+    if (requirements.size <= m_config.dedicated_allocation_threshold)
+        success = allocate_from_blocks(alloc, requirements.size, requirements.alignment, memory_type_index, tiling, mappable);
+    if (!success)
+        success = allocate_dedicated(alloc, requirements.size, memory_type_index, mappable);
 
-    if (is_mappable(flags))
-        GFX_VK_VERIFY(vkMapMemory(m_context.get_device_handle(), alloc.handle, 0, requirements.size, 0, &alloc.data.ptr));
+    assert(success);
 
     return handle;
 }
@@ -81,14 +108,83 @@ void gfx_vk::memory::free(allocation_handle handle)
 
     allocation& alloc = get_allocation(handle);
 
-    if (alloc.handle == VK_NULL_HANDLE)
+    if (!alloc.is_used)
         return;
 
-    if (alloc.data.ptr)
-        vkUnmapMemory(m_context.get_device_handle(), alloc.handle);
+    if (alloc.dedicated_handle)
+    {
+        if (alloc.data.ptr)
+            vkUnmapMemory(m_context.get_device_handle(), alloc.dedicated_handle);
+
+        vkFreeMemory(m_context.get_device_handle(), alloc.dedicated_handle, &m_context.get_allocator());
+        alloc.dedicated_handle = nullptr;
+    }
 
-    vkFreeMemory(m_context.get_device_handle(), alloc.handle, &m_context.get_allocator());
-    alloc.handle = VK_NULL_HANDLE;
+    if (alloc.block_index)
+    {
+        size_t block_index = *alloc.block_index;
+        block& b = m_blocks[block_index];
+
+        assert(b.allocator);
+        b.allocator->free(alloc.suballocation);
+
+        // Keep one empty block per memory type around to avoid allocation ping-pong
+        if (b.allocator->is_empty() && count_blocks(b.memory_type_index, b.tiling) > 1)
+            destroy_block(block_index);
+    }
+
+    alloc = {};
+    m_free_allocations.push_back(*handle.index);
+}
+
+gfx_vk::memory_statistics gfx_vk::memory::get_statistics() const
+{
+    memory_statistics result;
+
+    for (allocation const& alloc : m_allocations)
+    {
+        if (!alloc.is_used || !alloc.dedicated_handle)
+            continue;
+
+        result.dedicated_allocation_count++;
+    }
+
+    for (block const& b : m_blocks)
+    {
+        if (!b.allocator)
+            continue;
+
+        tlsf_allocator::statistics stats = b.allocator->get_statistics();
+
+        result.block_count++;
+        result.allocation_count += stats.allocation_count;
+        result.reserved_size += stats.size;
+        result.used_size += stats.used_size;
+    }
+
+    result.allocation_count += result.dedicated_allocation_count;
+
+    return result;
+}
+
+gfx_vk::allocation_handle gfx_vk::memory::create_allocation()
+{
+    size_t index = 0;
+
+    if (!m_free_allocations.empty())
+    {
+        index = m_free_allocations.back();
+        m_free_allocations.pop_back();
+    }
+    else
+    {
+        index = m_allocations.size();
+        m_allocations.emplace_back();
+    }
+
+    m_allocations[index].is_used = true;
+
+    return { index };
 }
 
 gfx_vk::memory::allocation& gfx_vk::memory::get_allocation(allocation_handle handle)
@@ -102,3 +198,139 @@ gfx_vk::memory::allocation const& gfx_vk::memory::get_allocation(allocation_hand
     assert(handle.index);
     return m_allocations[*handle.index];
 }
+
+bool gfx_vk::memory::allocate_dedicated(allocation& alloc, VkDeviceSize size, uint32_t memory_type_index, bool mappable)
+{
+    VkMemoryAllocateInfo info{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = size,
+        .memoryTypeIndex = memory_type_index,
+    };
+    GFX_VK_VERIFY(vkAllocateMemory(m_context.get_device_handle(), &info, &m_context.get_allocator(), &alloc.dedicated_handle.get()));
+
+    alloc.data = {
+        .handle = alloc.dedicated_handle,
+        .offset = 0,
+        .ptr = nullptr,
+    };
+
+    if (mappable)
+        GFX_VK_VERIFY(vkMapMemory(m_context.get_device_handle(), alloc.dedicated_handle, 0, size, 0, &alloc.data.ptr));
+
+    return true;
+}
+
+bool gfx_vk::memory::allocate_from_blocks(allocation& alloc, VkDeviceSize size, VkDeviceSize alignment, uint32_t memory_type_index, memory_tiling tiling, bool mappable)
+{
+    auto try_allocate = [&](size_t block_index)
+    {
+        block& b = m_blocks[block_index];
+        assert(b.allocator);
+
+        tlsf_allocator::allocation suballocation = b.allocator->allocate(size, alignment);
+        if (!suballocation)
+            return false;
+
+        alloc.block_index = block_index;
+        alloc.suballocation = suballocation;
+        alloc.data = {
+            .handle = b.handle,
+            .offset = suballocation.offset,
+            .ptr = mappable ? static_cast<unsigned char*>(b.ptr) + suballocation.offset : nullptr,
+        };
+
+        assert(!mappable || b.ptr);
+
+        return true;
+    };
+
+    for (size_t i = 0; i < m_blocks.size(); i++)
+    {
+        if (!m_blocks[i].allocator || m_blocks[i].memory_type_index != memory_type_index || m_blocks[i].tiling != tiling)
+            continue;
+
+        if (try_allocate(i))
+            return true;
+    }
+
+    nstl::optional<size_t> new_block_index = create_block(memory_type_index, tiling, tlsf_allocator::get_required_size(size, alignment));
+    if (!new_block_index)
+        return false;
+
+    if (try_allocate(*new_block_index))
+        return true;
+
+    // The block is sized to serve the allocation, but an empty block must not stay around if it doesn't
+    assert(false);
+    destroy_block(*new_block_index);
+    return false;
+}
+
+nstl::optional<size_t> gfx_vk::memory::create_block(uint32_t memory_type_index, memory_tiling tiling, VkDeviceSize min_size)
+{
+    VkPhysicalDeviceMemoryProperties const& props = m_context.get_physical_device_props().memory_properties;
+    VkMemoryType const& memory_type = props.memoryTypes[memory_type_index];
+    VkDeviceSize heap_size = props.memoryHeaps[memory_type.heapIndex].size;
+
+    // Small heaps (e.g. host-visible device-local memory without resizable BAR) shouldn't be exhausted by a single block
+    VkDeviceSize block_size = m_config.block_size;
+    if (block_size > heap_size / 8)
+        block_size = heap_size / 8;
+    if (block_size < min_size)
+        block_size = min_size;
+
+    block b;
+    b.memory_type_index = memory_type_index;
+    b.tiling = tiling;
+
+    VkMemoryAllocateInfo info{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = block_size,
+        .memoryTypeIndex = memory_type_index,
+    };
+    if (vkAllocateMemory(m_context.get_device_handle(), &info, &m_context.get_allocator(), &b.handle.get()) != VK_SUCCESS)
+        return {};
+
+    if (is_mappable(memory_type.propertyFlags))
+        GFX_VK_VERIFY(vkMapMemory(m_context.get_device_handle(), b.handle, 0, block_size, 0, &b.ptr));
+
+    b.allocator = tlsf_allocator{ block_size };
+
+    for (size_t i = 0; i < m_blocks.size(); i++)
+    {
+        if (!m_blocks[i].allocator)
+        {
+            m_blocks[i] = nstl::move(b);
+            return i;
+        }
+    }
+
+    m_blocks.push_back(nstl::move(b));
+    return m_blocks.size() - 1;
+}
+
+void gfx_vk::memory::destroy_block(size_t index)
+{
+    block& b = m_blocks[index];
+    if (!b.allocator)
+        return;
+
+    assert(b.allocator->is_empty());
+
+    if (b.ptr)
+        vkUnmapMemory(m_context.get_device_handle(), b.handle);
+
+    vkFreeMemory(m_context.get_device_handle(), b.handle, &m_context.get_allocator());
+
+    b = {};
+}
+
+size_t gfx_vk::memory::count_blocks(uint32_t memory_type_index, memory_tiling tiling) const
+{
+    size_t count = 0;
+    for (block const& b : m_blocks)
+        if (b.allocator && b.memory_type_index == memory_type_index && b.tiling == tiling)
+            count++;
+
+    return count;
+}
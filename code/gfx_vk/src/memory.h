@@ -1,5 +1,7 @@
 #pragma once
 
+#include "gfx_vk/config.h"
+
 #include "nstl/optional.h"
 #include "nstl/vector.h"
 
@@ -11,11 +13,18 @@ namespace gfx_vk
 
     struct allocation_handle
     {
-        nstl::optional<size_t> index = 0;
+        nstl::optional<size_t> index;
 
         explicit operator bool() const { return index.has_value(); }
     };
 
+    // Linear (buffers) and optimal (images) resources have to be bufferImageGranularity apart in memory
+    enum class memory_tiling
+    {
+        linear,
+        optimal,
+    };
+
     struct allocation_data
     {
         VkDeviceMemory handle = VK_NULL_HANDLE;
@@ -23,26 +32,53 @@ namespace gfx_vk
         void* ptr = nullptr;
     };
 
+    struct memory_statistics
+    {
+        size_t block_count = 0;
+        size_t dedicated_allocation_count = 0;
+        size_t allocation_count = 0;
+
+        VkDeviceSize reserved_size = 0; // allocated from the driver
+        VkDeviceSize used_size = 0; // handed out to the resources
+    };
+
+    // Small allocations are suballocated from big per-memory-type blocks,
+    // big ones get a dedicated VkDeviceMemory
     class memory
     {
     public:
-        memory(context& context);
+        memory(context& context, memory_config const& config);
         ~memory();
 
-        allocation_handle allocate(VkMemoryRequirements requirements, VkMemoryPropertyFlags flags);
+        allocation_handle allocate(VkMemoryRequirements requirements, VkMemoryPropertyFlags flags, memory_tiling tiling);
         allocation_data const* get_data(allocation_handle handle) const;
         void free(allocation_handle handle);
 
+        memory_statistics get_statistics() const;
+
     private:
         struct allocation;
+        struct block;
 
     private:
+        allocation_handle create_allocation();
         allocation& get_allocation(allocation_handle handle);
         allocation const& get_allocation(allocation_handle handle) const;
 
+        bool allocate_dedicated(allocation& alloc, VkDeviceSize size, uint32_t memory_type_index, bool mappable);
+        bool allocate_from_blocks(allocation& alloc, VkDeviceSize size, VkDeviceSize alignment, uint32_t memory_type_index, memory_tiling tiling, bool mappable);
+
+        nstl::optional<size_t> create_block(uint32_t memory_type_index, memory_tiling tiling, VkDeviceSize min_size);
+        void destroy_block(size_t index);
+        size_t count_blocks(uint32_t memory_type_index, memory_tiling tiling) const;
+
     private:
         context& m_context;
+        memory_config m_config;
 
         nstl::vector<allocation> m_allocations;
+        nstl::vector<size_t> m_free_allocations;
+
+        nstl::vector<block> m_blocks;
     };
 }
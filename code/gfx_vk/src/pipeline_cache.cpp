@@ -0,0 +1,135 @@
+#include "pipeline_cache.h"
+
+#include "context.h"
+#include "pipeline_cache_file.h"
+
+#include "fs/file.h"
+
+#include "logging/logging.h"
+
+#include "nstl/vector.h"
+
+namespace
+{
+    gfx_vk::pipeline_cache_device_id get_device_id(VkPhysicalDeviceProperties const& properties)
+    {
+        gfx_vk::pipeline_cache_device_id id{
+            .vendor_id = properties.vendorID,
+            .device_id = properties.deviceID,
+            .driver_version = properties.driverVersion,
+        };
+
+        static_assert(sizeof(id.cache_uuid) == VK_UUID_SIZE);
+        memcpy(id.cache_uuid.data(), properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+        return id;
+    }
+
+    nstl::vector<unsigned char> read_file(nstl::string_view path)
+    {
+        fs::file f;
+        if (!f.try_open(path, fs::open_mode::read))
+            return {};
+
+        nstl::vector<unsigned char> content;
+        content.resize(f.size());
+        if (!f.try_read(content.data(), content.size()))
+            return {};
+
+        return content;
+    }
+}
+
+gfx_vk::pipeline_cache::pipeline_cache(context& context, pipeline_cache_config const& config)
+    : m_context(context)
+    , m_config(config)
+{
+    nstl::vector<unsigned char> file;
+    nstl::blob_view initial_data;
+
+    if (m_config.path)
+    {
+        file = read_file(m_config.path);
+
+        if (!file.empty())
+        {
+            pipeline_cache_device_id device_id = get_device_id(m_context.get_physical_device_props().properties);
+            pipeline_cache_read_code code = read_pipeline_cache_file({ file.data(), file.size() }, device_id, initial_data);
+            if (code == pipeline_cache_read_code::success)
+                logging::info("Loaded pipeline cache '{}' ({} bytes)", m_config.path, initial_data.size());
+            else
+                logging::warn("Ignoring pipeline cache '{}': {}", m_config.path, to_string(code));
+        }
+    }
+
+    m_statistics.loaded_size = initial_data.size();
+
+    VkPipelineCacheCreateInfo info{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = initial_data.size(),
+        .pInitialData = initial_data.data(),
+    };
+
+    GFX_VK_VERIFY(vkCreatePipelineCache(m_context.get_device_handle(), &info, &m_context.get_allocator(), &m_handle.get()));
+}
+
+gfx_vk::pipeline_cache::~pipeline_cache()
+{
+    if (!m_handle)
+        return;
+
+    if (m_config.path)
+        save();
+
+    vkDestroyPipelineCache(m_context.get_device_handle(), m_handle, &m_context.get_allocator());
+    m_handle = nullptr;
+}
+
+VkPipeline gfx_vk::pipeline_cache::create_graphics_pipeline(VkGraphicsPipelineCreateInfo info)
+{
+    VkPipelineCreationFeedback feedback{};
+    VkPipelineCreationFeedbackCreateInfo feedback_info{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+        .pNext = info.pNext,
+        .pPipelineCreationFeedback = &feedback,
+    };
+    info.pNext = &feedback_info;
+
+    VkPipeline handle = VK_NULL_HANDLE;
+    GFX_VK_VERIFY(vkCreateGraphicsPipelines(m_context.get_device_handle(), m_handle, 1, &info, &m_context.get_allocator(), &handle));
+
+    // Pipelines without valid feedback are counted as misses
+    bool is_valid = (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) != 0;
+    bool is_hit = (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) != 0;
+    if (is_valid && is_hit)
+        m_statistics.hit_count++;
+    else
+        m_statistics.miss_count++;
+
+    return handle;
+}
+
+bool gfx_vk::pipeline_cache::save()
+{
+    assert(m_config.path);
+
+    size_t size = 0;
+    GFX_VK_VERIFY(vkGetPipelineCacheData(m_context.get_device_handle(), m_handle, &size, nullptr));
+
+    nstl::vector<unsigned char> data;
+    data.resize(size);
+    GFX_VK_VERIFY(vkGetPipelineCacheData(m_context.get_device_handle(), m_handle, &size, data.data()));
+
+    pipeline_cache_device_id device_id = get_device_id(m_context.get_physical_device_props().properties);
+    nstl::vector<unsigned char> file = write_pipeline_cache_file(device_id, { data.data(), size });
+
+    fs::file f;
+    if (!f.try_open(m_config.path, fs::open_mode::write) || !f.try_write(file.data(), file.size()))
+    {
+        logging::warn("Failed to write pipeline cache '{}'", m_config.path);
+        return false;
+    }
+
+    logging::info("Saved pipeline cache '{}' ({} bytes)", m_config.path, size);
+    return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "utils.h"
+
+#include "gfx_vk/backend.h"
+#include "gfx_vk/config.h"
+
+#include <vulkan/vulkan.h>
+
+namespace gfx_vk
+{
+    class context;
+
+    // Loaded from the file at startup and written back on destruction, so that pipelines
+    // don't have to be compiled from scratch on every run
+    class pipeline_cache final
+    {
+    public:
+        pipeline_cache(context& context, pipeline_cache_config const& config);
+        ~pipeline_cache();
+
+        [[nodiscard]] VkPipeline create_graphics_pipeline(VkGraphicsPipelineCreateInfo info);
+
+        VkPipelineCache get_handle() const { return m_handle; }
+        pipeline_cache_statistics const& get_statistics() const { return m_statistics; }
+
+        bool save();
+
+    private:
+        context& m_context;
+        pipeline_cache_config m_config;
+
+        unique_handle<VkPipelineCache> m_handle;
+
+        pipeline_cache_statistics m_statistics;
+    };
+}
@@ -0,0 +1,107 @@
+#include "pipeline_cache_file.h"
+
+#include <string.h>
+
+namespace
+{
+    constexpr uint32_t file_magic = 0x43504b56; // "VKPC"
+    constexpr uint32_t file_version = 1;
+
+    struct file_header
+    {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+
+        uint32_t vendor_id = 0;
+        uint32_t device_id = 0;
+        uint32_t driver_version = 0;
+        uint8_t cache_uuid[16]{};
+
+        uint32_t padding = 0;
+        uint64_t data_size = 0;
+        uint64_t data_hash = 0;
+    };
+
+    static_assert(sizeof(file_header) == 56);
+
+    uint64_t hash_data(nstl::blob_view data)
+    {
+        // FNV-1a
+        uint64_t hash = 0xcbf29ce484222325;
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            hash ^= data.ucdata()[i];
+            hash *= 0x100000001b3;
+        }
+        return hash;
+    }
+}
+
+nstl::vector<unsigned char> gfx_vk::write_pipeline_cache_file(pipeline_cache_device_id const& device, nstl::blob_view data)
+{
+    file_header header{
+        .magic = file_magic,
+        .version = file_version,
+        .vendor_id = device.vendor_id,
+        .device_id = device.device_id,
+        .driver_version = device.driver_version,
+        .data_size = data.size(),
+        .data_hash = hash_data(data),
+    };
+    memcpy(header.cache_uuid, device.cache_uuid.data(), sizeof(header.cache_uuid));
+
+    nstl::vector<unsigned char> file;
+    file.resize(sizeof(header) + data.size());
+    memcpy(file.data(), &header, sizeof(header));
+    if (!data.empty())
+        memcpy(file.data() + sizeof(header), data.data(), data.size());
+
+    return file;
+}
+
+gfx_vk::pipeline_cache_read_code gfx_vk::read_pipeline_cache_file(nstl::blob_view file, pipeline_cache_device_id const& device, nstl::blob_view& data)
+{
+    if (file.size() < sizeof(file_header))
+        return pipeline_cache_read_code::error_too_small;
+
+    file_header header;
+    memcpy(&header, file.data(), sizeof(header));
+
+    if (header.magic != file_magic)
+        return pipeline_cache_read_code::error_invalid_magic;
+    if (header.version != file_version)
+        return pipeline_cache_read_code::error_unsupported_version;
+
+    bool same_device = header.vendor_id == device.vendor_id
+        && header.device_id == device.device_id
+        && header.driver_version == device.driver_version
+        && memcmp(header.cache_uuid, device.cache_uuid.data(), sizeof(header.cache_uuid)) == 0;
+    if (!same_device)
+        return pipeline_cache_read_code::error_device_mismatch;
+
+    if (header.data_size != file.size() - sizeof(header))
+        return pipeline_cache_read_code::error_size_mismatch;
+
+    nstl::blob_view payload = file.subview(sizeof(header));
+    if (header.data_hash != hash_data(payload))
+        return pipeline_cache_read_code::error_hash_mismatch;
+
+    data = payload;
+    return pipeline_cache_read_code::success;
+}
+
+char const* gfx_vk::to_string(pipeline_cache_read_code code)
+{
+    switch (code)
+    {
+    case pipeline_cache_read_code::success: return "success";
+    case pipeline_cache_read_code::error_too_small: return "file is too small";
+    case pipeline_cache_read_code::error_invalid_magic: return "invalid magic";
+    case pipeline_cache_read_code::error_unsupported_version: return "unsupported version";
+    case pipeline_cache_read_code::error_device_mismatch: return "created for a different device or driver";
+    case pipeline_cache_read_code::error_size_mismatch: return "data size mismatch";
+    case pipeline_cache_read_code::error_hash_mismatch: return "data hash mismatch";
+    }
+
+    return "unknown";
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "nstl/array.h"
+#include "nstl/blob_view.h"
+#include "nstl/vector.h"
+
+#include <stdint.h>
+
+// On-disk format of the pipeline cache. Doesn't depend on Vulkan so that it can be validated without a device
+
+namespace gfx_vk
+{
+    struct pipeline_cache_device_id
+    {
+        uint32_t vendor_id = 0;
+        uint32_t device_id = 0;
+        uint32_t driver_version = 0;
+        nstl::array<uint8_t, 16> cache_uuid{};
+    };
+
+    enum class pipeline_cache_read_code
+    {
+        success,
+        error_too_small,
+        error_invalid_magic,
+        error_unsupported_version,
+        error_device_mismatch,
+        error_size_mismatch,
+        error_hash_mismatch,
+    };
+
+    [[nodiscard]] nstl::vector<unsigned char> write_pipeline_cache_file(pipeline_cache_device_id const& device, nstl::blob_view data);
+
+    // On success `data` points into `file`
+    [[nodiscard]] pipeline_cache_read_code read_pipeline_cache_file(nstl::blob_view file, pipeline_cache_device_id const& device, nstl::blob_view& data);
+
+    char const* to_string(pipeline_cache_read_code code);
+}
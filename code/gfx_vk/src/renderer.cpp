@@ -11,7 +11,6 @@
 #include "command_pool.h"
 
 #include "nstl/array.h"
-#include "nstl/static_vector.h"
 
 namespace
 {
@@ -126,10 +125,15 @@ void gfx_vk::renderer::begin_resource_update()
 
     get_current_frame_resources().in_flight_fence.wait();
     get_current_frame_resources().in_flight_fence.reset();
+
+    m_context.get_transfers().retire();
 }
 
 void gfx_vk::renderer::begin_frame()
 {
+    // Uploads recorded during the resource update are submitted before the frame
+    m_context.get_transfers().flush();
+
     VkCommandPoolResetFlags flags = 0;
     GFX_VK_VERIFY(vkResetCommandPool(m_context.get_device_handle(), get_current_frame_resources().command_pool.get_handle(), flags));
 
@@ -139,6 +143,9 @@ void gfx_vk::renderer::begin_frame()
     };
     GFX_VK_VERIFY(vkBeginCommandBuffer(get_current_frame_resources().command_buffer, &info));
 
+    m_bind_state.reset();
+    m_frame_arena.next_frame();
+
     m_in_frame = true;
 }
 
@@ -148,7 +155,7 @@ void gfx_vk::renderer::renderpass_begin(gfx::renderpass_begin_params const& para
 
     framebuffer& fb = m_context.get_resources().get_framebuffer(params.framebuffer);
 
-    nstl::vector<VkClearValue> clear_values;
+    nstl::vector<VkClearValue> clear_values{ m_frame_arena.get_allocator() };
     for (gfx::image_type type : fb.get_attachment_types())
     {
         switch (type)
@@ -190,6 +197,8 @@ void gfx_vk::renderer::renderpass_begin(gfx::renderpass_begin_params const& para
 
     m_current_renderpass = params.renderpass;
     m_current_framebuffer = params.framebuffer;
+
+    m_bind_state.reset();
 }
 
 void gfx_vk::renderer::renderpass_end()
@@ -208,47 +217,65 @@ void gfx_vk::renderer::draw_indexed(gfx::draw_indexed_args const& args)
 
     renderstate& rs = m_context.get_resources().get_renderstate(args.renderstate);
 
-    // TODO track what's already bound
-
-    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, rs.get_handle());
+    VkPipelineLayout layout = rs.get_params().layout;
 
-    nstl::static_vector<VkDescriptorSet, 5> sets;
-    for (gfx::descriptorgroup_handle handle : args.descriptorgroups)
-        sets.push_back(m_context.get_resources().get_descriptorgroup(handle).get_current_handle());
-    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, rs.get_params().layout, 0, static_cast<uint32_t>(sets.size()), sets.data(), 0, nullptr);
+    if (m_bind_state.bind_renderstate(args.renderstate, reinterpret_cast<uint64_t>(layout)))
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, rs.get_handle());
 
-    nstl::static_vector<VkBuffer, 5> vertex_buffers;
-    nstl::static_vector<VkDeviceSize, 5> vertex_buffers_offset;
-    for (auto&& [buffer, offset] : args.vertex_buffers)
+    if (nstl::optional<size_t> first_set = m_bind_state.bind_descriptorgroups(args.descriptorgroups))
     {
-        vertex_buffers.push_back(m_context.get_resources().get_buffer(buffer).get_current_handle());
-        vertex_buffers_offset.push_back(offset);
-    }
-    vkCmdBindVertexBuffers(command_buffer, 0, static_cast<uint32_t>(args.vertex_buffers.size()), vertex_buffers.data(), vertex_buffers_offset.data());
+        nstl::span<gfx::descriptorgroup_handle const> descriptorgroups = args.descriptorgroups.subspan(*first_set);
 
-    vkCmdBindIndexBuffer(command_buffer, m_context.get_resources().get_buffer(args.index_buffer.buffer).get_current_handle(), args.index_buffer.offset, utils::get_index_type(args.index_type));
+        nstl::vector<VkDescriptorSet> sets{ m_frame_arena.get_allocator() };
+        sets.reserve(descriptorgroups.size());
+        for (gfx::descriptorgroup_handle handle : descriptorgroups)
+            sets.push_back(m_context.get_resources().get_descriptorgroup(handle).get_current_handle());
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, static_cast<uint32_t>(*first_set), static_cast<uint32_t>(sets.size()), sets.data(), 0, nullptr);
+    }
 
-    VkRect2D scissor{};
-    if (args.scissor)
+    if (nstl::optional<size_t> first_binding = m_bind_state.bind_vertex_buffers(args.vertex_buffers))
     {
-        assert(args.scissor->size.x > 0);
-        assert(args.scissor->size.y > 0);
+        nstl::span<gfx::buffer_with_offset const> bindings = args.vertex_buffers.subspan(*first_binding);
 
-        scissor = {
-            .offset = { args.scissor->offset.x, args.scissor->offset.y },
-            .extent = { static_cast<uint32_t>(args.scissor->size.x), static_cast<uint32_t>(args.scissor->size.y) },
-        };
+        nstl::vector<VkBuffer> vertex_buffers{ m_frame_arena.get_allocator() };
+        nstl::vector<VkDeviceSize> vertex_buffers_offset{ m_frame_arena.get_allocator() };
+        vertex_buffers.reserve(bindings.size());
+        vertex_buffers_offset.reserve(bindings.size());
+        for (auto&& [buffer, offset] : bindings)
+        {
+            vertex_buffers.push_back(m_context.get_resources().get_buffer(buffer).get_current_handle());
+            vertex_buffers_offset.push_back(offset);
+        }
+        vkCmdBindVertexBuffers(command_buffer, static_cast<uint32_t>(*first_binding), static_cast<uint32_t>(vertex_buffers.size()), vertex_buffers.data(), vertex_buffers_offset.data());
     }
-    else
+
+    if (m_bind_state.bind_index_buffer(args.index_buffer, args.index_type))
+        vkCmdBindIndexBuffer(command_buffer, m_context.get_resources().get_buffer(args.index_buffer.buffer).get_current_handle(), args.index_buffer.offset, utils::get_index_type(args.index_type));
+
+    if (m_bind_state.set_scissor(args.scissor))
     {
-        framebuffer& fb = m_context.get_resources().get_framebuffer(m_current_framebuffer);
+        VkRect2D scissor{};
+        if (args.scissor)
+        {
+            assert(args.scissor->size.x > 0);
+            assert(args.scissor->size.y > 0);
 
-        scissor = {
-            .offset = { 0, 0 },
-            .extent = fb.get_extent(),
-        };
+            scissor = {
+                .offset = { args.scissor->offset.x, args.scissor->offset.y },
+                .extent = { static_cast<uint32_t>(args.scissor->size.x), static_cast<uint32_t>(args.scissor->size.y) },
+            };
+        }
+        else
+        {
+            framebuffer& fb = m_context.get_resources().get_framebuffer(m_current_framebuffer);
+
+            scissor = {
+                .offset = { 0, 0 },
+                .extent = fb.get_extent(),
+            };
+        }
+        vkCmdSetScissor(command_buffer, 0, 1, &scissor);
     }
-    vkCmdSetScissor(command_buffer, 0, 1, &scissor);
 
     assert(args.vertex_offset <= INT32_MAX);
     vkCmdDrawIndexed(command_buffer, static_cast<uint32_t>(args.index_count), static_cast<uint32_t>(args.instance_count), static_cast<uint32_t>(args.first_index), static_cast<int32_t>(args.vertex_offset), 0);
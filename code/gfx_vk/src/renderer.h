@@ -4,8 +4,10 @@
 
 #include "gfx_vk/config.h"
 
+#include "gfx/bind_state_tracker.h"
 #include "gfx/resources.h"
 
+#include "nstl/frame_arena.h"
 #include "nstl/vector.h"
 
 namespace gfx_vk
@@ -35,6 +37,8 @@ namespace gfx_vk
 
         void submit();
 
+        gfx::bind_statistics const& get_bind_statistics() const { return m_bind_state.get_statistics(); }
+
     private:
         struct frame_resources;
 
@@ -57,6 +61,11 @@ namespace gfx_vk
         gfx::renderpass_handle m_current_renderpass = nullptr;
         gfx::framebuffer_handle m_current_framebuffer = nullptr;
 
+        gfx::bind_state_tracker m_bind_state;
+
+        // Scratch memory for data that is only needed while recording a frame
+        nstl::frame_arena m_frame_arena;
+
         // Debug state tracking
         // TODO move to gfx::renderer
         bool m_in_frame = false;
@@ -212,7 +212,7 @@ gfx_vk::renderstate::renderstate(context& context, renderstate_init_params const
         .basePipelineIndex = -1,
     };
 
-    GFX_VK_VERIFY(vkCreateGraphicsPipelines(m_context.get_device_handle(), VK_NULL_HANDLE, 1, &info, &m_context.get_allocator(), &m_handle.get()));
+    m_handle = m_context.get_pipeline_cache().create_graphics_pipeline(info);
 }
 
 gfx_vk::renderstate::~renderstate()
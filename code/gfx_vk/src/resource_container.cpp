@@ -10,42 +10,29 @@
 #include "descriptor_set_layout.h"
 #include "pipeline_layout.h"
 #include "renderstate.h"
+#include "resource_handles.h"
 
 namespace
 {
-    template<typename T, typename H>
-    H create_handle(T& resource)
-    {
-        return { &resource };
-    }
-
     template<typename T, typename H, typename... Args>
-    H create_resource(nstl::vector<nstl::unique_ptr<T>>& container, gfx_vk::context& context, Args&&... params)
+    H create_resource(nstl::slot_map<nstl::unique_ptr<T>>& container, gfx_vk::context& context, Args&&... params)
     {
-        container.push_back(nstl::make_unique<T>(context, nstl::forward<Args>(params)...));
-        return { container.back().get() };
+        return gfx_vk::encode_handle<H>(container.insert(nstl::make_unique<T>(context, nstl::forward<Args>(params)...)));
     }
 
     template<typename T, typename H>
-    T& get_resource(nstl::vector<nstl::unique_ptr<T>> const&, H handle)
+    T& get_resource(nstl::slot_map<nstl::unique_ptr<T>> const& container, H handle)
     {
         assert(handle);
-        return *static_cast<T*>(handle.ptr);
+        nstl::unique_ptr<T> const* resource = container.get(gfx_vk::decode_handle(handle));
+        assert(resource); // The resource was destroyed or the handle is invalid
+        return **resource;
     }
 
     template<typename T, typename H>
-    bool destroy_resource(nstl::vector<nstl::unique_ptr<T>>& container, H handle)
+    bool destroy_resource(nstl::slot_map<nstl::unique_ptr<T>>& container, H handle)
     {
-        for (auto& resource : container)
-        {
-            if (resource.get() == static_cast<T*>(handle.ptr))
-            {
-                resource = nullptr;
-                return true;
-            }
-        }
-
-        return false;
+        return container.erase(gfx_vk::decode_handle(handle));
     }
 }
 
@@ -177,15 +164,8 @@ gfx::renderstate_handle gfx_vk::resource_container::create_renderstate(gfx::rend
         .renderpass = get_renderpass(params.renderpass).get_handle(),
     };
 
-    for (auto const& state : m_renderstates)
-    {
-        if (state->get_params() == init_params)
-        {
-            // TODO increase ref counter
-            return create_handle<renderstate, gfx::renderstate_handle>(*state.get());
-        }
-    }
-
+    // Identical renderstates are already shared by gfx::renderstate_cache, which also counts the references.
+    // Handing out the same handle here as well would destroy the pipeline while another cache entry still uses it
     return create_resource<renderstate, gfx::renderstate_handle>(m_renderstates, m_context, init_params);
 }
 
@@ -194,12 +174,10 @@ gfx_vk::renderstate& gfx_vk::resource_container::get_renderstate(gfx::renderstat
     return get_resource(m_renderstates, handle);
 }
 
-bool gfx_vk::resource_container::destroy_renderstate(gfx::renderstate_handle)
+bool gfx_vk::resource_container::destroy_renderstate(gfx::renderstate_handle handle)
 {
-    // TODO check the ref counter first before destroying the resource
-    // TODO also destroy descriptor set layouts and the pipeline layout
-//     return destroy_resource(m_renderstates, handle);
-    return false;
+    // TODO also destroy descriptor set layouts and the pipeline layout. They are shared between renderstates and kept until shutdown
+    return destroy_resource(m_renderstates, handle);
 }
 
 VkDescriptorSetLayout gfx_vk::resource_container::create_descriptor_set_layout(gfx::descriptorgroup_layout_view const& layout)
@@ -2,6 +2,7 @@
 
 #include "gfx/resources.h"
 
+#include "nstl/slot_map.h"
 #include "nstl/unique_ptr.h"
 #include "nstl/vector.h"
 
@@ -69,16 +70,16 @@ namespace gfx_vk
     private:
         context& m_context;
 
-        nstl::vector<nstl::unique_ptr<buffer>> m_buffers;
-        nstl::vector<nstl::unique_ptr<image>> m_images;
-        nstl::vector<nstl::unique_ptr<sampler>> m_samplers;
-        nstl::vector<nstl::unique_ptr<renderpass>> m_renderpasses;
-        nstl::vector<nstl::unique_ptr<framebuffer>> m_framebuffers;
-        nstl::vector<nstl::unique_ptr<descriptorgroup>> m_descriptorgroups;
-        nstl::vector<nstl::unique_ptr<shader>> m_shaders;
+        nstl::slot_map<nstl::unique_ptr<buffer>> m_buffers;
+        nstl::slot_map<nstl::unique_ptr<image>> m_images;
+        nstl::slot_map<nstl::unique_ptr<sampler>> m_samplers;
+        nstl::slot_map<nstl::unique_ptr<renderpass>> m_renderpasses;
+        nstl::slot_map<nstl::unique_ptr<framebuffer>> m_framebuffers;
+        nstl::slot_map<nstl::unique_ptr<descriptorgroup>> m_descriptorgroups;
+        nstl::slot_map<nstl::unique_ptr<shader>> m_shaders;
 
         nstl::vector<nstl::unique_ptr<descriptor_set_layout>> m_descriptor_set_layouts;
         nstl::vector<nstl::unique_ptr<pipeline_layout>> m_pipeline_layouts;
-        nstl::vector<nstl::unique_ptr<renderstate>> m_renderstates;
+        nstl::slot_map<nstl::unique_ptr<renderstate>> m_renderstates;
     };
 }
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "gfx/resources.h"
+
+#include "nstl/slot_map.h"
+
+#include <stdint.h>
+
+namespace gfx_vk
+{
+    // Handles encode the slot index and the generation, so stale handles can be detected in O(1)
+    static_assert(sizeof(uintptr_t) >= sizeof(uint64_t));
+
+    template<typename H>
+    H encode_handle(nstl::slot_map_handle handle)
+    {
+        // The index is offset by 1 so that a valid handle is never null
+        uintptr_t value = (static_cast<uintptr_t>(handle.generation) << 32) | (static_cast<uintptr_t>(handle.index) + 1);
+        return H{ reinterpret_cast<void*>(value) };
+    }
+
+    inline nstl::slot_map_handle decode_handle(gfx::handle handle)
+    {
+        uintptr_t value = reinterpret_cast<uintptr_t>(handle.ptr);
+        uint32_t index = static_cast<uint32_t>(value & UINT32_MAX);
+        if (index == 0)
+            return {};
+
+        return { index - 1, static_cast<uint32_t>(value >> 32) };
+    }
+}
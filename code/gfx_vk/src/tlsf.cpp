@@ -0,0 +1,308 @@
+#include "tlsf.h"
+
+#include "nstl/alignment.h"
+#include "nstl/bit.h"
+
+#include <assert.h>
+
+namespace
+{
+    constexpr uint32_t sl_index_bits = 5;
+    constexpr uint64_t sl_count = uint64_t{ 1 } << sl_index_bits;
+
+    struct list_index
+    {
+        uint32_t fl = 0;
+        uint32_t sl = 0;
+    };
+
+    // Small sizes get an exact list each, larger ones are split into sl_count lists per power of 2
+    list_index get_list_index(uint64_t size)
+    {
+        if (size < sl_count)
+            return { 0, static_cast<uint32_t>(size) };
+
+        uint32_t msb = nstl::find_last_set(size);
+        return {
+            .fl = msb - sl_index_bits + 1,
+            .sl = static_cast<uint32_t>((size >> (msb - sl_index_bits)) - sl_count),
+        };
+    }
+
+    // Rounds the size up so that any block from the resulting list (or above) fits it
+    uint64_t round_up_search_size(uint64_t size)
+    {
+        if (size < sl_count)
+            return size;
+
+        uint32_t msb = nstl::find_last_set(size);
+        uint64_t granularity = uint64_t{ 1 } << (msb - sl_index_bits);
+        return size + granularity - 1;
+    }
+
+    // Worst case, the block has to be padded in the front to satisfy the alignment
+    uint64_t get_search_size(uint64_t size, uint64_t alignment)
+    {
+        if (size == 0)
+            size = 1;
+        if (alignment == 0)
+            alignment = 1;
+
+        return size + alignment - 1;
+    }
+}
+
+gfx_vk::tlsf_allocator::tlsf_allocator(uint64_t size) : m_size(size)
+{
+    static_assert(sl_index_bits == ::sl_index_bits);
+
+    for (auto& lists : m_free_lists)
+        for (uint32_t& head : lists)
+            head = invalid_index;
+
+    assert(size > 0);
+    insert_free_block(create_block(0, size));
+}
+
+uint64_t gfx_vk::tlsf_allocator::get_required_size(uint64_t size, uint64_t alignment)
+{
+    // A block of exactly the rounded size is in the first list that find_free_block() searches
+    return round_up_search_size(get_search_size(size, alignment));
+}
+
+gfx_vk::tlsf_allocator::allocation gfx_vk::tlsf_allocator::allocate(uint64_t size, uint64_t alignment)
+{
+    if (size == 0)
+        size = 1;
+    if (alignment == 0)
+        alignment = 1;
+
+    assert(nstl::is_power_of_2(alignment));
+
+    uint64_t search_size = get_search_size(size, alignment);
+    if (search_size < size || search_size > m_size)
+        return {};
+
+    uint32_t index = find_free_block(search_size);
+    if (index == invalid_index)
+        return {};
+
+    remove_free_block(index);
+
+    uint64_t padding = nstl::align_up(m_blocks[index].offset, alignment) - m_blocks[index].offset;
+    if (padding > 0)
+    {
+        // The previous physical block is never free, so the padding becomes a separate free block
+        uint32_t aligned_index = split_block(index, padding);
+        insert_free_block(index);
+        index = aligned_index;
+    }
+
+    assert(m_blocks[index].size >= size);
+    if (m_blocks[index].size > size)
+    {
+        uint32_t remainder_index = split_block(index, size);
+        insert_free_block(remainder_index);
+    }
+
+    block& b = m_blocks[index];
+    b.is_free = false;
+
+    m_used_size += b.size;
+    m_allocation_count++;
+
+    assert(nstl::is_aligned(b.offset, alignment));
+    return { .block = index, .offset = b.offset };
+}
+
+void gfx_vk::tlsf_allocator::free(allocation allocation)
+{
+    if (!allocation)
+        return;
+
+    uint32_t index = allocation.block;
+    assert(index < m_blocks.size());
+    assert(!m_blocks[index].is_free);
+    assert(m_blocks[index].offset == allocation.offset);
+
+    m_used_size -= m_blocks[index].size;
+    m_allocation_count--;
+
+    m_blocks[index].is_free = true;
+
+    uint32_t next = m_blocks[index].next_physical;
+    if (next != invalid_index && m_blocks[next].is_free)
+    {
+        remove_free_block(next);
+        merge_with_next(index);
+    }
+
+    uint32_t prev = m_blocks[index].prev_physical;
+    if (prev != invalid_index && m_blocks[prev].is_free)
+    {
+        remove_free_block(prev);
+        merge_with_next(prev);
+        index = prev;
+    }
+
+    insert_free_block(index);
+}
+
+gfx_vk::tlsf_allocator::statistics gfx_vk::tlsf_allocator::get_statistics() const
+{
+    statistics result = {
+        .size = m_size,
+        .used_size = m_used_size,
+        .allocation_count = m_allocation_count,
+    };
+
+    for (uint32_t fl = 0; fl < fl_count; fl++)
+    {
+        for (uint32_t sl = 0; sl < sl_count; sl++)
+        {
+            for (uint32_t index = m_free_lists[fl][sl]; index != invalid_index; index = m_blocks[index].next_free)
+            {
+                result.free_block_count++;
+                if (m_blocks[index].size > result.largest_free_block)
+                    result.largest_free_block = m_blocks[index].size;
+            }
+        }
+    }
+
+    return result;
+}
+
+uint32_t gfx_vk::tlsf_allocator::create_block(uint64_t offset, uint64_t size)
+{
+    uint32_t index = m_first_unused_block;
+
+    if (index != invalid_index)
+    {
+        m_first_unused_block = m_blocks[index].next_free;
+    }
+    else
+    {
+        assert(m_blocks.size() < invalid_index);
+        index = static_cast<uint32_t>(m_blocks.size());
+        m_blocks.push_back({});
+    }
+
+    m_blocks[index] = { .offset = offset, .size = size };
+    return index;
+}
+
+void gfx_vk::tlsf_allocator::release_block(uint32_t index)
+{
+    m_blocks[index] = {};
+    m_blocks[index].next_free = m_first_unused_block;
+    m_first_unused_block = index;
+}
+
+void gfx_vk::tlsf_allocator::insert_free_block(uint32_t index)
+{
+    list_index list = get_list_index(m_blocks[index].size);
+    uint32_t& head = m_free_lists[list.fl][list.sl];
+
+    block& b = m_blocks[index];
+    b.is_free = true;
+    b.prev_free = invalid_index;
+    b.next_free = head;
+
+    if (head != invalid_index)
+        m_blocks[head].prev_free = index;
+    head = index;
+
+    m_fl_bitmap |= uint64_t{ 1 } << list.fl;
+    m_sl_bitmaps[list.fl] |= uint32_t{ 1 } << list.sl;
+}
+
+void gfx_vk::tlsf_allocator::remove_free_block(uint32_t index)
+{
+    block& b = m_blocks[index];
+    assert(b.is_free);
+
+    if (b.prev_free != invalid_index)
+        m_blocks[b.prev_free].next_free = b.next_free;
+    if (b.next_free != invalid_index)
+        m_blocks[b.next_free].prev_free = b.prev_free;
+
+    list_index list = get_list_index(b.size);
+    uint32_t& head = m_free_lists[list.fl][list.sl];
+    if (head == index)
+    {
+        head = b.next_free;
+
+        if (head == invalid_index)
+        {
+            m_sl_bitmaps[list.fl] &= ~(uint32_t{ 1 } << list.sl);
+            if (m_sl_bitmaps[list.fl] == 0)
+                m_fl_bitmap &= ~(uint64_t{ 1 } << list.fl);
+        }
+    }
+
+    b.prev_free = invalid_index;
+    b.next_free = invalid_index;
+}
+
+uint32_t gfx_vk::tlsf_allocator::find_free_block(uint64_t size) const
+{
+    list_index list = get_list_index(round_up_search_size(size));
+    if (list.fl >= fl_count)
+        return invalid_index;
+
+    uint32_t sl_map = m_sl_bitmaps[list.fl] & (~uint32_t{ 0 } << list.sl);
+    if (sl_map == 0)
+    {
+        uint64_t fl_map = list.fl + 1 < 64 ? m_fl_bitmap & (~uint64_t{ 0 } << (list.fl + 1)) : 0;
+        if (fl_map == 0)
+            return invalid_index;
+
+        list.fl = nstl::find_first_set(fl_map);
+        sl_map = m_sl_bitmaps[list.fl];
+        assert(sl_map != 0);
+    }
+
+    list.sl = nstl::find_first_set(sl_map);
+
+    uint32_t index = m_free_lists[list.fl][list.sl];
+    assert(index != invalid_index);
+    assert(m_blocks[index].size >= size);
+    return index;
+}
+
+uint32_t gfx_vk::tlsf_allocator::split_block(uint32_t index, uint64_t size)
+{
+    assert(m_blocks[index].size > size);
+
+    uint32_t remainder_index = create_block(m_blocks[index].offset + size, m_blocks[index].size - size);
+
+    block& b = m_blocks[index];
+    block& remainder = m_blocks[remainder_index];
+
+    remainder.prev_physical = index;
+    remainder.next_physical = b.next_physical;
+    if (b.next_physical != invalid_index)
+        m_blocks[b.next_physical].prev_physical = remainder_index;
+
+    b.next_physical = remainder_index;
+    b.size = size;
+
+    return remainder_index;
+}
+
+void gfx_vk::tlsf_allocator::merge_with_next(uint32_t index)
+{
+    uint32_t next_index = m_blocks[index].next_physical;
+    assert(next_index != invalid_index);
+
+    block& b = m_blocks[index];
+    block& next = m_blocks[next_index];
+    assert(b.offset + b.size == next.offset);
+
+    b.size += next.size;
+    b.next_physical = next.next_physical;
+    if (next.next_physical != invalid_index)
+        m_blocks[next.next_physical].prev_physical = index;
+
+    release_block(next_index);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "nstl/vector.h"
+
+#include <stdint.h>
+
+// Two-level segregated fit allocator. It only manages offsets inside an abstract range
+// and never touches the memory, so it doesn't depend on Vulkan and can be used
+// to suballocate any kind of memory block
+
+namespace gfx_vk
+{
+    class tlsf_allocator
+    {
+    public:
+        static constexpr uint32_t invalid_index = UINT32_MAX;
+
+        struct allocation
+        {
+            uint32_t block = invalid_index;
+            uint64_t offset = 0;
+
+            explicit operator bool() const { return block != invalid_index; }
+        };
+
+        struct statistics
+        {
+            uint64_t size = 0;
+            uint64_t used_size = 0;
+            uint64_t largest_free_block = 0;
+            size_t allocation_count = 0;
+            size_t free_block_count = 0;
+        };
+
+    public:
+        tlsf_allocator(uint64_t size);
+
+        // Size of an empty allocator which is guaranteed to serve the allocation. It's bigger than
+        // size + alignment, since the free lists are searched with the size rounded up to the list granularity
+        static uint64_t get_required_size(uint64_t size, uint64_t alignment);
+
+        [[nodiscard]] allocation allocate(uint64_t size, uint64_t alignment);
+        void free(allocation allocation);
+
+        uint64_t get_size() const { return m_size; }
+        uint64_t get_used_size() const { return m_used_size; }
+        bool is_empty() const { return m_allocation_count == 0; }
+
+        statistics get_statistics() const;
+
+    private:
+        static constexpr uint32_t sl_index_bits = 5;
+        static constexpr uint32_t sl_count = 1 << sl_index_bits;
+        static constexpr uint32_t fl_count = 64 - sl_index_bits + 1;
+
+        struct block
+        {
+            uint64_t offset = 0;
+            uint64_t size = 0;
+
+            uint32_t prev_physical = invalid_index;
+            uint32_t next_physical = invalid_index;
+
+            uint32_t prev_free = invalid_index;
+            uint32_t next_free = invalid_index;
+
+            bool is_free = false;
+        };
+
+    private:
+        uint32_t create_block(uint64_t offset, uint64_t size);
+        void release_block(uint32_t index);
+
+        void insert_free_block(uint32_t index);
+        void remove_free_block(uint32_t index);
+        uint32_t find_free_block(uint64_t size) const;
+
+        uint32_t split_block(uint32_t index, uint64_t size);
+        void merge_with_next(uint32_t index);
+
+    private:
+        uint64_t m_size = 0;
+        uint64_t m_used_size = 0;
+        size_t m_allocation_count = 0;
+
+        nstl::vector<block> m_blocks;
+        uint32_t m_first_unused_block = invalid_index; // unused nodes are chained through next_free
+
+        uint64_t m_fl_bitmap = 0;
+        uint32_t m_sl_bitmaps[fl_count] = {};
+        uint32_t m_free_lists[fl_count][sl_count];
+    };
+}
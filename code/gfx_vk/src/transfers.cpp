@@ -2,23 +2,105 @@
 
 #include "context.h"
 
+#include "logging/logging.h"
+
 namespace
 {
-    static constexpr size_t STAGING_BUFFER_SIZE = 64 * 1024 * 1024;
+    struct texel_block
+    {
+        size_t width = 1;
+        size_t height = 1;
+        size_t size = 0;
+    };
+
+    texel_block get_texel_block(gfx::image_format format)
+    {
+        switch (format)
+        {
+        case gfx::image_format::r8g8b8a8:
+        case gfx::image_format::b8g8r8a8_srgb:
+        case gfx::image_format::d32_float:
+            return { 1, 1, 4 };
+        case gfx::image_format::r8g8b8:
+            return { 1, 1, 3 };
+        case gfx::image_format::bc1_unorm:
+            return { 4, 4, 8 };
+        case gfx::image_format::bc3_unorm:
+        case gfx::image_format::bc5_unorm:
+            return { 4, 4, 16 };
+        }
+
+        assert(false);
+        return {};
+    }
+
+    // vkCmdCopyBufferToImage requires the buffer offset to be a multiple of both 4 and the texel block size
+    size_t get_image_copy_alignment(texel_block const& block)
+    {
+        size_t alignment = block.size;
+        while (alignment % 4 != 0)
+            alignment += block.size;
+        return alignment;
+    }
+
+    void record_image_barrier(VkCommandBuffer command_buffer, VkImage image, VkImageLayout old_layout, VkImageLayout new_layout, VkAccessFlags src_access, VkAccessFlags dst_access, VkPipelineStageFlags src_stage, VkPipelineStageFlags dst_stage)
+    {
+        VkImageMemoryBarrier barrier{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = src_access,
+            .dstAccessMask = dst_access,
+            .oldLayout = old_layout,
+            .newLayout = new_layout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = image,
+            .subresourceRange = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+        };
+
+        vkCmdPipelineBarrier(
+            command_buffer,
+            src_stage, dst_stage,
+            0,
+            0, nullptr,
+            0, nullptr,
+            1, &barrier
+        );
+    }
 }
 
-struct gfx_vk::transfers::transfer_storage
+struct gfx_vk::transfers::batch
 {
+    enum class status
+    {
+        idle,
+        recording,
+        in_flight,
+    };
+
+    command_pool pool;
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+    unique_handle<VkFence> fence;
 
+    status state = status::idle;
+    uint64_t ticket = 0;
 };
 
-gfx_vk::transfers::transfers(context& context)
+gfx_vk::transfers::transfers(context& context, transfers_config const& config)
     : m_context(context)
-    , m_command_pool(m_context, m_context.get_instance().get_transfer_queue_family_index())
+    , m_config(config)
+    , m_ring(config.staging_buffer_size)
 {
+    assert(m_config.max_chunk_size > 0 && m_config.max_chunk_size <= m_config.staging_buffer_size);
+
     VkBufferCreateInfo info{
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .size = STAGING_BUFFER_SIZE,
+        .size = m_config.staging_buffer_size,
         .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
         .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
     };
@@ -28,17 +110,27 @@ gfx_vk::transfers::transfers(context& context)
     VkMemoryRequirements requirements;
     vkGetBufferMemoryRequirements(m_context.get_device_handle(), m_buffer, &requirements);
 
-    m_memory = m_context.get_memory().allocate(requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    m_memory = m_context.get_memory().allocate(requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memory_tiling::linear);
 
     allocation_data const* data = m_context.get_memory().get_data(m_memory);
     assert(data);
+    assert(data->ptr);
     GFX_VK_VERIFY(vkBindBufferMemory(m_context.get_device_handle(), m_buffer, data->handle, data->offset));
 
-    m_command_buffer = m_command_pool.allocate();
+    m_mapped_ptr = static_cast<unsigned char*>(data->ptr);
 }
 
 gfx_vk::transfers::~transfers()
 {
+    flush();
+
+    for (batch& b : m_batches)
+    {
+        wait_for_batch(b);
+        vkDestroyFence(m_context.get_device_handle(), b.fence, &m_context.get_allocator());
+        b.fence = nullptr;
+    }
+
     if (m_buffer)
     {
         vkDestroyBuffer(m_context.get_device_handle(), m_buffer, &m_context.get_allocator());
@@ -48,51 +140,316 @@ gfx_vk::transfers::~transfers()
     m_context.get_memory().free(m_memory);
 }
 
-gfx_vk::transfer_data gfx_vk::transfers::begin_transfer(gfx::data_reader& reader)
+gfx::upload_ticket gfx_vk::transfers::upload_buffer(VkBuffer buffer, VkDeviceSize offset, gfx::data_reader& reader)
 {
-    size_t index = m_transfers.size();
+    size_t size = reader.get_size();
+    bool is_chunked = size > m_config.max_chunk_size;
 
-    assert(reader.get_size() <= STAGING_BUFFER_SIZE);
+    gfx::upload_ticket ticket;
 
-    allocation_data const* data = m_context.get_memory().get_data(m_memory);
-    assert(data);
-    assert(data->ptr);
+    size_t copied_size = 0;
+    while (copied_size < size)
+    {
+        size_t chunk_size = nstl::min(size - copied_size, m_config.max_chunk_size);
 
-    if (!reader.read(data->ptr, reader.get_size()))
-        assert(false);
+        VkDeviceSize staging_offset = allocate_staging(chunk_size, 1);
+        if (!reader.read(m_mapped_ptr + staging_offset, chunk_size))
+            assert(false);
 
-    VkCommandPoolResetFlags flags = 0;
-    GFX_VK_VERIFY(vkResetCommandPool(m_context.get_device_handle(), m_command_pool.get_handle(), flags));
+        VkCommandBuffer command_buffer = get_command_buffer();
 
-    VkCommandBufferBeginInfo info{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-    };
-    GFX_VK_VERIFY(vkBeginCommandBuffer(m_command_buffer, &info));
+        VkBufferCopy region{
+            .srcOffset = staging_offset,
+            .dstOffset = offset + copied_size,
+            .size = chunk_size,
+        };
+        vkCmdCopyBuffer(command_buffer, m_buffer, buffer, 1, &region);
 
-    m_transfers.push_back({
+        ticket = { m_batches[*m_open_batch_index].ticket };
+        copied_size += chunk_size;
 
-    });
+        // Submit the chunks one by one so that the GPU copies them while the next ones are being read
+        if (is_chunked)
+            flush();
+    }
 
-    return { index, m_buffer, 0, m_command_buffer };
+    return ticket;
 }
 
-void gfx_vk::transfers::submit_and_wait([[maybe_unused]] size_t index)
+gfx::upload_ticket gfx_vk::transfers::upload_image(VkImage image, gfx::image_params const& params, gfx::data_reader& reader)
 {
-    assert(m_transfers.size() == 1);
-    assert(index == 0);
+    assert(params.width <= UINT32_MAX);
+    assert(params.height <= UINT32_MAX);
+
+    texel_block block = get_texel_block(params.format);
+    size_t alignment = get_image_copy_alignment(block);
+
+    size_t row_count = (params.height + block.height - 1) / block.height; // rows of texel blocks
+    size_t blocks_per_row = (params.width + block.width - 1) / block.width;
+    size_t row_size = blocks_per_row * block.size;
+
+    // Every copy reads whole texel blocks from the staging buffer, so the data has to cover the whole image
+    size_t size = reader.get_size();
+    if (size != row_count * row_size)
+    {
+        logging::error("Image upload of {} bytes doesn't match the image size of {} bytes", size, row_count * row_size);
+        return {};
+    }
+
+    // Rows which don't fit into a chunk are split into runs of texel blocks
+    size_t rows_per_chunk = m_config.max_chunk_size / row_size;
+    size_t blocks_per_chunk = rows_per_chunk > 0 ? blocks_per_row : m_config.max_chunk_size / block.size;
+    if (blocks_per_chunk == 0)
+    {
+        logging::error("Image upload: a texel block of {} bytes doesn't fit into a chunk of {} bytes", block.size, m_config.max_chunk_size);
+        return {};
+    }
+
+    bool is_chunked = size > m_config.max_chunk_size;
+
+    record_image_barrier(get_command_buffer(), image,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        0, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    size_t copied_size = 0;
+    size_t copied_rows = 0;
+    size_t copied_row_blocks = 0; // of the current row if the rows are split
+    while (copied_rows < row_count)
+    {
+        size_t chunk_rows = 1;
+        size_t chunk_blocks = blocks_per_row;
+        if (rows_per_chunk > 0)
+            chunk_rows = nstl::min(row_count - copied_rows, rows_per_chunk);
+        else
+            chunk_blocks = nstl::min(blocks_per_row - copied_row_blocks, blocks_per_chunk);
+
+        size_t chunk_size = nstl::min(chunk_rows * chunk_blocks * block.size, size - copied_size);
 
-    GFX_VK_VERIFY(vkEndCommandBuffer(m_command_buffer));
+        VkDeviceSize staging_offset = allocate_staging(chunk_size, alignment);
+        if (!reader.read(m_mapped_ptr + staging_offset, chunk_size))
+            assert(false);
+
+        size_t first_texel_row = copied_rows * block.height;
+        size_t texel_rows = nstl::min(chunk_rows * block.height, params.height - first_texel_row);
+
+        size_t first_texel_column = copied_row_blocks * block.width;
+        size_t texel_columns = nstl::min(chunk_blocks * block.width, params.width - first_texel_column);
+
+        VkBufferImageCopy region{
+            .bufferOffset = staging_offset,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = 0,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+
+            .imageOffset = { static_cast<int32_t>(first_texel_column), static_cast<int32_t>(first_texel_row), 0 },
+            .imageExtent = {
+                static_cast<uint32_t>(texel_columns),
+                static_cast<uint32_t>(texel_rows),
+                1
+            },
+        };
+
+        vkCmdCopyBufferToImage(get_command_buffer(), m_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        copied_size += chunk_size;
+        copied_row_blocks += chunk_blocks;
+        if (copied_row_blocks == blocks_per_row)
+        {
+            copied_rows += chunk_rows;
+            copied_row_blocks = 0;
+        }
+
+        // The layout transitions are preserved across submissions to the same queue
+        if (is_chunked && copied_rows < row_count)
+            flush();
+    }
+
+    VkCommandBuffer command_buffer = get_command_buffer();
+
+    record_image_barrier(command_buffer, image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    return { m_batches[*m_open_batch_index].ticket };
+}
+
+bool gfx_vk::transfers::is_complete(gfx::upload_ticket ticket)
+{
+    if (!ticket)
+        return true;
+
+    assert(ticket.value < m_next_ticket);
+
+    poll_batches();
+
+    for (batch const& b : m_batches)
+        if (b.state != batch::status::idle && b.ticket <= ticket.value)
+            return false;
+
+    return true;
+}
+
+void gfx_vk::transfers::wait(gfx::upload_ticket ticket)
+{
+    if (!ticket)
+        return;
+
+    assert(ticket.value < m_next_ticket);
+
+    if (m_open_batch_index && m_batches[*m_open_batch_index].ticket <= ticket.value)
+        flush();
+
+    for (batch& b : m_batches)
+        if (b.state == batch::status::in_flight && b.ticket <= ticket.value)
+            wait_for_batch(b);
+
+    retire();
+}
+
+void gfx_vk::transfers::flush()
+{
+    if (!m_open_batch_index)
+        return;
+
+    batch& b = m_batches[*m_open_batch_index];
+    assert(b.state == batch::status::recording);
+
+    GFX_VK_VERIFY(vkEndCommandBuffer(b.command_buffer));
+    GFX_VK_VERIFY(vkResetFences(m_context.get_device_handle(), 1, &b.fence.get()));
 
     VkSubmitInfo info{
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
         .commandBufferCount = 1,
-        .pCommandBuffers = &m_command_buffer,
+        .pCommandBuffers = &b.command_buffer,
+    };
+
+    GFX_VK_VERIFY(vkQueueSubmit(m_context.get_instance().get_transfer_queue_handle(), 1, &info, b.fence));
+
+    b.state = batch::status::in_flight;
+    m_ring.close_batch(b.ticket);
+    m_open_batch_index = {};
+}
+
+void gfx_vk::transfers::retire()
+{
+    poll_batches();
+
+    // The ring is released in order, so it can only go up to the oldest unfinished batch
+    uint64_t completed_ticket = m_next_ticket - 1;
+    for (batch const& b : m_batches)
+        if (b.state != batch::status::idle && b.ticket <= completed_ticket)
+            completed_ticket = b.ticket - 1;
+
+    m_ring.retire(completed_ticket);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+VkCommandBuffer gfx_vk::transfers::get_command_buffer()
+{
+    if (m_open_batch_index)
+        return m_batches[*m_open_batch_index].command_buffer;
+
+    poll_batches();
+
+    nstl::optional<size_t> index;
+    for (size_t i = 0; i < m_batches.size(); i++)
+    {
+        if (m_batches[i].state == batch::status::idle)
+        {
+            index = i;
+            break;
+        }
+    }
+
+    if (!index)
+    {
+        command_pool pool{ m_context, m_context.get_instance().get_transfer_queue_family_index() };
+        VkCommandBuffer command_buffer = pool.allocate();
+
+        VkFenceCreateInfo fence_info{
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .flags = VK_FENCE_CREATE_SIGNALED_BIT,
+        };
+        VkFence fence = VK_NULL_HANDLE;
+        GFX_VK_VERIFY(vkCreateFence(m_context.get_device_handle(), &fence_info, &m_context.get_allocator(), &fence));
+
+        m_batches.push_back({
+            .pool = nstl::move(pool),
+            .command_buffer = command_buffer,
+            .fence = fence,
+        });
+
+        index = m_batches.size() - 1;
+
+        m_context.get_instance().set_debug_name(m_batches.back().command_buffer, "Transfer command buffer {}", *index);
+        m_context.get_instance().set_debug_name(m_batches.back().fence.get(), "Transfer fence {}", *index);
+    }
+
+    batch& b = m_batches[*index];
+
+    VkCommandPoolResetFlags flags = 0;
+    GFX_VK_VERIFY(vkResetCommandPool(m_context.get_device_handle(), b.pool.get_handle(), flags));
+
+    VkCommandBufferBeginInfo info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
     };
+    GFX_VK_VERIFY(vkBeginCommandBuffer(b.command_buffer, &info));
 
-    GFX_VK_VERIFY(vkQueueSubmit(m_context.get_instance().get_transfer_queue_handle(), 1, &info, VK_NULL_HANDLE));
+    b.state = batch::status::recording;
+    b.ticket = m_next_ticket++;
+    m_open_batch_index = index;
 
-    m_context.get_instance().wait_idle();
+    return b.command_buffer;
+}
 
-    m_transfers.pop_back();
+VkDeviceSize gfx_vk::transfers::allocate_staging(size_t size, size_t alignment)
+{
+    assert(size <= m_ring.get_size());
+
+    while (true)
+    {
+        if (nstl::optional<size_t> offset = m_ring.allocate(size, alignment))
+            return *offset;
+
+        // Not enough staging memory: submit what's been recorded and wait for the oldest batch
+        flush();
+
+        batch* oldest = nullptr;
+        for (batch& b : m_batches)
+            if (b.state == batch::status::in_flight && (!oldest || b.ticket < oldest->ticket))
+                oldest = &b;
+
+        assert(oldest);
+        if (!oldest)
+            return 0;
+
+        wait_for_batch(*oldest);
+        retire();
+    }
+}
+
+void gfx_vk::transfers::wait_for_batch(batch& b)
+{
+    if (b.state != batch::status::in_flight)
+        return;
+
+    GFX_VK_VERIFY(vkWaitForFences(m_context.get_device_handle(), 1, &b.fence.get(), VK_TRUE, UINT64_MAX));
+    b.state = batch::status::idle;
+}
+
+void gfx_vk::transfers::poll_batches()
+{
+    for (batch& b : m_batches)
+        if (b.state == batch::status::in_flight && vkGetFenceStatus(m_context.get_device_handle(), b.fence) == VK_SUCCESS)
+            b.state = batch::status::idle;
 }
@@ -3,9 +3,12 @@
 #include "command_pool.h"
 #include "memory.h"
 
+#include "gfx_vk/config.h"
+
 #include "gfx/resources.h"
+#include "gfx/staging_ring.h"
 
-#include "nstl/blob_view.h"
+#include "nstl/optional.h"
 #include "nstl/vector.h"
 
 #include <vulkan/vulkan.h>
@@ -14,35 +17,45 @@ namespace gfx_vk
 {
     class context;
 
-    struct transfer_data
-    {
-        size_t index = 0;
-
-        VkBuffer buffer = VK_NULL_HANDLE;
-        VkDeviceSize buffer_offset = 0;
-
-        VkCommandBuffer command_buffer = VK_NULL_HANDLE;
-    };
-
+    // Uploads go through a ring-buffered staging buffer. Copies are recorded into the current batch,
+    // which is submitted on flush() (or when the staging memory runs out) with its own fence.
+    // Staging memory of a batch is reclaimed once its fence is signaled
     class transfers
     {
     public:
-        transfers(context& context);
+        transfers(context& context, transfers_config const& config);
         ~transfers();
 
-        transfer_data begin_transfer(gfx::data_reader& reader);
-        void submit_and_wait(size_t index);
+        [[nodiscard]] gfx::upload_ticket upload_buffer(VkBuffer buffer, VkDeviceSize offset, gfx::data_reader& reader);
+        [[nodiscard]] gfx::upload_ticket upload_image(VkImage image, gfx::image_params const& params, gfx::data_reader& reader);
+
+        [[nodiscard]] bool is_complete(gfx::upload_ticket ticket);
+        void wait(gfx::upload_ticket ticket);
+
+        void flush();
+        void retire();
+
+    private:
+        struct batch;
+
+    private:
+        VkCommandBuffer get_command_buffer();
+        VkDeviceSize allocate_staging(size_t size, size_t alignment);
+        void wait_for_batch(batch& b);
+        void poll_batches();
 
     private:
         context& m_context;
+        transfers_config m_config;
+
+        gfx::staging_ring m_ring;
 
         unique_handle<VkBuffer> m_buffer;
         allocation_handle m_memory;
+        unsigned char* m_mapped_ptr = nullptr;
 
-        command_pool m_command_pool;
-        VkCommandBuffer m_command_buffer = VK_NULL_HANDLE;
-
-        struct transfer_storage;
-        nstl::vector<transfer_storage> m_transfers;
+        nstl::vector<batch> m_batches;
+        nstl::optional<size_t> m_open_batch_index;
+        uint64_t m_next_ticket = 1;
     };
 }
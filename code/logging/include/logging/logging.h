@@ -7,6 +7,7 @@
 
 #include "nstl/string_view.h"
 #include "nstl/source_location.h"
+#include "nstl/unique_ptr.h"
 
 namespace logging
 {
@@ -15,6 +16,7 @@ namespace logging
     public:
         virtual ~sink() = default;
         virtual void log(nstl::string_view str) = 0;
+        virtual void flush() {}
     };
 }
 
@@ -34,44 +36,103 @@ namespace logging
     };
     TINY_CTTI_DESCRIBE_ENUM(level, info, warn, error);
 
-    struct format_with_location
+    // Messages only store a pointer to the category, so it should have a static storage duration
+    struct category
     {
-        format_with_location(nstl::string_view format, nstl::source_location location = {}) : format(format), location(location) {}
-        format_with_location(char const* format, nstl::source_location location = {}) : format_with_location(nstl::string_view{format}, location) {}
+        nstl::string_view name;
+        level min_level = level::info;
+    };
+
+    struct config
+    {
+        size_t queue_size = 1024; // Has to be a power of two
+        level min_level = level::info;
+        nstl::string_view crash_output_path; // Where flush_on_crash() writes the queued messages, stderr if empty
+    };
+
+    // Starts the background thread that writes the messages to the sinks.
+    // Before init() and after shutdown() the messages are written on the calling thread
+    void init(config const& config = {});
+    void shutdown();
+
+    // Messages go to the platform debug output until the first sink is added
+    void add_sink(nstl::unique_ptr<sink> sink, level min_level = level::info);
+    void set_min_level(level level);
+    bool is_enabled(level level, category const* category = nullptr);
+
+    // Blocks until all the queued messages are written
+    void flush();
 
-        nstl::string_view format;
+    // Version of flush() for crash handlers: async-signal-safe, doesn't allocate or lock, and doesn't use the sinks.
+    // The queued messages are written to the crash output instead, see config::crash_output_path
+    void flush_on_crash();
+
+    template<typename... Ts>
+    struct basic_format_with_location
+    {
+        template<size_t N>
+        consteval basic_format_with_location(char const (&format)[N], nstl::source_location location = {}) : format(format), location(location) {}
+        basic_format_with_location(picofmt::runtime_format_string format, nstl::source_location location = {}) : format(format), location(location) {}
+
+        picofmt::basic_format_string<Ts...> format;
         nstl::source_location location;
     };
 
+    template<typename... Ts>
+    using format_with_location = basic_format_with_location<picofmt::type_identity_t<Ts>...>;
+
     void log(level level, nstl::string_view str, nstl::source_location loc = {});
+    void log(level level, category const& category, nstl::string_view str, nstl::source_location loc = {});
 
-    void vlogf(level level, nstl::string_view format, picofmt::args_list const& args, nstl::source_location loc = {});
+    void vlogf(level level, picofmt::format_string_view format, picofmt::args_list const& args, nstl::source_location loc = {});
+    void vlogf(level level, category const& category, picofmt::format_string_view format, picofmt::args_list const& args, nstl::source_location loc = {});
 
     template<picofmt::formattable... Ts>
-    void logf(level level, nstl::string_view format, Ts const&... args)
+    void logf(level level, picofmt::format_string<Ts...> format, Ts const&... args)
     {
         MEMORY_TRACKING_SCOPE(get_scope_id());
         return vlogf(level, format, { args... });
     }
 
     template<picofmt::formattable... Ts>
-    void info(format_with_location format_location, Ts const&... args)
+    void info(format_with_location<Ts...> format_location, Ts const&... args)
     {
         MEMORY_TRACKING_SCOPE(get_scope_id());
         return vlogf(level::info, format_location.format, { args... }, format_location.location);
     }
 
     template<picofmt::formattable... Ts>
-    void warn(format_with_location format_location, Ts const&... args)
+    void warn(format_with_location<Ts...> format_location, Ts const&... args)
     {
         MEMORY_TRACKING_SCOPE(get_scope_id());
         return vlogf(level::warn, format_location.format, { args... }, format_location.location);
     }
 
     template<picofmt::formattable... Ts>
-    void error(format_with_location format_location, Ts const&... args)
+    void error(format_with_location<Ts...> format_location, Ts const&... args)
     {
         MEMORY_TRACKING_SCOPE(get_scope_id());
         return vlogf(level::error, format_location.format, { args... }, format_location.location);
     }
+
+    template<picofmt::formattable... Ts>
+    void info(category const& category, format_with_location<Ts...> format_location, Ts const&... args)
+    {
+        MEMORY_TRACKING_SCOPE(get_scope_id());
+        return vlogf(level::info, category, format_location.format, { args... }, format_location.location);
+    }
+
+    template<picofmt::formattable... Ts>
+    void warn(category const& category, format_with_location<Ts...> format_location, Ts const&... args)
+    {
+        MEMORY_TRACKING_SCOPE(get_scope_id());
+        return vlogf(level::warn, category, format_location.format, { args... }, format_location.location);
+    }
+
+    template<picofmt::formattable... Ts>
+    void error(category const& category, format_with_location<Ts...> format_location, Ts const&... args)
+    {
+        MEMORY_TRACKING_SCOPE(get_scope_id());
+        return vlogf(level::error, category, format_location.format, { args... }, format_location.location);
+    }
 }
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "logging/logging.h"
+
+#include "fs/file.h"
+
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+
+namespace logging
+{
+    class debug_output_sink final : public sink
+    {
+    public:
+        void log(nstl::string_view str) override;
+    };
+
+    class stdout_sink final : public sink
+    {
+    public:
+        void log(nstl::string_view str) override;
+        void flush() override;
+    };
+
+    class file_sink final : public sink
+    {
+    public:
+        file_sink(nstl::string_view path);
+
+        void log(nstl::string_view str) override;
+        void flush() override;
+
+    private:
+        fs::file m_file;
+        size_t m_offset = 0;
+        nstl::string m_buffer;
+    };
+
+    // Writes to <base_path>.0.log, <base_path>.1.log, ... switching to the next file once the current one
+    // is larger than `max_file_size`. After `max_file_count` files the oldest one is overwritten
+    class rotating_file_sink final : public sink
+    {
+    public:
+        rotating_file_sink(nstl::string_view base_path, size_t max_file_size, size_t max_file_count);
+
+        void log(nstl::string_view str) override;
+        void flush() override;
+
+    private:
+        void open_next_file();
+
+        nstl::string m_base_path;
+        size_t m_max_file_size = 0;
+        size_t m_max_file_count = 0;
+        size_t m_file_index = 0;
+
+        fs::file m_file;
+        size_t m_offset = 0;
+        nstl::string m_buffer;
+    };
+}
@@ -1,25 +1,568 @@
 #include "logging/logging.h"
 
+#include "mt/atomic.h"
+#include "mt/lock_guard.h"
+#include "mt/mutex.h"
+#include "mt/semaphore.h"
+#include "mt/thread.h"
+
 #include "platform/debug.h"
+#include "platform/threading.h"
 
-#include "nstl/vector.h"
+#include "nstl/string.h"
 #include "nstl/unique_ptr.h"
+#include "nstl/vector.h"
+
+#include <assert.h>
+#include <string.h>
+
+namespace
+{
+    constexpr size_t inline_text_capacity = 256;
+
+    // Slot of the message queue. The sequence tells whether the slot is free for the producer
+    // at the matching position or holds a message for the consumer
+    struct record
+    {
+        uint64_t volatile sequence = 0;
+
+        logging::level level = logging::level::info;
+        logging::category const* category = nullptr;
+        nstl::source_location location;
+
+        size_t length = 0;
+        char* overflow_text = nullptr; // Heap-allocated copy of the messages that don't fit inline
+        char text[inline_text_capacity];
+    };
+
+    struct sink_entry
+    {
+        nstl::unique_ptr<logging::sink> sink;
+        logging::level min_level = logging::level::info;
+    };
+
+    struct logger_state
+    {
+        ~logger_state();
+
+        mt::mutex mutex; // Guards the sinks and the consumer side of the queue
+        nstl::vector<sink_entry> sinks;
+        nstl::string line;
+
+        // Bounded multi-producer queue based on Dmitry Vyukov's MPMC queue.
+        // The consumer claims the records with a compare-exchange, so that flush_on_crash() can take over the queue
+        nstl::vector<record> records;
+        uint64_t volatile enqueue_position = 0;
+        uint64_t volatile dequeue_position = 0;
+        uint64_t volatile crashed = 0;
+
+        uint64_t volatile running = 0;
+        nstl::unique_ptr<mt::thread> thread;
+
+        // Messages logged from the sinks which couldn't be queued, reported after the messages being written
+        uint64_t volatile dropped_count = 0;
+
+        // The background thread sleeps on the semaphore while the queue is empty
+        mt::semaphore wake_semaphore;
+        uint64_t volatile is_consumer_sleeping = 0;
+
+        logging::level volatile min_level = logging::level::info;
+    };
+
+    // Set while the thread holds the mutex and writes to the sinks, so the messages logged by the sinks can be detected
+    thread_local bool is_writing_thread = false;
+
+    class writer_lock
+    {
+    public:
+        writer_lock(logger_state& logger) : m_lock(logger.mutex)
+        {
+            is_writing_thread = true;
+        }
+
+        ~writer_lock()
+        {
+            is_writing_thread = false;
+        }
+
+    private:
+        mt::lock_guard m_lock;
+    };
+
+    logger_state& get_logger_state()
+    {
+        // The memory tracking checks for leaks when it's destroyed, so it has to be initialized before the state
+        [[maybe_unused]] static auto const scope_id = logging::get_scope_id();
+
+        static logger_state state;
+        return state;
+    }
+
+    void write_message(logger_state& logger, logging::level level, logging::category const* category, nstl::source_location const& location, nstl::string_view text)
+    {
+        logger.line.resize(0);
+
+        if (category && !category->name.empty())
+            common::format_to(logger.line, "{}({},{}): [{:!}] [{}] {}\n", location.file_name(), location.line(), location.column(), level, category->name, text);
+        else
+            common::format_to(logger.line, "{}({},{}): [{:!}] {}\n", location.file_name(), location.line(), location.column(), level, text);
+
+        if (logger.sinks.empty())
+        {
+            platform::debug_output(logger.line);
+            return;
+        }
+
+        for (sink_entry const& entry : logger.sinks)
+            if (level >= entry.min_level)
+                entry.sink->log(logger.line);
+    }
+
+    void write_dropped_count(logger_state& logger)
+    {
+        uint64_t dropped_count = mt::atomic_exchange(logger.dropped_count, 0);
+        if (dropped_count == 0)
+            return;
+
+        nstl::string text;
+        common::format_to(text, "{} messages logged from the sinks were dropped", dropped_count);
+        write_message(logger, logging::level::warn, nullptr, {}, text);
+    }
+
+    void flush_sinks(logger_state& logger)
+    {
+        for (sink_entry const& entry : logger.sinks)
+            entry.sink->flush();
+    }
+
+    bool try_push(logger_state& logger, logging::level level, logging::category const* category, nstl::source_location const& location, nstl::string_view text)
+    {
+        uint64_t size = logger.records.size();
+        uint64_t position = mt::atomic_load_relaxed(logger.enqueue_position);
+
+        record* slot = nullptr;
+        while (true)
+        {
+            slot = &logger.records[position & (size - 1)];
+            uint64_t sequence = mt::atomic_load_acquire(slot->sequence);
 
-#include "stdio.h"
+            if (sequence == position)
+            {
+                // On failure the position is updated to the current one
+                if (mt::atomic_compare_exchange(logger.enqueue_position, position, position + 1))
+                    break;
+            }
+            else if (sequence < position)
+            {
+                // The slot still holds the message from the previous lap, so the queue is full
+                return false;
+            }
+            else
+            {
+                position = mt::atomic_load_relaxed(logger.enqueue_position);
+            }
+        }
+
+        slot->level = level;
+        slot->category = category;
+        slot->location = location;
+        slot->length = text.size();
+        slot->overflow_text = nullptr;
+
+        char* destination = slot->text;
+        if (text.size() > inline_text_capacity)
+        {
+            slot->overflow_text = new char[text.size()];
+            destination = slot->overflow_text;
+        }
+        memcpy(destination, text.data(), text.size());
+
+        mt::atomic_store_release(slot->sequence, position + 1);
+
+        // Pairs with the fence in wait_for_messages(): either the consumer sees the message or it's woken up here
+        mt::atomic_thread_fence();
+        if (mt::atomic_load_relaxed(logger.is_consumer_sleeping))
+            logger.wake_semaphore.release();
+
+        return true;
+    }
+
+    // Returns the next record if it's ready, or nullptr if the queue is empty
+    record* peek(logger_state& logger, uint64_t position)
+    {
+        record& slot = logger.records[position & (logger.records.size() - 1)];
+        if (mt::atomic_load_acquire(slot.sequence) != position + 1)
+            return nullptr;
+
+        return &slot;
+    }
+
+    // Has to be called with the mutex locked. Returns true if any message was written
+    bool drain(logger_state& logger)
+    {
+        if (logger.records.empty())
+            return false;
+
+        uint64_t size = logger.records.size();
+        bool written = false;
+
+        // After a crash the records belong to flush_on_crash()
+        while (!mt::atomic_load_relaxed(logger.crashed))
+        {
+            uint64_t position = mt::atomic_load_relaxed(logger.dequeue_position);
+
+            record* slot = peek(logger, position);
+            if (!slot)
+                break;
+
+            if (!mt::atomic_compare_exchange(logger.dequeue_position, position, position + 1))
+                break;
+
+            char const* text = slot->overflow_text ? slot->overflow_text : slot->text;
+            write_message(logger, slot->level, slot->category, slot->location, { text, slot->length });
+
+            delete[] slot->overflow_text;
+            slot->overflow_text = nullptr;
+
+            mt::atomic_store_release(slot->sequence, position + size);
+
+            written = true;
+        }
+
+        if (mt::atomic_load_relaxed(logger.dropped_count) != 0 && !mt::atomic_load_relaxed(logger.crashed))
+        {
+            write_dropped_count(logger);
+            written = true;
+        }
+
+        return written;
+    }
+
+    // Formats the message without allocations, the crash handler can only use the stack
+    class crash_line
+    {
+    public:
+        void append(char const* str, size_t length)
+        {
+            size_t count = length < capacity - m_size ? length : capacity - m_size;
+            memcpy(m_data + m_size, str, count);
+            m_size += count;
+        }
+
+        void append(char const* str)
+        {
+            append(str, strlen(str));
+        }
+
+        void append(int value)
+        {
+            char digits[16];
+            size_t count = 0;
+
+            unsigned int magnitude = value < 0 ? 0u - static_cast<unsigned int>(value) : static_cast<unsigned int>(value);
+            do
+            {
+                digits[count++] = static_cast<char>('0' + magnitude % 10);
+                magnitude /= 10;
+            } while (magnitude > 0);
+
+            if (value < 0)
+                append("-", 1);
+            while (count > 0)
+                append(&digits[--count], 1);
+        }
+
+        void write()
+        {
+            platform::write_crash_output(m_data, m_size);
+            m_size = 0;
+        }
+
+    private:
+        inline static constexpr size_t capacity = 512;
+
+        char m_data[capacity];
+        size_t m_size = 0;
+    };
+
+    char const* get_crash_level_name(logging::level level)
+    {
+        switch (level)
+        {
+        case logging::level::info:
+            return "INFO";
+        case logging::level::warn:
+            return "WARN";
+        case logging::level::error:
+            return "ERROR";
+        }
+
+        return "?";
+    }
+
+    // Same layout as write_message()
+    void write_crash_message(record const& slot)
+    {
+        crash_line line;
+
+        line.append(slot.location.file_name());
+        line.append("(");
+        line.append(slot.location.line());
+        line.append(",");
+        line.append(slot.location.column());
+        line.append("): [");
+        line.append(get_crash_level_name(slot.level));
+        line.append("] ");
+
+        if (slot.category && !slot.category->name.empty())
+        {
+            line.append("[");
+            line.append(slot.category->name.data(), slot.category->name.size());
+            line.append("] ");
+        }
+
+        line.write();
+
+        platform::write_crash_output(slot.overflow_text ? slot.overflow_text : slot.text, slot.length);
+        platform::write_crash_output("\n", 1);
+    }
+
+    void submit(logging::level level, logging::category const* category, nstl::source_location const& location, nstl::string_view text)
+    {
+        logger_state& logger = get_logger_state();
+
+        // A sink logs while this thread is writing to the sinks. Writing the message here would reenter the sinks,
+        // and only this thread could free the space in the queue, so a message which can't be queued is counted instead
+        if (is_writing_thread)
+        {
+            if (!mt::atomic_load_relaxed(logger.running) || !try_push(logger, level, category, location, text))
+                mt::atomic_fetch_add(logger.dropped_count, 1);
+            return;
+        }
+
+        bool queued = false;
+        if (mt::atomic_load_relaxed(logger.running))
+        {
+            while (!try_push(logger, level, category, location, text))
+                platform::sleep(0);
+
+            if (mt::atomic_load_relaxed(logger.running))
+                return;
+
+            // shutdown() might have drained the queue before the message was pushed
+            queued = true;
+        }
+
+        writer_lock lock{ logger };
+
+        drain(logger);
+        if (!queued)
+        {
+            write_message(logger, level, category, location, text);
+            write_dropped_count(logger);
+        }
+        flush_sinks(logger);
+    }
+
+    void format_and_submit(logging::level level, logging::category const* category, picofmt::format_string_view format, picofmt::args_list const& args, nstl::source_location const& location)
+    {
+        // Reused between the messages, so formatting doesn't allocate once the buffer is large enough
+        thread_local nstl::string message;
+
+        message.resize(0);
+        common::vformat_to(message, format, args);
+
+        submit(level, category, location, message);
+    }
+
+    void wait_for_messages(logger_state& logger)
+    {
+        mt::atomic_store_relaxed(logger.is_consumer_sleeping, 1);
+        mt::atomic_thread_fence();
+
+        // A message might have been pushed before the producer could see that the consumer is sleeping
+        if (mt::atomic_load_relaxed(logger.running) && !peek(logger, mt::atomic_load_relaxed(logger.dequeue_position)))
+            logger.wake_semaphore.acquire();
+
+        mt::atomic_store_relaxed(logger.is_consumer_sleeping, 0);
+    }
+
+    void consume(logger_state& logger)
+    {
+        MEMORY_TRACKING_SCOPE(logging::get_scope_id());
+
+        while (mt::atomic_load_relaxed(logger.running))
+        {
+            bool written = false;
+
+            {
+                writer_lock lock{ logger };
+
+                written = drain(logger);
+                if (written)
+                    flush_sinks(logger);
+            }
+
+            if (!written)
+                wait_for_messages(logger);
+        }
+    }
+
+    void stop(logger_state& logger)
+    {
+        if (!mt::atomic_load_relaxed(logger.running))
+            return;
+
+        mt::atomic_store_release(logger.running, 0);
+        logger.wake_semaphore.release();
+        logger.thread = nullptr;
+
+        writer_lock lock{ logger };
+
+        drain(logger);
+        flush_sinks(logger);
+    }
+
+    logger_state::~logger_state()
+    {
+        stop(*this);
+    }
+}
 
 namespace logging
 {
+    void init(config const& config)
+    {
+        MEMORY_TRACKING_SCOPE(get_scope_id());
+
+        logger_state& logger = get_logger_state();
+
+        assert(!mt::atomic_load_relaxed(logger.running));
+        assert(config.queue_size >= 2 && (config.queue_size & (config.queue_size - 1)) == 0);
+
+        {
+            writer_lock lock{ logger };
+
+            logger.min_level = config.min_level;
+
+            drain(logger);
+
+            logger.records.clear();
+            logger.records.resize(config.queue_size);
+            for (size_t i = 0; i < logger.records.size(); i++)
+                logger.records[i].sequence = i;
+
+            logger.enqueue_position = 0;
+            logger.dequeue_position = 0;
+        }
+
+        if (!config.crash_output_path.empty())
+        {
+            [[maybe_unused]] bool opened = platform::open_crash_output(config.crash_output_path);
+            assert(opened);
+        }
+
+        mt::atomic_store_release(logger.running, 1);
+        logger.thread = nstl::make_unique<mt::thread>("Logging", [&logger]() { consume(logger); });
+
+        platform::set_crash_handler(&flush_on_crash);
+    }
+
+    void shutdown()
+    {
+        stop(get_logger_state());
+    }
+
+    void add_sink(nstl::unique_ptr<sink> sink, level min_level)
+    {
+        MEMORY_TRACKING_SCOPE(get_scope_id());
+
+        logger_state& logger = get_logger_state();
+
+        mt::lock_guard lock{ logger.mutex };
+        logger.sinks.push_back({ nstl::move(sink), min_level });
+    }
+
+    void set_min_level(level level)
+    {
+        get_logger_state().min_level = level;
+    }
+
+    bool is_enabled(level level, category const* category)
+    {
+        if (level < get_logger_state().min_level)
+            return false;
+
+        return !category || level >= category->min_level;
+    }
+
+    void flush()
+    {
+        logger_state& logger = get_logger_state();
+
+        writer_lock lock{ logger };
+
+        drain(logger);
+        flush_sinks(logger);
+    }
+
+    void flush_on_crash()
+    {
+        logger_state& logger = get_logger_state();
+
+        // Claims the queue, so the background thread stops writing messages and a nested crash doesn't write them again.
+        // The sinks and the mutex might be in use by the crashed thread, so only the crash output is used
+        if (mt::atomic_exchange(logger.crashed, 1) != 0)
+            return;
+
+        if (logger.records.empty())
+            return;
+
+        while (true)
+        {
+            uint64_t position = mt::atomic_load_relaxed(logger.dequeue_position);
+
+            record* slot = peek(logger, position);
+            if (!slot)
+                break;
+
+            // The background thread might have claimed the record right before the crash
+            if (!mt::atomic_compare_exchange(logger.dequeue_position, position, position + 1))
+                continue;
+
+            write_crash_message(*slot);
+        }
+    }
+
     void log(level level, nstl::string_view str, nstl::source_location loc)
     {
         MEMORY_TRACKING_SCOPE(get_scope_id());
 
-        nstl::string result = common::format("{}({},{}): [{:!}] {}\n", loc.file_name(), loc.line(), loc.column(), level, str);
-        platform::debug_output(result);
+        if (is_enabled(level))
+            submit(level, nullptr, loc, str);
     }
 
-    void vlogf(level level, nstl::string_view format, picofmt::args_list const& args, nstl::source_location loc)
+    void log(level level, category const& category, nstl::string_view str, nstl::source_location loc)
     {
         MEMORY_TRACKING_SCOPE(get_scope_id());
-        return log(level, common::vformat(format, args), loc);
+
+        if (is_enabled(level, &category))
+            submit(level, &category, loc, str);
+    }
+
+    void vlogf(level level, picofmt::format_string_view format, picofmt::args_list const& args, nstl::source_location loc)
+    {
+        MEMORY_TRACKING_SCOPE(get_scope_id());
+
+        if (is_enabled(level))
+            format_and_submit(level, nullptr, format, args, loc);
+    }
+
+    void vlogf(level level, category const& category, picofmt::format_string_view format, picofmt::args_list const& args, nstl::source_location loc)
+    {
+        MEMORY_TRACKING_SCOPE(get_scope_id());
+
+        if (is_enabled(level, &category))
+            format_and_submit(level, &category, format, args, loc);
     }
 }
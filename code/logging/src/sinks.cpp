@@ -0,0 +1,103 @@
+#include "logging/sinks.h"
+
+#include "common/fmt.h"
+
+#include "platform/debug.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+namespace
+{
+    // File writes are batched until this much text is accumulated or the sink is flushed
+    constexpr size_t file_buffer_size = 64 * 1024;
+
+    void write_buffer(fs::file& file, size_t& offset, nstl::string& buffer)
+    {
+        if (buffer.empty())
+            return;
+
+        if (file.is_open() && file.try_write(buffer.data(), buffer.size(), offset))
+            offset += buffer.size();
+
+        buffer.resize(0);
+    }
+}
+
+void logging::debug_output_sink::log(nstl::string_view str)
+{
+    platform::debug_output(str);
+}
+
+void logging::stdout_sink::log(nstl::string_view str)
+{
+    fwrite(str.data(), 1, str.size(), stdout);
+}
+
+void logging::stdout_sink::flush()
+{
+    fflush(stdout);
+}
+
+logging::file_sink::file_sink(nstl::string_view path)
+{
+    [[maybe_unused]] bool opened = m_file.try_open(path, fs::open_mode::write);
+    m_buffer.reserve(file_buffer_size);
+}
+
+void logging::file_sink::log(nstl::string_view str)
+{
+    m_buffer += str;
+
+    if (m_buffer.size() >= file_buffer_size)
+        flush();
+}
+
+void logging::file_sink::flush()
+{
+    write_buffer(m_file, m_offset, m_buffer);
+}
+
+logging::rotating_file_sink::rotating_file_sink(nstl::string_view base_path, size_t max_file_size, size_t max_file_count)
+    : m_base_path(base_path)
+    , m_max_file_size(max_file_size)
+    , m_max_file_count(max_file_count)
+{
+    assert(m_max_file_count > 0);
+
+    m_buffer.reserve(file_buffer_size);
+
+    m_file_index = m_max_file_count - 1;
+    open_next_file();
+}
+
+void logging::rotating_file_sink::log(nstl::string_view str)
+{
+    size_t current_size = m_offset + m_buffer.size();
+    if (current_size > 0 && current_size + str.size() > m_max_file_size)
+    {
+        flush();
+        open_next_file();
+    }
+
+    m_buffer += str;
+
+    if (m_buffer.size() >= file_buffer_size)
+        flush();
+}
+
+void logging::rotating_file_sink::flush()
+{
+    write_buffer(m_file, m_offset, m_buffer);
+}
+
+void logging::rotating_file_sink::open_next_file()
+{
+    m_file.close();
+
+    m_file_index = (m_file_index + 1) % m_max_file_count;
+    m_offset = 0;
+
+    nstl::string path = common::format("{}.{}.log", m_base_path, m_file_index);
+    [[maybe_unused]] bool opened = m_file.try_open(path, fs::open_mode::write);
+}
@@ -3,6 +3,8 @@
 #include "nstl/string_view.h"
 #include "nstl/vector.h"
 
+#include <stdint.h>
+
 namespace memory
 {
     namespace tracking
@@ -51,6 +53,28 @@ namespace memory
         void track_deallocation(void* ptr);
 
         nstl::vector<scope_stat> get_scope_stats_copy();
+
+        struct callstack_id
+        {
+            uint32_t index = 0; // 0 means the callstack wasn't captured
+        };
+
+        // Captures the callstack of every N-th allocation on each thread; 0 disables the capture
+        void set_callstack_sampling_period(size_t period);
+        size_t get_callstack_sampling_period();
+
+        struct callstack_stat
+        {
+            callstack_id id;
+            size_t active_bytes = 0;
+            size_t active_allocations = 0;
+        };
+
+        // Allocations which weren't sampled are grouped under the empty id
+        nstl::vector<callstack_stat> get_outstanding_allocations_by_callstack();
+        nstl::vector<void*> get_callstack_frames(callstack_id id);
+
+        void dump_outstanding_allocations(size_t max_callstack_count = 16);
     }
 }
 
@@ -4,11 +4,18 @@
 
 #include "logging/logging.h"
 
+#include "platform/debug.h"
+
+#include "mt/atomic.h"
 #include "mt/mutex.h"
 #include "mt/lock_guard.h"
 
 #include "nstl/vector.h"
-#include "nstl/unordered_map.h"
+#include "nstl/hash.h"
+#include "nstl/new.h"
+#include "nstl/span.h"
+#include "nstl/flat_hash_map.h"
+#include "nstl/utility.h"
 
 namespace
 {
@@ -22,7 +29,140 @@ namespace
     {
         size_t size = 0;
         memory::tracking::scope_id scope_id;
-        // TODO callstack id, etc.
+        memory::tracking::callstack_id callstack_id;
+    };
+
+    // Only the owning thread writes the counters of a block, so they don't need atomic read-modify-write operations
+    struct scope_counters
+    {
+        uint64_t volatile total_bytes = 0;
+        uint64_t volatile total_allocations = 0;
+        uint64_t volatile freed_bytes = 0;
+        uint64_t volatile freed_allocations = 0;
+    };
+
+    void increment_counter(uint64_t volatile& counter, uint64_t value)
+    {
+        mt::atomic_store_relaxed(counter, mt::atomic_load_relaxed(counter) + value);
+    }
+
+    constexpr size_t max_scope_count = 256;
+
+    // Blocks are never freed: a block of the finished thread is reused by the next one, keeping the counters.
+    // The shared block is never reused, it counts the memory tracked on the threads whose tracking data is already destroyed
+    struct thread_counters
+    {
+        scope_counters scopes[max_scope_count];
+        thread_counters* next = nullptr;
+        uint64_t volatile is_used = 0;
+    };
+
+    // Deallocations can happen on any thread, so the metadata is sharded by the pointer instead of the thread
+    struct alignas(64) metadata_shard
+    {
+        mt::mutex mutex;
+        nstl::flat_hash_map<void*, allocation_metadata> allocations{ memory::untracked_allocator{} };
+    };
+
+    constexpr size_t metadata_shard_count = 64;
+
+    constexpr size_t max_callstack_depth = 32;
+
+    // Deduplicated callstacks; frames of all callstacks are stored in a single array
+    class callstack_table
+    {
+    public:
+        callstack_table()
+        {
+            m_entries.push_back({}); // Index 0 is reserved for "no callstack"
+        }
+
+        memory::tracking::callstack_id add(nstl::span<void* const> frames)
+        {
+            if (frames.empty())
+                return {};
+
+            size_t hash = nstl::hash_bytes(frames.data(), frames.size() * sizeof(void*));
+
+            mt::lock_guard lock{ m_mutex };
+
+            uint32_t first_index = 0;
+            if (auto it = m_entries_by_hash.find(hash); it != m_entries_by_hash.end())
+                first_index = it->value();
+
+            for (uint32_t index = first_index; index != 0; index = m_entries[index].next_index)
+                if (is_equal(m_entries[index], frames))
+                    return { index };
+
+            assert(m_entries.size() <= UINT32_MAX);
+            assert(m_frames.size() <= UINT32_MAX);
+            uint32_t index = static_cast<uint32_t>(m_entries.size());
+
+            m_entries.push_back(entry{
+                .first_frame = static_cast<uint32_t>(m_frames.size()),
+                .frame_count = static_cast<uint32_t>(frames.size()),
+                .next_index = first_index,
+            });
+            for (void* frame : frames)
+                m_frames.push_back(frame);
+
+            m_entries_by_hash.insert_or_assign(hash, index);
+
+            return { index };
+        }
+
+        nstl::vector<void*> get_frames(memory::tracking::callstack_id id)
+        {
+            nstl::vector<void*> result;
+
+            if (id.index == 0)
+                return result;
+
+            size_t first_frame = 0;
+            size_t frame_count = 0;
+            {
+                mt::lock_guard lock{ m_mutex };
+
+                assert(id.index < m_entries.size());
+                first_frame = m_entries[id.index].first_frame;
+                frame_count = m_entries[id.index].frame_count;
+            }
+
+            // The result is allocated outside of the lock since its allocation might be sampled as well
+            result.resize(frame_count);
+
+            mt::lock_guard lock{ m_mutex };
+            for (size_t i = 0; i < frame_count; i++)
+                result[i] = m_frames[first_frame + i];
+
+            return result;
+        }
+
+    private:
+        struct entry
+        {
+            uint32_t first_frame = 0;
+            uint32_t frame_count = 0;
+            uint32_t next_index = 0; // Next entry with the same hash
+        };
+
+        bool is_equal(entry const& entry, nstl::span<void* const> frames) const
+        {
+            if (entry.frame_count != frames.size())
+                return false;
+
+            for (size_t i = 0; i < frames.size(); i++)
+                if (m_frames[entry.first_frame + i] != frames[i])
+                    return false;
+
+            return true;
+        }
+
+    private:
+        mt::mutex m_mutex;
+        nstl::vector<void*> m_frames{ memory::untracked_allocator{} };
+        nstl::vector<entry> m_entries{ memory::untracked_allocator{} };
+        nstl::flat_hash_map<size_t, uint32_t> m_entries_by_hash{ memory::untracked_allocator{} };
     };
 
     class teardown_tracker
@@ -30,37 +170,33 @@ namespace
     public:
         static void on_teardown_started()
         {
-            mt::lock_guard lock{ g_mutex };
-            g_is_tearing_down = true;
+            mt::atomic_store_release(g_is_tearing_down, 1);
         }
 
         static bool is_tearing_down()
         {
-            mt::lock_guard lock{ g_mutex };
-            return g_is_tearing_down;
+            return mt::atomic_load_relaxed(g_is_tearing_down) != 0;
         }
 
     private:
-        static inline mt::mutex g_mutex;
-        static inline bool g_is_tearing_down = false;
+        static inline uint64_t volatile g_is_tearing_down = 0;
     };
 
     class global_tracking_data
     {
     public:
-        global_tracking_data() = default;
+        global_tracking_data() : m_shared_thread_counters(acquire_thread_counters()) {}
         ~global_tracking_data()
         {
             teardown_tracker::on_teardown_started();
 
-            mt::lock_guard lock{ m_mutex };
-
-            for (memory::tracking::scope_stat const& entry : m_scope_stats)
+            for (size_t index = 0; index < m_scope_params.size(); index++)
             {
-                scope_parameters const& params = m_scope_params[entry.id.index];
+                scope_parameters const& params = m_scope_params[index];
                 if (params.type == memory::tracking::scope_type::external)
                     continue;
 
+                memory::tracking::scope_stat entry = get_scope_stat(memory::tracking::scope_id{ index });
                 assert(entry.active_bytes == 0);
                 assert(entry.active_allocations == 0);
             }
@@ -81,6 +217,8 @@ namespace
                 .index = m_scope_params.size()
             };
 
+            assert(id.index < max_scope_count);
+
             m_scope_params.push_back(scope_parameters{
                 .name = name,
                 .type = type,
@@ -89,86 +227,248 @@ namespace
             return id;
         }
 
-        void add_allocation_metadata(void* ptr, size_t size, memory::tracking::scope_id scope_id)
+        void add_allocation_metadata(void* ptr, allocation_metadata metadata)
         {
-            mt::lock_guard lock{ m_mutex };
+            metadata_shard& shard = get_shard(ptr);
+            mt::lock_guard lock{ shard.mutex };
 
-            assert(m_allocation_metadata.find(ptr) == m_allocation_metadata.end());
-            m_allocation_metadata[ptr] = allocation_metadata{ size, scope_id };
+            assert(shard.allocations.find(ptr) == shard.allocations.end());
+            shard.allocations.insert_or_assign(ptr, metadata);
         }
 
-        allocation_metadata get_allocation_metadata(void* ptr)
+        allocation_metadata extract_allocation_metadata(void* ptr)
         {
-            mt::lock_guard lock{ m_mutex };
-
             assert(ptr);
-            assert(m_allocation_metadata.find(ptr) != m_allocation_metadata.end());
 
-            return m_allocation_metadata[ptr];
+            metadata_shard& shard = get_shard(ptr);
+            mt::lock_guard lock{ shard.mutex };
+
+            auto it = shard.allocations.find(ptr);
+            assert(it != shard.allocations.end());
+
+            allocation_metadata metadata = it->value();
+            shard.allocations.erase(ptr);
+
+            return metadata;
         }
 
-        void remove_allocation_metadata(void* ptr)
+        void set_callstack_sampling_period(size_t period)
         {
-            mt::lock_guard lock{ m_mutex };
+            mt::atomic_store_relaxed(m_callstack_sampling_period, period);
+        }
 
-            assert(ptr);
-            assert(m_allocation_metadata.find(ptr) != m_allocation_metadata.end());
+        size_t get_callstack_sampling_period() const
+        {
+            return static_cast<size_t>(mt::atomic_load_relaxed(m_callstack_sampling_period));
+        }
 
-            m_allocation_metadata.erase(ptr);
+        memory::tracking::callstack_id add_callstack(nstl::span<void* const> frames)
+        {
+            return m_callstacks.add(frames);
         }
 
-        void track_allocation(memory::tracking::scope_id id, size_t bytes)
+        nstl::vector<void*> get_callstack_frames(memory::tracking::callstack_id id)
         {
-            mt::lock_guard lock{ m_mutex };
+            return m_callstacks.get_frames(id);
+        }
 
-            assert(bytes > 0);
+        nstl::vector<memory::tracking::callstack_stat> get_outstanding_allocations_by_callstack()
+        {
+            // Shard locks are held while grouping, so only the untracked memory can be allocated
+            nstl::flat_hash_map<uint32_t, memory::tracking::callstack_stat> groups{ memory::untracked_allocator{} };
+
+            for (metadata_shard& shard : m_shards)
+            {
+                mt::lock_guard lock{ shard.mutex };
 
-            for (size_t index = m_scope_stats.size(); index <= id.index; index++)
-                m_scope_stats.push_back(memory::tracking::scope_stat{ .id = memory::tracking::scope_id{index} });
+                for (auto const& node : shard.allocations)
+                {
+                    allocation_metadata const& metadata = node.value();
 
-            assert(id.index < m_scope_stats.size());
-            memory::tracking::scope_stat& entry = m_scope_stats[id.index];
+                    memory::tracking::callstack_stat& stat = groups[metadata.callstack_id.index];
+                    stat.id = metadata.callstack_id;
+                    stat.active_bytes += metadata.size;
+                    stat.active_allocations++;
+                }
+            }
+
+            nstl::vector<memory::tracking::callstack_stat> result;
+            result.reserve(groups.size());
+            for (auto const& node : groups)
+                result.push_back(node.value());
 
-            entry.active_bytes += bytes;
-            entry.total_bytes += bytes;
-            entry.active_allocations++;
-            entry.total_allocations++;
+            return result;
         }
 
-        void track_deallocation(memory::tracking::scope_id id, size_t bytes)
+        thread_counters* acquire_thread_counters()
         {
-            mt::lock_guard lock{ m_mutex };
+            for (thread_counters* counters = get_first_thread_counters(); counters; counters = counters->next)
+            {
+                uint64_t expected = 0;
+                if (mt::atomic_compare_exchange(counters->is_used, expected, 1))
+                    return counters;
+            }
 
-            assert(bytes > 0);
+            thread_counters* counters = new (nstl::new_tag{}, memory::untracked_allocator{}.allocate(sizeof(thread_counters), alignof(thread_counters))) thread_counters{};
+            counters->is_used = 1;
 
-            assert(id.index < m_scope_stats.size());
-            memory::tracking::scope_stat& entry = m_scope_stats[id.index];
+            void* head = m_thread_counters;
+            do
+            {
+                counters->next = static_cast<thread_counters*>(head);
+            } while (!mt::atomic_compare_exchange(m_thread_counters, head, counters));
 
-            assert(entry.active_bytes >= bytes);
-            entry.active_bytes -= bytes;
+            return counters;
+        }
 
-            assert(entry.active_allocations > 0);
-            entry.active_allocations--;
+        void release_thread_counters(thread_counters* counters)
+        {
+            assert(counters != m_shared_thread_counters);
+            mt::atomic_store_release(counters->is_used, 0);
+        }
+
+        // Any thread can write to the shared block, so it needs atomic additions
+        void on_shared_allocation(memory::tracking::scope_id id, size_t bytes)
+        {
+            scope_counters& counters = m_shared_thread_counters->scopes[id.index];
+            mt::atomic_fetch_add(counters.total_bytes, bytes);
+            mt::atomic_fetch_add(counters.total_allocations, 1);
+        }
+
+        void on_shared_deallocation(memory::tracking::scope_id id, size_t bytes)
+        {
+            scope_counters& counters = m_shared_thread_counters->scopes[id.index];
+            mt::atomic_fetch_add(counters.freed_bytes, bytes);
+            mt::atomic_fetch_add(counters.freed_allocations, 1);
         }
 
         nstl::vector<memory::tracking::scope_stat> get_scope_stats_copy()
+        {
+            size_t scope_count = get_scope_count();
+
+            nstl::vector<memory::tracking::scope_stat> result;
+            result.reserve(scope_count);
+
+            for (size_t index = 0; index < scope_count; index++)
+                result.push_back(get_scope_stat(memory::tracking::scope_id{ index }));
+
+            return result;
+        }
+
+    private:
+        size_t get_scope_count()
         {
             mt::lock_guard lock{ m_mutex };
+            return m_scope_params.size();
+        }
+
+        memory::tracking::scope_stat get_scope_stat(memory::tracking::scope_id id)
+        {
+            uint64_t total_bytes = 0;
+            uint64_t total_allocations = 0;
+            uint64_t freed_bytes = 0;
+            uint64_t freed_allocations = 0;
+
+            for (thread_counters const* counters = get_first_thread_counters(); counters; counters = counters->next)
+            {
+                scope_counters const& scope = counters->scopes[id.index];
+                total_bytes += mt::atomic_load_relaxed(scope.total_bytes);
+                total_allocations += mt::atomic_load_relaxed(scope.total_allocations);
+                freed_bytes += mt::atomic_load_relaxed(scope.freed_bytes);
+                freed_allocations += mt::atomic_load_relaxed(scope.freed_allocations);
+            }
+
+            // Counters of different threads aren't read at the same instant, so a deallocation might be seen before its allocation
+            return memory::tracking::scope_stat{
+                .id = id,
+                .active_bytes = total_bytes > freed_bytes ? total_bytes - freed_bytes : 0,
+                .total_bytes = total_bytes,
+                .active_allocations = total_allocations > freed_allocations ? total_allocations - freed_allocations : 0,
+                .total_allocations = total_allocations,
+            };
+        }
+
+        metadata_shard& get_shard(void* ptr)
+        {
+            uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+            return m_shards[((address >> 4) ^ (address >> 12)) % metadata_shard_count];
+        }
 
-            return m_scope_stats;
+        thread_counters* get_first_thread_counters()
+        {
+            return static_cast<thread_counters*>(mt::atomic_load_acquire(m_thread_counters));
         }
 
     private:
         mt::mutex m_mutex;
         nstl::vector<scope_parameters> m_scope_params{ memory::untracked_allocator{} };
-        nstl::unordered_map<void*, allocation_metadata> m_allocation_metadata{ memory::untracked_allocator{} };
-        nstl::vector<memory::tracking::scope_stat> m_scope_stats{ memory::untracked_allocator{} };
+
+        metadata_shard m_shards[metadata_shard_count];
+        void* volatile m_thread_counters = nullptr;
+        thread_counters* m_shared_thread_counters = nullptr;
+
+        callstack_table m_callstacks;
+        uint64_t volatile m_callstack_sampling_period = 0;
     };
 
+    global_tracking_data& get_global_data();
+
+    memory::tracking::scope_id get_unsorted_scope_id()
+    {
+        static memory::tracking::scope_id const unsorted_scope_id = memory::tracking::create_scope_id("Unsorted");
+        return unsorted_scope_id;
+    }
+
+    // Thread-local destructors which run after the one of thread_tracking_data can still allocate and free memory.
+    // The flag is trivially destructible, so it stays valid until the thread exits
+    thread_local bool t_is_thread_data_destroyed = false;
+
     class thread_tracking_data
     {
     public:
-        thread_tracking_data() = default;
+        thread_tracking_data() : m_counters(get_global_data().acquire_thread_counters()) {}
+        ~thread_tracking_data()
+        {
+            // The block can be reused by another thread right away, so this thread must not write to it anymore
+            t_is_thread_data_destroyed = true;
+            get_global_data().release_thread_counters(m_counters);
+        }
+
+        thread_tracking_data(thread_tracking_data const&) = delete;
+        thread_tracking_data& operator=(thread_tracking_data const&) = delete;
+
+        void on_allocation(memory::tracking::scope_id id, size_t bytes)
+        {
+            assert(bytes > 0);
+            assert(id.index < max_scope_count);
+
+            scope_counters& counters = m_counters->scopes[id.index];
+            increment_counter(counters.total_bytes, bytes);
+            increment_counter(counters.total_allocations, 1);
+        }
+
+        void on_deallocation(memory::tracking::scope_id id, size_t bytes)
+        {
+            assert(bytes > 0);
+            assert(id.index < max_scope_count);
+
+            scope_counters& counters = m_counters->scopes[id.index];
+            increment_counter(counters.freed_bytes, bytes);
+            increment_counter(counters.freed_allocations, 1);
+        }
+
+        bool should_capture_callstack(size_t sampling_period)
+        {
+            if (sampling_period == 0)
+                return false;
+
+            m_allocations_since_sample++;
+            if (m_allocations_since_sample < sampling_period)
+                return false;
+
+            m_allocations_since_sample = 0;
+            return true;
+        }
 
         void push_scope(memory::tracking::scope_id id)
         {
@@ -182,24 +482,28 @@ namespace
 
         memory::tracking::scope_id get_current_scope_id()
         {
-            static memory::tracking::scope_id const unsorted_scope_id = memory::tracking::create_scope_id("Unsorted");
-
             if (m_scope_stack.empty())
-                return unsorted_scope_id;
+                return get_unsorted_scope_id();
 
             return m_scope_stack.back();
         }
 
     private:
+        thread_counters* m_counters = nullptr;
+        size_t m_allocations_since_sample = 0;
         nstl::vector<memory::tracking::scope_id> m_scope_stack{ memory::untracked_allocator{} }; // TODO use static_vector
     };
 
-    thread_tracking_data& get_thread_data()
+    // Returns null once the data of the thread is destroyed
+    thread_tracking_data* try_get_thread_data()
     {
         assert(!teardown_tracker::is_tearing_down());
 
+        if (t_is_thread_data_destroyed)
+            return nullptr;
+
         static thread_local thread_tracking_data data;
-        return data;
+        return &data;
     }
 
     global_tracking_data& get_global_data()
@@ -221,17 +525,22 @@ nstl::string_view memory::tracking::get_scope_name(scope_id id)
 
 void memory::tracking::on_scope_enter(scope_id id)
 {
-    get_thread_data().push_scope(id);
+    if (thread_tracking_data* thread_data = try_get_thread_data())
+        thread_data->push_scope(id);
 }
 
 void memory::tracking::on_scope_exit()
 {
-    get_thread_data().pop_scope();
+    if (thread_tracking_data* thread_data = try_get_thread_data())
+        thread_data->pop_scope();
 }
 
 memory::tracking::scope_id memory::tracking::get_current_thread_scope_id()
 {
-    return get_thread_data().get_current_scope_id();
+    if (thread_tracking_data* thread_data = try_get_thread_data())
+        return thread_data->get_current_scope_id();
+
+    return get_unsorted_scope_id();
 }
 
 void memory::tracking::track_allocation(void* ptr, size_t size)
@@ -239,25 +548,101 @@ void memory::tracking::track_allocation(void* ptr, size_t size)
     assert(ptr);
     assert(size > 0);
 
-    scope_id scope_id = get_current_thread_scope_id();
+    global_tracking_data& global_data = get_global_data();
+    thread_tracking_data* thread_data = try_get_thread_data();
+
+    allocation_metadata metadata = {
+        .size = size,
+        .scope_id = thread_data ? thread_data->get_current_scope_id() : get_unsorted_scope_id(),
+    };
+
+    if (thread_data && thread_data->should_capture_callstack(global_data.get_callstack_sampling_period()))
+    {
+        void* frames[max_callstack_depth];
+        size_t frame_count = platform::capture_callstack(frames, 2); // Skip track_allocation() and memory::allocate()
+        metadata.callstack_id = global_data.add_callstack({ frames, frame_count });
+    }
+
+    global_data.add_allocation_metadata(ptr, metadata);
 
-    get_global_data().add_allocation_metadata(ptr, size, scope_id);
-    get_global_data().track_allocation(scope_id, size);
+    if (thread_data)
+        thread_data->on_allocation(metadata.scope_id, size);
+    else
+        global_data.on_shared_allocation(metadata.scope_id, size);
 }
 
 void memory::tracking::track_deallocation(void* ptr)
 {
-    global_tracking_data& data = get_global_data();
-
-    allocation_metadata metadata = data.get_allocation_metadata(ptr);
+    global_tracking_data& global_data = get_global_data();
+    allocation_metadata metadata = global_data.extract_allocation_metadata(ptr);
 
     assert(metadata.size > 0);
 
-    data.track_deallocation(metadata.scope_id, metadata.size);
-    data.remove_allocation_metadata(ptr);
+    if (thread_tracking_data* thread_data = try_get_thread_data())
+        thread_data->on_deallocation(metadata.scope_id, metadata.size);
+    else
+        global_data.on_shared_deallocation(metadata.scope_id, metadata.size);
 }
 
 nstl::vector<memory::tracking::scope_stat> memory::tracking::get_scope_stats_copy()
 {
     return ::get_global_data().get_scope_stats_copy();
 }
+
+void memory::tracking::set_callstack_sampling_period(size_t period)
+{
+    get_global_data().set_callstack_sampling_period(period);
+}
+
+size_t memory::tracking::get_callstack_sampling_period()
+{
+    return get_global_data().get_callstack_sampling_period();
+}
+
+nstl::vector<memory::tracking::callstack_stat> memory::tracking::get_outstanding_allocations_by_callstack()
+{
+    return get_global_data().get_outstanding_allocations_by_callstack();
+}
+
+nstl::vector<void*> memory::tracking::get_callstack_frames(callstack_id id)
+{
+    return get_global_data().get_callstack_frames(id);
+}
+
+void memory::tracking::dump_outstanding_allocations(size_t max_callstack_count)
+{
+    nstl::vector<callstack_stat> stats = get_outstanding_allocations_by_callstack();
+
+    size_t total_bytes = 0;
+    size_t total_allocations = 0;
+    for (callstack_stat const& stat : stats)
+    {
+        total_bytes += stat.active_bytes;
+        total_allocations += stat.active_allocations;
+    }
+
+    logging::info("Outstanding allocations: {} bytes in {} allocations, callstack sampling period {}", total_bytes, total_allocations, get_callstack_sampling_period());
+
+    // Only a few of the biggest groups are reported, so a partial selection sort is enough
+    for (size_t i = 0; i < stats.size() && i < max_callstack_count; i++)
+    {
+        size_t biggest_index = i;
+        for (size_t j = i + 1; j < stats.size(); j++)
+            if (stats[j].active_bytes > stats[biggest_index].active_bytes)
+                biggest_index = j;
+
+        nstl::exchange(stats[i], stats[biggest_index]);
+
+        callstack_stat const& stat = stats[i];
+
+        if (stat.id.index == 0)
+        {
+            logging::info("{} bytes in {} allocations without a callstack", stat.active_bytes, stat.active_allocations);
+            continue;
+        }
+
+        logging::info("{} bytes in {} allocations, callstack #{}:", stat.active_bytes, stat.active_allocations, stat.id.index);
+        for (void* frame : get_callstack_frames(stat.id))
+            logging::info("    {}", platform::symbolize_address(frame));
+    }
+}
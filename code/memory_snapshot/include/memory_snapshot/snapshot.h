@@ -0,0 +1,62 @@
+#pragma once
+
+#include "common/tiny_ctti.h"
+
+#include "nstl/optional.h"
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+#include "nstl/vector.h"
+
+#include <stdint.h>
+
+namespace memory_snapshot
+{
+    constexpr uint16_t snapshot_version = 1;
+
+    // Scopes are stored flat; the tree is implied by the '/' separated names
+    struct scope_entry
+    {
+        nstl::string name;
+        size_t active_bytes = 0;
+        size_t total_bytes = 0;
+        size_t active_allocations = 0;
+        size_t total_allocations = 0;
+    };
+    TINY_CTTI_DESCRIBE_STRUCT(scope_entry, name, active_bytes, total_bytes, active_allocations, total_allocations);
+
+    // Frames are symbolized at capture time since addresses aren't comparable between runs
+    struct callstack_entry
+    {
+        nstl::vector<nstl::string> frames;
+        size_t active_bytes = 0;
+        size_t active_allocations = 0;
+    };
+    TINY_CTTI_DESCRIBE_STRUCT(callstack_entry, frames, active_bytes, active_allocations);
+
+    struct snapshot
+    {
+        uint16_t version = 0;
+        nstl::string label;
+        nstl::vector<scope_entry> scopes;
+        nstl::vector<callstack_entry> callstacks;
+    };
+    TINY_CTTI_DESCRIBE_STRUCT(snapshot, version, label, scopes, callstacks);
+
+    // Outstanding allocations are only included when the callstack sampling is enabled
+    snapshot capture(nstl::string_view label, size_t max_callstack_count = 64);
+
+    [[nodiscard]] bool save(snapshot const& snapshot, nstl::string_view path);
+    nstl::optional<snapshot> load(nstl::string_view path);
+
+    struct scope_diff
+    {
+        nstl::string name;
+        int64_t active_bytes_delta = 0;
+        int64_t active_allocations_delta = 0;
+        size_t base_active_bytes = 0;
+        size_t current_active_bytes = 0;
+    };
+
+    // Every scope also includes its children, same as in the memory viewer. Sorted by active_bytes_delta, biggest growth first
+    nstl::vector<scope_diff> diff(snapshot const& base, snapshot const& current);
+}
@@ -0,0 +1,195 @@
+#include "memory_snapshot/snapshot.h"
+
+#include "memory/tracking.h"
+
+#include "platform/debug.h"
+
+#include "common/json-nstl.h"
+#include "common/json-tiny-ctti.h"
+
+#include "fs/file.h"
+
+#include "yyjsoncpp/yyjsoncpp.h"
+
+#include "nstl/function.h"
+#include "nstl/unordered_map.h"
+#include "nstl/utility.h"
+
+namespace
+{
+    auto get_scope_id()
+    {
+        static auto scope_id = memory::tracking::create_scope_id("System/MemorySnapshot");
+        return scope_id;
+    }
+
+    struct scope_totals
+    {
+        size_t active_bytes = 0;
+        size_t active_allocations = 0;
+    };
+
+    void for_each_scope_path(nstl::string_view name, nstl::function_ref<void(nstl::string_view)> func)
+    {
+        func(name.substr(0, 0));
+
+        for (size_t i = 0; i < name.size(); i++)
+            if (name[i] == '/')
+                func(name.substr(0, i));
+
+        if (!name.empty())
+            func(name);
+    }
+
+    nstl::unordered_map<nstl::string, scope_totals> accumulate_scope_totals(memory_snapshot::snapshot const& snapshot)
+    {
+        nstl::unordered_map<nstl::string, scope_totals> result;
+
+        for (memory_snapshot::scope_entry const& entry : snapshot.scopes)
+        {
+            for_each_scope_path(entry.name, [&result, &entry](nstl::string_view path)
+            {
+                scope_totals& totals = result[nstl::string{ path }];
+                totals.active_bytes += entry.active_bytes;
+                totals.active_allocations += entry.active_allocations;
+            });
+        }
+
+        return result;
+    }
+
+    int64_t get_delta(size_t base, size_t current)
+    {
+        return static_cast<int64_t>(current) - static_cast<int64_t>(base);
+    }
+}
+
+memory_snapshot::snapshot memory_snapshot::capture(nstl::string_view label, size_t max_callstack_count)
+{
+    MEMORY_TRACKING_SCOPE(get_scope_id());
+
+    snapshot result;
+    result.version = snapshot_version;
+    result.label = label;
+
+    for (memory::tracking::scope_stat const& stat : memory::tracking::get_scope_stats_copy())
+    {
+        result.scopes.push_back({
+            .name = memory::tracking::get_scope_name(stat.id),
+            .active_bytes = stat.active_bytes,
+            .total_bytes = stat.total_bytes,
+            .active_allocations = stat.active_allocations,
+            .total_allocations = stat.total_allocations,
+        });
+    }
+
+    if (memory::tracking::get_callstack_sampling_period() == 0)
+        return result;
+
+    nstl::vector<memory::tracking::callstack_stat> stats = memory::tracking::get_outstanding_allocations_by_callstack();
+
+    // Only a few of the biggest groups are stored, so a partial selection sort is enough
+    for (size_t i = 0; i < stats.size() && result.callstacks.size() < max_callstack_count; i++)
+    {
+        size_t biggest_index = i;
+        for (size_t j = i + 1; j < stats.size(); j++)
+            if (stats[j].active_bytes > stats[biggest_index].active_bytes)
+                biggest_index = j;
+
+        nstl::exchange(stats[i], stats[biggest_index]);
+
+        memory::tracking::callstack_stat const& stat = stats[i];
+        if (stat.id.index == 0)
+            continue;
+
+        callstack_entry& entry = result.callstacks.emplace_back();
+        entry.active_bytes = stat.active_bytes;
+        entry.active_allocations = stat.active_allocations;
+
+        for (void* frame : memory::tracking::get_callstack_frames(stat.id))
+            entry.frames.push_back(platform::symbolize_address(frame));
+    }
+
+    return result;
+}
+
+bool memory_snapshot::save(snapshot const& snapshot, nstl::string_view path)
+{
+    MEMORY_TRACKING_SCOPE(get_scope_id());
+
+    namespace json = yyjsoncpp;
+
+    json::mutable_doc doc;
+    json::mutable_value_ref root = doc.create_value(snapshot);
+    doc.set_root(root);
+
+    nstl::string contents = doc.write();
+
+    fs::file f;
+    if (!f.try_open(path, fs::open_mode::write))
+        return false;
+
+    return f.try_write(contents.data(), contents.size());
+}
+
+nstl::optional<memory_snapshot::snapshot> memory_snapshot::load(nstl::string_view path)
+{
+    MEMORY_TRACKING_SCOPE(get_scope_id());
+
+    fs::file f;
+    if (!f.try_open(path, fs::open_mode::read))
+        return {};
+
+    nstl::string contents;
+    contents.resize(f.size());
+    if (!f.try_read(contents.data(), contents.size()))
+        return {};
+
+    yyjsoncpp::doc doc;
+    if (!doc.read(contents.data(), contents.size()))
+        return {};
+
+    nstl::optional<snapshot> result = doc.get_root().try_get<snapshot>();
+    if (!result || result->version != snapshot_version)
+        return {};
+
+    return result;
+}
+
+nstl::vector<memory_snapshot::scope_diff> memory_snapshot::diff(snapshot const& base, snapshot const& current)
+{
+    MEMORY_TRACKING_SCOPE(get_scope_id());
+
+    nstl::unordered_map<nstl::string, scope_totals> base_totals = accumulate_scope_totals(base);
+    nstl::unordered_map<nstl::string, scope_totals> current_totals = accumulate_scope_totals(current);
+
+    nstl::vector<scope_diff> result;
+
+    auto add_diff = [&result](nstl::string const& name, scope_totals const& base, scope_totals const& current)
+    {
+        result.push_back({
+            .name = name,
+            .active_bytes_delta = get_delta(base.active_bytes, current.active_bytes),
+            .active_allocations_delta = get_delta(base.active_allocations, current.active_allocations),
+            .base_active_bytes = base.active_bytes,
+            .current_active_bytes = current.active_bytes,
+        });
+    };
+
+    for (auto const& node : current_totals)
+    {
+        auto it = base_totals.find(node.key());
+        add_diff(node.key(), it != base_totals.end() ? it->value() : scope_totals{}, node.value());
+    }
+
+    for (auto const& node : base_totals)
+        if (current_totals.find(node.key()) == current_totals.end())
+            add_diff(node.key(), node.value(), scope_totals{});
+
+    // The number of scopes is small
+    for (size_t i = 1; i < result.size(); i++)
+        for (size_t j = i; j > 0 && result[j].active_bytes_delta > result[j - 1].active_bytes_delta; j--)
+            nstl::exchange(result[j], result[j - 1]);
+
+    return result;
+}
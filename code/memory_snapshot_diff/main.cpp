@@ -0,0 +1,72 @@
+#include "memory_snapshot/snapshot.h"
+
+#include "platform/startup.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Exit codes: 0 - no scope grew above the threshold, 1 - invalid arguments or snapshots, 2 - some scope grew above the threshold
+
+namespace
+{
+    constexpr int exitCodeGrowth = 2;
+
+    void printUsage()
+    {
+        fprintf(stderr, "Usage: memory_snapshot_diff <base.json> <current.json> [threshold_bytes]\n");
+    }
+}
+
+int run(int argc, char** argv)
+{
+    if (argc < 3 || argc > 4)
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    long long threshold = 0;
+    if (argc == 4)
+    {
+        char* end = nullptr;
+        threshold = strtoll(argv[3], &end, 10);
+        if (!end || *end != '\0' || threshold < 0)
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    nstl::optional<memory_snapshot::snapshot> base = memory_snapshot::load(argv[1]);
+    if (!base)
+    {
+        fprintf(stderr, "Failed to load the snapshot '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    nstl::optional<memory_snapshot::snapshot> current = memory_snapshot::load(argv[2]);
+    if (!current)
+    {
+        fprintf(stderr, "Failed to load the snapshot '%s'\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    printf("Base: '%s', current: '%s'\n", base->label.c_str(), current->label.c_str());
+    printf("%14s %12s %14s  %s\n", "Bytes delta", "Allocs delta", "Current bytes", "Scope");
+
+    bool hasGrowth = false;
+
+    for (memory_snapshot::scope_diff const& entry : memory_snapshot::diff(*base, *current))
+    {
+        if (entry.active_bytes_delta == 0 && entry.active_allocations_delta == 0)
+            continue;
+
+        bool isGrowth = entry.active_bytes_delta > threshold;
+        hasGrowth = hasGrowth || isGrowth;
+
+        char const* name = entry.name.empty() ? "(total)" : entry.name.c_str();
+        printf("%+14lld %+12lld %14zu  %s%s\n", static_cast<long long>(entry.active_bytes_delta), static_cast<long long>(entry.active_allocations_delta), entry.current_active_bytes, name, isGrowth ? "  <- growth" : "");
+    }
+
+    return hasGrowth ? exitCodeGrowth : EXIT_SUCCESS;
+}
@@ -8,4 +8,115 @@ namespace mt
     {
         return platform::atomic_fetch_increment_relaxed(dest);
     }
+
+    inline uint64_t atomic_fetch_add(uint64_t volatile& dest, uint64_t value)
+    {
+        return platform::atomic_fetch_add(dest, value);
+    }
+
+    inline uint64_t atomic_load_relaxed(uint64_t volatile const& src)
+    {
+        return platform::atomic_load_relaxed(src);
+    }
+
+    inline uint64_t atomic_load_acquire(uint64_t volatile const& src)
+    {
+        return platform::atomic_load_acquire(src);
+    }
+
+    inline void atomic_store_relaxed(uint64_t volatile& dest, uint64_t value)
+    {
+        platform::atomic_store_relaxed(dest, value);
+    }
+
+    inline void atomic_store_release(uint64_t volatile& dest, uint64_t value)
+    {
+        platform::atomic_store_release(dest, value);
+    }
+
+    inline uint64_t atomic_exchange(uint64_t volatile& dest, uint64_t value)
+    {
+        return platform::atomic_exchange(dest, value);
+    }
+
+    inline bool atomic_compare_exchange(uint64_t volatile& dest, uint64_t& expected, uint64_t desired)
+    {
+        return platform::atomic_compare_exchange(dest, expected, desired);
+    }
+
+    inline void* atomic_load_acquire(void* volatile const& src)
+    {
+        return platform::atomic_load_acquire(src);
+    }
+
+    inline bool atomic_compare_exchange(void* volatile& dest, void*& expected, void* desired)
+    {
+        return platform::atomic_compare_exchange(dest, expected, desired);
+    }
+
+    inline void atomic_thread_fence()
+    {
+        platform::atomic_thread_fence();
+    }
+
+    namespace detail
+    {
+        // Integers, bools and enums are stored by value, pointers through uintptr_t
+        template<typename T>
+        inline constexpr bool is_atomic_integral_v = requires(T value) { static_cast<uint64_t>(value); };
+    }
+
+    // Typed wrapper over the 64-bit atomics. T has to be an integer, an enum or a pointer
+    template<typename T>
+    class atomic
+    {
+    public:
+        static_assert(sizeof(T) <= sizeof(uint64_t));
+
+        atomic(T value = {}) : m_value(to_storage(value)) {}
+
+        atomic(atomic const&) = delete;
+        atomic& operator=(atomic const&) = delete;
+
+        T load_relaxed() const { return from_storage(atomic_load_relaxed(m_value)); }
+        T load_acquire() const { return from_storage(atomic_load_acquire(m_value)); }
+
+        void store_relaxed(T value) { atomic_store_relaxed(m_value, to_storage(value)); }
+        void store_release(T value) { atomic_store_release(m_value, to_storage(value)); }
+
+        // Returns the previous value
+        T exchange(T value) { return from_storage(atomic_exchange(m_value, to_storage(value))); }
+
+        // On failure the expected value is updated to the current one
+        bool compare_exchange(T& expected, T desired)
+        {
+            uint64_t expected_storage = to_storage(expected);
+            bool result = atomic_compare_exchange(m_value, expected_storage, to_storage(desired));
+            expected = from_storage(expected_storage);
+            return result;
+        }
+
+        // Return the previous value
+        T fetch_add(T value) requires detail::is_atomic_integral_v<T> { return from_storage(atomic_fetch_add(m_value, to_storage(value))); }
+        T fetch_sub(T value) requires detail::is_atomic_integral_v<T> { return from_storage(atomic_fetch_add(m_value, 0 - to_storage(value))); }
+
+    private:
+        static uint64_t to_storage(T value)
+        {
+            if constexpr (detail::is_atomic_integral_v<T>)
+                return static_cast<uint64_t>(value);
+            else
+                return reinterpret_cast<uintptr_t>(value);
+        }
+
+        static T from_storage(uint64_t value)
+        {
+            if constexpr (detail::is_atomic_integral_v<T>)
+                return static_cast<T>(value);
+            else
+                return reinterpret_cast<T>(static_cast<uintptr_t>(value));
+        }
+
+        uint64_t volatile m_value;
+    };
 }
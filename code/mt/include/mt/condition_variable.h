@@ -0,0 +1,31 @@
+#pragma once
+
+#include "platform/threading.h"
+
+namespace mt
+{
+    class mutex;
+
+    class condition_variable
+    {
+    public:
+        condition_variable();
+        ~condition_variable();
+
+        // The mutex has to be locked by the calling thread. Might wake up spuriously
+        void wait(mt::mutex& mutex);
+
+        template<typename Predicate>
+        void wait(mt::mutex& mutex, Predicate&& predicate)
+        {
+            while (!predicate())
+                wait(mutex);
+        }
+
+        void notify_one();
+        void notify_all();
+
+    private:
+        platform::condition_variable_storage_t m_storage;
+    };
+}
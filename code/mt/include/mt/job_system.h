@@ -0,0 +1,123 @@
+#pragma once
+
+#include "mt/atomic.h"
+#include "mt/condition_variable.h"
+#include "mt/mutex.h"
+#include "mt/semaphore.h"
+
+#include "nstl/algorithm.h"
+#include "nstl/function.h"
+#include "nstl/unique_ptr.h"
+#include "nstl/vector.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace mt
+{
+    // Number of unfinished jobs started with the counter. Waiting on it is the fence between dependent jobs
+    class job_counter
+    {
+    public:
+        job_counter() = default;
+
+        job_counter(job_counter const&) = delete;
+        job_counter& operator=(job_counter const&) = delete;
+
+        bool is_done() const { return m_pending.load_acquire() == 0; }
+
+    private:
+        friend class job_system;
+
+        mt::atomic<uint64_t> m_pending;
+    };
+
+    // Every worker owns a work-stealing deque: jobs started from a job go to the deque of its worker,
+    // idle workers steal from the others. Jobs started from other threads go to the shared queue.
+    // The jobs are recycled through pools, so starting a job only allocates until the pools have warmed up
+    class job_system
+    {
+    public:
+        // Without workers every job runs on the thread waiting for it, in the order the jobs were started
+        explicit job_system(size_t worker_count = get_default_worker_count());
+        ~job_system();
+
+        job_system(job_system const&) = delete;
+        job_system& operator=(job_system const&) = delete;
+
+        // The counter has to outlive the job
+        void run(job_counter& counter, nstl::function<void()> func);
+
+        // Executes the pending jobs until the counter is done, so it can be called from a job as well.
+        // When there is nothing to execute it blocks until the counter is done or a new job is started
+        void wait(job_counter& counter);
+
+        // Calls func(begin, end) for the chunks of [0, count) and waits for all of them.
+        // 0 chunk size splits the range into a few chunks per thread
+        template<typename Func>
+        void parallel_for(size_t count, size_t chunk_size, Func&& func)
+        {
+            if (count == 0)
+                return;
+
+            if (chunk_size == 0)
+                chunk_size = get_default_chunk_size(count);
+
+            // The jobs only store a pointer to the function, so they don't allocate it
+            auto* func_ptr = &func;
+
+            job_counter counter;
+            for (size_t begin = 0; begin < count; begin += chunk_size)
+            {
+                size_t end = begin + nstl::min(chunk_size, count - begin);
+                run(counter, [func_ptr, begin, end]() { (*func_ptr)(begin, end); });
+            }
+
+            wait(counter);
+        }
+
+        size_t get_worker_count() const { return m_workers.size(); }
+
+        // A worker per hardware thread except the one waiting for the jobs
+        static size_t get_default_worker_count();
+
+    private:
+        struct job;
+        struct worker;
+
+        worker* get_current_worker();
+        size_t get_default_chunk_size(size_t count) const;
+
+        job* find_job(worker* self);
+        job* pop_injected_job();
+
+        job* allocate_job(worker* self);
+        void release_job(worker* self, job* job);
+        void execute(worker* self, job* job);
+        void wake_worker();
+        void wake_waiters();
+
+        void worker_main(worker& self);
+
+        nstl::vector<nstl::unique_ptr<worker>> m_workers;
+
+        mt::mutex m_injected_mutex;
+        nstl::vector<job*> m_injected_jobs;
+        size_t m_injected_head = 0;
+        mt::atomic<uint64_t> m_injected_count;
+
+        // Jobs released by the threads without a worker and the surplus of the workers
+        mt::mutex m_free_jobs_mutex;
+        job* m_free_jobs = nullptr;
+
+        mt::semaphore m_wake_semaphore;
+        mt::atomic<uint64_t> m_sleeping_count;
+        mt::atomic<bool> m_stopping;
+
+        // Threads blocked in wait(). The epoch changes whenever they might have something to do
+        mt::mutex m_wait_mutex;
+        mt::condition_variable m_wait_condition;
+        mt::atomic<uint64_t> m_waiting_count;
+        mt::atomic<uint64_t> m_wait_epoch;
+    };
+}
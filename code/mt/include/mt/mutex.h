@@ -14,6 +14,8 @@ namespace mt
         void unlock();
 
     private:
+        friend class condition_variable;
+
         platform::mutex_storage_t m_storage;
     };
 }
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "mt/condition_variable.h"
+#include "mt/mutex.h"
+
+#include <stddef.h>
+
+namespace mt
+{
+    class semaphore
+    {
+    public:
+        semaphore(size_t initial_count = 0) : m_count(initial_count) {}
+
+        // Blocks until the count is positive and decrements it
+        void acquire();
+        bool try_acquire();
+
+        void release(size_t count = 1);
+
+    private:
+        mt::mutex m_mutex;
+        mt::condition_variable m_condition;
+        size_t m_count = 0;
+    };
+}
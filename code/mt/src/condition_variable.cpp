@@ -0,0 +1,31 @@
+#include "mt/condition_variable.h"
+
+#include "mt/mutex.h"
+
+#include <assert.h>
+
+mt::condition_variable::condition_variable()
+{
+    [[maybe_unused]] bool result = platform::condition_variable_create(m_storage);
+    assert(result);
+}
+
+mt::condition_variable::~condition_variable()
+{
+    platform::condition_variable_destroy(m_storage);
+}
+
+void mt::condition_variable::wait(mt::mutex& mutex)
+{
+    platform::condition_variable_wait(m_storage, mutex.m_storage);
+}
+
+void mt::condition_variable::notify_one()
+{
+    platform::condition_variable_notify_one(m_storage);
+}
+
+void mt::condition_variable::notify_all()
+{
+    platform::condition_variable_notify_all(m_storage);
+}
@@ -0,0 +1,447 @@
+#include "mt/job_system.h"
+
+#include "mt/lock_guard.h"
+#include "mt/thread.h"
+
+#include "platform/threading.h"
+
+#include <assert.h>
+
+namespace
+{
+    constexpr size_t cache_line_size = 64;
+
+    // Workers keep the jobs they executed for their next ones and hand the surplus over to the shared pool in batches
+    constexpr size_t max_cached_job_count = 256;
+    constexpr size_t job_batch_size = 64;
+
+    // Chase-Lev deque with a fixed capacity. The owner pushes and pops at the bottom, the thieves take from the top
+    template<typename T>
+    class work_stealing_deque
+    {
+    public:
+        inline static constexpr int64_t capacity = 4096;
+
+        bool push(T* value)
+        {
+            int64_t bottom = m_bottom.load_relaxed();
+            int64_t top = m_top.load_acquire();
+
+            if (bottom - top >= capacity)
+                return false;
+
+            m_jobs[bottom & (capacity - 1)].store_relaxed(value);
+            m_bottom.store_release(bottom + 1);
+
+            return true;
+        }
+
+        T* pop()
+        {
+            int64_t bottom = m_bottom.load_relaxed() - 1;
+            m_bottom.store_relaxed(bottom);
+
+            mt::atomic_thread_fence();
+
+            int64_t top = m_top.load_relaxed();
+            if (top > bottom)
+            {
+                m_bottom.store_relaxed(bottom + 1);
+                return nullptr;
+            }
+
+            T* value = m_jobs[bottom & (capacity - 1)].load_relaxed();
+
+            if (top == bottom)
+            {
+                // The last job might be taken by a thief at the same time
+                if (!m_top.compare_exchange(top, top + 1))
+                    value = nullptr;
+
+                m_bottom.store_relaxed(bottom + 1);
+            }
+
+            return value;
+        }
+
+        T* steal()
+        {
+            int64_t top = m_top.load_acquire();
+
+            mt::atomic_thread_fence();
+
+            int64_t bottom = m_bottom.load_acquire();
+            if (top >= bottom)
+                return nullptr;
+
+            T* value = m_jobs[top & (capacity - 1)].load_relaxed();
+
+            // Either the owner or another thief got it first
+            if (!m_top.compare_exchange(top, top + 1))
+                return nullptr;
+
+            return value;
+        }
+
+    private:
+        alignas(cache_line_size) mt::atomic<int64_t> m_top;
+        alignas(cache_line_size) mt::atomic<int64_t> m_bottom;
+        alignas(cache_line_size) mt::atomic<T*> m_jobs[capacity];
+    };
+}
+
+struct mt::job_system::job
+{
+    nstl::function<void()> func;
+    job_counter* counter = nullptr;
+    job* next_free = nullptr;
+};
+
+struct mt::job_system::worker
+{
+    size_t index = 0;
+    uint64_t random_state = 0;
+
+    work_stealing_deque<job> deque;
+    nstl::unique_ptr<mt::thread> thread;
+
+    // Only accessed by the thread of the worker
+    job* free_jobs = nullptr;
+    size_t free_job_count = 0;
+};
+
+namespace
+{
+    thread_local mt::job_system* current_system = nullptr;
+    thread_local void* current_worker = nullptr;
+
+    uint64_t next_random(uint64_t& state)
+    {
+        // xorshift64
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+}
+
+mt::job_system::job_system(size_t worker_count)
+{
+    m_workers.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; i++)
+    {
+        auto w = nstl::make_unique<worker>();
+        w->index = i;
+        w->random_state = 0x9e3779b97f4a7c15ull * (i + 1);
+        m_workers.push_back(nstl::move(w));
+    }
+
+    // The threads are started after all the workers exist, since they steal from each other
+    for (nstl::unique_ptr<worker>& w : m_workers)
+    {
+        worker* self = w.get();
+        self->thread = nstl::make_unique<mt::thread>("Job worker", [this, self]() { worker_main(*self); });
+    }
+}
+
+size_t mt::job_system::get_default_worker_count()
+{
+    size_t hardware_thread_count = platform::get_hardware_thread_count();
+    return hardware_thread_count > 0 ? hardware_thread_count - 1 : 0;
+}
+
+mt::job_system::~job_system()
+{
+    m_stopping.store_release(true);
+    m_wake_semaphore.release(m_workers.size());
+
+    for (nstl::unique_ptr<worker>& w : m_workers)
+        w->thread = nullptr;
+
+    // The workers stop once they find nothing to do, but jobs which nobody waited for (e.g. without workers)
+    // can still be queued. Their counters have to outlive them, so they are executed rather than dropped
+    while (job* remaining_job = find_job(nullptr))
+        execute(nullptr, remaining_job);
+
+    assert(m_injected_count.load_relaxed() == 0);
+
+    auto delete_jobs = [](job* free_jobs)
+    {
+        while (free_jobs)
+        {
+            job* next_free = free_jobs->next_free;
+            delete free_jobs;
+            free_jobs = next_free;
+        }
+    };
+
+    for (nstl::unique_ptr<worker>& w : m_workers)
+        delete_jobs(w->free_jobs);
+    delete_jobs(m_free_jobs);
+}
+
+void mt::job_system::run(job_counter& counter, nstl::function<void()> func)
+{
+    counter.m_pending.fetch_add(1);
+
+    worker* self = get_current_worker();
+
+    job* new_job = allocate_job(self);
+    new_job->func = nstl::move(func);
+    new_job->counter = &counter;
+
+    if (!self || !self->deque.push(new_job))
+    {
+        mt::lock_guard lock{ m_injected_mutex };
+        m_injected_jobs.push_back(new_job);
+        m_injected_count.fetch_add(1);
+    }
+
+    wake_worker();
+}
+
+void mt::job_system::wait(job_counter& counter)
+{
+    worker* self = get_current_worker();
+
+    while (!counter.is_done())
+    {
+        if (job* next_job = find_job(self))
+        {
+            execute(self, next_job);
+            continue;
+        }
+
+        // Registered before checking for the jobs again, so that run() and execute() either wake it up
+        // or the jobs and the counter updates they publish are visible here
+        m_waiting_count.fetch_add(1);
+        uint64_t epoch = m_wait_epoch.load_acquire();
+
+        if (job* next_job = find_job(self))
+        {
+            m_waiting_count.fetch_sub(1);
+            execute(self, next_job);
+            continue;
+        }
+
+        {
+            mt::lock_guard lock{ m_wait_mutex };
+            m_wait_condition.wait(m_wait_mutex, [&]() { return counter.is_done() || m_wait_epoch.load_relaxed() != epoch; });
+        }
+
+        m_waiting_count.fetch_sub(1);
+    }
+}
+
+mt::job_system::worker* mt::job_system::get_current_worker()
+{
+    if (current_system != this)
+        return nullptr;
+
+    return static_cast<worker*>(current_worker);
+}
+
+size_t mt::job_system::get_default_chunk_size(size_t count) const
+{
+    size_t chunk_count = 4 * (m_workers.size() + 1);
+    return nstl::max<size_t>((count + chunk_count - 1) / chunk_count, 1);
+}
+
+mt::job_system::job* mt::job_system::find_job(worker* self)
+{
+    if (self)
+        if (job* own_job = self->deque.pop())
+            return own_job;
+
+    if (job* injected_job = pop_injected_job())
+        return injected_job;
+
+    size_t worker_count = m_workers.size();
+    if (worker_count == 0)
+        return nullptr;
+
+    size_t start = self ? static_cast<size_t>(next_random(self->random_state) % worker_count) : 0;
+    for (size_t i = 0; i < worker_count; i++)
+    {
+        worker& victim = *m_workers[(start + i) % worker_count];
+        if (&victim == self)
+            continue;
+
+        if (job* stolen_job = victim.deque.steal())
+            return stolen_job;
+    }
+
+    return nullptr;
+}
+
+mt::job_system::job* mt::job_system::pop_injected_job()
+{
+    if (m_injected_count.load_relaxed() == 0)
+        return nullptr;
+
+    mt::lock_guard lock{ m_injected_mutex };
+
+    if (m_injected_head == m_injected_jobs.size())
+        return nullptr;
+
+    job* next_job = m_injected_jobs[m_injected_head++];
+    m_injected_count.fetch_sub(1);
+
+    if (m_injected_head == m_injected_jobs.size())
+    {
+        m_injected_jobs.clear();
+        m_injected_head = 0;
+    }
+
+    return next_job;
+}
+
+mt::job_system::job* mt::job_system::allocate_job(worker* self)
+{
+    if (self)
+    {
+        if (!self->free_jobs)
+        {
+            // Takes a batch at once, so that the shared pool isn't locked for every job
+            mt::lock_guard lock{ m_free_jobs_mutex };
+
+            if (job* first_job = m_free_jobs)
+            {
+                job* last_job = first_job;
+                size_t count = 1;
+                for (; count < job_batch_size && last_job->next_free; count++)
+                    last_job = last_job->next_free;
+
+                m_free_jobs = last_job->next_free;
+                last_job->next_free = nullptr;
+
+                self->free_jobs = first_job;
+                self->free_job_count = count;
+            }
+        }
+
+        if (job* free_job = self->free_jobs)
+        {
+            self->free_jobs = free_job->next_free;
+            self->free_job_count--;
+            return free_job;
+        }
+    }
+    else
+    {
+        mt::lock_guard lock{ m_free_jobs_mutex };
+
+        if (job* free_job = m_free_jobs)
+        {
+            m_free_jobs = free_job->next_free;
+            return free_job;
+        }
+    }
+
+    return new job{};
+}
+
+void mt::job_system::release_job(worker* self, job* free_job)
+{
+    if (!self)
+    {
+        mt::lock_guard lock{ m_free_jobs_mutex };
+        free_job->next_free = m_free_jobs;
+        m_free_jobs = free_job;
+        return;
+    }
+
+    free_job->next_free = self->free_jobs;
+    self->free_jobs = free_job;
+    self->free_job_count++;
+
+    // Workers which execute more jobs than they start (e.g. the ones started from other threads) return the surplus
+    if (self->free_job_count <= max_cached_job_count)
+        return;
+
+    job* first_job = self->free_jobs;
+    job* last_job = first_job;
+    for (size_t i = 1; i < job_batch_size; i++)
+        last_job = last_job->next_free;
+
+    self->free_jobs = last_job->next_free;
+    self->free_job_count -= job_batch_size;
+
+    mt::lock_guard lock{ m_free_jobs_mutex };
+    last_job->next_free = m_free_jobs;
+    m_free_jobs = first_job;
+}
+
+void mt::job_system::execute(worker* self, job* current_job)
+{
+    current_job->func();
+
+    // The function is destroyed before the counter is updated, so its captures are released by the time wait() returns
+    job_counter* counter = current_job->counter;
+    current_job->func = nullptr;
+    release_job(self, current_job);
+
+    if (counter->m_pending.fetch_sub(1) == 1)
+        wake_waiters();
+}
+
+void mt::job_system::wake_worker()
+{
+    // Pairs with the fence in worker_main(): either the sleeping worker sees the new job or it's woken up here
+    mt::atomic_thread_fence();
+
+    if (m_sleeping_count.load_relaxed() > 0)
+        m_wake_semaphore.release();
+
+    wake_waiters();
+}
+
+void mt::job_system::wake_waiters()
+{
+    // Pairs with the registration in wait(): either the waiting thread sees the update or it's woken up here
+    mt::atomic_thread_fence();
+
+    if (m_waiting_count.load_relaxed() == 0)
+        return;
+
+    mt::lock_guard lock{ m_wait_mutex };
+    m_wait_epoch.fetch_add(1);
+    m_wait_condition.notify_all();
+}
+
+void mt::job_system::worker_main(worker& self)
+{
+    current_system = this;
+    current_worker = &self;
+
+    while (true)
+    {
+        if (job* next_job = find_job(&self))
+        {
+            execute(&self, next_job);
+            continue;
+        }
+
+        m_sleeping_count.fetch_add(1);
+        mt::atomic_thread_fence();
+
+        if (job* next_job = find_job(&self))
+        {
+            m_sleeping_count.fetch_sub(1);
+            execute(&self, next_job);
+            continue;
+        }
+
+        if (m_stopping.load_acquire())
+        {
+            m_sleeping_count.fetch_sub(1);
+            break;
+        }
+
+        m_wake_semaphore.acquire();
+        m_sleeping_count.fetch_sub(1);
+    }
+
+    current_system = nullptr;
+    current_worker = nullptr;
+}
@@ -0,0 +1,35 @@
+#include "mt/semaphore.h"
+
+#include "mt/lock_guard.h"
+
+void mt::semaphore::acquire()
+{
+    mt::lock_guard lock{ m_mutex };
+
+    m_condition.wait(m_mutex, [this]() { return m_count > 0; });
+    m_count--;
+}
+
+bool mt::semaphore::try_acquire()
+{
+    mt::lock_guard lock{ m_mutex };
+
+    if (m_count == 0)
+        return false;
+
+    m_count--;
+    return true;
+}
+
+void mt::semaphore::release(size_t count)
+{
+    {
+        mt::lock_guard lock{ m_mutex };
+        m_count += count;
+    }
+
+    if (count == 1)
+        m_condition.notify_one();
+    else
+        m_condition.notify_all();
+}
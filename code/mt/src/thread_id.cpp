@@ -13,7 +13,10 @@ namespace
 uint64_t mt::get_thread_id()
 {
     if (!has_thread_id)
+    {
         thread_id = mt::atomic_fetch_increment_relaxed(next_thread_id);
+        has_thread_id = true;
+    }
 
     return thread_id;
 }
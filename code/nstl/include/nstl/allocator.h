@@ -17,7 +17,7 @@ namespace nstl
         { lhs == rhs} -> same_as<bool>;
     };
 
-    // TODO store small allocators on the stack (make the size configurable, like any_allocator<64>)
+    // Allocators which fit into the inline storage (e.g. stateless ones or a pointer to an arena) don't allocate memory for themselves
     class any_allocator
     {
     public:
@@ -26,8 +26,15 @@ namespace nstl
         template<allocator_like Alloc>
         any_allocator(Alloc allocator)
         {
-            m_allocator = allocator.allocate(sizeof(Alloc), alignof(Alloc));
-            new(nstl::new_tag{}, m_allocator) Alloc(nstl::move(allocator));
+            if constexpr (fits_inline<Alloc>)
+            {
+                m_allocator = new(nstl::new_tag{}, m_storage) Alloc(nstl::move(allocator));
+            }
+            else
+            {
+                m_allocator = allocator.allocate(sizeof(Alloc), alignof(Alloc));
+                new(nstl::new_tag{}, m_allocator) Alloc(nstl::move(allocator));
+            }
 
             m_destructStorage = [](any_allocator* self)
             {
@@ -35,14 +42,22 @@ namespace nstl
 
                 Alloc* allocator = static_cast<Alloc*>(self->m_allocator);
 
-                // 1. move allocator to a local variable
-                Alloc local_allocator = nstl::move(*allocator);
+                if constexpr (fits_inline<Alloc>)
+                {
+                    allocator->~Alloc();
+                }
+                else
+                {
+                    // 1. move allocator to a local variable
+                    Alloc local_allocator = nstl::move(*allocator);
 
-                // 2. destruct the allocator on the heap
-                allocator->~Alloc();
+                    // 2. destruct the allocator on the heap
+                    allocator->~Alloc();
+
+                    // 3. deallocate memory for the allocator
+                    local_allocator.deallocate(self->m_allocator);
+                }
 
-                // 3. deallocate memory for the allocator
-                local_allocator.deallocate(self->m_allocator);
                 self->m_allocator = nullptr;
             };
 
@@ -60,8 +75,35 @@ namespace nstl
                 NSTL_ASSERT(destination->m_allocator == nullptr);
 
                 Alloc* allocator = static_cast<Alloc*>(source->m_allocator);
-                destination->m_allocator = allocator->allocate(sizeof(Alloc), alignof(Alloc));
-                new(nstl::new_tag{}, destination->m_allocator) Alloc(*allocator);
+
+                if constexpr (fits_inline<Alloc>)
+                {
+                    destination->m_allocator = new(nstl::new_tag{}, destination->m_storage) Alloc(*allocator);
+                }
+                else
+                {
+                    destination->m_allocator = allocator->allocate(sizeof(Alloc), alignof(Alloc));
+                    new(nstl::new_tag{}, destination->m_allocator) Alloc(*allocator);
+                }
+            };
+
+            m_move = [](any_allocator* source, any_allocator* destination)
+            {
+                NSTL_ASSERT(source->m_allocator != nullptr);
+                NSTL_ASSERT(destination->m_allocator == nullptr);
+
+                if constexpr (fits_inline<Alloc>)
+                {
+                    Alloc* allocator = static_cast<Alloc*>(source->m_allocator);
+                    destination->m_allocator = new(nstl::new_tag{}, destination->m_storage) Alloc(nstl::move(*allocator));
+                    allocator->~Alloc();
+                }
+                else
+                {
+                    destination->m_allocator = source->m_allocator;
+                }
+
+                source->m_allocator = nullptr;
             };
 
             m_allocate = [](void* allocator, size_t size, size_t alignment) { return static_cast<Alloc*>(allocator)->allocate(size, alignment); };
@@ -84,10 +126,17 @@ namespace nstl
         bool operator==(any_allocator const& rhs) const;
 
     private:
-        static void swap(any_allocator& lhs, any_allocator& rhs);
+        static constexpr size_t inline_storage_size = 2 * sizeof(void*);
+
+        template<typename Alloc>
+        static constexpr bool fits_inline = sizeof(Alloc) <= inline_storage_size && alignof(Alloc) <= alignof(void*);
+
+        void reset();
+        void move_from(any_allocator& rhs);
 
     private:
         using CopyFunc = void(*)(any_allocator const* source, any_allocator* destination);
+        using MoveFunc = void(*)(any_allocator* source, any_allocator* destination);
         using CompareFunc = bool(*)(any_allocator const& lhs, any_allocator const& rhs);
         using DestructStorageFunc = void(*)(any_allocator*);
 
@@ -98,8 +147,11 @@ namespace nstl
         DestructStorageFunc m_destructStorage = nullptr;
         CompareFunc m_compare = nullptr;
         CopyFunc m_copy = nullptr;
+        MoveFunc m_move = nullptr;
 
         AllocFunc m_allocate = nullptr;
         DeallocFunc m_deallocate = nullptr;
+
+        alignas(void*) unsigned char m_storage[inline_storage_size];
     };
 }
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "assert.h"
+
+#include <stdint.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#pragma intrinsic(_BitScanForward64)
+#pragma intrinsic(_BitScanReverse64)
+#endif
+
+namespace nstl
+{
+    // Index of the lowest set bit. x shouldn't be zero
+    inline uint32_t find_first_set(uint64_t x)
+    {
+        NSTL_ASSERT(x != 0);
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index = 0;
+        _BitScanForward64(&index, x);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(x));
+#endif
+    }
+
+    // Index of the highest set bit. x shouldn't be zero
+    inline uint32_t find_last_set(uint64_t x)
+    {
+        NSTL_ASSERT(x != 0);
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index = 0;
+        _BitScanReverse64(&index, x);
+        return static_cast<uint32_t>(index);
+#else
+        return 63 - static_cast<uint32_t>(__builtin_clzll(x));
+#endif
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "allocator.h"
+
+#include <stddef.h>
+
+namespace nstl
+{
+    // Hands out blocks of a fixed size from a free list. Blocks are allocated in pages which are only released in the destructor
+    class fixed_pool
+    {
+    public:
+        fixed_pool(size_t block_size, size_t block_alignment, size_t blocks_per_page = 64, any_allocator upstream = {});
+        ~fixed_pool();
+
+        fixed_pool(fixed_pool const&) = delete;
+        fixed_pool(fixed_pool&&) = delete;
+        fixed_pool& operator=(fixed_pool const&) = delete;
+        fixed_pool& operator=(fixed_pool&&) = delete;
+
+        void* allocate();
+        void deallocate(void* ptr);
+
+        size_t get_block_size() const { return m_block_size; }
+        size_t get_block_alignment() const { return m_block_alignment; }
+        size_t get_used_block_count() const { return m_used_block_count; }
+
+    private:
+        struct free_block
+        {
+            free_block* next = nullptr;
+        };
+
+        struct page_header
+        {
+            page_header* next = nullptr;
+        };
+
+        void add_page();
+
+    private:
+        any_allocator m_upstream;
+
+        size_t m_block_size = 0;
+        size_t m_block_alignment = 0;
+        size_t m_blocks_per_page = 0;
+
+        page_header* m_pages = nullptr;
+        free_block* m_free_blocks = nullptr;
+        size_t m_used_block_count = 0;
+    };
+
+    class pool_allocator
+    {
+    public:
+        pool_allocator(fixed_pool& pool) : m_pool(&pool) {}
+
+        void* allocate(size_t size, size_t alignment);
+        void deallocate(void* ptr) { m_pool->deallocate(ptr); }
+
+        bool operator==(pool_allocator const& rhs) const { return m_pool == rhs.m_pool; }
+
+    private:
+        fixed_pool* m_pool = nullptr;
+    };
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "flat_hash_table.h"
+#include "unordered_map.h"
+
+namespace nstl
+{
+    namespace flat_hash_detail
+    {
+        template<typename K, typename V>
+        struct map_key_of
+        {
+            static K const& get(key_value_pair<K, V> const& pair)
+            {
+                return pair.m_key;
+            }
+        };
+    }
+
+    // Open-addressing alternative to unordered_map. Pointers and iterators are invalidated by insertions and erasures
+    template<typename K, typename V>
+    class flat_hash_map : public flat_hash_detail::table<key_value_pair<K, V>, flat_hash_detail::map_key_of<K, V>>
+    {
+    private:
+        using base = flat_hash_detail::table<key_value_pair<K, V>, flat_hash_detail::map_key_of<K, V>>;
+
+    public:
+        using iterator = typename base::iterator;
+        using const_iterator = typename base::const_iterator;
+
+        flat_hash_map(any_allocator alloc = {}) : base(nstl::move(alloc)) {}
+
+        iterator insert_or_assign(K key, V value)
+        {
+            auto result = this->prepare_insert(key);
+
+            if (result.found)
+                this->slot_at(result.index).m_value = nstl::move(value);
+            else
+                new(nstl::new_tag{}, &this->slot_at(result.index)) key_value_pair<K, V>{ nstl::move(key), nstl::move(value) };
+
+            return this->iterator_at(result.index);
+        }
+
+        template<typename T>
+        V const& operator[](T const& key) const
+        {
+            auto it = this->find(key);
+            NSTL_ASSERT(it != this->end());
+            return it->value();
+        }
+
+        template<typename T>
+        V& operator[](T const& key)
+        {
+            auto result = this->prepare_insert(key);
+
+            if (!result.found)
+                new(nstl::new_tag{}, &this->slot_at(result.index)) key_value_pair<K, V>{ K{ key }, V{} };
+
+            return this->slot_at(result.index).value();
+        }
+    };
+}
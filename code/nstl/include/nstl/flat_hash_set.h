@@ -0,0 +1,49 @@
+#pragma once
+
+#include "flat_hash_table.h"
+
+namespace nstl
+{
+    namespace flat_hash_detail
+    {
+        template<typename K>
+        struct set_key_of
+        {
+            static K const& get(K const& key)
+            {
+                return key;
+            }
+        };
+    }
+
+    // Open-addressing hash set. Pointers and iterators are invalidated by insertions and erasures
+    template<typename K>
+    class flat_hash_set : public flat_hash_detail::table<K, flat_hash_detail::set_key_of<K>>
+    {
+    private:
+        using base = flat_hash_detail::table<K, flat_hash_detail::set_key_of<K>>;
+
+    public:
+        using iterator = typename base::iterator;
+        using const_iterator = typename base::const_iterator;
+
+        flat_hash_set(any_allocator alloc = {}) : base(nstl::move(alloc)) {}
+
+        // Returns false if the key was already present
+        bool insert(K key)
+        {
+            auto result = this->prepare_insert(key);
+
+            if (!result.found)
+                new(nstl::new_tag{}, &this->slot_at(result.index)) K{ nstl::move(key) };
+
+            return !result.found;
+        }
+
+        template<typename T>
+        bool contains(T const& key) const
+        {
+            return this->find(key) != this->end();
+        }
+    };
+}
@@ -0,0 +1,485 @@
+#pragma once
+
+#include "alignment.h"
+#include "allocator.h"
+#include "assert.h"
+#include "bit.h"
+#include "hash.h"
+#include "malloc_allocator.h"
+#include "new.h"
+#include "utility.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define NSTL_FLAT_HASH_SSE2 1
+#include <emmintrin.h>
+#else
+#define NSTL_FLAT_HASH_SSE2 0
+#endif
+
+namespace nstl::flat_hash_detail
+{
+    // Every slot has a control byte: either empty or the 7 low bits of the key hash
+    using ctrl_t = int8_t;
+    inline constexpr ctrl_t ctrl_empty = -128;
+
+#if NSTL_FLAT_HASH_SSE2
+    struct group
+    {
+        static constexpr size_t width = 16;
+        static constexpr uint32_t bit_shift = 0;
+
+        explicit group(ctrl_t const* ctrl) : m_ctrl(_mm_loadu_si128(reinterpret_cast<__m128i const*>(ctrl))) {}
+
+        uint64_t match(ctrl_t h2) const
+        {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), m_ctrl)));
+        }
+
+        // Only the empty control byte has the sign bit set
+        uint64_t match_empty() const
+        {
+            return static_cast<uint32_t>(_mm_movemask_epi8(m_ctrl));
+        }
+
+        __m128i m_ctrl;
+    };
+#else
+    // Portable fallback: 8 control bytes are processed at once in a 64-bit word (assumes little-endian)
+    struct group
+    {
+        static constexpr size_t width = 8;
+        static constexpr uint32_t bit_shift = 3;
+
+        static constexpr uint64_t lsbs = 0x0101010101010101ull;
+        static constexpr uint64_t msbs = 0x8080808080808080ull;
+
+        explicit group(ctrl_t const* ctrl)
+        {
+            memcpy(&m_ctrl, ctrl, sizeof(m_ctrl));
+        }
+
+        // May report false positives, which are filtered out by the key comparison
+        uint64_t match(ctrl_t h2) const
+        {
+            uint64_t x = m_ctrl ^ (lsbs * static_cast<uint8_t>(h2));
+            return (x - lsbs) & ~x & msbs;
+        }
+
+        uint64_t match_empty() const
+        {
+            return m_ctrl & msbs;
+        }
+
+        uint64_t m_ctrl = 0;
+    };
+#endif
+
+    template<bool IsConst, typename T>
+    struct add_const_if
+    {
+        using Type = T;
+    };
+    template<typename T>
+    struct add_const_if<true, T>
+    {
+        using Type = T const;
+    };
+
+    inline size_t first_match_index(uint64_t mask)
+    {
+        return find_first_set(mask) >> group::bit_shift;
+    }
+
+    inline size_t mix_hash(size_t hash)
+    {
+        // Spreads weak hashes (e.g. pointers) over all bits, both the slot index and the control byte depend on it
+        uint64_t h = static_cast<uint64_t>(hash) * 0x9e3779b97f4a7c15ull;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+
+    inline ctrl_t get_h2(size_t hash)
+    {
+        return static_cast<ctrl_t>(hash & 0x7f);
+    }
+
+    inline size_t get_h1(size_t hash)
+    {
+        return hash >> 7;
+    }
+
+    // Open-addressing table with linear probing, scanned one group of control bytes at a time.
+    // Erase shifts the following elements of the cluster back, so there are no tombstones.
+    // KeyOf::get(T const&) returns the key of a stored element
+    template<typename T, typename KeyOf>
+    class table
+    {
+    public:
+        template<bool IsConst>
+        class basic_iterator
+        {
+        public:
+            using value_type = typename add_const_if<IsConst, T>::Type;
+
+            basic_iterator(ctrl_t const* ctrl, value_type* slot, ctrl_t const* ctrl_end) : m_ctrl(ctrl), m_slot(slot), m_ctrl_end(ctrl_end)
+            {
+                skip_empty();
+            }
+
+            value_type& operator*() const
+            {
+                return *m_slot;
+            }
+            value_type* operator->() const
+            {
+                return m_slot;
+            }
+
+            bool operator==(basic_iterator const& rhs) const
+            {
+                return m_slot == rhs.m_slot;
+            }
+
+            bool operator!=(basic_iterator const& rhs) const
+            {
+                return !(*this == rhs);
+            }
+
+            basic_iterator& operator++()
+            {
+                m_ctrl++;
+                m_slot++;
+                skip_empty();
+                return *this;
+            }
+
+        private:
+            void skip_empty()
+            {
+                while (m_ctrl != m_ctrl_end && *m_ctrl == ctrl_empty)
+                {
+                    m_ctrl++;
+                    m_slot++;
+                }
+            }
+
+            ctrl_t const* m_ctrl = nullptr;
+            value_type* m_slot = nullptr;
+            ctrl_t const* m_ctrl_end = nullptr;
+        };
+
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+
+        table(any_allocator alloc) : m_allocator(alloc ? nstl::move(alloc) : malloc_allocator{}) {}
+
+        table(table const& rhs) : table(rhs.m_allocator)
+        {
+            reserve(rhs.m_size);
+            for (T const& value : rhs)
+            {
+                prepare_insert_result result = prepare_insert(KeyOf::get(value));
+                NSTL_ASSERT(!result.found);
+                new(nstl::new_tag{}, &m_slots[result.index]) T(value);
+            }
+        }
+
+        table(table&& rhs) : table(rhs.m_allocator)
+        {
+            swap(rhs);
+        }
+
+        ~table()
+        {
+            clear();
+            release();
+        }
+
+        table& operator=(table const& rhs)
+        {
+            table temp{ rhs };
+            swap(temp);
+            return *this;
+        }
+
+        table& operator=(table&& rhs)
+        {
+            swap(rhs);
+            return *this;
+        }
+
+        iterator begin() { return { m_ctrl, m_slots, m_ctrl + m_capacity }; }
+        iterator end() { return { m_ctrl + m_capacity, m_slots + m_capacity, m_ctrl + m_capacity }; }
+        const_iterator begin() const { return { m_ctrl, m_slots, m_ctrl + m_capacity }; }
+        const_iterator end() const { return { m_ctrl + m_capacity, m_slots + m_capacity, m_ctrl + m_capacity }; }
+
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        size_t capacity() const { return m_capacity; }
+
+        void reserve(size_t size)
+        {
+            if (size == 0)
+                return;
+
+            size_t capacity = m_capacity > group::width ? m_capacity : group::width;
+            while (get_max_size(capacity) < size)
+                capacity *= 2;
+
+            if (capacity != m_capacity)
+                rehash(capacity);
+        }
+
+        void clear()
+        {
+            for (size_t i = 0; i < m_capacity; i++)
+            {
+                if (m_ctrl[i] != ctrl_empty)
+                {
+                    m_slots[i].~T();
+                    set_ctrl(i, ctrl_empty);
+                }
+            }
+
+            m_size = 0;
+        }
+
+        template<typename Key>
+        iterator find(Key const& key)
+        {
+            size_t index = find_index(key);
+            if (index == invalid_index)
+                return end();
+            return iterator_at(index);
+        }
+
+        template<typename Key>
+        const_iterator find(Key const& key) const
+        {
+            size_t index = find_index(key);
+            if (index == invalid_index)
+                return end();
+            return { m_ctrl + index, m_slots + index, m_ctrl + m_capacity };
+        }
+
+        template<typename Key>
+        bool erase(Key const& key)
+        {
+            size_t index = find_index(key);
+            if (index == invalid_index)
+                return false;
+
+            erase_at(index);
+            return true;
+        }
+
+    protected:
+        struct prepare_insert_result
+        {
+            size_t index = invalid_index;
+            bool found = false;
+        };
+
+        // Finds the key or reserves an empty slot for it. The caller has to construct the element in the reserved slot
+        template<typename Key>
+        prepare_insert_result prepare_insert(Key const& key)
+        {
+            size_t hash = hash_key(key);
+
+            if (size_t index = find_index(key, hash); index != invalid_index)
+                return { index, true };
+
+            if (m_size + 1 > get_max_size(m_capacity))
+                reserve(m_size + 1);
+
+            size_t index = find_empty_index(hash);
+            set_ctrl(index, get_h2(hash));
+            m_size++;
+
+            return { index, false };
+        }
+
+        iterator iterator_at(size_t index)
+        {
+            return { m_ctrl + index, m_slots + index, m_ctrl + m_capacity };
+        }
+
+        T& slot_at(size_t index)
+        {
+            NSTL_ASSERT(index < m_capacity);
+            return m_slots[index];
+        }
+
+    private:
+        // Every key is hashed with the hash of the stored key type, otherwise a lookup by another type (e.g. string_view)
+        // could probe a different slot than the one the element was moved to by rehash() or erase_at().
+        // Hashes marked as is_transparent accept such keys directly, the rest get a converted key
+        template<typename Key>
+        static size_t hash_key(Key const& key)
+        {
+            using hasher = nstl::hash<key_type>;
+
+            if constexpr (is_same_v<Key, key_type> || requires { typename hasher::is_transparent; })
+                return mix_hash(hasher{}(key));
+            else
+                return mix_hash(hasher{}(key_type(key)));
+        }
+
+        template<typename Key>
+        size_t find_index(Key const& key) const
+        {
+            if (m_size == 0)
+                return invalid_index;
+
+            return find_index(key, hash_key(key));
+        }
+
+        template<typename Key>
+        size_t find_index(Key const& key, size_t hash) const
+        {
+            if (m_capacity == 0)
+                return invalid_index;
+
+            size_t mask = m_capacity - 1;
+            ctrl_t h2 = get_h2(hash);
+
+            for (size_t position = get_h1(hash) & mask;; position = (position + group::width) & mask)
+            {
+                group g{ m_ctrl + position };
+
+                for (uint64_t matches = g.match(h2); matches != 0; matches &= matches - 1)
+                {
+                    size_t index = (position + first_match_index(matches)) & mask;
+                    if (KeyOf::get(m_slots[index]) == key)
+                        return index;
+                }
+
+                if (g.match_empty() != 0)
+                    return invalid_index;
+            }
+        }
+
+        size_t find_empty_index(size_t hash) const
+        {
+            NSTL_ASSERT(m_size < m_capacity);
+
+            size_t mask = m_capacity - 1;
+
+            for (size_t position = get_h1(hash) & mask;; position = (position + group::width) & mask)
+            {
+                if (uint64_t empties = group{ m_ctrl + position }.match_empty(); empties != 0)
+                    return (position + first_match_index(empties)) & mask;
+            }
+        }
+
+        void erase_at(size_t index)
+        {
+            NSTL_ASSERT(index < m_capacity);
+            NSTL_ASSERT(m_ctrl[index] != ctrl_empty);
+
+            size_t mask = m_capacity - 1;
+            size_t hole = index;
+
+            // Backward shift: pull the following elements of the cluster into the hole unless that would move them before their home slot
+            for (size_t next = (hole + 1) & mask; m_ctrl[next] != ctrl_empty; next = (next + 1) & mask)
+            {
+                size_t home = get_h1(hash_key(KeyOf::get(m_slots[next]))) & mask;
+                if (((next - home) & mask) < ((next - hole) & mask))
+                    continue;
+
+                m_slots[hole] = nstl::move(m_slots[next]);
+                set_ctrl(hole, m_ctrl[next]);
+                hole = next;
+            }
+
+            m_slots[hole].~T();
+            set_ctrl(hole, ctrl_empty);
+            m_size--;
+        }
+
+        void set_ctrl(size_t index, ctrl_t value)
+        {
+            m_ctrl[index] = value;
+
+            // The first bytes are mirrored after the end so that a group can be loaded at any position without wrapping
+            if (index < group::width - 1)
+                m_ctrl[m_capacity + index] = value;
+        }
+
+        void rehash(size_t capacity)
+        {
+            NSTL_ASSERT(is_power_of_2(capacity));
+            NSTL_ASSERT(capacity >= group::width);
+            NSTL_ASSERT(get_max_size(capacity) >= m_size);
+
+            T* old_slots = m_slots;
+            ctrl_t* old_ctrl = m_ctrl;
+            size_t old_capacity = m_capacity;
+
+            size_t ctrl_offset = align_up(capacity * sizeof(T), alignof(ctrl_t));
+            size_t ctrl_size = capacity + group::width - 1;
+            void* memory = m_allocator.allocate(ctrl_offset + ctrl_size, alignof(T));
+            NSTL_ASSERT(memory);
+
+            m_slots = static_cast<T*>(memory);
+            m_ctrl = reinterpret_cast<ctrl_t*>(static_cast<char*>(memory) + ctrl_offset);
+            m_capacity = capacity;
+            memset(m_ctrl, static_cast<uint8_t>(ctrl_empty), ctrl_size);
+
+            for (size_t i = 0; i < old_capacity; i++)
+            {
+                if (old_ctrl[i] == ctrl_empty)
+                    continue;
+
+                size_t hash = hash_key(KeyOf::get(old_slots[i]));
+                size_t index = find_empty_index(hash);
+                set_ctrl(index, get_h2(hash));
+                new(nstl::new_tag{}, &m_slots[index]) T(nstl::move(old_slots[i]));
+                old_slots[i].~T();
+            }
+
+            if (old_slots)
+                m_allocator.deallocate(old_slots);
+        }
+
+        void release()
+        {
+            if (m_slots)
+                m_allocator.deallocate(m_slots);
+
+            m_slots = nullptr;
+            m_ctrl = nullptr;
+            m_capacity = 0;
+        }
+
+        void swap(table& rhs)
+        {
+            nstl::exchange(m_allocator, rhs.m_allocator);
+            nstl::exchange(m_slots, rhs.m_slots);
+            nstl::exchange(m_ctrl, rhs.m_ctrl);
+            nstl::exchange(m_capacity, rhs.m_capacity);
+            nstl::exchange(m_size, rhs.m_size);
+        }
+
+        // Linear probing degrades quickly with load, so the table is kept at most 3/4 full
+        static size_t get_max_size(size_t capacity)
+        {
+            return capacity - capacity / 4;
+        }
+
+    private:
+        using key_type = simple_decay_t<decltype(KeyOf::get(declval<T const&>()))>;
+
+        inline static constexpr size_t invalid_index = static_cast<size_t>(-1);
+
+        any_allocator m_allocator;
+
+        T* m_slots = nullptr;
+        ctrl_t* m_ctrl = nullptr;
+        size_t m_capacity = 0;
+        size_t m_size = 0;
+    };
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "monotonic_arena.h"
+
+namespace nstl
+{
+    // Double-buffered linear allocator: memory allocated during a frame stays valid until the end of the next frame
+    class frame_arena
+    {
+    public:
+        frame_arena(size_t initial_capacity = 64 * 1024, any_allocator upstream = {});
+
+        // Resets the arena of the frame before the previous one
+        void next_frame();
+
+        void* allocate(size_t size, size_t alignment) { return get_current_arena().allocate(size, alignment); }
+        arena_allocator get_allocator() { return get_current_arena(); }
+
+        monotonic_arena& get_current_arena() { return m_arenas[m_current_index]; }
+
+    private:
+        static constexpr size_t frame_count = 2;
+
+        monotonic_arena m_arenas[frame_count];
+        size_t m_current_index = 0;
+    };
+}
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "nstl/assert.h"
+#include "nstl/new.h"
+#include "nstl/type_traits.h"
 #include "nstl/utility.h"
 
 #include <stddef.h>
+#include <string.h>
 
 namespace nstl
 {
@@ -17,15 +20,27 @@ namespace nstl
         function(nullptr_t = nullptr) {}
 
         template<typename Func>
+        requires (!is_same_v<simple_decay_t<Func>, function>)
         function(Func func)
         {
-            m_func = new Func(nstl::move(func));
-            m_callFunc = [](void* func, Args... args) -> R {
-                return (*static_cast<Func*>(func))(nstl::move(args)...);
-            };
-            m_destroyFunc = [](void* func) {
-                delete static_cast<Func*>(func);
-            };
+            if constexpr (fits_inline<Func>)
+            {
+                new(nstl::new_tag{}, &m_storage) Func(nstl::move(func));
+                m_callFunc = [](void* storage, Args... args) -> R {
+                    return (*static_cast<Func*>(storage))(nstl::move(args)...);
+                };
+            }
+            else
+            {
+                Func* heapFunc = new Func(nstl::move(func));
+                memcpy(&m_storage, &heapFunc, sizeof(heapFunc));
+                m_callFunc = [](void* storage, Args... args) -> R {
+                    return (**static_cast<Func**>(storage))(nstl::move(args)...);
+                };
+                m_destroyFunc = [](void* storage) {
+                    delete *static_cast<Func**>(storage);
+                };
+            }
         }
 
         function(function const& rhs) = delete;
@@ -36,8 +51,8 @@ namespace nstl
 
         ~function()
         {
-            if (m_func && m_destroyFunc)
-                m_destroyFunc(m_func);
+            if (m_destroyFunc)
+                m_destroyFunc(&m_storage);
         }
 
         function& operator=(function const& rhs) = delete;
@@ -49,29 +64,81 @@ namespace nstl
 
         R operator()(Args... args) const
         {
-            NSTL_ASSERT(m_func);
             NSTL_ASSERT(m_callFunc);
-            return m_callFunc(m_func, nstl::move(args)...);
+            return m_callFunc(const_cast<unsigned char*>(m_storage), nstl::move(args)...);
         }
 
         explicit operator bool() const
         {
-            return m_func;
+            return m_callFunc;
         }
 
     private:
+        static constexpr size_t inline_storage_size = 3 * sizeof(void*);
+
+        // Inline functors are relocated with memcpy when the function is moved
+        template<typename Func>
+        static constexpr bool fits_inline = sizeof(Func) <= inline_storage_size && alignof(Func) <= alignof(void*) && is_trivially_copyable_v<Func>;
+
         void swap(function& rhs)
         {
-            nstl::exchange(m_func, rhs.m_func);
+            unsigned char temp[inline_storage_size];
+            memcpy(temp, m_storage, inline_storage_size);
+            memcpy(m_storage, rhs.m_storage, inline_storage_size);
+            memcpy(rhs.m_storage, temp, inline_storage_size);
+
             nstl::exchange(m_callFunc, rhs.m_callFunc);
             nstl::exchange(m_destroyFunc, rhs.m_destroyFunc);
         }
 
-        using CallFuncPtr = R(*)(void* func, Args... args);
-        using DestroyFuncPtr = void(*)(void* func);
+        using CallFuncPtr = R(*)(void* storage, Args... args);
+        using DestroyFuncPtr = void(*)(void* storage);
 
-        void* m_func = nullptr;
+        // Holds either the functor itself or a pointer to the heap-allocated one
+        alignas(void*) unsigned char m_storage[inline_storage_size];
         CallFuncPtr m_callFunc = nullptr;
         DestroyFuncPtr m_destroyFunc = nullptr;
     };
+
+    template<typename Signature>
+    class function_ref;
+
+    // Non-owning reference to a callable, meant for parameters that are only called during the function call
+    template<typename R, typename... Args>
+    class function_ref<R(Args...)>
+    {
+    public:
+        template<typename Func>
+        requires (!is_same_v<simple_decay_t<Func>, function_ref>)
+        function_ref(Func&& func)
+        {
+            using FuncType = remove_reference_t<Func>;
+
+            m_object = const_cast<void*>(static_cast<void const*>(&func));
+            m_callFunc = [](void* object, Args... args) -> R {
+                return (*static_cast<FuncType*>(object))(nstl::move(args)...);
+            };
+        }
+
+        function_ref(R(*func)(Args...))
+        {
+            NSTL_ASSERT(func);
+
+            m_object = reinterpret_cast<void*>(func);
+            m_callFunc = [](void* object, Args... args) -> R {
+                return reinterpret_cast<R(*)(Args...)>(object)(nstl::move(args)...);
+            };
+        }
+
+        R operator()(Args... args) const
+        {
+            return m_callFunc(m_object, nstl::move(args)...);
+        }
+
+    private:
+        using CallFuncPtr = R(*)(void* object, Args... args);
+
+        void* m_object = nullptr;
+        CallFuncPtr m_callFunc = nullptr;
+    };
 }
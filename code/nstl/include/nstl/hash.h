@@ -12,9 +12,19 @@ namespace nstl
         size_t operator()(T const& value);
     };
 
+    size_t hash_bytes(void const* data, size_t size);
     size_t hash_string(char const* bytes, size_t size);
+
+    // Order-dependent, suitable for composite keys
     void hash_combine(size_t& hash, size_t hash2);
 
+    template<typename T>
+    void hash_combine(size_t& hash, T const& v)
+    {
+        nstl::hash<T> hasher;
+        hash_combine(hash, hasher(v));
+    }
+
     template<typename T>
     size_t hash_array(T* values, size_t size)
     {
@@ -24,13 +34,6 @@ namespace nstl
         return hash;
     }
 
-    template<typename T>
-    void hash_combine(size_t& hash, T const& v)
-    {
-        nstl::hash<T> hasher;
-        hash_combine(hash, hasher(v));
-    }
-
     template<typename... Ts>
     size_t hash_values(Ts const&... values)
     {
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "allocator.h"
+
+#include <stddef.h>
+
+namespace nstl
+{
+    // Allocates linearly from chunks; the memory is only released all at once by reset() or the destructor
+    class monotonic_arena
+    {
+    public:
+        monotonic_arena(size_t initial_capacity = 64 * 1024, any_allocator upstream = {});
+        ~monotonic_arena();
+
+        monotonic_arena(monotonic_arena const&) = delete;
+        monotonic_arena(monotonic_arena&&) = delete;
+        monotonic_arena& operator=(monotonic_arena const&) = delete;
+        monotonic_arena& operator=(monotonic_arena&&) = delete;
+
+        void* allocate(size_t size, size_t alignment);
+
+        // If the arena has grown, its chunks are replaced with a single chunk big enough for all of them
+        void reset();
+
+        size_t get_used_size() const { return m_used_size; }
+        size_t get_capacity() const { return m_capacity; }
+
+    private:
+        struct chunk_header
+        {
+            chunk_header* next = nullptr;
+            size_t size = 0;
+        };
+
+        static size_t get_chunk_header_size();
+
+        void add_chunk(size_t min_size);
+        void release_chunks();
+
+    private:
+        any_allocator m_upstream;
+
+        chunk_header* m_chunks = nullptr; // The newest chunk is the first one
+        char* m_current = nullptr;
+        char* m_end = nullptr;
+
+        size_t m_used_size = 0;
+        size_t m_capacity = 0;
+    };
+
+    class arena_allocator
+    {
+    public:
+        arena_allocator(monotonic_arena& arena) : m_arena(&arena) {}
+
+        void* allocate(size_t size, size_t alignment) { return m_arena->allocate(size, alignment); }
+        void deallocate(void*) {}
+
+        bool operator==(arena_allocator const& rhs) const { return m_arena == rhs.m_arena; }
+
+    private:
+        monotonic_arena* m_arena = nullptr;
+    };
+}
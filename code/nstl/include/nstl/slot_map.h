@@ -0,0 +1,172 @@
+#pragma once
+
+#include "assert.h"
+#include "allocator.h"
+#include "utility.h"
+#include "vector.h"
+
+#include <stdint.h>
+
+namespace nstl
+{
+    struct slot_map_handle
+    {
+        uint32_t index = static_cast<uint32_t>(-1);
+        uint32_t generation = 0;
+
+        explicit operator bool() const { return index != static_cast<uint32_t>(-1); }
+
+        bool operator==(slot_map_handle const& rhs) const = default;
+    };
+
+    // Values are stored densely and moved on erase; handles stay valid until the value is erased.
+    // Every erase bumps the slot generation, so stale handles are detected instead of aliasing a newer value.
+    // A slot whose generation reaches the maximum is retired instead of wrapping around, GenerationBits limits
+    // the generations for handle encodings which have fewer bits for them
+    template<typename T, uint32_t GenerationBits = 32>
+    class slot_map
+    {
+        static_assert(GenerationBits >= 1 && GenerationBits <= 32);
+
+    public:
+        slot_map(any_allocator alloc = {}) : m_values(alloc), m_value_slots(alloc), m_slots(alloc) {}
+
+        template<typename... Args>
+        slot_map_handle emplace(Args&&... args)
+        {
+            NSTL_ASSERT(m_values.size() < invalid_index);
+            uint32_t dense_index = static_cast<uint32_t>(m_values.size());
+
+            uint32_t slot_index = m_free_head;
+            if (slot_index != invalid_index)
+            {
+                m_free_head = m_slots[slot_index].dense_index;
+            }
+            else
+            {
+                NSTL_ASSERT(m_slots.size() < invalid_index);
+                slot_index = static_cast<uint32_t>(m_slots.size());
+                m_slots.push_back({});
+            }
+
+            slot& s = m_slots[slot_index];
+            s.dense_index = dense_index;
+
+            m_values.emplace_back(nstl::forward<Args>(args)...);
+            m_value_slots.push_back(slot_index);
+
+            return { slot_index, s.generation };
+        }
+
+        slot_map_handle insert(T value)
+        {
+            return emplace(nstl::move(value));
+        }
+
+        bool erase(slot_map_handle handle)
+        {
+            if (!contains(handle))
+                return false;
+
+            slot& s = m_slots[handle.index];
+            uint32_t dense_index = s.dense_index;
+            uint32_t last_index = static_cast<uint32_t>(m_values.size() - 1);
+
+            if (dense_index != last_index)
+            {
+                m_values[dense_index] = nstl::move(m_values[last_index]);
+                m_value_slots[dense_index] = m_value_slots[last_index];
+                m_slots[m_value_slots[dense_index]].dense_index = dense_index;
+            }
+
+            m_values.pop_back();
+            m_value_slots.pop_back();
+
+            // The last generation is never handed out, so the handles of a retired slot are all stale
+            s.generation++;
+            if (s.generation == max_generation)
+            {
+                s.dense_index = invalid_index;
+            }
+            else
+            {
+                s.dense_index = m_free_head;
+                m_free_head = handle.index;
+            }
+
+            return true;
+        }
+
+        // A free slot has the generation of its next value, and its dense index links the free list (or is invalid
+        // if the slot is retired), so the slot also has to be the owner of the value it points to
+        bool contains(slot_map_handle handle) const
+        {
+            if (handle.index >= m_slots.size())
+                return false;
+
+            slot const& s = m_slots[handle.index];
+            if (s.generation != handle.generation)
+                return false;
+
+            return s.dense_index < m_values.size() && m_value_slots[s.dense_index] == handle.index;
+        }
+
+        T* get(slot_map_handle handle)
+        {
+            if (!contains(handle))
+                return nullptr;
+            return &m_values[m_slots[handle.index].dense_index];
+        }
+
+        T const* get(slot_map_handle handle) const
+        {
+            if (!contains(handle))
+                return nullptr;
+            return &m_values[m_slots[handle.index].dense_index];
+        }
+
+        // Handle of the value at the given position of the dense storage
+        slot_map_handle get_handle_at(size_t dense_index) const
+        {
+            NSTL_ASSERT(dense_index < m_value_slots.size());
+            uint32_t slot_index = m_value_slots[dense_index];
+            return { slot_index, m_slots[slot_index].generation };
+        }
+
+        void clear()
+        {
+            while (!m_values.empty())
+                erase(get_handle_at(m_values.size() - 1));
+        }
+
+        void reserve(size_t capacity)
+        {
+            m_values.reserve(capacity);
+            m_value_slots.reserve(capacity);
+            m_slots.reserve(capacity);
+        }
+
+        size_t size() const { return m_values.size(); }
+        bool empty() const { return m_values.empty(); }
+
+        T* begin() { return m_values.begin(); }
+        T const* begin() const { return m_values.begin(); }
+        T* end() { return m_values.end(); }
+        T const* end() const { return m_values.end(); }
+
+    private:
+        inline static constexpr uint32_t invalid_index = static_cast<uint32_t>(-1);
+        inline static constexpr uint32_t max_generation = static_cast<uint32_t>((uint64_t{ 1 } << GenerationBits) - 1);
+
+        struct slot
+        {
+            uint32_t dense_index = invalid_index; // Next free slot if the slot is free
+            uint32_t generation = 0;
+        };
+
+        vector<T> m_values;
+        vector<uint32_t> m_value_slots;
+        vector<slot> m_slots;
+        uint32_t m_free_head = invalid_index;
+    };
+}
@@ -1,11 +1,10 @@
 #pragma once
 
-#include "buffer.h"
-
 #include "hash.h"
 #include "allocator.h"
 
 #include <stddef.h>
+#include <stdint.h>
 
 namespace nstl
 {
@@ -19,6 +18,12 @@ namespace nstl
         string(char const* str, any_allocator alloc = {});
         string(string_view str, any_allocator alloc = {});
         string(char const* str, size_t length, any_allocator alloc = {});
+        string(string const& rhs);
+        string(string&& rhs);
+        ~string();
+
+        string& operator=(string const& rhs);
+        string& operator=(string&& rhs);
 
         size_t length() const;
         size_t size() const;
@@ -61,10 +66,39 @@ namespace nstl
         static size_t npos;
 
     private:
+        // Short strings are stored inside the object. The last byte of the storage is the tag:
+        // for inline strings it holds the remaining inline capacity, so it doubles as the null terminator of a full inline string
+        struct heap_storage
+        {
+            char* data;
+            size_t size;
+            uint32_t capacity;
+            unsigned char padding[sizeof(void*) - sizeof(uint32_t) - 1];
+            unsigned char tag;
+        };
+
+        static constexpr size_t storage_size = sizeof(heap_storage);
+        static constexpr size_t inline_capacity = storage_size - 1;
+        static constexpr unsigned char heap_tag = 0xff;
+        static constexpr size_t max_heap_capacity = UINT32_MAX; // The heap capacity is stored in 32 bits to keep the string small
+
+        bool is_inline() const;
+        void set_inline_size(size_t size);
+        void set_size(size_t size);
+        void grow(size_t min_capacity);
+        void release();
+        void swap(string& rhs);
+
         void validateIsNullTerminated();
 
     private:
-        buffer m_buffer;
+        any_allocator m_allocator;
+
+        union
+        {
+            heap_storage m_heap;
+            char m_inline[storage_size];
+        };
     };
 
     string operator+(string lhs, char rhs);
@@ -75,6 +109,9 @@ namespace nstl
     template<>
     struct hash<string>
     {
-        size_t operator()(string const& value);
+        // Lets the hash tables look up strings by string_view or char const* without constructing a string
+        using is_transparent = void;
+
+        size_t operator()(string_view const& value);
     };
 }
@@ -305,12 +305,16 @@ T& nstl::vector<T>::emplace_back(Args&&... args)
 template<typename T>
 void nstl::vector<T>::erase(T* first, T* last)
 {
-    NSTL_ASSERT(last == end()); // TODO implement erase properly
+    NSTL_ASSERT(begin() <= first && first <= last && last <= end());
+
+    // The elements after the range are moved into it, then the leftovers at the end are destroyed
+    T* destination = first;
+    for (T* source = last; source != end(); source++, destination++)
+        *destination = nstl::move(*source);
 
-    NSTL_ASSERT(first <= last);
     size_t erasedCount = static_cast<size_t>(last - first);
-    NSTL_ASSERT(size() >= erasedCount);
-    resize(size() - erasedCount);
+    for (size_t i = 0; i < erasedCount; i++)
+        pop_back();
 }
 
 template<typename T>
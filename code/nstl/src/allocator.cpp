@@ -7,6 +7,7 @@ nstl::any_allocator::any_allocator(any_allocator const& rhs)
     , m_destructStorage(rhs.m_destructStorage)
     , m_compare(rhs.m_compare)
     , m_copy(rhs.m_copy)
+    , m_move(rhs.m_move)
     , m_allocate(rhs.m_allocate)
     , m_deallocate(rhs.m_deallocate)
 {
@@ -19,16 +20,12 @@ nstl::any_allocator::any_allocator(any_allocator const& rhs)
 
 nstl::any_allocator::any_allocator(any_allocator&& rhs)
 {
-    any_allocator::swap(*this, rhs);
+    move_from(rhs);
 }
 
 nstl::any_allocator::~any_allocator()
 {
-    if (m_allocator)
-    {
-        NSTL_ASSERT(m_destructStorage);
-        m_destructStorage(this);
-    }
+    reset();
 }
 
 nstl::any_allocator& nstl::any_allocator::operator=(any_allocator const&)
@@ -41,7 +38,12 @@ nstl::any_allocator& nstl::any_allocator::operator=(any_allocator const&)
 
 nstl::any_allocator& nstl::any_allocator::operator=(any_allocator&& rhs)
 {
-    any_allocator::swap(*this, rhs);
+    if (this != &rhs)
+    {
+        reset();
+        move_from(rhs);
+    }
+
     return *this;
 }
 
@@ -76,12 +78,29 @@ bool nstl::any_allocator::operator==(any_allocator const& rhs) const
     return false;
 }
 
-void nstl::any_allocator::swap(any_allocator& lhs, any_allocator& rhs)
+void nstl::any_allocator::reset()
+{
+    if (m_allocator)
+    {
+        NSTL_ASSERT(m_destructStorage);
+        m_destructStorage(this);
+    }
+}
+
+void nstl::any_allocator::move_from(any_allocator& rhs)
 {
-    nstl::exchange(lhs.m_allocator, rhs.m_allocator);
-    nstl::exchange(lhs.m_destructStorage, rhs.m_destructStorage);
-    nstl::exchange(lhs.m_compare, rhs.m_compare);
-    nstl::exchange(lhs.m_copy, rhs.m_copy);
-    nstl::exchange(lhs.m_allocate, rhs.m_allocate);
-    nstl::exchange(lhs.m_deallocate, rhs.m_deallocate);
+    NSTL_ASSERT(m_allocator == nullptr);
+
+    m_destructStorage = rhs.m_destructStorage;
+    m_compare = rhs.m_compare;
+    m_copy = rhs.m_copy;
+    m_move = rhs.m_move;
+    m_allocate = rhs.m_allocate;
+    m_deallocate = rhs.m_deallocate;
+
+    if (rhs.m_allocator)
+    {
+        NSTL_ASSERT(m_move);
+        m_move(&rhs, this);
+    }
 }
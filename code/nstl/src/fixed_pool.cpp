@@ -0,0 +1,80 @@
+#include "nstl/fixed_pool.h"
+
+#include "nstl/alignment.h"
+#include "nstl/assert.h"
+#include "nstl/malloc_allocator.h"
+#include "nstl/new.h"
+#include "nstl/utility.h"
+
+nstl::fixed_pool::fixed_pool(size_t block_size, size_t block_alignment, size_t blocks_per_page, any_allocator upstream)
+    : m_upstream(upstream ? nstl::move(upstream) : malloc_allocator{})
+    , m_block_alignment(block_alignment > alignof(free_block) ? block_alignment : alignof(free_block))
+    , m_blocks_per_page(blocks_per_page)
+{
+    NSTL_ASSERT(is_power_of_2(block_alignment));
+    NSTL_ASSERT(blocks_per_page > 0);
+
+    // Free blocks store the free list link inside
+    size_t min_size = block_size > sizeof(free_block) ? block_size : sizeof(free_block);
+    m_block_size = align_up(min_size, m_block_alignment);
+}
+
+nstl::fixed_pool::~fixed_pool()
+{
+    NSTL_ASSERT(m_used_block_count == 0);
+
+    while (m_pages)
+    {
+        page_header* next = m_pages->next;
+        m_upstream.deallocate(m_pages);
+        m_pages = next;
+    }
+}
+
+void* nstl::fixed_pool::allocate()
+{
+    if (!m_free_blocks)
+        add_page();
+
+    NSTL_ASSERT(m_free_blocks);
+    free_block* block = m_free_blocks;
+    m_free_blocks = block->next;
+    m_used_block_count++;
+
+    return block;
+}
+
+void nstl::fixed_pool::deallocate(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    NSTL_ASSERT(m_used_block_count > 0);
+    m_used_block_count--;
+
+    m_free_blocks = new(nstl::new_tag{}, ptr) free_block{ .next = m_free_blocks };
+}
+
+void nstl::fixed_pool::add_page()
+{
+    size_t header_size = align_up(sizeof(page_header), m_block_alignment);
+    size_t page_alignment = m_block_alignment > alignof(page_header) ? m_block_alignment : alignof(page_header);
+
+    void* memory = m_upstream.allocate(header_size + m_block_size * m_blocks_per_page, page_alignment);
+    NSTL_ASSERT(memory);
+
+    m_pages = new(nstl::new_tag{}, memory) page_header{ .next = m_pages };
+
+    // Blocks are pushed in reverse so that they are handed out in the address order
+    char* blocks = static_cast<char*>(memory) + header_size;
+    for (size_t i = m_blocks_per_page; i > 0; i--)
+        m_free_blocks = new(nstl::new_tag{}, blocks + (i - 1) * m_block_size) free_block{ .next = m_free_blocks };
+}
+
+void* nstl::pool_allocator::allocate([[maybe_unused]] size_t size, [[maybe_unused]] size_t alignment)
+{
+    NSTL_ASSERT(size <= m_pool->get_block_size());
+    NSTL_ASSERT(alignment <= m_pool->get_block_alignment());
+
+    return m_pool->allocate();
+}
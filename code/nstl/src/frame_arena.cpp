@@ -0,0 +1,13 @@
+#include "nstl/frame_arena.h"
+
+nstl::frame_arena::frame_arena(size_t initial_capacity, any_allocator upstream)
+    : m_arenas{ monotonic_arena{ initial_capacity, upstream }, monotonic_arena{ initial_capacity, upstream } }
+{
+    static_assert(frame_count == 2);
+}
+
+void nstl::frame_arena::next_frame()
+{
+    m_current_index = (m_current_index + 1) % frame_count;
+    m_arenas[m_current_index].reset();
+}
@@ -2,47 +2,178 @@
 
 #include <string.h>
 
-size_t nstl::hash_string(char const* bytes, size_t size)
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#pragma intrinsic(_umul128)
+#endif
+
+namespace
 {
-    // djb2 from http://www.cse.yorku.ca/~oz/hash.html
+    // Based on wyhash final version 4 by Wang Yi: https://github.com/wangyi-fudan/wyhash
+
+    constexpr uint64_t secret[4] = { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull };
+
+    // 64x64->128 bit multiplication, the halves of the result are returned in a and b
+    void multiply(uint64_t& a, uint64_t& b)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        a = _umul128(a, b, &b);
+#else
+        __uint128_t r = static_cast<__uint128_t>(a) * b;
+        a = static_cast<uint64_t>(r);
+        b = static_cast<uint64_t>(r >> 64);
+#endif
+    }
+
+    uint64_t mix(uint64_t a, uint64_t b)
+    {
+        multiply(a, b);
+        return a ^ b;
+    }
 
-    size_t hash = 5381;
+    uint64_t read64(unsigned char const* p)
+    {
+        uint64_t v = 0;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
 
-    for (size_t i = 0; i < size; i++)
-        hash = hash * 33 + static_cast<size_t>(bytes[i]);
+    uint64_t read32(unsigned char const* p)
+    {
+        uint32_t v = 0;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
 
-    return hash;
+    // Reads 1 to 3 bytes
+    uint64_t read_small(unsigned char const* p, size_t size)
+    {
+        return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[size >> 1]) << 8) | p[size - 1];
+    }
+
+    uint64_t hash_integer(uint64_t value)
+    {
+        return mix(value ^ secret[0], secret[1]);
+    }
+}
+
+size_t nstl::hash_bytes(void const* data, size_t size)
+{
+    auto p = static_cast<unsigned char const*>(data);
+
+    uint64_t seed = mix(secret[0], secret[1]);
+    uint64_t a = 0;
+    uint64_t b = 0;
+
+    if (size <= 16)
+    {
+        if (size >= 4)
+        {
+            a = (read32(p) << 32) | read32(p + ((size >> 3) << 2));
+            b = (read32(p + size - 4) << 32) | read32(p + size - 4 - ((size >> 3) << 2));
+        }
+        else if (size > 0)
+        {
+            a = read_small(p, size);
+        }
+    }
+    else
+    {
+        size_t remaining = size;
+        if (remaining > 48)
+        {
+            uint64_t seed1 = seed;
+            uint64_t seed2 = seed;
+            do
+            {
+                seed = mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+                seed1 = mix(read64(p + 16) ^ secret[2], read64(p + 24) ^ seed1);
+                seed2 = mix(read64(p + 32) ^ secret[3], read64(p + 40) ^ seed2);
+                p += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+
+            seed ^= seed1 ^ seed2;
+        }
+
+        while (remaining > 16)
+        {
+            seed = mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+
+        a = read64(p + remaining - 16);
+        b = read64(p + remaining - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    multiply(a, b);
+
+    return static_cast<size_t>(mix(a ^ secret[0] ^ size, b ^ secret[1]));
+}
+
+size_t nstl::hash_string(char const* bytes, size_t size)
+{
+    return hash_bytes(bytes, size);
 }
 
 void nstl::hash_combine(size_t& hash, size_t hash2)
 {
-    hash ^= hash2 + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash = static_cast<size_t>(mix(hash ^ secret[0], hash2 ^ secret[2]));
 }
 
-#define DEFINE_POS_HASH(T) \
+#define DEFINE_INTEGER_HASH(T) \
     size_t nstl::hash<T>::operator()(T const& value) \
     { \
-        return hash_string(reinterpret_cast<char const*>(&value), sizeof(value)); \
-    }
-
-DEFINE_POS_HASH(void*);
-DEFINE_POS_HASH(bool);
-DEFINE_POS_HASH(char);
-DEFINE_POS_HASH(signed char);
-DEFINE_POS_HASH(unsigned char);
-DEFINE_POS_HASH(short);
-DEFINE_POS_HASH(unsigned short);
-DEFINE_POS_HASH(int);
-DEFINE_POS_HASH(unsigned int);
-DEFINE_POS_HASH(long);
-DEFINE_POS_HASH(unsigned long);
-DEFINE_POS_HASH(long long);
-DEFINE_POS_HASH(unsigned long long);
-DEFINE_POS_HASH(float);
-DEFINE_POS_HASH(double);
-DEFINE_POS_HASH(long double);
-
-#undef DEFINE_POS_HASH
+        return static_cast<size_t>(hash_integer(static_cast<uint64_t>(value))); \
+    }
+
+DEFINE_INTEGER_HASH(bool);
+DEFINE_INTEGER_HASH(char);
+DEFINE_INTEGER_HASH(signed char);
+DEFINE_INTEGER_HASH(unsigned char);
+DEFINE_INTEGER_HASH(short);
+DEFINE_INTEGER_HASH(unsigned short);
+DEFINE_INTEGER_HASH(int);
+DEFINE_INTEGER_HASH(unsigned int);
+DEFINE_INTEGER_HASH(long);
+DEFINE_INTEGER_HASH(unsigned long);
+DEFINE_INTEGER_HASH(long long);
+DEFINE_INTEGER_HASH(unsigned long long);
+
+#undef DEFINE_INTEGER_HASH
+
+size_t nstl::hash<void*>::operator()(void* const& value)
+{
+    return static_cast<size_t>(hash_integer(reinterpret_cast<uintptr_t>(value)));
+}
+
+size_t nstl::hash<float>::operator()(float const& value)
+{
+    // 0.0f and -0.0f compare equal, so they have to hash the same
+    float normalized = value == 0.0f ? 0.0f : value;
+
+    uint32_t bits = 0;
+    memcpy(&bits, &normalized, sizeof(bits));
+    return static_cast<size_t>(hash_integer(bits));
+}
+
+size_t nstl::hash<double>::operator()(double const& value)
+{
+    double normalized = value == 0.0 ? 0.0 : value;
+
+    uint64_t bits = 0;
+    memcpy(&bits, &normalized, sizeof(bits));
+    return static_cast<size_t>(hash_integer(bits));
+}
+
+size_t nstl::hash<long double>::operator()(long double const& value)
+{
+    // The representation might contain padding, so the value is hashed through double
+    return hash<double>{}(static_cast<double>(value));
+}
 
 namespace nstl
 {
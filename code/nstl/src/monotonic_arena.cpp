@@ -0,0 +1,101 @@
+#include "nstl/monotonic_arena.h"
+
+#include "nstl/alignment.h"
+#include "nstl/assert.h"
+#include "nstl/malloc_allocator.h"
+#include "nstl/new.h"
+#include "nstl/utility.h"
+
+namespace
+{
+    constexpr size_t chunk_alignment = alignof(max_align_t);
+}
+
+nstl::monotonic_arena::monotonic_arena(size_t initial_capacity, any_allocator upstream)
+    : m_upstream(upstream ? nstl::move(upstream) : malloc_allocator{})
+{
+    if (initial_capacity > 0)
+        add_chunk(initial_capacity);
+}
+
+nstl::monotonic_arena::~monotonic_arena()
+{
+    release_chunks();
+}
+
+void* nstl::monotonic_arena::allocate(size_t size, size_t alignment)
+{
+    NSTL_ASSERT(is_power_of_2(alignment));
+
+    if (size == 0)
+        return nullptr;
+
+    uint64_t address = align_up(reinterpret_cast<uintptr_t>(m_current), alignment);
+    if (!m_current || address + size > reinterpret_cast<uintptr_t>(m_end))
+    {
+        // Chunks grow geometrically so that the number of upstream allocations stays logarithmic
+        size_t chunk_size = m_capacity > size + alignment ? m_capacity : size + alignment;
+        add_chunk(chunk_size);
+        address = align_up(reinterpret_cast<uintptr_t>(m_current), alignment);
+        NSTL_ASSERT(address + size <= reinterpret_cast<uintptr_t>(m_end));
+    }
+
+    char* ptr = reinterpret_cast<char*>(address);
+    m_used_size += static_cast<size_t>(ptr + size - m_current);
+    m_current = ptr + size;
+
+    return ptr;
+}
+
+void nstl::monotonic_arena::reset()
+{
+    if (!m_chunks)
+        return;
+
+    if (m_chunks->next)
+    {
+        size_t capacity = m_capacity;
+        release_chunks();
+        add_chunk(capacity);
+    }
+
+    m_current = reinterpret_cast<char*>(m_chunks) + get_chunk_header_size();
+    m_end = m_current + m_chunks->size;
+    m_used_size = 0;
+}
+
+size_t nstl::monotonic_arena::get_chunk_header_size()
+{
+    return align_up(sizeof(chunk_header), chunk_alignment);
+}
+
+void nstl::monotonic_arena::add_chunk(size_t min_size)
+{
+    size_t header_size = get_chunk_header_size();
+    size_t size = align_up(min_size, chunk_alignment);
+
+    void* memory = m_upstream.allocate(header_size + size, chunk_alignment);
+    NSTL_ASSERT(memory);
+
+    chunk_header* chunk = new(nstl::new_tag{}, memory) chunk_header{ .next = m_chunks, .size = size };
+    m_chunks = chunk;
+
+    m_current = static_cast<char*>(memory) + header_size;
+    m_end = m_current + size;
+    m_capacity += size;
+}
+
+void nstl::monotonic_arena::release_chunks()
+{
+    while (m_chunks)
+    {
+        chunk_header* next = m_chunks->next;
+        m_upstream.deallocate(m_chunks);
+        m_chunks = next;
+    }
+
+    m_current = nullptr;
+    m_end = nullptr;
+    m_used_size = 0;
+    m_capacity = 0;
+}
@@ -1,19 +1,29 @@
 #include "nstl/string.h"
 
 #include "nstl/assert.h"
+#include "nstl/malloc_allocator.h"
 #include "nstl/string_view.h"
+#include "nstl/utility.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 size_t nstl::string::npos = static_cast<size_t>(-1);
 
-nstl::string::string(any_allocator alloc) : m_buffer(0, sizeof(char), alignof(char), nstl::move(alloc)) {}
+nstl::string::string(any_allocator alloc) : m_allocator(alloc ? nstl::move(alloc) : malloc_allocator{})
+{
+    static_assert(sizeof(heap_storage) == 3 * sizeof(void*));
+    static_assert(inline_capacity < heap_tag);
+
+    set_inline_size(0);
+}
 
 nstl::string::string(size_t length, any_allocator alloc) : string(nstl::move(alloc))
 {
     if (length == 0)
         return;
 
+    reserve(length);
     resize(length);
 }
 
@@ -24,30 +34,59 @@ nstl::string::string(string_view str, any_allocator alloc) : string(str.data(),
 nstl::string::string(char const* str, size_t length, any_allocator alloc) : string(length, nstl::move(alloc))
 {
     NSTL_ASSERT(str);
-    m_buffer.copy(str, length);
+    if (length > 0)
+        memcpy(data(), str, length);
 
     validateIsNullTerminated();
 }
 
+nstl::string::string(string const& rhs) : string(rhs.data(), rhs.length(), rhs.m_allocator) {}
+
+nstl::string::string(string&& rhs) : string()
+{
+    swap(rhs);
+}
+
+nstl::string::~string()
+{
+    release();
+}
+
+nstl::string& nstl::string::operator=(string const& rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    NSTL_ASSERT(m_allocator == rhs.m_allocator);
+
+    resize(0);
+    append(rhs.data(), rhs.length());
+    return *this;
+}
+
+nstl::string& nstl::string::operator=(string&& rhs)
+{
+    swap(rhs);
+    return *this;
+}
+
 size_t nstl::string::length() const
 {
-    if (m_buffer.size() > 0)
-        return m_buffer.size() - 1;
-    return 0;
+    if (is_inline())
+        return inline_capacity - static_cast<unsigned char>(m_inline[inline_capacity]);
+    return m_heap.size;
 }
 
 size_t nstl::string::size() const
 {
-    if (m_buffer.size() > 0)
-        return m_buffer.size() - 1;
-    return 0;
+    return length();
 }
 
 size_t nstl::string::capacity() const
 {
-    if (m_buffer.capacity() > 0)
-        return m_buffer.capacity() - 1;
-    return 0;
+    if (is_inline())
+        return inline_capacity;
+    return m_heap.capacity;
 }
 
 int nstl::string::slength() const
@@ -62,61 +101,56 @@ bool nstl::string::empty() const
 
 void nstl::string::reserve(size_t capacity)
 {
-    validateIsNullTerminated();
-
-    size_t requiredBufferSize = capacity + 1;
-
-    if (requiredBufferSize > m_buffer.capacity())
-    {
-        // TODO don't copy allocator
-        buffer buffer{ requiredBufferSize, sizeof(char), alignof(char), m_buffer.get_allocator()};
-        buffer.copy(m_buffer.data(), length());
-        *buffer.get(length()) = '\0';
-        buffer.resize(m_buffer.size());
-        m_buffer = nstl::move(buffer);
-    }
+    if (capacity > this->capacity())
+        grow(capacity);
 
     validateIsNullTerminated();
 }
 
 char const* nstl::string::c_str() const
 {
-    return m_buffer.data();
+    return data();
 }
 
 char* nstl::string::data()
 {
-    return m_buffer.data();
+    return is_inline() ? m_inline : m_heap.data;
 }
 
 char const* nstl::string::data() const
 {
-    return m_buffer.data();
+    return is_inline() ? m_inline : m_heap.data;
 }
 
 char& nstl::string::back()
 {
     NSTL_ASSERT(!empty());
-    return *m_buffer.get(length() - 1);
+    return data()[length() - 1];
 }
 
 char const& nstl::string::back() const
 {
     NSTL_ASSERT(!empty());
-    return *m_buffer.get(length() - 1);
+    return data()[length() - 1];
 }
 
 void nstl::string::resize(size_t newSize)
 {
     validateIsNullTerminated();
 
-    reserve(newSize);
-    NSTL_ASSERT(m_buffer.capacity() >= newSize + 1);
+    size_t oldCapacity = capacity();
+    if (newSize > oldCapacity)
+    {
+        // Grow geometrically so that repeated appends don't reallocate every time
+        size_t newCapacity = newSize > 2 * oldCapacity ? newSize : 2 * oldCapacity;
+        if (newCapacity > max_heap_capacity && newSize <= max_heap_capacity)
+            newCapacity = max_heap_capacity;
 
-    m_buffer.resize(newSize + 1);
-    *m_buffer.get(newSize) = '\0';
+        grow(newCapacity);
+    }
 
-    NSTL_ASSERT(m_buffer.size() == newSize + 1);
+    NSTL_ASSERT(capacity() >= newSize);
+    set_size(newSize);
 
     validateIsNullTerminated();
 }
@@ -125,9 +159,12 @@ void nstl::string::append(char const* str, size_t length)
 {
     validateIsNullTerminated();
 
+    if (length == 0)
+        return;
+
     size_t oldSize = this->length();
     resize(oldSize + length);
-    memcpy(m_buffer.data() + oldSize, str, length);
+    memcpy(data() + oldSize, str, length);
 
     validateIsNullTerminated();
 }
@@ -149,14 +186,12 @@ nstl::string nstl::string::substr(size_t offset, size_t length) const
 
 char* nstl::string::begin()
 {
-    NSTL_ASSERT(m_buffer.size() != 0);
-    return m_buffer.data();
+    return data();
 }
 
 char const* nstl::string::begin() const
 {
-    NSTL_ASSERT(m_buffer.size() != 0);
-    return m_buffer.data();
+    return data();
 }
 
 char* nstl::string::end()
@@ -225,14 +260,77 @@ nstl::string::operator nstl::string_view() const
     return string_view{ c_str(), length() };
 }
 
-void nstl::string::validateIsNullTerminated()
+bool nstl::string::is_inline() const
+{
+    return static_cast<unsigned char>(m_inline[inline_capacity]) != heap_tag;
+}
+
+void nstl::string::set_inline_size(size_t size)
 {
-    if (m_buffer.size() > 0)
+    NSTL_ASSERT(size <= inline_capacity);
+
+    m_inline[size] = '\0';
+    m_inline[inline_capacity] = static_cast<char>(inline_capacity - size);
+}
+
+void nstl::string::set_size(size_t size)
+{
+    if (is_inline())
+    {
+        set_inline_size(size);
+    }
+    else
     {
-        NSTL_ASSERT(*end() == '\0');
+        m_heap.size = size;
+        m_heap.data[size] = '\0';
     }
 }
 
+void nstl::string::grow(size_t min_capacity)
+{
+    NSTL_ASSERT(min_capacity > capacity());
+
+    // Unlike the asserts, this check is never compiled out: a truncated capacity would let the following appends write past the allocation
+    if (min_capacity > max_heap_capacity)
+        abort();
+
+    size_t size = length();
+    char* new_data = static_cast<char*>(m_allocator.allocate(min_capacity + 1, alignof(char)));
+    NSTL_ASSERT(new_data);
+    memcpy(new_data, data(), size + 1);
+
+    release();
+
+    m_heap.data = new_data;
+    m_heap.size = size;
+    m_heap.capacity = static_cast<uint32_t>(min_capacity);
+    m_heap.tag = heap_tag;
+}
+
+void nstl::string::release()
+{
+    if (!is_inline())
+        m_allocator.deallocate(m_heap.data);
+
+    set_inline_size(0);
+}
+
+void nstl::string::swap(string& rhs)
+{
+    nstl::exchange(m_allocator, rhs.m_allocator);
+
+    // Neither representation points into the object itself, so the storage can be swapped bytewise
+    char temp[storage_size];
+    memcpy(temp, m_inline, storage_size);
+    memcpy(m_inline, rhs.m_inline, storage_size);
+    memcpy(rhs.m_inline, temp, storage_size);
+}
+
+void nstl::string::validateIsNullTerminated()
+{
+    NSTL_ASSERT(*end() == '\0');
+}
+
 nstl::string nstl::operator+(string lhs, char rhs)
 {
     return lhs += rhs;
@@ -253,7 +351,7 @@ nstl::string nstl::operator+(string lhs, string_view const& rhs)
     return lhs += rhs;
 }
 
-size_t nstl::hash<nstl::string>::operator()(string const& value)
+size_t nstl::hash<nstl::string>::operator()(string_view const& value)
 {
     return hash<string_view>{}(value);
 }
@@ -7,8 +7,7 @@
 #include "picofmt/detail/simple_string_view.h"
 #include "picofmt/detail/core_impl.h"
 #include "picofmt/detail/context_base.h"
-
-// TODO add constexpr validation
+#include "picofmt/detail/format_string_parser.h"
 
 namespace picofmt
 {
@@ -34,60 +33,148 @@ namespace picofmt
         }
 
         template<formattable T>
-        class any_arg_impl : public any_arg
+        format_arg_result format_any_arg(void const* value, simple_string_view specifier, context& ctx)
         {
-        public:
-            any_arg_impl(T const& value) : m_value(value) {}
-
-            bool parse(simple_string_view specifier, context& ctx) override
-            {
-                return m_formatter.parse(to_string_view(specifier), ctx);
-            }
-
-            bool try_get_int(int& value) const override
-            {
-                // TODO use "is convertible to int" trait
-                if constexpr (is_integer_v<T>)
-                {
-                    value = static_cast<int>(m_value);
-                    return true;
-                }
-                else
-                {
-                    return false;
-                }
-            }
-
-            bool format(context& ctx) const override
-            {
-                return m_formatter.format(m_value, ctx);
-            }
-
-        private:
-            T const& m_value;
-            formatter<T> m_formatter;
-        };
+            formatter<T> value_formatter;
+
+            if (!value_formatter.parse(to_string_view(specifier), ctx))
+                return format_arg_result::invalid_specifier;
+
+            if (!value_formatter.format(*static_cast<T const*>(value), ctx))
+                return format_arg_result::format_error;
+
+            return format_arg_result::success;
+        }
+
+        template<typename T>
+        bool get_any_arg_int(void const* value, int& result)
+        {
+            // TODO use "is convertible to int" trait
+            result = static_cast<int>(*static_cast<T const*>(value));
+            return true;
+        }
+
+        template<formattable T>
+        any_arg make_any_arg(T const& value)
+        {
+            any_arg arg{ &value, &format_any_arg<T>, nullptr };
+
+            if constexpr (is_integer_v<T>)
+                arg.get_int = &get_any_arg_int<T>;
+
+            return arg;
+        }
     }
 
     template<typename... Ts>
     args_list::args_list(Ts const& ... args)
         : m_size(sizeof...(args))
-        , m_args(new detail::any_arg*[m_size])
     {
+        static_assert(sizeof...(Ts) <= max_size, "Too many format arguments");
+
         size_t i = 0;
-        ((m_args[i++] = new detail::any_arg_impl<Ts>(args)), ...);
+        ((m_args[i++] = detail::make_any_arg(args)), ...);
     }
 
     //////////////////////////////////////////////////////////////////////////
 
-    inline bool vformat_to(writer& writer, string_view fmt, args_list const& args)
+    template<typename T>
+    struct type_identity
+    {
+        using type = T;
+    };
+
+    template<typename T>
+    using type_identity_t = typename type_identity<T>::type;
+
+    // Opts out of the compile-time validation for format strings that aren't known at compile time
+    struct runtime_format_string
+    {
+        string_view str;
+    };
+
+    inline runtime_format_string runtime(string_view str)
+    {
+        return { str };
+    }
+
+    // Type-erased reference to either a pre-parsed format string or a plain one that is parsed while formatting
+    class format_string_view
+    {
+    public:
+        format_string_view(string_view str) : m_str(str.data(), str.length()) {}
+        format_string_view(detail::simple_string_view str, detail::format_segment const* segments, size_t segment_count) : m_str(str), m_segments(segments), m_segment_count(segment_count) {}
+
+        detail::simple_string_view str() const { return m_str; }
+        detail::format_segment const* segments() const { return m_segments; } // nullptr if the string wasn't pre-parsed
+        size_t segment_count() const { return m_segment_count; }
+
+    private:
+        detail::simple_string_view m_str;
+        detail::format_segment const* m_segments = nullptr;
+        size_t m_segment_count = 0;
+    };
+
+    namespace detail
+    {
+        // Deliberately not constexpr: reaching it during constant evaluation makes the error a compile error
+        inline void format_string_error(char const*) {}
+    }
+
+    // Format string that is validated against the argument types and split into segments at compile time
+    template<typename... Ts>
+    class basic_format_string
+    {
+    public:
+        template<size_t N>
+        consteval basic_format_string(char const (&str)[N]) : m_str(str, N - 1)
+        {
+            constexpr bool integer_args[] = { detail::is_integer_v<Ts>..., false };
+
+            detail::format_string_parse_result result = detail::parse_format_string(str, N - 1, integer_args, sizeof...(Ts), m_segments, segment_capacity);
+            if (result.error)
+                detail::format_string_error(result.error);
+
+            m_segment_count = result.segment_count;
+        }
+
+        basic_format_string(runtime_format_string str) : m_str(str.str.data(), str.str.length()), m_segment_count(static_cast<size_t>(-1)) {}
+
+        string_view get() const { return string_view{ m_str.data, m_str.length }; }
+
+        operator format_string_view() const
+        {
+            // Strings that reuse the arguments a lot might not fit, those are parsed while formatting
+            if (m_segment_count > segment_capacity)
+                return format_string_view{ m_str, nullptr, 0 };
+
+            return format_string_view{ m_str, m_segments, m_segment_count };
+        }
+
+    private:
+        // Enough for every argument to be used once with literal text around each of them
+        inline static constexpr size_t segment_capacity = 2 * sizeof...(Ts) + 1;
+
+        detail::simple_string_view m_str;
+        detail::format_segment m_segments[segment_capacity] = {};
+        size_t m_segment_count = 0;
+    };
+
+    template<typename... Ts>
+    using format_string = basic_format_string<type_identity_t<Ts>...>;
+
+    inline bool vformat_to(writer& writer, format_string_view fmt, args_list const& args)
     {
         context ctx{ writer, args };
-        return detail::vformat_to(detail::simple_string_view{ fmt.data(), fmt.length() }, ctx);
+
+        if (fmt.segments())
+            return detail::vformat_to(fmt.str(), fmt.segments(), fmt.segment_count(), ctx);
+
+        return detail::vformat_to(fmt.str(), ctx);
     }
 
     template<formattable... Ts>
-    bool format_to(writer& writer, string_view fmt, Ts const&... args)
+    bool format_to(writer& writer, format_string<Ts...> fmt, Ts const&... args)
     {
         return vformat_to(writer, fmt, args_list{ args... });
     }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stddef.h>
+
 namespace picofmt
 {
     class args_list;
@@ -9,35 +11,52 @@ namespace picofmt
     {
         class context_base;
         struct simple_string_view;
+        struct format_segment;
 
-        class any_arg
+        enum class format_arg_result
         {
-        public:
-            virtual ~any_arg() = default;
-            virtual bool parse(simple_string_view specifier, context& ctx) = 0;
-            virtual bool try_get_int(int& value) const = 0;
-            virtual bool format(context& ctx) const = 0;
+            success,
+            invalid_specifier,
+            format_error,
+        };
+
+        // Type-erased reference to a single argument. The formatter only lives on the stack
+        // for the duration of `format`, so the argument list doesn't need any allocations
+        struct any_arg
+        {
+            using format_func = format_arg_result(*)(void const* value, simple_string_view specifier, context& ctx);
+            using get_int_func = bool(*)(void const* value, int& result);
+
+            void const* value;
+            format_func format;
+            get_int_func get_int; // nullptr if the argument isn't an integer
         };
 
         bool vformat_to(simple_string_view fmt, context_base& ctx);
+        bool vformat_to(simple_string_view fmt, format_segment const* segments, size_t segment_count, context_base& ctx);
     }
 
     class args_list
     {
         friend bool detail::vformat_to(detail::simple_string_view fmt, detail::context_base& ctx);
+        friend bool detail::vformat_to(detail::simple_string_view fmt, detail::format_segment const* segments, size_t segment_count, detail::context_base& ctx);
 
     public:
+        inline static constexpr size_t max_size = 16;
+
         template<typename... Ts> args_list(Ts const& ... args); // implemented in core.h because it depends on the user-specified type
-        ~args_list();
+
+        args_list(args_list const&) = delete;
+        args_list& operator=(args_list const&) = delete;
 
         size_t size() const { return m_size; }
         bool try_get_int(size_t index, int& value) const;
 
     private:
-        detail::any_arg& operator[](size_t index) const;
+        detail::any_arg const& operator[](size_t index) const;
 
     private:
-        size_t const m_size = 0;
-        detail::any_arg** const m_args = nullptr;
+        size_t m_size = 0;
+        detail::any_arg m_args[max_size]; // Only the first `m_size` are initialized
     };
 }
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace picofmt::detail
+{
+    // Either a piece of literal text or a replacement field; offsets point into the format string
+    struct format_segment
+    {
+        inline static constexpr uint32_t literal = static_cast<uint32_t>(-1);
+
+        uint32_t arg_index = literal;
+        uint32_t offset = 0; // Literal text or the format specifier of the replacement field
+        uint32_t length = 0;
+    };
+
+    struct format_string_parse_result
+    {
+        char const* error = nullptr;
+        size_t segment_count = 0; // Might be larger than the capacity, in which case the segments are incomplete
+    };
+
+    constexpr bool parse_constexpr_index(char const* str, size_t length, size_t& value)
+    {
+        if (length == 0)
+            return false;
+
+        size_t result = 0;
+        for (size_t i = 0; i < length; i++)
+        {
+            if (str[i] < '0' || str[i] > '9')
+                return false;
+
+            size_t digit = static_cast<size_t>(str[i] - '0');
+            if (result > (static_cast<size_t>(-1) - digit) / 10)
+                return false;
+
+            result = result * 10 + digit;
+        }
+
+        value = result;
+        return true;
+    }
+
+    // Mirrors the runtime parsing in vformat_to() and parse_dynamic_param() so that
+    // the argument ids are resolved in exactly the same order
+    constexpr format_string_parse_result parse_format_string(char const* fmt, size_t length, bool const* integer_args, size_t arg_count, format_segment* segments, size_t capacity)
+    {
+        format_string_parse_result result;
+
+        auto add_segment = [&](uint32_t arg_index, size_t offset, size_t segment_length) {
+            if (result.segment_count < capacity)
+                segments[result.segment_count] = { arg_index, static_cast<uint32_t>(offset), static_cast<uint32_t>(segment_length) };
+            result.segment_count++;
+        };
+
+        size_t next_arg_id = 0;
+        size_t pos = 0;
+
+        while (pos < length)
+        {
+            size_t begin = pos;
+            while (begin < length && fmt[begin] != '{')
+                begin++;
+
+            if (begin == length)
+                break;
+
+            if (begin > pos)
+                add_segment(format_segment::literal, pos, begin - pos);
+
+            size_t end = begin + 1;
+            size_t depth = 1;
+            for (; end < length; end++)
+            {
+                if (fmt[end] == '{')
+                    depth++;
+                if (fmt[end] == '}' && --depth == 0)
+                    break;
+            }
+
+            if (end == length)
+            {
+                result.error = "Unmatched '{' in format spec";
+                return result;
+            }
+
+            size_t field_begin = begin + 1;
+            size_t delimiter_pos = field_begin;
+            while (delimiter_pos < end && fmt[delimiter_pos] != ':')
+                delimiter_pos++;
+
+            size_t arg_index = next_arg_id;
+            if (delimiter_pos > field_begin && !parse_constexpr_index(fmt + field_begin, delimiter_pos - field_begin, arg_index))
+            {
+                result.error = "Invalid argument id";
+                return result;
+            }
+
+            if (arg_index >= arg_count)
+            {
+                result.error = "Argument id is out of range";
+                return result;
+            }
+
+            next_arg_id = arg_index + 1;
+
+            size_t spec_begin = delimiter_pos < end ? delimiter_pos + 1 : end;
+
+            // Dynamic width and precision
+            for (size_t i = spec_begin; i < end; i++)
+            {
+                if (fmt[i] != '{')
+                    continue;
+
+                size_t closing_pos = i + 1;
+                while (closing_pos < end && fmt[closing_pos] != '}')
+                    closing_pos++;
+
+                size_t dynamic_arg_index = next_arg_id;
+                if (closing_pos > i + 1 && !parse_constexpr_index(fmt + i + 1, closing_pos - i - 1, dynamic_arg_index))
+                {
+                    result.error = "Invalid argument id";
+                    return result;
+                }
+
+                if (dynamic_arg_index >= arg_count || !integer_args[dynamic_arg_index])
+                {
+                    result.error = "Argument not found or not an integer";
+                    return result;
+                }
+
+                next_arg_id = dynamic_arg_index + 1;
+                i = closing_pos;
+            }
+
+            add_segment(static_cast<uint32_t>(arg_index), spec_begin, end - spec_begin);
+
+            pos = end + 1;
+        }
+
+        if (pos < length)
+            add_segment(format_segment::literal, pos, length - pos);
+
+        return result;
+    }
+}
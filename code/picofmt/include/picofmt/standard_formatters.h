@@ -69,7 +69,12 @@ namespace picofmt
     {
         bool format(char const (&value)[N], context& ctx) const
         {
-            return formatter<detail::simple_string_view>::format({ value, N }, ctx);
+            // String literals include the null terminator, which shouldn't be written
+            size_t length = 0;
+            while (length < N && value[length] != '\0')
+                length++;
+
+            return formatter<detail::simple_string_view>::format({ value, length }, ctx);
         }
     };
 }
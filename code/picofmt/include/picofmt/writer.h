@@ -5,6 +5,8 @@
 #include "picofmt/detail/writer_base.h"
 #include "picofmt/detail/simple_string_view.h"
 
+#include <string.h>
+
 namespace picofmt
 {
     // TODO rename to io_handler or something similar?
@@ -15,12 +17,22 @@ namespace picofmt
         virtual bool write(string_view str) = 0;
         virtual void report_error(string_view str) = 0;
 
+        // Writes the fill characters in chunks; writers that can do better should override it
         bool write(char c, size_t count) override
         {
-            string_view fill{ &c, 1 };
-            for (size_t i = 0; i < count; i++)
-                if (!write(fill))
+            constexpr size_t chunk_size = 64;
+
+            char chunk[chunk_size];
+            memset(chunk, c, count < chunk_size ? count : chunk_size);
+
+            while (count > 0)
+            {
+                size_t length = count < chunk_size ? count : chunk_size;
+                if (!write(string_view{ chunk, length }))
                     return false;
+                count -= length;
+            }
+
             return true;
         }
 
@@ -5,10 +5,31 @@
 #include "picofmt/detail/simple_string_view.h"
 #include "picofmt/detail/context_base.h"
 #include "picofmt/detail/util.h"
+#include "picofmt/detail/format_string_parser.h"
 
 #include <string.h>
 #include <assert.h>
 
+namespace
+{
+    bool format_arg(picofmt::detail::any_arg const& arg, picofmt::detail::simple_string_view specifier, picofmt::detail::context_base& ctx)
+    {
+        switch (arg.format(arg.value, specifier, ctx.get_user_context()))
+        {
+        case picofmt::detail::format_arg_result::success:
+            return true;
+        case picofmt::detail::format_arg_result::invalid_specifier:
+            ctx.report_error("Invalid format specifier"); // TODO include `specifier`
+            return false;
+        case picofmt::detail::format_arg_result::format_error:
+            ctx.report_error("Unable to format argument");
+            return false;
+        }
+
+        return false;
+    }
+}
+
 bool picofmt::detail:: vformat_to(simple_string_view fmt, context_base& ctx)
 {
     simple_string_view rest = fmt;
@@ -63,19 +84,16 @@ bool picofmt::detail:: vformat_to(simple_string_view fmt, context_base& ctx)
             }
         }
 
-        ctx.consume_arg(arg_index);
-
-        if (!ctx.args[arg_index].parse(format_spec_str, ctx.get_user_context()))
+        if (arg_index >= ctx.args.size())
         {
-            ctx.report_error("Invalid format specifier"); // TODO include `format_spec_str`
+            ctx.report_error("Argument id is out of range");
             return false;
         }
 
-        if (!ctx.args[arg_index].format(ctx.get_user_context()))
-        {
-            ctx.report_error("Unable to format argument"); // TODO include `arg_index`
+        ctx.consume_arg(arg_index);
+
+        if (!format_arg(ctx.args[arg_index], format_spec_str, ctx))
             return false;
-        }
     }
 
     if (!rest.empty())
@@ -85,12 +103,32 @@ bool picofmt::detail:: vformat_to(simple_string_view fmt, context_base& ctx)
     return true;
 }
 
-picofmt::args_list::~args_list()
+bool picofmt::detail::vformat_to(simple_string_view fmt, format_segment const* segments, size_t segment_count, context_base& ctx)
 {
-    for (size_t i = 0; i < m_size; i++)
-        delete m_args[i];
+    // The format string was validated at compile time, so only the format specifiers are left to parse
 
-    delete[] m_args;
+    for (size_t i = 0; i < segment_count; i++)
+    {
+        format_segment const& segment = segments[i];
+        simple_string_view str{ fmt.data + segment.offset, segment.length };
+
+        if (segment.arg_index == format_segment::literal)
+        {
+            if (!ctx.write(str))
+                return false;
+
+            continue;
+        }
+
+        size_t arg_index = segment.arg_index;
+
+        ctx.consume_arg(arg_index);
+
+        if (!format_arg(ctx.args[arg_index], str, ctx))
+            return false;
+    }
+
+    return true;
 }
 
 bool picofmt::args_list::try_get_int(size_t index, int& value) const
@@ -98,12 +136,14 @@ bool picofmt::args_list::try_get_int(size_t index, int& value) const
     if (index >= m_size)
         return false;
 
-    return m_args[index]->try_get_int(value);
+    if (!m_args[index].get_int)
+        return false;
+
+    return m_args[index].get_int(m_args[index].value, value);
 }
 
-picofmt::detail::any_arg& picofmt::args_list::operator[](size_t index) const
+picofmt::detail::any_arg const& picofmt::args_list::operator[](size_t index) const
 {
     assert(index < m_size);
-    assert(m_args[index]);
-    return *m_args[index];
+    return m_args[index];
 }
@@ -5,7 +5,8 @@
 #include "picofmt/detail/simple_string_view.h"
 #include "picofmt/detail/context_base.h"
 
-#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
 #include <assert.h>
 
 bool picofmt::detail::parse_index(simple_string_view str, size_t& value)
@@ -19,39 +20,27 @@ bool picofmt::detail::parse_index(simple_string_view str, size_t& value)
 
 bool picofmt::detail::parse_index(simple_string_view str, size_t& parsed_chars, size_t& value)
 {
-    if (str.empty())
-    {
-        parsed_chars = 0;
-        return false;
-    }
-
-    // TODO don't allocate and don't use strtoXXX
-
-    char* null_terminated_str = new char[str.length + 1];
-
-    memcpy(null_terminated_str, str.data, str.length);
-    null_terminated_str[str.length] = '\0';
+    parsed_chars = 0;
 
-    errno = 0;
-
-    char* parsed_end = nullptr;
-    unsigned long long raw_value = strtoull(null_terminated_str, &parsed_end, 10);
-
-    assert(parsed_end >= null_terminated_str);
-    parsed_chars = static_cast<size_t>(parsed_end - null_terminated_str);
+    bool overflow = false;
+    size_t result = 0;
+    while (parsed_chars < str.length && str[parsed_chars] >= '0' && str[parsed_chars] <= '9')
+    {
+        size_t digit = static_cast<size_t>(str[parsed_chars] - '0');
+        if (result > (SIZE_MAX - digit) / 10)
+            overflow = true;
 
-    delete[] null_terminated_str;
+        result = result * 10 + digit;
+        parsed_chars++;
+    }
 
     if (parsed_chars == 0)
         return false;
 
-    if (errno == ERANGE)
-        return false;
-
-    if (raw_value > SIZE_MAX)
+    if (overflow)
         return false;
 
-    value = static_cast<size_t>(raw_value);
+    value = result;
 
     return true;
 }
@@ -1,8 +1,24 @@
 #pragma once
 
+#include "nstl/span.h"
+#include "nstl/string.h"
 #include "nstl/string_view.h"
 
 namespace platform
 {
     void debug_output(nstl::string_view str);
+
+    // Returns the number of written frames; skip_count doesn't include capture_callstack itself
+    size_t capture_callstack(nstl::span<void*> frames, size_t skip_count);
+    nstl::string symbolize_address(void* address);
+
+    // The handler is called on fatal signals or unhandled exceptions, before the process terminates.
+    // It runs in a signal handler context, so it should only do a minimal amount of work
+    using crash_handler_t = void(*)();
+    void set_crash_handler(crash_handler_t handler);
+
+    // Output for crash handlers: the file is opened up front and writing to it doesn't allocate or take locks.
+    // Until a file is opened the output goes to stderr
+    [[nodiscard]] bool open_crash_output(nstl::string_view path);
+    void write_crash_output(char const* data, size_t size);
 }
@@ -3,6 +3,8 @@
 #include "nstl/aligned_storage.h"
 #include "nstl/string_view.h"
 #include "nstl/optional.h"
+#include "nstl/string.h"
+#include "nstl/vector.h"
 
 #include <stdint.h>
 
@@ -16,6 +18,14 @@ namespace platform
     using file_storage_t = nstl::aligned_storage_t<8, 8>;
 
     void create_directory(nstl::string_view path);
+    [[nodiscard]] bool remove_directory(nstl::string_view path); // Only removes empty directories
+
+    // Names of the directory entries, excluding "." and ".."
+    [[nodiscard]] nstl::vector<nstl::string> list_directory(nstl::string_view path);
+
+    // Replaces the destination file if it exists
+    [[nodiscard]] bool rename_file(nstl::string_view from, nstl::string_view to);
+    [[nodiscard]] bool remove_file(nstl::string_view path);
 
     [[nodiscard]] bool open_file(file_storage_t& storage, nstl::string_view filename, fs::open_mode mode);
     void close_file(file_storage_t& storage);
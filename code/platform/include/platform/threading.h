@@ -2,6 +2,7 @@
 
 #include "nstl/aligned_storage.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
 namespace nstl
@@ -31,4 +32,15 @@ namespace platform
     void mutex_destroy(mutex_storage_t& storage);
     void mutex_lock(mutex_storage_t& storage);
     void mutex_unlock(mutex_storage_t& storage);
+
+    // Condition variable, waits on a mutex created with mutex_create()
+    using condition_variable_storage_t = nstl::aligned_storage_t<48, 8>;
+
+    [[nodiscard]] bool condition_variable_create(condition_variable_storage_t& storage);
+    void condition_variable_destroy(condition_variable_storage_t& storage);
+    void condition_variable_wait(condition_variable_storage_t& storage, mutex_storage_t& mutex);
+    void condition_variable_notify_one(condition_variable_storage_t& storage);
+    void condition_variable_notify_all(condition_variable_storage_t& storage);
+
+    size_t get_hardware_thread_count();
 }
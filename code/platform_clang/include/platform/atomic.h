@@ -6,4 +6,54 @@ namespace platform
     {
         return __atomic_fetch_add(&dest, 1, __ATOMIC_RELAXED);
     }
+
+    inline uint64_t atomic_fetch_add(uint64_t volatile& dest, uint64_t value)
+    {
+        return __atomic_fetch_add(&dest, value, __ATOMIC_SEQ_CST);
+    }
+
+    inline uint64_t atomic_load_relaxed(uint64_t volatile const& src)
+    {
+        return __atomic_load_n(&src, __ATOMIC_RELAXED);
+    }
+
+    inline uint64_t atomic_load_acquire(uint64_t volatile const& src)
+    {
+        return __atomic_load_n(&src, __ATOMIC_ACQUIRE);
+    }
+
+    inline void atomic_store_relaxed(uint64_t volatile& dest, uint64_t value)
+    {
+        __atomic_store_n(&dest, value, __ATOMIC_RELAXED);
+    }
+
+    inline void atomic_store_release(uint64_t volatile& dest, uint64_t value)
+    {
+        __atomic_store_n(&dest, value, __ATOMIC_RELEASE);
+    }
+
+    inline uint64_t atomic_exchange(uint64_t volatile& dest, uint64_t value)
+    {
+        return __atomic_exchange_n(&dest, value, __ATOMIC_SEQ_CST);
+    }
+
+    inline bool atomic_compare_exchange(uint64_t volatile& dest, uint64_t& expected, uint64_t desired)
+    {
+        return __atomic_compare_exchange_n(&dest, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    }
+
+    inline void* atomic_load_acquire(void* volatile const& src)
+    {
+        return __atomic_load_n(&src, __ATOMIC_ACQUIRE);
+    }
+
+    inline bool atomic_compare_exchange(void* volatile& dest, void*& expected, void* desired)
+    {
+        return __atomic_compare_exchange_n(&dest, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    }
+
+    inline void atomic_thread_fence()
+    {
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    }
 }
@@ -1,8 +1,16 @@
 #pragma once
 
 #include <atomic>
+#include <intrin.h>
 
 #pragma intrinsic (_InterlockedIncrement64)
+#pragma intrinsic (_InterlockedExchangeAdd64)
+#pragma intrinsic (_InterlockedExchange64)
+#pragma intrinsic (_InterlockedCompareExchange64)
+#pragma intrinsic (_InterlockedCompareExchangePointer)
+#pragma intrinsic (_ReadWriteBarrier)
+
+// Aligned 64-bit loads and stores are atomic on x64, so only the compiler reordering has to be prevented
 
 namespace platform
 {
@@ -11,4 +19,69 @@ namespace platform
         int64_t volatile& signed_dest = reinterpret_cast<int64_t volatile&>(dest);
         return _InterlockedIncrement64(&signed_dest) - 1; // _InterlockedIncrement64 returns incremented value
     }
+
+    inline uint64_t atomic_fetch_add(uint64_t volatile& dest, uint64_t value)
+    {
+        int64_t volatile& signed_dest = reinterpret_cast<int64_t volatile&>(dest);
+        return static_cast<uint64_t>(_InterlockedExchangeAdd64(&signed_dest, static_cast<int64_t>(value)));
+    }
+
+    inline uint64_t atomic_load_relaxed(uint64_t volatile const& src)
+    {
+        return src;
+    }
+
+    inline uint64_t atomic_load_acquire(uint64_t volatile const& src)
+    {
+        uint64_t value = src;
+        _ReadWriteBarrier();
+        return value;
+    }
+
+    inline void atomic_store_relaxed(uint64_t volatile& dest, uint64_t value)
+    {
+        dest = value;
+    }
+
+    inline void atomic_store_release(uint64_t volatile& dest, uint64_t value)
+    {
+        _ReadWriteBarrier();
+        dest = value;
+    }
+
+    inline uint64_t atomic_exchange(uint64_t volatile& dest, uint64_t value)
+    {
+        int64_t volatile& signed_dest = reinterpret_cast<int64_t volatile&>(dest);
+        return static_cast<uint64_t>(_InterlockedExchange64(&signed_dest, static_cast<int64_t>(value)));
+    }
+
+    inline bool atomic_compare_exchange(uint64_t volatile& dest, uint64_t& expected, uint64_t desired)
+    {
+        int64_t volatile& signed_dest = reinterpret_cast<int64_t volatile&>(dest);
+        uint64_t previous = static_cast<uint64_t>(_InterlockedCompareExchange64(&signed_dest, static_cast<int64_t>(desired), static_cast<int64_t>(expected)));
+        bool succeeded = previous == expected;
+        expected = previous;
+        return succeeded;
+    }
+
+    inline void* atomic_load_acquire(void* volatile const& src)
+    {
+        void* value = src;
+        _ReadWriteBarrier();
+        return value;
+    }
+
+    inline bool atomic_compare_exchange(void* volatile& dest, void*& expected, void* desired)
+    {
+        void* previous = _InterlockedCompareExchangePointer(&dest, desired, expected);
+        bool succeeded = previous == expected;
+        expected = previous;
+        return succeeded;
+    }
+
+    inline void atomic_thread_fence()
+    {
+        _ReadWriteBarrier();
+        _mm_mfence();
+    }
 }
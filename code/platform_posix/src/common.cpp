@@ -0,0 +1,14 @@
+#include "common.h"
+
+#include <string.h>
+
+platform_posix::error platform_posix::get_last_error()
+{
+    int code = errno;
+
+    error e;
+    e.code = code;
+    e.message = strerror(code); // TODO use strerror_r?
+
+    return e;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <errno.h>
+
+#include "nstl/string.h"
+
+namespace platform_posix
+{
+    struct error
+    {
+        int code;
+        nstl::string message;
+    };
+
+    error get_last_error();
+}
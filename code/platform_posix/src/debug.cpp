@@ -0,0 +1,125 @@
+#include "platform/debug.h"
+
+#include "nstl/sprintf.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace
+{
+    platform::crash_handler_t crash_handler = nullptr;
+    int crash_output_fd = STDERR_FILENO;
+
+    // write() is async-signal-safe, so this can be used from the crash handler
+    void write_all(int fd, char const* data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return;
+            }
+
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    void on_fatal_signal(int signal)
+    {
+        if (crash_handler)
+            crash_handler();
+
+        // The handler was installed with SA_RESETHAND, so raising the signal again runs the default action
+        ::raise(signal);
+    }
+}
+
+void platform::debug_output(nstl::string_view str)
+{
+    write_all(STDERR_FILENO, str.data(), str.size());
+}
+
+size_t platform::capture_callstack(nstl::span<void*> frames, size_t skip_count)
+{
+    constexpr size_t max_frame_count = 128;
+    void* buffer[max_frame_count];
+
+    // backtrace() allocates with malloc, so this doesn't recurse into the memory tracking
+    int captured_count = ::backtrace(buffer, static_cast<int>(max_frame_count));
+    size_t first_frame = skip_count + 1;
+    if (captured_count <= 0 || static_cast<size_t>(captured_count) <= first_frame)
+        return 0;
+
+    size_t count = static_cast<size_t>(captured_count) - first_frame;
+    if (count > frames.size())
+        count = frames.size();
+
+    for (size_t i = 0; i < count; i++)
+        frames[i] = buffer[first_frame + i];
+
+    return count;
+}
+
+nstl::string platform::symbolize_address(void* address)
+{
+    Dl_info info{};
+    if (::dladdr(address, &info) == 0)
+        return nstl::sprintf("%p", address);
+
+    char const* module = info.dli_fname ? info.dli_fname : "?";
+
+    if (!info.dli_sname)
+        return nstl::sprintf("%p (%s)", address, module);
+
+    size_t offset = static_cast<size_t>(static_cast<char*>(address) - static_cast<char*>(info.dli_saddr));
+
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    nstl::string result = nstl::sprintf("%s+0x%zx (%s)", status == 0 && demangled ? demangled : info.dli_sname, offset, module);
+    ::free(demangled);
+
+    return result;
+}
+
+void platform::set_crash_handler(crash_handler_t handler)
+{
+    crash_handler = handler;
+
+    struct sigaction action{};
+    action.sa_handler = on_fatal_signal;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+
+    int const signals[] = { SIGSEGV, SIGABRT, SIGBUS, SIGILL, SIGFPE };
+    for (int signal : signals)
+        ::sigaction(signal, &action, nullptr);
+}
+
+bool platform::open_crash_output(nstl::string_view path)
+{
+    nstl::string path_copy = path;
+
+    int fd = ::open(path_copy.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+
+    if (crash_output_fd != STDERR_FILENO)
+        ::close(crash_output_fd);
+    crash_output_fd = fd;
+
+    return true;
+}
+
+void platform::write_crash_output(char const* data, size_t size)
+{
+    write_all(crash_output_fd, data, size);
+}
@@ -0,0 +1,178 @@
+#include "platform/filesystem.h"
+
+#include "common.h"
+
+#include "fs/file.h"
+
+#include "nstl/string.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+void platform::create_directory(nstl::string_view path)
+{
+    nstl::string path_copy = path;
+
+    int result = mkdir(path_copy.c_str(), 0755);
+
+    [[maybe_unused]] int last_error = errno;
+    if (result != 0)
+        assert(last_error == EEXIST);
+}
+
+bool platform::remove_directory(nstl::string_view path)
+{
+    nstl::string path_copy = path;
+
+    return rmdir(path_copy.c_str()) == 0;
+}
+
+nstl::vector<nstl::string> platform::list_directory(nstl::string_view path)
+{
+    nstl::string path_copy = path;
+
+    DIR* directory = opendir(path_copy.c_str());
+    if (!directory)
+        return {};
+
+    nstl::vector<nstl::string> names;
+    while (dirent* entry = readdir(directory))
+    {
+        nstl::string_view name = entry->d_name;
+        if (name != "." && name != "..")
+            names.push_back(name);
+    }
+
+    closedir(directory);
+
+    return names;
+}
+
+bool platform::rename_file(nstl::string_view from, nstl::string_view to)
+{
+    nstl::string from_copy = from;
+    nstl::string to_copy = to;
+
+    return rename(from_copy.c_str(), to_copy.c_str()) == 0;
+}
+
+bool platform::remove_file(nstl::string_view path)
+{
+    nstl::string path_copy = path;
+
+    return unlink(path_copy.c_str()) == 0;
+}
+
+bool platform::open_file(file_storage_t& storage, nstl::string_view filename, fs::open_mode mode)
+{
+    nstl::string filename_copy = filename;
+
+    int flags = O_CLOEXEC;
+
+    if (mode == fs::open_mode::read)
+    {
+        flags |= O_RDONLY;
+    }
+    else if (mode == fs::open_mode::write)
+    {
+        flags |= O_WRONLY | O_CREAT | O_TRUNC;
+    }
+    else
+    {
+        assert(false);
+    }
+
+    int fd = open(filename_copy.c_str(), flags, 0644);
+    if (fd < 0)
+    {
+        auto e = platform_posix::get_last_error(); // TODO make use of it
+        return false;
+    }
+
+    storage.create_inplace<int>(fd);
+    return true;
+}
+
+void platform::close_file(file_storage_t& storage)
+{
+    int fd = storage.get_as<int>();
+    if (close(fd) != 0)
+    {
+        auto e = platform_posix::get_last_error(); // TODO make use of it
+        assert(false);
+    }
+}
+
+size_t platform::get_file_size(file_storage_t& storage)
+{
+    int fd = storage.get_as<int>();
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0)
+    {
+        auto e = platform_posix::get_last_error(); // TODO make use of it
+        assert(false);
+    }
+
+    assert(info.st_size >= 0);
+    return static_cast<size_t>(info.st_size);
+}
+
+bool platform::read_file(file_storage_t& storage, void* data, size_t size, size_t offset)
+{
+    int fd = storage.get_as<int>();
+
+    unsigned char* dest = static_cast<unsigned char*>(data);
+    size_t total_read = 0;
+
+    // pread might return less than requested, so keep reading until EOF or error
+    while (total_read < size)
+    {
+        ssize_t bytes_read = pread(fd, dest + total_read, size - total_read, static_cast<off_t>(offset + total_read));
+        if (bytes_read < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            auto e = platform_posix::get_last_error(); // TODO make use of it
+            assert(false);
+            return false;
+        }
+
+        if (bytes_read == 0)
+            break;
+
+        total_read += static_cast<size_t>(bytes_read);
+    }
+
+    return total_read == size;
+}
+
+bool platform::write_file(file_storage_t& storage, void const* data, size_t size, size_t offset)
+{
+    int fd = storage.get_as<int>();
+
+    unsigned char const* src = static_cast<unsigned char const*>(data);
+    size_t total_written = 0;
+
+    while (total_written < size)
+    {
+        ssize_t bytes_written = pwrite(fd, src + total_written, size - total_written, static_cast<off_t>(offset + total_written));
+        if (bytes_written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            auto e = platform_posix::get_last_error(); // TODO make use of it
+            assert(false);
+            return false;
+        }
+
+        total_written += static_cast<size_t>(bytes_written);
+    }
+
+    return total_written == size;
+}
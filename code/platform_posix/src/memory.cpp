@@ -0,0 +1,68 @@
+#include "platform/memory.h"
+
+#include "nstl/alignment.h"
+
+#include <assert.h>
+#include <malloc.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+    size_t adjust_alignment(size_t alignment)
+    {
+        // posix_memalign requires the alignment to be a multiple of sizeof(void*)
+        return alignment < sizeof(void*) ? sizeof(void*) : alignment;
+    }
+}
+
+void* platform::allocate(size_t size, size_t alignment)
+{
+    assert(nstl::is_power_of_2(alignment));
+
+    if (alignment <= alignof(max_align_t))
+        return malloc(size);
+
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, adjust_alignment(alignment), size) != 0)
+        return nullptr;
+
+    return ptr;
+}
+
+void* platform::reallocate(void* ptr, size_t size, size_t alignment)
+{
+    assert(nstl::is_power_of_2(alignment));
+
+    if (alignment <= alignof(max_align_t))
+        return realloc(ptr, size);
+
+    if (!ptr)
+        return allocate(size, alignment);
+
+    if (size == 0)
+    {
+        deallocate(ptr);
+        return nullptr;
+    }
+
+    // There is no aligned realloc in POSIX, so move the data manually
+    size_t old_size = malloc_usable_size(ptr);
+    if (old_size >= size && nstl::is_aligned(ptr, alignment))
+        return ptr;
+
+    void* new_ptr = allocate(size, alignment);
+    if (!new_ptr)
+        return nullptr;
+
+    memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+    deallocate(ptr);
+
+    return new_ptr;
+}
+
+void platform::deallocate(void* ptr)
+{
+    return free(ptr);
+}
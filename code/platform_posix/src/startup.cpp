@@ -0,0 +1,6 @@
+#include "platform/startup.h"
+
+int main(int argc, char** argv)
+{
+    return run(argc, argv);
+}
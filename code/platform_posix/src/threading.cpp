@@ -0,0 +1,192 @@
+#include "platform/threading.h"
+
+#include "common.h"
+
+#include "platform/memory.h"
+
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+static_assert(sizeof(pthread_t) <= sizeof(platform::thread_storage_t), "thread_storage_t is too small for pthread_t");
+static_assert(sizeof(pthread_mutex_t) <= sizeof(platform::mutex_storage_t), "mutex_storage_t is too small for pthread_mutex_t");
+static_assert(sizeof(pthread_cond_t) <= sizeof(platform::condition_variable_storage_t), "condition_variable_storage_t is too small for pthread_cond_t");
+
+namespace
+{
+    struct new_tag {};
+
+    struct thread_args
+    {
+        platform::thread_func_t func = nullptr;
+        void* arg = nullptr;
+    };
+
+    // pthread_t is opaque, but it's never zero for a valid thread on the supported platforms
+    constexpr pthread_t invalid_thread = pthread_t{};
+
+    // Linux limits thread names to 16 characters including the null terminator
+    constexpr size_t max_thread_name_length = 15;
+}
+
+void* operator new(size_t, ::new_tag, void* p) { return p; }
+void operator delete(void*, ::new_tag, void*) {}
+
+static void* posix_thread_func(void* param)
+{
+    thread_args* args = static_cast<thread_args*>(param);
+    thread_args args_copy = *args;
+
+    args->~thread_args();
+    platform::deallocate(param);
+    param = nullptr;
+    args = nullptr;
+
+    args_copy.func(args_copy.arg);
+
+    return nullptr;
+}
+
+bool platform::thread_create_empty(thread_storage_t& storage)
+{
+    storage.create_inplace<pthread_t>(invalid_thread);
+    return true;
+}
+
+bool platform::thread_create(thread_storage_t& storage, thread_func_t func, void* arg, nstl::string_view name)
+{
+    void* ptr = platform::allocate(sizeof(thread_args), alignof(thread_args));
+    [[maybe_unused]] thread_args* args = new(new_tag{}, ptr) thread_args{ .func = func, .arg = arg };
+    assert(args == ptr);
+
+    pthread_t thread = invalid_thread;
+    int result = pthread_create(&thread, nullptr, posix_thread_func, ptr);
+
+    if (result != 0)
+    {
+        platform::deallocate(ptr);
+        assert(false);
+        return false;
+    }
+
+    if (!name.empty())
+    {
+        nstl::string name_copy = name.substr(0, max_thread_name_length);
+        pthread_setname_np(thread, name_copy.c_str());
+    }
+
+    storage.create_inplace<pthread_t>(thread);
+    return true;
+}
+
+void platform::thread_swap(thread_storage_t& lhs, thread_storage_t& rhs)
+{
+    nstl::exchange(lhs.get_as<pthread_t>(), rhs.get_as<pthread_t>());
+}
+
+void platform::thread_join(thread_storage_t& storage)
+{
+    // Unlike Win32 handles, a pthread can only be joined once
+    pthread_t& thread = storage.get_as<pthread_t>();
+    if (thread != invalid_thread)
+    {
+        pthread_join(thread, nullptr);
+        thread = invalid_thread;
+    }
+}
+
+void platform::thread_destroy(thread_storage_t& storage)
+{
+    thread_join(storage);
+}
+
+uint64_t platform::thread_get_current_id()
+{
+    return static_cast<uint64_t>(pthread_self());
+}
+
+void platform::sleep(uint64_t milliseconds)
+{
+    timespec remaining{};
+    remaining.tv_sec = static_cast<time_t>(milliseconds / 1000);
+    remaining.tv_nsec = static_cast<long>((milliseconds % 1000) * 1'000'000);
+
+    while (nanosleep(&remaining, &remaining) != 0 && errno == EINTR)
+    {
+    }
+}
+
+bool platform::mutex_create(mutex_storage_t& storage)
+{
+    storage.create_inplace<pthread_mutex_t>();
+
+    pthread_mutex_t& mutex = storage.get_as<pthread_mutex_t>();
+
+    // CRITICAL_SECTION on Windows is recursive, keep the same semantics
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    int result = pthread_mutex_init(&mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+
+    return result == 0;
+}
+
+void platform::mutex_destroy(mutex_storage_t& storage)
+{
+    pthread_mutex_destroy(&storage.get_as<pthread_mutex_t>());
+    storage.destroy<pthread_mutex_t>();
+}
+
+void platform::mutex_lock(mutex_storage_t& storage)
+{
+    [[maybe_unused]] int result = pthread_mutex_lock(&storage.get_as<pthread_mutex_t>());
+    assert(result == 0);
+}
+
+void platform::mutex_unlock(mutex_storage_t& storage)
+{
+    [[maybe_unused]] int result = pthread_mutex_unlock(&storage.get_as<pthread_mutex_t>());
+    assert(result == 0);
+}
+
+bool platform::condition_variable_create(condition_variable_storage_t& storage)
+{
+    storage.create_inplace<pthread_cond_t>();
+
+    int result = pthread_cond_init(&storage.get_as<pthread_cond_t>(), nullptr);
+    assert(result == 0);
+    return result == 0;
+}
+
+void platform::condition_variable_destroy(condition_variable_storage_t& storage)
+{
+    pthread_cond_destroy(&storage.get_as<pthread_cond_t>());
+    storage.destroy<pthread_cond_t>();
+}
+
+void platform::condition_variable_wait(condition_variable_storage_t& storage, mutex_storage_t& mutex)
+{
+    [[maybe_unused]] int result = pthread_cond_wait(&storage.get_as<pthread_cond_t>(), &mutex.get_as<pthread_mutex_t>());
+    assert(result == 0);
+}
+
+void platform::condition_variable_notify_one(condition_variable_storage_t& storage)
+{
+    pthread_cond_signal(&storage.get_as<pthread_cond_t>());
+}
+
+void platform::condition_variable_notify_all(condition_variable_storage_t& storage)
+{
+    pthread_cond_broadcast(&storage.get_as<pthread_cond_t>());
+}
+
+size_t platform::get_hardware_thread_count()
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? static_cast<size_t>(count) : 1;
+}
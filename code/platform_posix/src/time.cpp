@@ -0,0 +1,24 @@
+#include "platform/time.h"
+
+#include <assert.h>
+#include <time.h>
+
+namespace
+{
+    constexpr size_t nanoseconds_per_second = 1'000'000'000;
+}
+
+size_t platform::get_monotonic_time_frequency()
+{
+    return nanoseconds_per_second;
+}
+
+size_t platform::get_monotonic_time_counter()
+{
+    timespec ts{};
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        assert(false);
+
+    assert(ts.tv_sec >= 0 && ts.tv_nsec >= 0);
+    return static_cast<size_t>(ts.tv_sec) * nanoseconds_per_second + static_cast<size_t>(ts.tv_nsec);
+}
@@ -0,0 +1,145 @@
+#include "platform/uuid.h"
+
+#include "common.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+// The byte layout and the string representation match the Win32 UUID structure
+// (Data1, Data2 and Data3 are stored little-endian), so that asset UUIDs are
+// identical no matter which platform generated them
+
+namespace
+{
+    constexpr size_t uuid_size = 16;
+    constexpr size_t uuid_string_length = 36;
+
+    // Index of the byte in the span for every pair of hex digits in the string representation
+    constexpr size_t string_byte_order[uuid_size] = { 3, 2, 1, 0, 5, 4, 7, 6, 8, 9, 10, 11, 12, 13, 14, 15 };
+
+    bool is_dash_position(size_t pos)
+    {
+        return pos == 8 || pos == 13 || pos == 18 || pos == 23;
+    }
+
+    bool read_random_bytes(uint8_t* data, size_t size)
+    {
+        int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+
+        size_t total_read = 0;
+        while (total_read < size)
+        {
+            ssize_t bytes_read = read(fd, data + total_read, size - total_read);
+            if (bytes_read < 0 && errno == EINTR)
+                continue;
+            if (bytes_read <= 0)
+                break;
+
+            total_read += static_cast<size_t>(bytes_read);
+        }
+
+        close(fd);
+
+        return total_read == size;
+    }
+
+    int hex_digit_value(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+}
+
+bool platform::uuid_generate(nstl::span<uint8_t> bytes)
+{
+    assert(bytes.size() == uuid_size);
+
+    uint8_t uuid[uuid_size]{};
+    if (!read_random_bytes(uuid, sizeof(uuid)))
+        return false;
+
+    // RFC 4122 version 4 (high nibble of Data3) and variant 1 (top bits of Data4[0])
+    uuid[7] = static_cast<uint8_t>((uuid[7] & 0x0f) | 0x40);
+    uuid[8] = static_cast<uint8_t>((uuid[8] & 0x3f) | 0x80);
+
+    memcpy(bytes.data(), uuid, sizeof(uuid));
+
+    return true;
+}
+
+bool platform::uuid_from_string(nstl::string_view str, nstl::span<uint8_t> bytes)
+{
+    assert(bytes.size() == uuid_size);
+
+    if (str.length() != uuid_string_length)
+        return false;
+
+    uint8_t uuid[uuid_size]{};
+
+    size_t byte_index = 0;
+    size_t pos = 0;
+    while (pos < str.length())
+    {
+        if (is_dash_position(pos))
+        {
+            if (str[pos] != '-')
+                return false;
+            pos++;
+            continue;
+        }
+
+        int high = hex_digit_value(str[pos]);
+        int low = hex_digit_value(str[pos + 1]);
+        if (high < 0 || low < 0)
+            return false;
+
+        assert(byte_index < uuid_size);
+        uuid[string_byte_order[byte_index]] = static_cast<uint8_t>((high << 4) | low);
+
+        byte_index++;
+        pos += 2;
+    }
+
+    assert(byte_index == uuid_size);
+    memcpy(bytes.data(), uuid, sizeof(uuid));
+
+    return true;
+}
+
+nstl::string platform::uuid_to_string(nstl::span<uint8_t const> bytes)
+{
+    assert(bytes.size() == uuid_size);
+
+    constexpr char digits[] = "0123456789abcdef";
+
+    nstl::string result{ uuid_string_length };
+
+    size_t byte_index = 0;
+    size_t pos = 0;
+    while (pos < uuid_string_length)
+    {
+        if (is_dash_position(pos))
+        {
+            result[pos] = '-';
+            pos++;
+            continue;
+        }
+
+        uint8_t value = bytes[string_byte_order[byte_index]];
+        result[pos] = digits[value >> 4];
+        result[pos + 1] = digits[value & 0x0f];
+
+        byte_index++;
+        pos += 2;
+    }
+
+    return result;
+}
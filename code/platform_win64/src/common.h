@@ -6,6 +6,7 @@
 
 #include <stdint.h>
 
+#include "nstl/buffer.h"
 #include "nstl/string.h"
 
 namespace platform_win64
@@ -2,8 +2,33 @@
 
 #include "common.h"
 
+#include "nstl/scope_exit.h"
+#include "nstl/sprintf.h"
 #include "nstl/string.h"
 
+#include <DbgHelp.h>
+#include <signal.h>
+
+namespace
+{
+    platform::crash_handler_t crash_handler = nullptr;
+    HANDLE crash_output = INVALID_HANDLE_VALUE; // stderr until a file is opened
+
+    LONG WINAPI on_unhandled_exception(EXCEPTION_POINTERS*)
+    {
+        if (crash_handler)
+            crash_handler();
+
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+
+    void on_abort(int)
+    {
+        if (crash_handler)
+            crash_handler();
+    }
+}
+
 void platform::debug_output(nstl::string_view str)
 {
     if (str.empty())
@@ -12,3 +37,88 @@ void platform::debug_output(nstl::string_view str)
     nstl::string copy = str;
     OutputDebugStringA(copy.c_str());
 }
+
+size_t platform::capture_callstack(nstl::span<void*> frames, size_t skip_count)
+{
+    USHORT count = RtlCaptureStackBackTrace(static_cast<DWORD>(skip_count + 1), static_cast<DWORD>(frames.size()), frames.data(), nullptr);
+    return static_cast<size_t>(count);
+}
+
+nstl::string platform::symbolize_address(void* address)
+{
+    // DbgHelp functions aren't thread-safe
+    static SRWLOCK lock = SRWLOCK_INIT;
+    AcquireSRWLockExclusive(&lock);
+    nstl::scope_exit unlock = [] { ReleaseSRWLockExclusive(&lock); };
+
+    HANDLE process = GetCurrentProcess();
+
+    static bool initialized = false;
+    if (!initialized)
+    {
+        SymSetOptions(SymGetOptions() | SYMOPT_UNDNAME | SYMOPT_LOAD_LINES | SYMOPT_DEFERRED_LOADS);
+        initialized = SymInitialize(process, nullptr, TRUE) != FALSE;
+        if (!initialized)
+            return nstl::sprintf("%p", address);
+    }
+
+    DWORD64 address64 = reinterpret_cast<DWORD64>(address);
+
+    alignas(SYMBOL_INFO) char symbol_buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+    SYMBOL_INFO* symbol = reinterpret_cast<SYMBOL_INFO*>(symbol_buffer);
+    symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+    symbol->MaxNameLen = MAX_SYM_NAME;
+
+    DWORD64 symbol_displacement = 0;
+    if (!SymFromAddr(process, address64, &symbol_displacement, symbol))
+        return nstl::sprintf("%p", address);
+
+    IMAGEHLP_LINE64 line{};
+    line.SizeOfStruct = sizeof(line);
+    DWORD line_displacement = 0;
+    if (!SymGetLineFromAddr64(process, address64, &line_displacement, &line))
+        return nstl::sprintf("%s+0x%llx", symbol->Name, symbol_displacement);
+
+    return nstl::sprintf("%s+0x%llx (%s:%lu)", symbol->Name, symbol_displacement, line.FileName, line.LineNumber);
+}
+
+void platform::set_crash_handler(crash_handler_t handler)
+{
+    crash_handler = handler;
+
+    SetUnhandledExceptionFilter(on_unhandled_exception);
+    signal(SIGABRT, on_abort);
+}
+
+bool platform::open_crash_output(nstl::string_view path)
+{
+    nstl::string path_copy = path;
+
+    HANDLE handle = CreateFileA(path_copy.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    if (crash_output != INVALID_HANDLE_VALUE)
+        CloseHandle(crash_output);
+    crash_output = handle;
+
+    return true;
+}
+
+void platform::write_crash_output(char const* data, size_t size)
+{
+    HANDLE handle = crash_output != INVALID_HANDLE_VALUE ? crash_output : GetStdHandle(STD_ERROR_HANDLE);
+    if (handle == INVALID_HANDLE_VALUE || handle == nullptr)
+        return;
+
+    while (size > 0)
+    {
+        DWORD chunk_size = size > UINT32_MAX ? UINT32_MAX : static_cast<DWORD>(size);
+        DWORD written = 0;
+        if (!WriteFile(handle, data, chunk_size, &written, nullptr) || written == 0)
+            return;
+
+        data += written;
+        size -= written;
+    }
+}
@@ -17,6 +17,51 @@ void platform::create_directory(nstl::string_view path)
         assert(lastError == ERROR_ALREADY_EXISTS);
 }
 
+bool platform::remove_directory(nstl::string_view path)
+{
+    nstl::string path_copy = path;
+
+    return RemoveDirectoryA(path_copy.c_str());
+}
+
+nstl::vector<nstl::string> platform::list_directory(nstl::string_view path)
+{
+    nstl::string pattern = path;
+    pattern += "\\*";
+
+    WIN32_FIND_DATAA data{};
+    HANDLE h = FindFirstFileA(pattern.c_str(), &data);
+    if (h == INVALID_HANDLE_VALUE)
+        return {};
+
+    nstl::vector<nstl::string> names;
+    do
+    {
+        nstl::string_view name = data.cFileName;
+        if (name != "." && name != "..")
+            names.push_back(name);
+    } while (FindNextFileA(h, &data));
+
+    FindClose(h);
+
+    return names;
+}
+
+bool platform::rename_file(nstl::string_view from, nstl::string_view to)
+{
+    nstl::string from_copy = from;
+    nstl::string to_copy = to;
+
+    return MoveFileExA(from_copy.c_str(), to_copy.c_str(), MOVEFILE_REPLACE_EXISTING);
+}
+
+bool platform::remove_file(nstl::string_view path)
+{
+    nstl::string path_copy = path;
+
+    return DeleteFileA(path_copy.c_str());
+}
+
 bool platform::open_file(file_storage_t& storage, nstl::string_view filename, fs::open_mode mode)
 {
     assert(filename.length() <= MAX_PATH);
@@ -46,7 +91,6 @@ bool platform::open_file(file_storage_t& storage, nstl::string_view filename, fs
     if (h == INVALID_HANDLE_VALUE)
     {
         auto e = platform_win64::get_last_error(); // TODO make use of it
-        assert(false);
         return false;
     }
 
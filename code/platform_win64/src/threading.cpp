@@ -133,3 +133,38 @@ void platform::mutex_unlock(mutex_storage_t& storage)
     CRITICAL_SECTION& section = storage.get_as<CRITICAL_SECTION>();
     LeaveCriticalSection(&section);
 }
+
+bool platform::condition_variable_create(condition_variable_storage_t& storage)
+{
+    storage.create_inplace<CONDITION_VARIABLE>();
+    InitializeConditionVariable(&storage.get_as<CONDITION_VARIABLE>());
+    return true;
+}
+
+void platform::condition_variable_destroy(condition_variable_storage_t& storage)
+{
+    storage.destroy<CONDITION_VARIABLE>();
+}
+
+void platform::condition_variable_wait(condition_variable_storage_t& storage, mutex_storage_t& mutex)
+{
+    [[maybe_unused]] BOOL result = SleepConditionVariableCS(&storage.get_as<CONDITION_VARIABLE>(), &mutex.get_as<CRITICAL_SECTION>(), INFINITE);
+    assert(result);
+}
+
+void platform::condition_variable_notify_one(condition_variable_storage_t& storage)
+{
+    WakeConditionVariable(&storage.get_as<CONDITION_VARIABLE>());
+}
+
+void platform::condition_variable_notify_all(condition_variable_storage_t& storage)
+{
+    WakeAllConditionVariable(&storage.get_as<CONDITION_VARIABLE>());
+}
+
+size_t platform::get_hardware_thread_count()
+{
+    SYSTEM_INFO info{};
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? static_cast<size_t>(info.dwNumberOfProcessors) : 1;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "memory/tracking.h"
+
+// Counts the allocations made by the current thread during the lifetime of the counter, using the memory tracking
+class AllocationCounter
+{
+public:
+    AllocationCounter() : m_scopeGuard(getScopeId()), m_initialStat(getStat()) {}
+
+    size_t getAllocationCount() const
+    {
+        return getStat().total_allocations - m_initialStat.total_allocations;
+    }
+
+    size_t getActiveAllocationCount() const
+    {
+        return getStat().active_allocations;
+    }
+
+private:
+    static memory::tracking::scope_id getScopeId()
+    {
+        static memory::tracking::scope_id const id = memory::tracking::create_scope_id("Test/AllocationCounter");
+        return id;
+    }
+
+    // Reading the statistics allocates as well, so that is done in a different scope
+    static memory::tracking::scope_stat getStat()
+    {
+        static memory::tracking::scope_id const statisticsScopeId = memory::tracking::create_scope_id("Test/AllocationCounter/Statistics");
+        MEMORY_TRACKING_SCOPE(statisticsScopeId);
+
+        return memory::tracking::get_scope_stats_copy()[getScopeId().index];
+    }
+
+private:
+    memory::tracking::scope_guard m_scopeGuard;
+    memory::tracking::scope_stat m_initialStat;
+};
@@ -0,0 +1,134 @@
+#include "check.h"
+
+#include "editor/assets/AssetDatabase.h"
+#include "editor/assets/Uuid.h"
+
+#include "mt/job_system.h"
+
+#include "fs/directory.h"
+#include "fs/file.h"
+
+#include "path/path.h"
+
+#include "platform/startup.h"
+
+#include "nstl/blob.h"
+#include "nstl/span.h"
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+#include "nstl/vector.h"
+
+#include <string.h>
+
+// Imports the same glTF models without workers, where the jobs run one after another in the order they were
+// started, and with several workers, and checks that every asset file is byte-identical between the imports
+
+namespace
+{
+    using editor::assets::Uuid;
+
+    nstl::string_view assetsRoot = "data/assets";
+
+    nstl::blob readFile(nstl::string_view path)
+    {
+        fs::file f{ path, fs::open_mode::read };
+        nstl::blob content{ f.size() };
+        f.read(content.data(), content.size());
+
+        return content;
+    }
+
+    void replaceAll(nstl::blob& content, void const* from, void const* to, size_t size)
+    {
+        unsigned char* data = content.ucdata();
+        for (size_t offset = 0; offset + size <= content.size(); offset++)
+        {
+            if (memcmp(data + offset, from, size) == 0)
+            {
+                memcpy(data + offset, to, size);
+                offset += size - 1;
+            }
+        }
+    }
+
+    // The ids are random, so the ids of one import are replaced with the matching ids of the other one.
+    // The binary files contain the raw bytes, the JSON files contain the strings
+    void replaceIds(nstl::blob& content, nstl::span<Uuid const> from, nstl::span<Uuid const> to)
+    {
+        for (size_t i = 0; i < from.size(); i++)
+        {
+            replaceAll(content, from[i].bytes, to[i].bytes, sizeof(Uuid::bytes));
+
+            nstl::string fromString = from[i].toString();
+            nstl::string toString = to[i].toString();
+            CHECK(fromString.size() == toString.size());
+            replaceAll(content, fromString.data(), toString.data(), fromString.size());
+        }
+    }
+
+    nstl::vector<Uuid> importModel(size_t workerCount, nstl::string_view path)
+    {
+        mt::job_system jobs{ workerCount };
+
+        editor::assets::AssetDatabase database{ jobs };
+        database.setJsonExportEnabled(true);
+
+        return database.importAsset(path);
+    }
+
+    void compareImports(nstl::span<Uuid const> expectedIds, nstl::span<Uuid const> ids)
+    {
+        CHECK(!expectedIds.empty());
+        CHECK(expectedIds.size() == ids.size());
+
+        for (size_t i = 0; i < expectedIds.size(); i++)
+        {
+            nstl::string expectedDirectory = path::join(assetsRoot, expectedIds[i].toString());
+            nstl::string directory = path::join(assetsRoot, ids[i].toString());
+
+            nstl::vector<nstl::string> expectedFiles = fs::list_directory(expectedDirectory);
+            CHECK(!expectedFiles.empty());
+            CHECK(expectedFiles.size() == fs::list_directory(directory).size());
+
+            for (nstl::string const& filename : expectedFiles)
+            {
+                // The metadata stores the hash of the files, which contain the ids
+                if (filename == "asset.json")
+                    continue;
+
+                nstl::blob expected = readFile(path::join(expectedDirectory, filename));
+                nstl::blob actual = readFile(path::join(directory, filename));
+
+                replaceIds(expected, expectedIds, ids);
+
+                CHECK(expected.size() == actual.size());
+                CHECK(memcmp(expected.data(), actual.data(), actual.size()) == 0);
+            }
+        }
+    }
+}
+
+int run(int, char**)
+{
+    char const* models[] = {
+        "Box/glTF/Box.gltf",
+        "BoxInterleaved/glTF/BoxInterleaved.gltf",
+        "BoxTextured/glTF/BoxTextured.gltf",
+        "Duck/glTF/Duck.gltf",
+        "VertexColorTest/glTF/VertexColorTest.gltf",
+    };
+
+    size_t const workerCounts[] = { 1, 4, mt::job_system::get_default_worker_count() };
+
+    for (char const* model : models)
+    {
+        nstl::string path = path::join(MODELS_DIRECTORY, model);
+
+        nstl::vector<Uuid> serialIds = importModel(0, path);
+
+        for (size_t workerCount : workerCounts)
+            compareImports(serialIds, importModel(workerCount, path));
+    }
+
+    return EXIT_SUCCESS;
+}
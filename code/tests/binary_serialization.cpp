@@ -0,0 +1,140 @@
+#include "check.h"
+
+#include "common/binary.h"
+#include "common/binary-nstl.h"
+
+#include "platform/startup.h"
+
+#include "nstl/optional.h"
+#include "nstl/string.h"
+#include "nstl/vector.h"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace
+{
+    // Takes much more memory than a byte per element, which is the bound the count is checked against
+    struct LargeElement
+    {
+        unsigned char bytes[64 * 1024];
+    };
+}
+
+template<>
+struct common::binary_serializer<LargeElement> : common::binary_trivial_serializer<LargeElement> {};
+
+namespace
+{
+    template<typename T>
+    nstl::vector<unsigned char> write(T const& value)
+    {
+        nstl::vector<unsigned char> bytes;
+        common::binary_writer writer{ bytes };
+        common::binary_write(writer, value);
+        return bytes;
+    }
+
+    template<typename T>
+    bool read(nstl::vector<unsigned char> const& bytes, T& value)
+    {
+        common::binary_reader reader{ { bytes.data(), bytes.size() } };
+        return common::binary_read(reader, value) && reader.is_at_end();
+    }
+
+    void testRoundTrip()
+    {
+        nstl::vector<nstl::string> strings;
+        strings.push_back("first");
+        strings.push_back("");
+        strings.push_back("a string which is too long to be stored inline");
+
+        nstl::vector<nstl::string> readStrings;
+        CHECK(read(write(strings), readStrings));
+        CHECK(readStrings.size() == strings.size());
+        for (size_t i = 0; i < strings.size(); i++)
+            CHECK(readStrings[i] == strings[i]);
+
+        nstl::vector<nstl::vector<uint32_t>> nested;
+        nested.resize(3);
+        for (uint32_t i = 0; i < 1000; i++)
+            nested[i % 3].push_back(i);
+
+        nstl::vector<nstl::vector<uint32_t>> readNested;
+        CHECK(read(write(nested), readNested));
+        CHECK(readNested.size() == nested.size());
+        for (size_t i = 0; i < nested.size(); i++)
+        {
+            CHECK(readNested[i].size() == nested[i].size());
+            for (size_t j = 0; j < nested[i].size(); j++)
+                CHECK(readNested[i][j] == nested[i][j]);
+        }
+
+        nstl::optional<float> empty;
+        nstl::optional<float> value = 1.5f;
+
+        nstl::optional<float> readEmpty = 2.0f;
+        nstl::optional<float> readValue;
+        CHECK(read(write(empty), readEmpty) && !readEmpty);
+        CHECK(read(write(value), readValue) && readValue && *readValue == 1.5f);
+    }
+
+    // Every serializable scalar has the same size on all platforms
+    void testFixedWidthLayout()
+    {
+        CHECK(write(int8_t{ -1 }).size() == 1 && write(uint8_t{ 1 }).size() == 1);
+        CHECK(write(int16_t{ -1 }).size() == 2 && write(uint16_t{ 1 }).size() == 2);
+        CHECK(write(int32_t{ -1 }).size() == 4 && write(uint32_t{ 1 }).size() == 4);
+        CHECK(write(int64_t{ -1 }).size() == 8 && write(uint64_t{ 1 }).size() == 8);
+        CHECK(write(1.0f).size() == 4 && write(1.0).size() == 8);
+        CHECK(write('a').size() == 1 && write(true).size() == 1);
+
+        int64_t minValue = 0;
+        uint64_t maxValue = 0;
+        CHECK(read(write(int64_t{ INT64_MIN }), minValue) && minValue == INT64_MIN);
+        CHECK(read(write(uint64_t{ UINT64_MAX }), maxValue) && maxValue == UINT64_MAX);
+    }
+
+    // The old reader allocated the whole count up front, which is several gigabytes here
+    void testCorruptedCountDoesNotAllocateTheCount()
+    {
+        uint32_t count = 100000;
+
+        nstl::vector<unsigned char> bytes;
+        bytes.resize(sizeof(count) + count, 0);
+        memcpy(bytes.data(), &count, sizeof(count));
+
+        nstl::vector<LargeElement> value;
+        CHECK(!read(bytes, value));
+        CHECK(value.size() <= 1);
+    }
+
+    void testTruncatedData()
+    {
+        nstl::vector<uint32_t> values;
+        for (uint32_t i = 0; i < 100; i++)
+            values.push_back(i);
+
+        nstl::vector<unsigned char> bytes = write(values);
+        bytes.resize(bytes.size() - 1);
+
+        nstl::vector<uint32_t> readValues;
+        CHECK(!read(bytes, readValues));
+
+        uint32_t count = 5;
+        nstl::vector<unsigned char> countOnly;
+        countOnly.resize(sizeof(count));
+        memcpy(countOnly.data(), &count, sizeof(count));
+        CHECK(!read(countOnly, readValues));
+    }
+}
+
+int run(int, char**)
+{
+    testRoundTrip();
+    testFixedWidthLayout();
+    testCorruptedCountDoesNotAllocateTheCount();
+    testTruncatedData();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+#include "check.h"
+
+#include "gfx/bind_state_tracker.h"
+
+#include "platform/startup.h"
+
+#include <stdint.h>
+
+// The tracker only compares the handles, so they don't have to point to real resources
+
+namespace
+{
+    template<typename Handle>
+    Handle fakeHandle(uintptr_t id)
+    {
+        return Handle{ reinterpret_cast<void*>(id) };
+    }
+
+    bool hasCounts(gfx::bind_counter const& counter, size_t issued, size_t skipped)
+    {
+        return counter.issued_count == issued && counter.skipped_count == skipped;
+    }
+
+    void testRenderstates()
+    {
+        gfx::bind_state_tracker tracker;
+
+        gfx::renderstate_handle first = fakeHandle<gfx::renderstate_handle>(1);
+        gfx::renderstate_handle second = fakeHandle<gfx::renderstate_handle>(2);
+
+        CHECK(tracker.bind_renderstate(first, 10));
+        CHECK(!tracker.bind_renderstate(first, 10));
+        CHECK(!tracker.bind_renderstate(first, 10));
+        CHECK(tracker.bind_renderstate(second, 10));
+        CHECK(tracker.bind_renderstate(first, 10));
+
+        CHECK(hasCounts(tracker.get_statistics().renderstates, 3, 2));
+
+        // Everything has to be bound again after a reset, the statistics are kept
+        tracker.reset();
+        CHECK(tracker.bind_renderstate(first, 10));
+        CHECK(hasCounts(tracker.get_statistics().renderstates, 4, 2));
+
+        tracker.reset_statistics();
+        CHECK(hasCounts(tracker.get_statistics().renderstates, 0, 0));
+        CHECK(!tracker.bind_renderstate(first, 10));
+        CHECK(hasCounts(tracker.get_statistics().renderstates, 0, 1));
+    }
+
+    void testDescriptorgroupSlots()
+    {
+        gfx::bind_state_tracker tracker;
+
+        gfx::descriptorgroup_handle const a = fakeHandle<gfx::descriptorgroup_handle>(1);
+        gfx::descriptorgroup_handle const b = fakeHandle<gfx::descriptorgroup_handle>(2);
+        gfx::descriptorgroup_handle const c = fakeHandle<gfx::descriptorgroup_handle>(3);
+
+        gfx::descriptorgroup_handle const abc[] = { a, b, c };
+        gfx::descriptorgroup_handle const abb[] = { a, b, b };
+        gfx::descriptorgroup_handle const ab[] = { a, b };
+
+        CHECK(tracker.bind_renderstate(fakeHandle<gfx::renderstate_handle>(1), 10));
+
+        CHECK(tracker.bind_descriptorgroups(abc) == 0u);
+        CHECK(!tracker.bind_descriptorgroups(abc));
+        CHECK(hasCounts(tracker.get_statistics().descriptorgroups, 3, 3));
+
+        // Only the slots starting from the first different one are rebound
+        CHECK(tracker.bind_descriptorgroups(abb) == 2u);
+        CHECK(hasCounts(tracker.get_statistics().descriptorgroups, 4, 5));
+
+        // Fewer groups leave the remaining slots bound
+        CHECK(!tracker.bind_descriptorgroups(ab));
+        CHECK(tracker.bind_descriptorgroups(abc) == 2u);
+        CHECK(hasCounts(tracker.get_statistics().descriptorgroups, 5, 9));
+
+        // A renderstate with the same layout keeps the descriptorgroups, a different layout invalidates them
+        CHECK(tracker.bind_renderstate(fakeHandle<gfx::renderstate_handle>(2), 10));
+        CHECK(!tracker.bind_descriptorgroups(abc));
+        CHECK(tracker.bind_renderstate(fakeHandle<gfx::renderstate_handle>(3), 20));
+        CHECK(tracker.bind_descriptorgroups(abc) == 0u);
+        CHECK(hasCounts(tracker.get_statistics().descriptorgroups, 8, 12));
+    }
+
+    void testVertexAndIndexBuffers()
+    {
+        gfx::bind_state_tracker tracker;
+
+        gfx::buffer_handle const buffer = fakeHandle<gfx::buffer_handle>(1);
+        gfx::buffer_handle const otherBuffer = fakeHandle<gfx::buffer_handle>(2);
+
+        gfx::buffer_with_offset const vertexBuffers[] = { { buffer, 0 }, { buffer, 256 } };
+        gfx::buffer_with_offset const offsetVertexBuffers[] = { { buffer, 0 }, { buffer, 512 } };
+
+        CHECK(tracker.bind_vertex_buffers(vertexBuffers) == 0u);
+        CHECK(!tracker.bind_vertex_buffers(vertexBuffers));
+        CHECK(tracker.bind_vertex_buffers(offsetVertexBuffers) == 1u);
+        CHECK(hasCounts(tracker.get_statistics().vertex_buffers, 3, 3));
+
+        // The offset and the index type are part of the binding
+        CHECK(tracker.bind_index_buffer({ buffer, 0 }, gfx::index_type::uint16));
+        CHECK(!tracker.bind_index_buffer({ buffer, 0 }, gfx::index_type::uint16));
+        CHECK(tracker.bind_index_buffer({ buffer, 64 }, gfx::index_type::uint16));
+        CHECK(tracker.bind_index_buffer({ buffer, 64 }, gfx::index_type::uint32));
+        CHECK(tracker.bind_index_buffer({ otherBuffer, 64 }, gfx::index_type::uint32));
+        CHECK(!tracker.bind_index_buffer({ otherBuffer, 64 }, gfx::index_type::uint32));
+        CHECK(hasCounts(tracker.get_statistics().index_buffers, 4, 2));
+
+        tracker.reset();
+        CHECK(tracker.bind_vertex_buffers(vertexBuffers) == 0u);
+        CHECK(tracker.bind_index_buffer({ otherBuffer, 64 }, gfx::index_type::uint32));
+    }
+
+    void testScissors()
+    {
+        gfx::bind_state_tracker tracker;
+
+        gfx::rect const scissor = { .offset = { 0, 0 }, .size = { 64, 64 } };
+        gfx::rect const otherScissor = { .offset = { 32, 0 }, .size = { 64, 64 } };
+
+        // Disabling the scissor is a state change too, so the first one is always issued
+        CHECK(tracker.set_scissor({}));
+        CHECK(!tracker.set_scissor({}));
+        CHECK(tracker.set_scissor(scissor));
+        CHECK(!tracker.set_scissor(scissor));
+        CHECK(tracker.set_scissor(otherScissor));
+        CHECK(tracker.set_scissor({}));
+        CHECK(hasCounts(tracker.get_statistics().scissors, 4, 2));
+
+        tracker.reset();
+        CHECK(tracker.set_scissor({}));
+    }
+}
+
+int run(int, char**)
+{
+    testRenderstates();
+    testDescriptorgroupSlots();
+    testVertexAndIndexBuffers();
+    testScissors();
+
+    return EXIT_SUCCESS;
+}
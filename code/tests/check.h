@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Every test is a separate executable which exits with a non-zero code on the first failed check.
+// Unlike assert(), the checks are done in the release builds as well
+
+#define CHECK(...) \
+    do \
+    { \
+        if (!(__VA_ARGS__)) \
+        { \
+            fprintf(stderr, "%s(%d): check failed: %s\n", __FILE__, __LINE__, #__VA_ARGS__); \
+            exit(EXIT_FAILURE); \
+        } \
+    } while (false)
@@ -0,0 +1,237 @@
+#include "check.h"
+
+#include "gfx_null/backend.h"
+
+#include "gfx/draw_queue.h"
+#include "gfx/renderer.h"
+#include "gfx/resources.h"
+
+#include "platform/startup.h"
+
+#include "nstl/unique_ptr.h"
+#include "nstl/vector.h"
+
+#include <stdint.h>
+
+namespace
+{
+    uint8_t const passes[] = { 0, 1, 15 };
+    uint16_t const ids[] = { 0, 1, 2, UINT16_MAX };
+    float const depths[] = { 0.0f, 0.01f, 0.5f, 1.0f, 10.0f, 1000.0f };
+
+    // Keys of all combinations of the fields, listed in the expected replay order
+    nstl::vector<uint64_t> createOrderedKeys()
+    {
+        nstl::vector<uint64_t> keys;
+
+        for (uint8_t pass : passes)
+        {
+            // Opaque draws: renderstate, then material, then front-to-back
+            for (uint16_t renderstate : ids)
+                for (uint16_t material : ids)
+                    for (float depth : depths)
+                        keys.push_back(gfx::make_draw_sort_key({ .pass = pass, .renderstate = renderstate, .material = material, .depth = depth }));
+
+            // Translucent draws after all the opaque ones of the pass: back-to-front, then renderstate, then material
+            for (size_t i = 0; i < sizeof(depths) / sizeof(depths[0]); i++)
+            {
+                float depth = depths[sizeof(depths) / sizeof(depths[0]) - 1 - i];
+                for (uint16_t renderstate : ids)
+                    for (uint16_t material : ids)
+                        keys.push_back(gfx::make_draw_sort_key({ .pass = pass, .translucent = true, .renderstate = renderstate, .material = material, .depth = depth }));
+            }
+        }
+
+        return keys;
+    }
+
+    // Deterministic permutation, so that the submission order differs from the sorted one
+    nstl::vector<size_t> createShuffledIndices(size_t count)
+    {
+        nstl::vector<size_t> indices;
+        for (size_t i = 0; i < count; i++)
+            indices.push_back(i);
+
+        uint32_t state = 12345;
+        for (size_t i = count; i > 1; i--)
+        {
+            state = state * 1664525u + 1013904223u;
+            nstl::exchange(indices[i - 1], indices[(state >> 8) % i]);
+        }
+
+        return indices;
+    }
+
+    void testSortKeyFieldOrder()
+    {
+        nstl::vector<uint64_t> keys = createOrderedKeys();
+
+        for (size_t i = 1; i < keys.size(); i++)
+            CHECK(keys[i - 1] < keys[i]);
+
+        // Negative depths are clamped to the camera plane
+        CHECK(gfx::make_draw_sort_key({ .depth = -1.0f }) == gfx::make_draw_sort_key({ .depth = 0.0f }));
+    }
+
+    void testSortOrdersPacketsByKey()
+    {
+        nstl::vector<uint64_t> keys = createOrderedKeys();
+        nstl::vector<size_t> submissionOrder = createShuffledIndices(keys.size());
+
+        // Every key is submitted twice, the copies have to keep their submission order
+        gfx::draw_queue queue;
+        for (size_t copy = 0; copy < 2; copy++)
+            for (size_t keyIndex : submissionOrder)
+                queue.submit(keys[keyIndex], {});
+
+        nstl::span<uint32_t const> order = queue.sort();
+        CHECK(order.size() == 2 * keys.size());
+
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            uint32_t first = order[2 * i];
+            uint32_t second = order[2 * i + 1];
+
+            CHECK(first < keys.size() && second == first + keys.size());
+            CHECK(keys[submissionOrder[first]] == keys[i]);
+        }
+    }
+
+    struct TestRenderer
+    {
+        TestRenderer()
+        {
+            auto backend = nstl::make_unique<gfx_null::backend>(64, 64);
+            nullBackend = backend.get();
+            renderer = nstl::make_unique<gfx::renderer>(nstl::move(backend));
+        }
+
+        gfx_null::backend* nullBackend = nullptr;
+        nstl::unique_ptr<gfx::renderer> renderer;
+    };
+
+    // Draws sorted by the queue bind every renderstate and material once, the same draws submitted
+    // in an interleaved order rebind them for almost every draw
+    void testFlushGroupsTheBinds()
+    {
+        TestRenderer test;
+        gfx::renderer& renderer = *test.renderer;
+
+        gfx::shader_handle const shaders[] = {
+            renderer.create_shader({ .filename = "shader.vert", .stage = gfx::shader_stage::vertex }),
+            renderer.create_shader({ .filename = "shader.frag", .stage = gfx::shader_stage::fragment }),
+        };
+        gfx::buffer_binding_description const bufferBindings[] = { { .buffer_index = 0, .stride = 12 } };
+        gfx::attribute_description const attributes[] = { { .location = 0, .buffer_binding_index = 0, .offset = 0, .type = gfx::attribute_type::vec3f } };
+        gfx::descriptor_layout_entry const descriptorEntries[] = { { .location = 0, .type = gfx::descriptor_type::uniform_buffer } };
+        gfx::descriptorgroup_layout_view const layouts[] = { { .entries = descriptorEntries } };
+
+        gfx::renderstate_handle renderstates[2];
+        for (size_t i = 0; i < 2; i++)
+        {
+            renderstates[i] = renderer.create_renderstate({
+                .shaders = shaders,
+                .renderpass = renderer.get_main_renderpass(),
+                .vertex_config = {
+                    .buffer_bindings = bufferBindings,
+                    .attributes = attributes,
+                },
+                .descriptorgroup_layouts = layouts,
+                .flags = { .wireframe = i == 1 },
+            });
+        }
+        CHECK(renderstates[0] != renderstates[1]);
+
+        gfx::buffer_handle uniformBuffer = renderer.create_buffer({ .size = 512, .usage = gfx::buffer_usage::uniform });
+        gfx::descriptorgroup_handle materials[2];
+        for (size_t i = 0; i < 2; i++)
+        {
+            gfx::descriptorgroup_entry const entries[] = { { .location = 0, .resource = { uniformBuffer, gfx::descriptor_type::uniform_buffer } } };
+            materials[i] = renderer.create_descriptorgroup({ .entries = entries });
+        }
+
+        gfx::buffer_handle meshBuffer = renderer.create_buffer({ .size = 1024 });
+        gfx::buffer_with_offset const vertexBuffers[] = { { meshBuffer, 0 } };
+
+        constexpr size_t drawCount = 16;
+
+        auto replay = [&](bool sorted)
+        {
+            test.nullBackend->clear_command_stream();
+            test.nullBackend->reset_statistics();
+
+            renderer.begin_frame();
+            renderer.renderpass_begin({ .renderpass = renderer.get_main_renderpass(), .framebuffer = renderer.acquire_main_framebuffer() });
+
+            gfx::draw_queue queue;
+            for (size_t i = 0; i < drawCount; i++)
+            {
+                size_t renderstate = i % 2;
+                size_t material = (i / 2) % 2;
+
+                gfx::draw_indexed_args args = {
+                    .renderstate = renderstates[renderstate],
+                    .descriptorgroups = { &materials[material], 1 },
+                    .vertex_buffers = vertexBuffers,
+                    .index_buffer = { meshBuffer, 512 },
+                    .index_count = 3,
+                    .first_index = i,
+                };
+
+                if (sorted)
+                    queue.submit(gfx::make_draw_sort_key({ .renderstate = static_cast<uint16_t>(renderstate), .material = static_cast<uint16_t>(material), .depth = static_cast<float>(drawCount - i) }), args);
+                else
+                    renderer.draw_indexed(args);
+            }
+            queue.flush(renderer);
+            CHECK(queue.empty());
+
+            renderer.renderpass_end();
+            renderer.submit();
+
+            CHECK(test.nullBackend->get_statistics().draw_count == drawCount);
+            CHECK(test.nullBackend->get_statistics().validation_errors == 0);
+
+            return test.nullBackend->get_bind_statistics();
+        };
+
+        gfx::bind_statistics unsorted = replay(false);
+        CHECK(unsorted.renderstates.issued_count == drawCount);
+        CHECK(unsorted.descriptorgroups.issued_count == drawCount / 2);
+
+        gfx::bind_statistics sorted = replay(true);
+        CHECK(sorted.renderstates.issued_count == 2);
+        CHECK(sorted.renderstates.skipped_count == drawCount - 2);
+        CHECK(sorted.descriptorgroups.issued_count == 4);
+        CHECK(sorted.descriptorgroups.skipped_count == drawCount - 4);
+        CHECK(sorted.vertex_buffers.issued_count == 1);
+        CHECK(sorted.index_buffers.issued_count == 1);
+
+        // Within a renderstate and material the draws are replayed front-to-back, i.e. in descending submission order
+        gfx_null::command_stream const& commands = test.nullBackend->get_command_stream();
+        nstl::vector<gfx_null::draw_indexed_command> draws;
+        for (gfx_null::command const& command : commands.get_commands())
+            if (command.type == gfx_null::command_type::draw_indexed)
+                draws.push_back(commands.get_draw_indexed(command));
+        CHECK(draws.size() == drawCount);
+
+        for (size_t i = 0; i < drawCount; i++)
+        {
+            size_t group = i / (drawCount / 4);
+            CHECK(draws[i].renderstate == renderstates[group / 2]);
+            CHECK(commands.get_descriptorgroups(draws[i])[0] == materials[group % 2]);
+
+            if (i % (drawCount / 4) != 0)
+                CHECK(draws[i].first_index < draws[i - 1].first_index);
+        }
+    }
+}
+
+int run(int, char**)
+{
+    testSortKeyFieldOrder();
+    testSortOrdersPacketsByKey();
+    testFlushGroupsTheBinds();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,236 @@
+#include "check.h"
+#include "allocation_counter.h"
+
+#include "platform/startup.h"
+
+#include "nstl/flat_hash_map.h"
+#include "nstl/flat_hash_set.h"
+#include "nstl/sprintf.h"
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+#include "nstl/vector.h"
+
+#include <stdint.h>
+
+namespace
+{
+    constexpr size_t elementCount = 1000;
+
+    // Groups of keys share the same hash, so they end up in long clusters which wrap around the end of the table
+    struct CollidingKey
+    {
+        uint32_t value = 0;
+
+        bool operator==(CollidingKey const& rhs) const = default;
+    };
+}
+
+template<>
+struct nstl::hash<CollidingKey>
+{
+    size_t operator()(CollidingKey const& key) const
+    {
+        return key.value / 16;
+    }
+};
+
+namespace
+{
+
+    nstl::string createName(size_t index)
+    {
+        return nstl::sprintf("assets/meshes/mesh_%zu", index);
+    }
+
+    // The lookups use a different key type than the stored one, so they would probe different slots
+    // if the hash of the lookup type was used instead of the hash of the stored type
+    void testHeterogeneousLookupsAfterRehash()
+    {
+        nstl::flat_hash_map<nstl::string, size_t> map;
+        for (size_t i = 0; i < elementCount; i++)
+            map.insert_or_assign(createName(i), i);
+
+        CHECK(map.size() == elementCount);
+
+        for (size_t i = 0; i < elementCount; i++)
+        {
+            nstl::string name = createName(i);
+
+            auto it = map.find(nstl::string_view{ name });
+            CHECK(it != map.end());
+            CHECK(it->value() == i);
+
+            CHECK(map.find(name.c_str()) != map.end());
+        }
+
+        CHECK(map.find("assets/meshes/mesh_0") != map.end());
+        CHECK(map.find(nstl::string_view{ "assets/meshes/missing" }) == map.end());
+    }
+
+    void testHeterogeneousErase()
+    {
+        nstl::flat_hash_set<uint64_t> set;
+        for (uint64_t i = 0; i < elementCount; i++)
+            set.insert(i * 7919);
+
+        // Every erase shifts the following elements of the cluster back, using the hash of the stored type
+        for (uint32_t i = 0; i < elementCount; i += 2)
+            CHECK(set.erase(i * 7919u));
+
+        CHECK(set.size() == elementCount / 2);
+
+        for (uint32_t i = 0; i < elementCount; i++)
+            CHECK(set.contains(i * 7919u) == (i % 2 == 1));
+    }
+
+    void testStringViewLookupDoesNotAllocate()
+    {
+        nstl::flat_hash_map<nstl::string, size_t> map;
+        for (size_t i = 0; i < elementCount; i++)
+            map.insert_or_assign(createName(i), i);
+
+        nstl::string name = createName(elementCount / 2);
+        nstl::string_view nameView = name;
+
+        AllocationCounter counter;
+
+        CHECK(map.find(nameView) != map.end());
+        CHECK(map[nameView] == elementCount / 2);
+        CHECK(map.find(name.c_str()) != map.end());
+
+        CHECK(counter.getAllocationCount() == 0);
+    }
+
+    // The table never has more than 3/4 of the slots in use, and grows to the next power of 2 only when it has to
+    void testGrowthAcrossLoadFactor()
+    {
+        nstl::flat_hash_set<uint32_t> set;
+        CHECK(set.capacity() == 0);
+
+        size_t const initialCapacity = [&]
+        {
+            set.insert(0);
+            return set.capacity();
+        }();
+        CHECK(initialCapacity > 0);
+
+        size_t growCount = 0;
+        for (uint32_t i = 1; i < elementCount; i++)
+        {
+            size_t capacity = set.capacity();
+            CHECK(set.insert(i));
+
+            if (set.capacity() != capacity)
+            {
+                CHECK(set.capacity() == capacity * 2);
+                CHECK(i == capacity - capacity / 4);
+                growCount++;
+            }
+
+            CHECK(set.size() <= set.capacity() - set.capacity() / 4);
+        }
+        CHECK(growCount > 0);
+
+        for (uint32_t i = 0; i < elementCount; i++)
+            CHECK(set.contains(i));
+        CHECK(!set.contains(static_cast<uint32_t>(elementCount)));
+
+        // Inserting an existing key never grows the table
+        size_t capacity = set.capacity();
+        for (uint32_t i = 0; i < elementCount; i++)
+            CHECK(!set.insert(i));
+        CHECK(set.size() == elementCount && set.capacity() == capacity);
+    }
+
+    // Erased slots are emptied by shifting the cluster back instead of leaving tombstones, so the table doesn't grow
+    // from insert/erase churn, and a rehash after many erasures only moves the remaining elements
+    void testRehashAfterErase()
+    {
+        nstl::flat_hash_map<CollidingKey, uint32_t> map;
+        for (uint32_t i = 0; i < elementCount; i++)
+            map.insert_or_assign({ i }, i);
+
+        for (uint32_t i = 0; i < elementCount; i++)
+            if (i % 3 != 0)
+                CHECK(map.erase(CollidingKey{ i }));
+
+        size_t const remainingCount = (elementCount + 2) / 3;
+        CHECK(map.size() == remainingCount);
+
+        size_t capacity = map.capacity();
+        for (uint32_t round = 0; round < 10; round++)
+        {
+            for (uint32_t i = 0; i < elementCount; i++)
+                if (i % 3 != 0)
+                    map.insert_or_assign({ static_cast<uint32_t>(elementCount) + i }, i);
+
+            for (uint32_t i = 0; i < elementCount; i++)
+                if (i % 3 != 0)
+                    CHECK(map.erase(CollidingKey{ static_cast<uint32_t>(elementCount) + i }));
+        }
+        CHECK(map.size() == remainingCount);
+        CHECK(map.capacity() == capacity);
+
+        // Grows the table with the erased slots in between the remaining elements
+        map.reserve(capacity);
+        CHECK(map.capacity() > capacity);
+
+        for (uint32_t i = 0; i < 2 * elementCount; i++)
+        {
+            auto it = map.find(CollidingKey{ i });
+            CHECK((it != map.end()) == (i < elementCount && i % 3 == 0));
+            if (it != map.end())
+                CHECK(it->value() == i);
+        }
+
+        for (uint32_t i = 0; i < elementCount; i += 3)
+            CHECK(map.erase(CollidingKey{ i }));
+        CHECK(map.empty());
+        CHECK(map.begin() == map.end());
+    }
+
+    void testIterationAfterErase()
+    {
+        nstl::flat_hash_map<CollidingKey, uint32_t> map;
+        for (uint32_t i = 0; i < elementCount; i++)
+            map.insert_or_assign({ i }, 2 * i);
+
+        for (uint32_t i = 0; i < elementCount; i += 3)
+            CHECK(map.erase(CollidingKey{ i }));
+
+        // Every remaining element is visited exactly once, the erased ones aren't visited at all
+        nstl::vector<uint32_t> visitCounts;
+        visitCounts.resize(elementCount, 0);
+
+        size_t count = 0;
+        for (auto const& pair : map)
+        {
+            CHECK(pair.key().value < elementCount);
+            CHECK(pair.value() == 2 * pair.key().value);
+            visitCounts[pair.key().value]++;
+            count++;
+        }
+        CHECK(count == map.size());
+
+        for (uint32_t i = 0; i < elementCount; i++)
+            CHECK(visitCounts[i] == (i % 3 == 0 ? 0u : 1u));
+
+        nstl::flat_hash_map<CollidingKey, uint32_t> const& constMap = map;
+        size_t constCount = 0;
+        for (auto it = constMap.begin(); it != constMap.end(); ++it)
+            constCount++;
+        CHECK(constCount == map.size());
+    }
+}
+
+int run(int, char**)
+{
+    testHeterogeneousLookupsAfterRehash();
+    testHeterogeneousErase();
+    testStringViewLookupDoesNotAllocate();
+    testGrowthAcrossLoadFactor();
+    testRehashAfterErase();
+    testIterationAfterErase();
+
+    return EXIT_SUCCESS;
+}
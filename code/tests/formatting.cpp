@@ -0,0 +1,99 @@
+#include "check.h"
+#include "allocation_counter.h"
+
+#include "common/fmt.h"
+
+#include "platform/startup.h"
+
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+
+// picofmt::args_list keeps up to 16 arguments inline, so formatting into a reserved buffer must not allocate
+
+namespace
+{
+    constexpr size_t bufferCapacity = 512;
+
+    void testFormatToDoesNotAllocate()
+    {
+        nstl::string buffer;
+        buffer.reserve(bufferCapacity);
+
+        nstl::string_view name = "vertex_buffer";
+        nstl::string longName = "a string which is too long to be stored inline";
+
+        AllocationCounter counter;
+
+        common::format_to(buffer, "no arguments;");
+        common::format_to(buffer, "{};", 1);
+        common::format_to(buffer, "{:>6}|{:<6}|{:^6};", 1, 2u, 3l);
+        common::format_to(buffer, "{:#x} {:08.3f} {};", 255u, 3.5, name);
+        common::format_to(buffer, "{:{}};", 7, 4);
+        common::format_to(buffer, "{};", longName);
+        common::format_to(buffer, picofmt::runtime("{1} {0};"), 1, 2);
+
+        CHECK(counter.getAllocationCount() == 0);
+        CHECK(buffer == nstl::string_view{ "no arguments;1;     1|2     |  3   ;0xff 0003.500 vertex_buffer;   7;a string which is too long to be stored inline;2 1;" });
+    }
+
+    void testSixteenArgumentsDoNotAllocate()
+    {
+        nstl::string buffer;
+        buffer.reserve(bufferCapacity);
+
+        // args_list only references the arguments, so they have to outlive it
+        int i = 1;
+        unsigned int u = 2;
+        long l = 3;
+        unsigned long ul = 4;
+        long long ll = 5;
+        unsigned long long ull = 6;
+        short s = 7;
+        unsigned short us = 8;
+        char c = 'c';
+        bool b = true;
+        float f = 0.5f;
+        double d = 2.5;
+        char const* str = "str";
+        nstl::string_view view = "view";
+        nstl::string string = "string";
+        int last = 16;
+
+        AllocationCounter counter;
+
+        picofmt::args_list args{ i, u, l, ul, ll, ull, s, us, c, b, f, d, str, view, string, last };
+        CHECK(args.size() == picofmt::args_list::max_size);
+
+        common::vformat_to(buffer, nstl::string_view{ "{} {} {} {} {} {} {} {} {} {} {} {} {} {} {} {}" }, args);
+        common::format_to(buffer, "|{15} {14} {13} {12} {11} {10} {9} {8} {7} {6} {5} {4} {3} {2} {1} {0}", i, u, l, ul, ll, ull, s, us, c, b, f, d, str, view, string, last);
+
+        CHECK(counter.getAllocationCount() == 0);
+        CHECK(buffer == nstl::string_view{ "1 2 3 4 5 6 7 8 c true 0.5 2.5 str view string 16|16 string view str 2.5 0.5 true c 8 7 6 5 4 3 2 1" });
+    }
+
+    void testReusedBufferDoesNotAllocate()
+    {
+        nstl::string buffer;
+        buffer.reserve(bufferCapacity);
+
+        AllocationCounter counter;
+
+        for (int i = 0; i < 1000; i++)
+        {
+            buffer.resize(0);
+            common::format_to(buffer, "Frame {}: {} draws, {:.2f} ms", i, i % 100, static_cast<double>(i) / 7.0);
+        }
+
+        CHECK(counter.getAllocationCount() == 0);
+        CHECK(buffer == nstl::string_view{ "Frame 999: 99 draws, 142.71 ms" });
+    }
+}
+
+int run(int, char**)
+{
+    testFormatToDoesNotAllocate();
+    testSixteenArgumentsDoNotAllocate();
+    testReusedBufferDoesNotAllocate();
+
+    return EXIT_SUCCESS;
+}
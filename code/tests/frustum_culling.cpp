@@ -0,0 +1,145 @@
+#include "check.h"
+
+#include "tglm/bounds.h"
+#include "tglm/camera.h"
+#include "tglm/types.h"
+
+#include "platform/startup.h"
+
+// The tests are conservative: an object is only culled if it's fully outside of one of the planes,
+// so everything which touches the frustum is reported as intersecting
+
+namespace
+{
+    // The camera is at the origin and looks down -Z, with a 90 degree field of view
+    tglm::frustum createFrustum()
+    {
+        float const fovy = 3.14159265f / 2.0f;
+        return tglm::extract_frustum(tglm::perspective(fovy, 1.0f, 1.0f, 100.0f));
+    }
+
+    tglm::aabb createBox(tglm::vec3 const& center, float halfSize)
+    {
+        return { { center.x - halfSize, center.y - halfSize, center.z - halfSize }, { center.x + halfSize, center.y + halfSize, center.z + halfSize } };
+    }
+
+    // Both shapes have to be classified the same way for the points which aren't near the edges of the frustum
+    void checkClassification(tglm::frustum const& frustum, tglm::vec3 const& center, float size, bool isVisible)
+    {
+        tglm::aabb box = createBox(center, size);
+        tglm::sphere sphere{ .center = center, .radius = size };
+
+        CHECK(tglm::intersects(frustum, box) == isVisible);
+        CHECK(tglm::intersects(frustum, sphere) == isVisible);
+        CHECK(tglm::intersects(frustum, tglm::bounding_sphere(box)) == isVisible);
+    }
+
+    void testPlanesAreNormalized()
+    {
+        tglm::frustum frustum = createFrustum();
+
+        for (tglm::vec4 const& plane : frustum.planes)
+        {
+            float lengthSquared = plane.x * plane.x + plane.y * plane.y + plane.z * plane.z;
+            CHECK(lengthSquared > 0.999f && lengthSquared < 1.001f);
+        }
+    }
+
+    void testInside()
+    {
+        tglm::frustum frustum = createFrustum();
+
+        checkClassification(frustum, { 0.0f, 0.0f, -10.0f }, 1.0f, true);
+        checkClassification(frustum, { 5.0f, -5.0f, -50.0f }, 0.5f, true);
+        checkClassification(frustum, { 0.0f, 0.0f, -99.0f }, 0.5f, true);
+
+        // Bigger than the frustum
+        checkClassification(frustum, { 0.0f, 0.0f, 0.0f }, 1000.0f, true);
+    }
+
+    void testOutside()
+    {
+        tglm::frustum frustum = createFrustum();
+
+        // Behind the camera, in front of the near plane and beyond the far plane
+        checkClassification(frustum, { 0.0f, 0.0f, 10.0f }, 1.0f, false);
+        checkClassification(frustum, { 0.0f, 0.0f, -0.25f }, 0.25f, false);
+        checkClassification(frustum, { 0.0f, 0.0f, -110.0f }, 1.0f, false);
+
+        // Beyond each side plane
+        checkClassification(frustum, { -30.0f, 0.0f, -10.0f }, 1.0f, false);
+        checkClassification(frustum, { 30.0f, 0.0f, -10.0f }, 1.0f, false);
+        checkClassification(frustum, { 0.0f, -30.0f, -10.0f }, 1.0f, false);
+        checkClassification(frustum, { 0.0f, 30.0f, -10.0f }, 1.0f, false);
+    }
+
+    void testIntersecting()
+    {
+        tglm::frustum frustum = createFrustum();
+
+        // The center is outside, but the shape reaches into the frustum through each plane
+        checkClassification(frustum, { -11.0f, 0.0f, -10.0f }, 2.0f, true);
+        checkClassification(frustum, { 11.0f, 0.0f, -10.0f }, 2.0f, true);
+        checkClassification(frustum, { 0.0f, -11.0f, -10.0f }, 2.0f, true);
+        checkClassification(frustum, { 0.0f, 11.0f, -10.0f }, 2.0f, true);
+        checkClassification(frustum, { 0.0f, 0.0f, -101.0f }, 2.0f, true);
+        checkClassification(frustum, { 0.0f, 0.0f, -0.5f }, 1.0f, true);
+    }
+
+    // The bounding sphere encloses the corners, so it can reach into the frustum while the box doesn't
+    void testSphereIsMoreConservative()
+    {
+        tglm::frustum frustum = createFrustum();
+
+        // Just beyond the left plane
+        tglm::aabb box = createBox({ -12.2f, 0.0f, -10.0f }, 1.0f);
+        tglm::sphere sphere = tglm::bounding_sphere(box);
+
+        CHECK(sphere.radius > 1.73f && sphere.radius < 1.74f);
+        CHECK(!tglm::intersects(frustum, box));
+        CHECK(tglm::intersects(frustum, sphere));
+
+        // A box which passes is never culled by its bounding sphere
+
+        for (float x = -40.0f; x <= 40.0f; x += 1.5f)
+        {
+            for (float y = -40.0f; y <= 40.0f; y += 1.5f)
+            {
+                for (float z = -120.0f; z <= 20.0f; z += 3.5f)
+                {
+                    tglm::aabb b = createBox({ x, y, z }, 1.0f);
+                    if (tglm::intersects(frustum, b))
+                        CHECK(tglm::intersects(frustum, tglm::bounding_sphere(b)));
+                }
+            }
+        }
+    }
+
+    void testTransformedBoxes()
+    {
+        tglm::frustum frustum = createFrustum();
+        tglm::aabb box = createBox({ 0.0f, 0.0f, 0.0f }, 1.0f);
+
+        tglm::mat4 translation = tglm::mat4::identity();
+        translation.data[3][2] = -20.0f;
+        CHECK(tglm::intersects(frustum, tglm::transformed(box, translation)));
+
+        translation.data[3][2] = 20.0f;
+        CHECK(!tglm::intersects(frustum, tglm::transformed(box, translation)));
+
+        // Empty boxes stay empty, the callers decide whether they are culled
+        CHECK(tglm::transformed(tglm::aabb::empty(), translation).is_empty());
+    }
+}
+
+int run(int, char**)
+{
+    testPlanesAreNormalized();
+    testInside();
+    testOutside();
+    testIntersecting();
+    testSphereIsMoreConservative();
+    testTransformedBoxes();
+
+    return EXIT_SUCCESS;
+}
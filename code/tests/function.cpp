@@ -0,0 +1,106 @@
+#include "check.h"
+#include "allocation_counter.h"
+
+#include "platform/startup.h"
+
+#include "nstl/function.h"
+#include "nstl/utility.h"
+
+namespace
+{
+    struct NonTrivial
+    {
+        NonTrivial(int value) : value(value) {}
+        NonTrivial(NonTrivial const& rhs) : value(rhs.value) {}
+        ~NonTrivial() {}
+
+        int value = 0;
+    };
+
+    int addOne(int value)
+    {
+        return value + 1;
+    }
+
+    void testSmallTrivialCallableIsInline()
+    {
+        AllocationCounter counter;
+
+        int a = 1;
+        int b = 2;
+        nstl::function<int(int)> func = [&a, &b](int value) { return a + b + value; };
+        CHECK(func(3) == 6);
+
+        nstl::function<int(int)> moved = nstl::move(func);
+        CHECK(moved(4) == 7);
+
+        nstl::function<int(int)> pointer = &addOne;
+        CHECK(pointer(1) == 2);
+
+        CHECK(counter.getAllocationCount() == 0);
+    }
+
+    void testLargeCallableAllocatesOnce()
+    {
+        AllocationCounter counter;
+
+        {
+            int values[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+            nstl::function<int()> func = [values]() { return values[0] + values[7]; };
+            CHECK(func() == 9);
+            CHECK(counter.getAllocationCount() == 1);
+
+            nstl::function<int()> moved = nstl::move(func);
+            CHECK(moved() == 9);
+            CHECK(counter.getAllocationCount() == 1);
+        }
+
+        CHECK(counter.getActiveAllocationCount() == 0);
+    }
+
+    void testNonTrivialCallableAllocatesOnce()
+    {
+        AllocationCounter counter;
+
+        {
+            NonTrivial captured{ 5 };
+            nstl::function<int()> func = [captured]() { return captured.value; };
+            CHECK(func() == 5);
+            CHECK(counter.getAllocationCount() == 1);
+
+            nstl::function<int()> moved;
+            moved = nstl::move(func);
+            CHECK(moved() == 5);
+            CHECK(counter.getAllocationCount() == 1);
+        }
+
+        CHECK(counter.getActiveAllocationCount() == 0);
+    }
+
+    int callRef(nstl::function_ref<int(int)> func, int value)
+    {
+        return func(value);
+    }
+
+    void testFunctionRefNeverAllocates()
+    {
+        AllocationCounter counter;
+
+        int values[16] = { 1 };
+        NonTrivial captured{ 10 };
+        CHECK(callRef([values, captured](int value) { return value + values[0] + captured.value; }, 1) == 12);
+        CHECK(callRef(&addOne, 1) == 2);
+
+        CHECK(counter.getAllocationCount() == 0);
+    }
+}
+
+int run(int, char**)
+{
+    testSmallTrivialCallableIsInline();
+    testLargeCallableAllocatesOnce();
+    testNonTrivialCallableAllocatesOnce();
+    testFunctionRefNeverAllocates();
+
+    return EXIT_SUCCESS;
+}
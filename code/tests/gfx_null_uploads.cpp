@@ -0,0 +1,156 @@
+#include "check.h"
+
+#include "gfx_null/backend.h"
+
+#include "gfx/resources.h"
+
+#include "platform/startup.h"
+
+#include "nstl/vector.h"
+
+// The tickets of the asynchronous uploads complete in the order they were issued, so completing
+// a ticket completes all the earlier ones, but never a later one
+
+namespace
+{
+    gfx::upload_ticket upload(gfx_null::backend& backend, gfx::buffer_handle buffer, size_t size)
+    {
+        nstl::vector<unsigned char> bytes;
+        bytes.resize(size, 0);
+
+        gfx::memory_reader reader{ { bytes.data(), bytes.size() } };
+        return backend.buffer_upload_async(buffer, reader, 0);
+    }
+
+    void testUploadsCompleteAfterLatency()
+    {
+        gfx_null::backend backend{ 64, 64, { .staging_buffer_size = 1024, .upload_latency_frames = 1 } };
+        gfx::buffer_handle buffer = backend.create_buffer({ .size = 512 });
+
+        backend.begin_resource_update();
+        gfx::upload_ticket first = upload(backend, buffer, 128);
+        gfx::upload_ticket second = upload(backend, buffer, 128);
+        CHECK(first.value < second.value);
+        CHECK(!backend.is_upload_complete(first));
+        CHECK(!backend.is_upload_complete(second));
+
+        backend.begin_resource_update();
+        CHECK(backend.is_upload_complete(first));
+        CHECK(backend.is_upload_complete(second));
+
+        CHECK(backend.get_statistics().validation_errors == 0);
+    }
+
+    void testEmptyUploadDoesNotCompleteEarlierUploads()
+    {
+        gfx_null::backend backend{ 64, 64, { .staging_buffer_size = 1024, .upload_latency_frames = 1 } };
+        gfx::buffer_handle buffer = backend.create_buffer({ .size = 512 });
+
+        backend.begin_resource_update();
+        gfx::upload_ticket pending = upload(backend, buffer, 128);
+        gfx::upload_ticket empty = upload(backend, buffer, 0);
+        CHECK(!backend.is_upload_complete(pending));
+        CHECK(!backend.is_upload_complete(empty));
+
+        backend.begin_resource_update();
+        CHECK(backend.is_upload_complete(pending));
+        CHECK(backend.is_upload_complete(empty));
+
+        // An empty upload followed by a real one: waiting for the empty one doesn't complete the later one
+        gfx::upload_ticket emptyFirst = upload(backend, buffer, 0);
+        gfx::upload_ticket later = upload(backend, buffer, 128);
+        backend.wait_for_upload(emptyFirst);
+        CHECK(backend.is_upload_complete(emptyFirst));
+        CHECK(!backend.is_upload_complete(later));
+
+        CHECK(backend.get_statistics().validation_errors == 0);
+    }
+
+    void testWaitCompletesEarlierUploadsOnly()
+    {
+        gfx_null::backend backend{ 64, 64, { .staging_buffer_size = 1024, .upload_latency_frames = 2 } };
+        gfx::buffer_handle buffer = backend.create_buffer({ .size = 512 });
+
+        backend.begin_resource_update();
+        gfx::upload_ticket tickets[] = {
+            upload(backend, buffer, 64),
+            upload(backend, buffer, 64),
+            upload(backend, buffer, 64),
+        };
+
+        backend.wait_for_upload(tickets[1]);
+        CHECK(backend.is_upload_complete(tickets[0]));
+        CHECK(backend.is_upload_complete(tickets[1]));
+        CHECK(!backend.is_upload_complete(tickets[2]));
+
+        // Waiting for an older ticket again doesn't change anything
+        backend.wait_for_upload(tickets[0]);
+        CHECK(!backend.is_upload_complete(tickets[2]));
+
+        // The remaining upload still completes after the latency
+        backend.begin_resource_update();
+        CHECK(!backend.is_upload_complete(tickets[2]));
+        backend.begin_resource_update();
+        CHECK(backend.is_upload_complete(tickets[2]));
+
+        CHECK(backend.get_statistics().validation_errors == 0);
+    }
+
+    void testStagingStallCompletesOldestUpload()
+    {
+        gfx_null::backend backend{ 64, 64, { .staging_buffer_size = 256, .upload_latency_frames = 1 } };
+        gfx::buffer_handle buffer = backend.create_buffer({ .size = 512 });
+
+        backend.begin_resource_update();
+        gfx::upload_ticket first = upload(backend, buffer, 200);
+        gfx::upload_ticket second = upload(backend, buffer, 200);
+
+        CHECK(backend.get_statistics().upload_stall_count == 1);
+        CHECK(backend.is_upload_complete(first));
+        CHECK(!backend.is_upload_complete(second));
+
+        backend.begin_resource_update();
+        CHECK(backend.is_upload_complete(second));
+
+        CHECK(backend.get_statistics().validation_errors == 0);
+    }
+
+    // The uploads of a frame retire the frame after, so the staging memory is reused from the beginning of the ring
+    void testStagingWrapsAroundWithoutStalls()
+    {
+        gfx_null::backend backend{ 64, 64, { .staging_buffer_size = 256, .upload_latency_frames = 1 } };
+        gfx::buffer_handle buffer = backend.create_buffer({ .size = 512 });
+
+        gfx::upload_ticket previous[2];
+        for (size_t frame = 0; frame < 10; frame++)
+        {
+            backend.begin_resource_update();
+            for (gfx::upload_ticket ticket : previous)
+                CHECK(backend.is_upload_complete(ticket));
+
+            gfx::upload_ticket first = upload(backend, buffer, 100);
+            gfx::upload_ticket second = upload(backend, buffer, 100);
+            CHECK(first.value < second.value);
+            CHECK(!previous[1] || previous[1].value < first.value);
+            CHECK(!backend.is_upload_complete(first));
+            CHECK(!backend.is_upload_complete(second));
+
+            previous[0] = first;
+            previous[1] = second;
+        }
+
+        CHECK(backend.get_statistics().upload_stall_count == 0);
+        CHECK(backend.get_statistics().validation_errors == 0);
+    }
+}
+
+int run(int, char**)
+{
+    testUploadsCompleteAfterLatency();
+    testEmptyUploadDoesNotCompleteEarlierUploads();
+    testWaitCompletesEarlierUploadsOnly();
+    testStagingStallCompletesOldestUpload();
+    testStagingWrapsAroundWithoutStalls();
+
+    return EXIT_SUCCESS;
+}
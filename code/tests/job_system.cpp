@@ -0,0 +1,216 @@
+#include "check.h"
+#include "allocation_counter.h"
+
+#include "mt/atomic.h"
+#include "mt/job_system.h"
+#include "mt/thread.h"
+
+#include "platform/startup.h"
+
+#include "nstl/vector.h"
+
+#include <stdint.h>
+
+// Stress test: every case runs with different worker counts. Without workers the waiting thread does all the work
+
+namespace
+{
+    void testManyJobs(mt::job_system& jobs)
+    {
+        constexpr uint64_t jobCount = 20000;
+
+        mt::atomic<uint64_t> sum;
+        mt::job_counter counter;
+
+        for (uint64_t i = 1; i <= jobCount; i++)
+            jobs.run(counter, [&sum, i]() { sum.fetch_add(i); });
+
+        jobs.wait(counter);
+
+        CHECK(counter.is_done());
+        CHECK(sum.load_relaxed() == jobCount * (jobCount + 1) / 2);
+    }
+
+    // Every job starts two more until the depth runs out and waits for them, so the waits are nested
+    uint64_t countNodes(mt::job_system& jobs, size_t depth)
+    {
+        if (depth == 0)
+            return 1;
+
+        uint64_t left = 0;
+        uint64_t right = 0;
+
+        mt::job_counter counter;
+        jobs.run(counter, [&jobs, &left, depth]() { left = countNodes(jobs, depth - 1); });
+        jobs.run(counter, [&jobs, &right, depth]() { right = countNodes(jobs, depth - 1); });
+        jobs.wait(counter);
+
+        return 1 + left + right;
+    }
+
+    void testNestedWaits(mt::job_system& jobs)
+    {
+        constexpr size_t depth = 12;
+        CHECK(countNodes(jobs, depth) == (uint64_t{ 1 } << (depth + 1)) - 1);
+    }
+
+    // More jobs than fit into the deque of a worker, the rest goes to the shared queue
+    void testDequeOverflow(mt::job_system& jobs)
+    {
+        constexpr uint64_t jobCount = 10000;
+
+        mt::atomic<uint64_t> executed;
+        mt::job_counter outerCounter;
+
+        jobs.run(outerCounter, [&jobs, &executed]()
+        {
+            mt::job_counter counter;
+            for (uint64_t i = 0; i < jobCount; i++)
+                jobs.run(counter, [&executed]() { executed.fetch_add(1); });
+            jobs.wait(counter);
+        });
+
+        jobs.wait(outerCounter);
+
+        CHECK(executed.load_relaxed() == jobCount);
+    }
+
+    void testParallelFor(mt::job_system& jobs)
+    {
+        constexpr size_t count = 100000;
+
+        nstl::vector<uint32_t> values;
+        values.resize(count, 0);
+
+        jobs.parallel_for(count, 0, [&values](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                values[i]++;
+        });
+
+        for (uint32_t value : values)
+            CHECK(value == 1);
+
+        // Chunks of a single element, and a range which doesn't divide evenly
+        mt::atomic<uint64_t> sum;
+        jobs.parallel_for(1001, 1, [&sum](size_t begin, size_t end)
+        {
+            CHECK(end == begin + 1);
+            sum.fetch_add(begin);
+        });
+        CHECK(sum.load_relaxed() == 1000 * 1001 / 2);
+
+        jobs.parallel_for(0, 0, [](size_t, size_t) { CHECK(false); });
+    }
+
+    // Several threads outside of the job system start jobs and wait for them at the same time
+    void testConcurrentSubmitters(mt::job_system& jobs)
+    {
+        constexpr size_t threadCount = 4;
+        constexpr uint64_t jobsPerThread = 2000;
+
+        mt::atomic<uint64_t> executed;
+
+        nstl::vector<mt::thread> threads;
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            threads.push_back(mt::thread{ "Submitter", [&jobs, &executed]()
+            {
+                for (size_t batch = 0; batch < 4; batch++)
+                {
+                    mt::job_counter counter;
+                    for (uint64_t j = 0; j < jobsPerThread / 4; j++)
+                        jobs.run(counter, [&executed]() { executed.fetch_add(1); });
+                    jobs.wait(counter);
+                    CHECK(counter.is_done());
+                }
+            } });
+        }
+
+        for (mt::thread& thread : threads)
+            thread.join();
+
+        CHECK(executed.load_relaxed() == threadCount * jobsPerThread);
+    }
+
+    void testWaitWithoutJobs(mt::job_system& jobs)
+    {
+        mt::job_counter counter;
+        CHECK(counter.is_done());
+        jobs.wait(counter);
+    }
+
+    // Without workers everything runs on this thread, so the allocations of the job system are all counted here
+    void testFinishedJobsAreReused()
+    {
+        mt::job_system jobs{ 0 };
+
+        mt::atomic<uint64_t> sum;
+        auto runJobs = [&jobs, &sum]()
+        {
+            mt::job_counter counter;
+            for (uint64_t i = 0; i < 100; i++)
+                jobs.run(counter, [&sum, i]() { sum.fetch_add(i); });
+            jobs.wait(counter);
+
+            jobs.parallel_for(1000, 10, [&sum](size_t begin, size_t end) { sum.fetch_add(end - begin); });
+        };
+
+        runJobs();
+
+        AllocationCounter counter;
+        for (size_t iteration = 0; iteration < 10; iteration++)
+            runJobs();
+
+        CHECK(counter.getAllocationCount() == 0);
+        CHECK(sum.load_relaxed() == 11 * (100 * 99 / 2 + 1000));
+    }
+
+    // The jobs which were started but never waited for are executed by the destructor instead of being leaked
+    void testDestructorRunsQueuedJobs(size_t workerCount)
+    {
+        constexpr uint64_t jobCount = 1000;
+
+        mt::atomic<uint64_t> executed;
+        mt::job_counter counter;
+
+        {
+            mt::job_system jobs{ workerCount };
+            for (uint64_t i = 0; i < jobCount; i++)
+                jobs.run(counter, [&executed]() { executed.fetch_add(1); });
+        }
+
+        CHECK(counter.is_done());
+        CHECK(executed.load_relaxed() == jobCount);
+    }
+}
+
+int run(int, char**)
+{
+    auto runCases = [](mt::job_system& jobs)
+    {
+        for (size_t iteration = 0; iteration < 5; iteration++)
+        {
+            testManyJobs(jobs);
+            testNestedWaits(jobs);
+            testDequeOverflow(jobs);
+            testParallelFor(jobs);
+            testConcurrentSubmitters(jobs);
+            testWaitWithoutJobs(jobs);
+        }
+    };
+
+    size_t const workerCounts[] = { 0, 1, 3, 8, mt::job_system::get_default_worker_count() };
+    for (size_t workerCount : workerCounts)
+    {
+        mt::job_system jobs{ workerCount };
+        CHECK(jobs.get_worker_count() == workerCount);
+        runCases(jobs);
+
+        testDestructorRunsQueuedJobs(workerCount);
+    }
+
+    testFinishedJobsAreReused();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,241 @@
+#include "check.h"
+
+#include "logging/logging.h"
+
+#include "mt/thread.h"
+
+#include "platform/startup.h"
+
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+#include "nstl/unique_ptr.h"
+#include "nstl/vector.h"
+
+#include <stdio.h>
+
+// The logger is global, so all the cases share it: they flush the messages and reset the sink between them
+
+namespace
+{
+    constexpr size_t queueSize = 8;
+
+    struct SinkState
+    {
+        nstl::vector<nstl::string> lines;
+        size_t flushCount = 0;
+
+        // Messages the sink logs itself when it gets the trigger message
+        size_t nestedMessageCount = 0;
+    };
+
+    // Lives in run(), so that its strings are freed before the memory tracking is destroyed
+    SinkState* sinkState = nullptr;
+
+    class TestSink final : public logging::sink
+    {
+    public:
+        void log(nstl::string_view str) override
+        {
+            sinkState->lines.push_back(nstl::string{ str });
+
+            if (str.ends_with("] trigger\n"))
+                for (size_t i = 0; i < sinkState->nestedMessageCount; i++)
+                    logging::info("nested {}", i);
+        }
+
+        void flush() override
+        {
+            sinkState->flushCount++;
+        }
+    };
+
+    nstl::string_view getText(nstl::string_view line)
+    {
+        size_t start = line.find("] ");
+        CHECK(start != nstl::string_view::npos);
+        CHECK(line.ends_with("\n"));
+        return line.substr(start + 2, line.size() - start - 3);
+    }
+
+    nstl::string format(char const* format, size_t value)
+    {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), format, value);
+        return buffer;
+    }
+
+    void reset()
+    {
+        logging::flush();
+        sinkState->lines.clear();
+        sinkState->flushCount = 0;
+        sinkState->nestedMessageCount = 0;
+    }
+
+    // A sink which logs would reenter itself when the messages are written synchronously, so those messages are counted
+    void testSynchronousWrites()
+    {
+        reset();
+
+        logging::info("first");
+        CHECK(sinkState->lines.size() == 1 && getText(sinkState->lines[0]) == "first");
+        CHECK(sinkState->flushCount == 1);
+
+        sinkState->nestedMessageCount = 3;
+        logging::info("trigger");
+        CHECK(sinkState->lines.size() == 3);
+        CHECK(getText(sinkState->lines[1]) == "trigger");
+        CHECK(nstl::string_view{ sinkState->lines[2] }.find("[WARN]") != nstl::string_view::npos);
+        CHECK(getText(sinkState->lines[2]) == "3 messages logged from the sinks were dropped");
+    }
+
+    void testOrdering()
+    {
+        reset();
+
+        // Many more messages than fit into the queue, the caller waits for the space
+        constexpr size_t messageCount = 1000;
+        for (size_t i = 0; i < messageCount; i++)
+            logging::info("message {}", i);
+
+        logging::flush();
+        CHECK(sinkState->lines.size() == messageCount);
+        for (size_t i = 0; i < messageCount; i++)
+            CHECK(getText(sinkState->lines[i]) == format("message %zu", i));
+
+        reset();
+
+        // The messages of different threads interleave, but every thread keeps its own order
+        constexpr size_t threadCount = 4;
+        constexpr size_t messagesPerThread = 500;
+
+        nstl::vector<mt::thread> threads;
+        for (size_t thread = 0; thread < threadCount; thread++)
+        {
+            threads.push_back(mt::thread{ "Logging test", [thread]()
+            {
+                for (size_t i = 0; i < messagesPerThread; i++)
+                    logging::info("thread {} message {}", thread, i);
+            } });
+        }
+        for (mt::thread& thread : threads)
+            thread.join();
+
+        logging::flush();
+        CHECK(sinkState->lines.size() == threadCount * messagesPerThread);
+
+        size_t nextMessages[threadCount] = {};
+        for (nstl::string const& line : sinkState->lines)
+        {
+            nstl::string_view text = getText(line);
+
+            size_t thread = 0;
+            size_t message = 0;
+            nstl::string textCopy{ text };
+            CHECK(sscanf(textCopy.c_str(), "thread %zu message %zu", &thread, &message) == 2);
+            CHECK(thread < threadCount);
+            CHECK(message == nextMessages[thread]++);
+        }
+        for (size_t count : nextMessages)
+            CHECK(count == messagesPerThread);
+    }
+
+    void testFlush()
+    {
+        reset();
+
+        for (size_t i = 0; i < 3; i++)
+            logging::warn("warning {}", i);
+
+        // Everything that was logged before is written and the sinks are flushed by the time flush() returns
+        logging::flush();
+        CHECK(sinkState->lines.size() == 3);
+        CHECK(sinkState->flushCount >= 1);
+        for (nstl::string const& line : sinkState->lines)
+            CHECK(nstl::string_view{ line }.find("[WARN]") != nstl::string_view::npos);
+
+        size_t flushCount = sinkState->flushCount;
+        logging::flush();
+        CHECK(sinkState->flushCount == flushCount + 1);
+        CHECK(sinkState->lines.size() == 3);
+    }
+
+    // Messages longer than the inline storage of the queue slots
+    void testLongMessages()
+    {
+        reset();
+
+        nstl::string text;
+        for (size_t i = 0; i < 1000; i++)
+            text.push_back(static_cast<char>('a' + i % 26));
+
+        for (size_t i = 0; i < 2 * queueSize; i++)
+            logging::error("{} {}", i, text);
+
+        logging::flush();
+        CHECK(sinkState->lines.size() == 2 * queueSize);
+        for (size_t i = 0; i < 2 * queueSize; i++)
+        {
+            nstl::string expected = format("%zu ", i);
+            expected += text;
+            CHECK(getText(sinkState->lines[i]) == expected);
+        }
+    }
+
+    // Only the thread writing the messages could free the space in the queue, so the messages a sink logs
+    // while the queue is full are counted and reported once the queued messages are written
+    void testQueueOverflowFromSink()
+    {
+        reset();
+
+        sinkState->nestedMessageCount = 3;
+        logging::info("trigger");
+        logging::flush();
+        CHECK(sinkState->lines.size() == 4);
+        for (size_t i = 0; i < 3; i++)
+            CHECK(getText(sinkState->lines[1 + i]) == format("nested %zu", i));
+
+        reset();
+
+        // The slot of the trigger message is still in use while it's being written
+        sinkState->nestedMessageCount = 2 * queueSize;
+        logging::info("trigger");
+        logging::flush();
+
+        size_t const queuedCount = queueSize - 1;
+        CHECK(sinkState->lines.size() == 1 + queuedCount + 1);
+        CHECK(getText(sinkState->lines[0]) == "trigger");
+        for (size_t i = 0; i < queuedCount; i++)
+            CHECK(getText(sinkState->lines[1 + i]) == format("nested %zu", i));
+        CHECK(getText(sinkState->lines.back()) == format("%zu messages logged from the sinks were dropped", 2 * queueSize - queuedCount));
+
+        // The count is reported once
+        reset();
+        logging::info("after");
+        logging::flush();
+        CHECK(sinkState->lines.size() == 1);
+    }
+}
+
+int run(int, char**)
+{
+    SinkState state;
+    sinkState = &state;
+
+    logging::add_sink(nstl::make_unique<TestSink>());
+
+    testSynchronousWrites();
+
+    logging::init({ .queue_size = queueSize });
+
+    testOrdering();
+    testFlush();
+    testLongMessages();
+    testQueueOverflowFromSink();
+
+    logging::shutdown();
+
+    testSynchronousWrites();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+#include "check.h"
+
+#include "memory/memory.h"
+#include "memory/tracking.h"
+
+#include "mt/thread.h"
+
+#include "platform/startup.h"
+
+#include "nstl/vector.h"
+
+namespace
+{
+    memory::tracking::scope_stat getScopeStat(memory::tracking::scope_id id)
+    {
+        nstl::vector<memory::tracking::scope_stat> stats = memory::tracking::get_scope_stats_copy();
+        CHECK(id.index < stats.size());
+        return stats[id.index];
+    }
+
+    // Frees its memory in a thread_local destructor which runs after the tracking data of the thread is destroyed
+    struct LateDeallocation
+    {
+        ~LateDeallocation()
+        {
+            memory::deallocate(ptr);
+        }
+
+        void* ptr = nullptr;
+    };
+
+    void testScopeCounters()
+    {
+        static memory::tracking::scope_id const scopeId = memory::tracking::create_scope_id("Test/Counters");
+
+        void* ptr = nullptr;
+        {
+            MEMORY_TRACKING_SCOPE(scopeId);
+            ptr = memory::allocate(100, 16);
+        }
+
+        memory::tracking::scope_stat stat = getScopeStat(scopeId);
+        CHECK(stat.active_bytes == 100);
+        CHECK(stat.active_allocations == 1);
+
+        memory::deallocate(ptr);
+
+        stat = getScopeStat(scopeId);
+        CHECK(stat.active_bytes == 0);
+        CHECK(stat.active_allocations == 0);
+        CHECK(stat.total_bytes == 100);
+        CHECK(stat.total_allocations == 1);
+    }
+
+    void testDeallocationAfterThreadExit()
+    {
+        static memory::tracking::scope_id const scopeId = memory::tracking::create_scope_id("Test/ThreadExit");
+
+        constexpr size_t threadCount = 8;
+        constexpr size_t allocationSize = 32;
+
+        nstl::vector<mt::thread> threads;
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            threads.push_back(mt::thread{ "Test", []()
+            {
+                // Constructed before the tracking data of the thread, so it is destroyed after it
+                static thread_local LateDeallocation lateDeallocation;
+                LateDeallocation& deallocation = lateDeallocation;
+
+                MEMORY_TRACKING_SCOPE(scopeId);
+                deallocation.ptr = memory::allocate(allocationSize, 16);
+
+                // Makes the other threads reuse the counter blocks while the late deallocations are in flight
+                for (size_t j = 0; j < 100; j++)
+                    memory::deallocate(memory::allocate(allocationSize, 16));
+            } });
+        }
+
+        for (mt::thread& thread : threads)
+            thread.join();
+
+        memory::tracking::scope_stat stat = getScopeStat(scopeId);
+        CHECK(stat.active_bytes == 0);
+        CHECK(stat.active_allocations == 0);
+        CHECK(stat.total_allocations == threadCount * 101);
+        CHECK(stat.total_bytes == threadCount * 101 * allocationSize);
+    }
+
+    void testCallstackSampling()
+    {
+        constexpr size_t allocationCount = 10;
+        constexpr size_t allocationSize = 48;
+
+        memory::tracking::set_callstack_sampling_period(1);
+
+        void* allocations[allocationCount] = {};
+        for (void*& ptr : allocations)
+            ptr = memory::allocate(allocationSize, 16);
+
+        memory::tracking::set_callstack_sampling_period(0);
+
+        // All allocations come from the same callstack, so they end up in the same group
+        bool isGroupFound = false;
+        for (memory::tracking::callstack_stat const& stat : memory::tracking::get_outstanding_allocations_by_callstack())
+        {
+            if (stat.id.index == 0 || stat.active_allocations != allocationCount || stat.active_bytes != allocationCount * allocationSize)
+                continue;
+
+            CHECK(!memory::tracking::get_callstack_frames(stat.id).empty());
+            isGroupFound = true;
+        }
+        CHECK(isGroupFound);
+
+        memory::tracking::dump_outstanding_allocations(4);
+
+        for (void* ptr : allocations)
+            memory::deallocate(ptr);
+
+        for (memory::tracking::callstack_stat const& stat : memory::tracking::get_outstanding_allocations_by_callstack())
+            CHECK(stat.id.index == 0 || stat.active_allocations != allocationCount);
+    }
+}
+
+int run(int, char**)
+{
+    testScopeCounters();
+    testDeallocationAfterThreadExit();
+    testCallstackSampling();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,188 @@
+#include "check.h"
+
+#include "pipeline_cache_file.h"
+
+#include "fs/file.h"
+
+#include "platform/startup.h"
+
+#include "nstl/blob_view.h"
+#include "nstl/vector.h"
+
+#include <string.h>
+
+// The validation of the pipeline cache file doesn't depend on Vulkan, so it's tested without a device.
+// A file which fails the validation is ignored and the pipeline cache starts empty
+
+namespace
+{
+    using gfx_vk::pipeline_cache_read_code;
+
+    gfx_vk::pipeline_cache_device_id createDeviceId()
+    {
+        gfx_vk::pipeline_cache_device_id id{
+            .vendor_id = 0x10de,
+            .device_id = 0x2684,
+            .driver_version = 0x21a40000,
+        };
+        for (size_t i = 0; i < id.cache_uuid.size(); i++)
+            id.cache_uuid[i] = static_cast<uint8_t>(i * 17 + 1);
+        return id;
+    }
+
+    nstl::vector<unsigned char> createData(size_t size)
+    {
+        nstl::vector<unsigned char> data;
+        for (size_t i = 0; i < size; i++)
+            data.push_back(static_cast<unsigned char>(i * 31 + 7));
+        return data;
+    }
+
+    pipeline_cache_read_code read(nstl::vector<unsigned char> const& file, gfx_vk::pipeline_cache_device_id const& device)
+    {
+        nstl::blob_view data;
+        return gfx_vk::read_pipeline_cache_file({ file.data(), file.size() }, device, data);
+    }
+
+    bool isSameData(nstl::blob_view data, nstl::vector<unsigned char> const& expected)
+    {
+        return data.size() == expected.size() && (expected.empty() || memcmp(data.data(), expected.data(), expected.size()) == 0);
+    }
+
+    void testRoundTrip()
+    {
+        gfx_vk::pipeline_cache_device_id device = createDeviceId();
+
+        for (size_t size : { size_t{ 0 }, size_t{ 1 }, size_t{ 1000 } })
+        {
+            nstl::vector<unsigned char> data = createData(size);
+            nstl::vector<unsigned char> file = gfx_vk::write_pipeline_cache_file(device, { data.data(), data.size() });
+
+            nstl::blob_view readData;
+            CHECK(gfx_vk::read_pipeline_cache_file({ file.data(), file.size() }, device, readData) == pipeline_cache_read_code::success);
+            CHECK(isSameData(readData, data));
+
+            // The data isn't copied
+            if (size > 0)
+                CHECK(readData.ucdata() >= file.data() && readData.ucdata() + readData.size() <= file.data() + file.size());
+        }
+    }
+
+    // Same as pipeline_cache::save() and the pipeline_cache constructor
+    void testSaveAndLoad()
+    {
+        char const* path = "test_pipeline_cache.bin";
+
+        gfx_vk::pipeline_cache_device_id device = createDeviceId();
+        nstl::vector<unsigned char> data = createData(4096);
+
+        {
+            nstl::vector<unsigned char> file = gfx_vk::write_pipeline_cache_file(device, { data.data(), data.size() });
+
+            fs::file f;
+            CHECK(f.try_open(path, fs::open_mode::write));
+            CHECK(f.try_write(file.data(), file.size()));
+        }
+
+        nstl::vector<unsigned char> file;
+        {
+            fs::file f;
+            CHECK(f.try_open(path, fs::open_mode::read));
+            file.resize(f.size());
+            CHECK(f.try_read(file.data(), file.size()));
+        }
+
+        CHECK(fs::remove_file(path));
+
+        nstl::blob_view readData;
+        CHECK(gfx_vk::read_pipeline_cache_file({ file.data(), file.size() }, device, readData) == pipeline_cache_read_code::success);
+        CHECK(isSameData(readData, data));
+    }
+
+    void testDeviceMismatch()
+    {
+        gfx_vk::pipeline_cache_device_id device = createDeviceId();
+        nstl::vector<unsigned char> data = createData(100);
+        nstl::vector<unsigned char> file = gfx_vk::write_pipeline_cache_file(device, { data.data(), data.size() });
+
+        gfx_vk::pipeline_cache_device_id otherVendor = device;
+        otherVendor.vendor_id = 0x1002;
+        CHECK(read(file, otherVendor) == pipeline_cache_read_code::error_device_mismatch);
+
+        gfx_vk::pipeline_cache_device_id otherDevice = device;
+        otherDevice.device_id++;
+        CHECK(read(file, otherDevice) == pipeline_cache_read_code::error_device_mismatch);
+
+        // A driver update invalidates the cache
+        gfx_vk::pipeline_cache_device_id otherDriver = device;
+        otherDriver.driver_version++;
+        CHECK(read(file, otherDriver) == pipeline_cache_read_code::error_device_mismatch);
+
+        for (size_t i = 0; i < device.cache_uuid.size(); i++)
+        {
+            gfx_vk::pipeline_cache_device_id otherUuid = device;
+            otherUuid.cache_uuid[i] ^= 0x80;
+            CHECK(read(file, otherUuid) == pipeline_cache_read_code::error_device_mismatch);
+        }
+
+        CHECK(read(file, device) == pipeline_cache_read_code::success);
+    }
+
+    void testTruncatedFile()
+    {
+        gfx_vk::pipeline_cache_device_id device = createDeviceId();
+        nstl::vector<unsigned char> data = createData(100);
+        nstl::vector<unsigned char> file = gfx_vk::write_pipeline_cache_file(device, { data.data(), data.size() });
+        size_t headerSize = file.size() - data.size();
+
+        for (size_t size = 0; size < file.size(); size++)
+        {
+            nstl::vector<unsigned char> truncated;
+            for (size_t i = 0; i < size; i++)
+                truncated.push_back(file[i]);
+
+            pipeline_cache_read_code expected = size < headerSize ? pipeline_cache_read_code::error_too_small : pipeline_cache_read_code::error_size_mismatch;
+            CHECK(read(truncated, device) == expected);
+        }
+
+        // Trailing bytes don't belong to the data either
+        nstl::vector<unsigned char> extended = file;
+        extended.push_back(0);
+        CHECK(read(extended, device) == pipeline_cache_read_code::error_size_mismatch);
+    }
+
+    void testCorruptedFile()
+    {
+        gfx_vk::pipeline_cache_device_id device = createDeviceId();
+        nstl::vector<unsigned char> data = createData(100);
+        nstl::vector<unsigned char> file = gfx_vk::write_pipeline_cache_file(device, { data.data(), data.size() });
+        size_t headerSize = file.size() - data.size();
+
+        for (size_t i = headerSize; i < file.size(); i++)
+        {
+            nstl::vector<unsigned char> corrupted = file;
+            corrupted[i] ^= 1;
+            CHECK(read(corrupted, device) == pipeline_cache_read_code::error_hash_mismatch);
+        }
+
+        // The magic and the version are the first two 32-bit fields of the header
+        nstl::vector<unsigned char> invalidMagic = file;
+        invalidMagic[0] ^= 1;
+        CHECK(read(invalidMagic, device) == pipeline_cache_read_code::error_invalid_magic);
+
+        nstl::vector<unsigned char> invalidVersion = file;
+        invalidVersion[4] ^= 1;
+        CHECK(read(invalidVersion, device) == pipeline_cache_read_code::error_unsupported_version);
+    }
+}
+
+int run(int, char**)
+{
+    testRoundTrip();
+    testSaveAndLoad();
+    testDeviceMismatch();
+    testTruncatedFile();
+    testCorruptedFile();
+
+    return EXIT_SUCCESS;
+}
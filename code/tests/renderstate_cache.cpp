@@ -0,0 +1,194 @@
+#include "check.h"
+
+#include "gfx_null/backend.h"
+
+#include "gfx/renderer.h"
+#include "gfx/resources.h"
+
+#include "platform/startup.h"
+
+#include "nstl/unique_ptr.h"
+
+// The renderer shares identical renderstates and only destroys the backend renderstate after the last reference is released
+
+namespace
+{
+    struct TestRenderer
+    {
+        TestRenderer()
+        {
+            auto backend = nstl::make_unique<gfx_null::backend>(64, 64);
+            nullBackend = backend.get();
+            renderer = nstl::make_unique<gfx::renderer>(nstl::move(backend));
+
+            vertexShader = renderer->create_shader({ .filename = "shader.vert", .stage = gfx::shader_stage::vertex });
+            fragmentShader = renderer->create_shader({ .filename = "shader.frag", .stage = gfx::shader_stage::fragment });
+            otherFragmentShader = renderer->create_shader({ .filename = "other.frag", .stage = gfx::shader_stage::fragment });
+        }
+
+        size_t getBackendRenderstateCount() const
+        {
+            return nullBackend->get_statistics().resource_counts[static_cast<size_t>(gfx_null::resource_type::renderstate)] - nullBackend->get_statistics().destroyed_renderstate_count;
+        }
+
+        gfx_null::backend* nullBackend = nullptr;
+        nstl::unique_ptr<gfx::renderer> renderer;
+
+        gfx::shader_handle vertexShader = nullptr;
+        gfx::shader_handle fragmentShader = nullptr;
+        gfx::shader_handle otherFragmentShader = nullptr;
+    };
+
+    gfx::buffer_binding_description const bufferBindings[] = { { .buffer_index = 0, .stride = 32 } };
+    gfx::attribute_description const attributes[] = {
+        { .location = 0, .buffer_binding_index = 0, .offset = 0, .type = gfx::attribute_type::vec3f },
+        { .location = 1, .buffer_binding_index = 0, .offset = 12, .type = gfx::attribute_type::vec2f },
+    };
+    gfx::descriptor_layout_entry const descriptorEntries[] = { { .location = 0, .type = gfx::descriptor_type::uniform_buffer } };
+
+    // The params point to separate copies of the descriptions, so the cache has to compare them by value
+    struct Params
+    {
+        gfx::shader_handle shaders[2];
+        gfx::buffer_binding_description bufferBindings[1];
+        gfx::attribute_description attributes[2];
+        gfx::descriptor_layout_entry descriptorEntries[1];
+        gfx::descriptorgroup_layout_view layouts[1];
+
+        gfx::renderstate_params params;
+
+        Params(TestRenderer const& test, gfx::renderstate_flags flags = {})
+            : shaders{ test.vertexShader, test.fragmentShader }
+            , bufferBindings{ ::bufferBindings[0] }
+            , attributes{ ::attributes[0], ::attributes[1] }
+            , descriptorEntries{ ::descriptorEntries[0] }
+        {
+            layouts[0] = { .entries = descriptorEntries };
+
+            params = {
+                .shaders = shaders,
+                .renderpass = test.renderer->get_main_renderpass(),
+                .vertex_config = {
+                    .buffer_bindings = bufferBindings,
+                    .attributes = attributes,
+                },
+                .descriptorgroup_layouts = layouts,
+                .flags = flags,
+            };
+        }
+
+        Params(Params const&) = delete;
+    };
+
+    void testIdenticalParamsShareTheRenderstate()
+    {
+        TestRenderer test;
+
+        Params first{ test };
+        Params second{ test };
+
+        gfx::renderstate_handle firstHandle = test.renderer->create_renderstate(first.params);
+        gfx::renderstate_handle secondHandle = test.renderer->create_renderstate(second.params);
+        CHECK(firstHandle);
+        CHECK(firstHandle == secondHandle);
+        CHECK(test.getBackendRenderstateCount() == 1);
+
+        gfx::renderstate_cache_statistics const& statistics = test.renderer->get_renderstate_cache_statistics();
+        CHECK(statistics.request_count == 2);
+        CHECK(statistics.hit_count == 1);
+        CHECK(statistics.unique_count == 1);
+
+        CHECK(test.nullBackend->get_statistics().validation_errors == 0);
+    }
+
+    void testDifferentParamsCreateDifferentRenderstates()
+    {
+        TestRenderer test;
+
+        Params base{ test };
+        gfx::renderstate_handle baseHandle = test.renderer->create_renderstate(base.params);
+
+        Params otherShader{ test };
+        otherShader.shaders[1] = test.otherFragmentShader;
+
+        Params otherFlags{ test, { .wireframe = true } };
+
+        Params otherAttribute{ test };
+        otherAttribute.attributes[1].offset = 16;
+
+        Params otherStride{ test };
+        otherStride.bufferBindings[0].stride = 48;
+
+        Params otherTopology{ test };
+        otherTopology.params.vertex_config.topology = gfx::vertex_topology::triangle_strip;
+
+        Params otherDescriptor{ test };
+        otherDescriptor.descriptorEntries[0].type = gfx::descriptor_type::combined_image_sampler;
+
+        Params fewerLayouts{ test };
+        fewerLayouts.params.descriptorgroup_layouts = {};
+
+        gfx::renderstate_params const* variations[] = {
+            &otherShader.params,
+            &otherFlags.params,
+            &otherAttribute.params,
+            &otherStride.params,
+            &otherTopology.params,
+            &otherDescriptor.params,
+            &fewerLayouts.params,
+        };
+
+        gfx::renderstate_handle handles[sizeof(variations) / sizeof(variations[0])];
+        for (size_t i = 0; i < sizeof(variations) / sizeof(variations[0]); i++)
+        {
+            handles[i] = test.renderer->create_renderstate(*variations[i]);
+            CHECK(handles[i] && handles[i] != baseHandle);
+            for (size_t j = 0; j < i; j++)
+                CHECK(handles[i] != handles[j]);
+        }
+
+        CHECK(test.getBackendRenderstateCount() == 1 + sizeof(variations) / sizeof(variations[0]));
+        CHECK(test.renderer->get_renderstate_cache_statistics().hit_count == 0);
+
+        // Each variation is still shared with its identical twin
+        Params twin{ test, { .wireframe = true } };
+        CHECK(test.renderer->create_renderstate(twin.params) == handles[1]);
+
+        CHECK(test.nullBackend->get_statistics().validation_errors == 0);
+    }
+
+    void testLastReleaseDestroysTheRenderstate()
+    {
+        TestRenderer test;
+
+        Params params{ test };
+        gfx::renderstate_handle first = test.renderer->create_renderstate(params.params);
+        gfx::renderstate_handle second = test.renderer->create_renderstate(params.params);
+        CHECK(first == second);
+
+        test.renderer->destroy_renderstate(first);
+        CHECK(test.nullBackend->get_statistics().destroyed_renderstate_count == 0);
+        CHECK(test.renderer->get_renderstate_cache_statistics().unique_count == 1);
+
+        test.renderer->destroy_renderstate(second);
+        CHECK(test.nullBackend->get_statistics().destroyed_renderstate_count == 1);
+        CHECK(test.renderer->get_renderstate_cache_statistics().unique_count == 0);
+        CHECK(test.getBackendRenderstateCount() == 0);
+
+        // The description isn't shared with the destroyed renderstate anymore
+        gfx::renderstate_handle recreated = test.renderer->create_renderstate(params.params);
+        CHECK(recreated && recreated != first);
+        CHECK(test.getBackendRenderstateCount() == 1);
+
+        CHECK(test.nullBackend->get_statistics().validation_errors == 0);
+    }
+}
+
+int run(int, char**)
+{
+    testIdenticalParamsShareTheRenderstate();
+    testDifferentParamsCreateDifferentRenderstates();
+    testLastReleaseDestroysTheRenderstate();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+#include "check.h"
+
+#include "platform/startup.h"
+
+#include "resource_handles.h"
+
+#include "nstl/slot_map.h"
+#include "nstl/unique_ptr.h"
+
+// gfx_vk::resource_container keeps every resource type in a slot_map of unique_ptr and hands out encoded handles.
+// The resources themselves need a Vulkan device, so the same protocol is checked with plain values
+
+namespace
+{
+    struct Resource
+    {
+        int value = 0;
+    };
+
+    using Container = nstl::slot_map<nstl::unique_ptr<Resource>>;
+
+    gfx::buffer_handle createResource(Container& container, int value)
+    {
+        return gfx_vk::encode_handle<gfx::buffer_handle>(container.insert(nstl::make_unique<Resource>(Resource{ value })));
+    }
+
+    Resource* getResource(Container& container, gfx::buffer_handle handle)
+    {
+        nstl::unique_ptr<Resource>* resource = container.get(gfx_vk::decode_handle(handle));
+        return resource ? resource->get() : nullptr;
+    }
+
+    bool destroyResource(Container& container, gfx::buffer_handle handle)
+    {
+        return container.erase(gfx_vk::decode_handle(handle));
+    }
+
+    void testEncoding()
+    {
+        nstl::slot_map_handle const handles[] = {
+            { 0, 0 },
+            { 1, 1 },
+            { 12345, 678 },
+            { UINT32_MAX - 1, UINT32_MAX - 1 },
+        };
+
+        for (nstl::slot_map_handle handle : handles)
+        {
+            gfx::buffer_handle encoded = gfx_vk::encode_handle<gfx::buffer_handle>(handle);
+            CHECK(encoded);
+            CHECK(gfx_vk::decode_handle(encoded) == handle);
+        }
+
+        CHECK(!gfx_vk::decode_handle(gfx::buffer_handle{}));
+    }
+
+    void testStaleHandlesAreRejected()
+    {
+        Container container;
+
+        gfx::buffer_handle first = createResource(container, 1);
+        gfx::buffer_handle second = createResource(container, 2);
+        Resource* secondResource = getResource(container, second);
+
+        CHECK(destroyResource(container, first));
+        CHECK(!destroyResource(container, first));
+        CHECK(getResource(container, first) == nullptr);
+
+        // The resources are stored by pointer, so erasing another one doesn't move them
+        CHECK(getResource(container, second) == secondResource);
+        CHECK(getResource(container, second)->value == 2);
+
+        // Reuses the slot of the first resource with a new generation
+        gfx::buffer_handle third = createResource(container, 3);
+        CHECK(gfx_vk::decode_handle(third).index == gfx_vk::decode_handle(first).index);
+        CHECK(third.ptr != first.ptr);
+        CHECK(getResource(container, first) == nullptr);
+        CHECK(getResource(container, third)->value == 3);
+    }
+
+    void testTeardown()
+    {
+        constexpr int resourceCount = 1000;
+
+        Container container;
+
+        gfx::buffer_handle handles[resourceCount];
+        for (int i = 0; i < resourceCount; i++)
+            handles[i] = createResource(container, i);
+
+        for (int i = 0; i < resourceCount; i += 2)
+            CHECK(destroyResource(container, handles[i]));
+        for (int i = 1; i < resourceCount; i += 2)
+            CHECK(getResource(container, handles[i])->value == i);
+        for (int i = 1; i < resourceCount; i += 2)
+            CHECK(destroyResource(container, handles[i]));
+
+        CHECK(container.empty());
+    }
+}
+
+int run(int, char**)
+{
+    testEncoding();
+    testStaleHandlesAreRejected();
+    testTeardown();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+#include "check.h"
+
+#include "platform/startup.h"
+
+#include "nstl/slot_map.h"
+
+namespace
+{
+    void testInsertAndErase()
+    {
+        nstl::slot_map<int> map;
+
+        nstl::slot_map_handle a = map.insert(1);
+        nstl::slot_map_handle b = map.insert(2);
+        nstl::slot_map_handle c = map.insert(3);
+
+        CHECK(map.size() == 3);
+        CHECK(*map.get(a) == 1 && *map.get(b) == 2 && *map.get(c) == 3);
+
+        // The last value is moved into the hole, the handles of the other values stay valid
+        CHECK(map.erase(a));
+        CHECK(map.size() == 2);
+        CHECK(*map.get(b) == 2 && *map.get(c) == 3);
+        CHECK(map.begin()[0] == 3);
+
+        int sum = 0;
+        for (int value : map)
+            sum += value;
+        CHECK(sum == 5);
+    }
+
+    void testStaleHandlesAreRejected()
+    {
+        nstl::slot_map<int> map;
+
+        nstl::slot_map_handle handle = map.insert(1);
+        CHECK(map.erase(handle));
+
+        CHECK(!map.contains(handle));
+        CHECK(map.get(handle) == nullptr);
+        CHECK(!map.erase(handle));
+
+        CHECK(!map.contains(nstl::slot_map_handle{}));
+        CHECK(!map.contains(nstl::slot_map_handle{ 100, 0 }));
+
+        // The slot is reused with a new generation, the old handle must not see the new value
+        nstl::slot_map_handle newHandle = map.insert(2);
+        CHECK(newHandle.index == handle.index);
+        CHECK(newHandle.generation != handle.generation);
+        CHECK(map.get(handle) == nullptr);
+        CHECK(*map.get(newHandle) == 2);
+    }
+
+    void testSlotsAreReused()
+    {
+        nstl::slot_map<int> map;
+
+        nstl::slot_map_handle handles[4];
+        for (int i = 0; i < 4; i++)
+            handles[i] = map.insert(i);
+
+        CHECK(map.erase(handles[1]));
+        CHECK(map.erase(handles[3]));
+
+        nstl::slot_map_handle first = map.insert(10);
+        nstl::slot_map_handle second = map.insert(11);
+        nstl::slot_map_handle third = map.insert(12);
+
+        // The free slots are reused before new ones are added
+        CHECK((first.index == 1 && second.index == 3) || (first.index == 3 && second.index == 1));
+        CHECK(third.index == 4);
+        CHECK(map.size() == 5);
+
+        map.clear();
+        CHECK(map.empty());
+        nstl::slot_map_handle const erasedHandles[] = { first, second, third, handles[0], handles[2] };
+        for (nstl::slot_map_handle handle : erasedHandles)
+            CHECK(!map.contains(handle));
+    }
+
+    void testGenerationWrap()
+    {
+        // 2 bits for the generations, so generations 0, 1 and 2 are handed out and then the slot is retired
+        nstl::slot_map<int, 2> map;
+
+        nstl::slot_map_handle handles[3];
+        for (uint32_t generation = 0; generation < 3; generation++)
+        {
+            handles[generation] = map.insert(static_cast<int>(generation));
+            CHECK(handles[generation].index == 0);
+            CHECK(handles[generation].generation == generation);
+            CHECK(map.erase(handles[generation]));
+        }
+
+        nstl::slot_map_handle handle = map.insert(3);
+        CHECK(handle.index == 1);
+        CHECK(handle.generation == 0);
+
+        for (nstl::slot_map_handle staleHandle : handles)
+        {
+            CHECK(!map.contains(staleHandle));
+            CHECK(map.get(staleHandle) == nullptr);
+        }
+        CHECK(*map.get(handle) == 3);
+    }
+
+    // A handle with the generation a free slot will hand out next isn't valid before the slot is reused
+    void testForgedHandlesAreRejected()
+    {
+        nstl::slot_map<int> map;
+
+        nstl::slot_map_handle a = map.insert(1);
+        nstl::slot_map_handle b = map.insert(2);
+        nstl::slot_map_handle c = map.insert(3);
+        CHECK(map.erase(a));
+        CHECK(map.erase(b));
+
+        // The slot freed first ends the free list, the one freed after it links to it with a dense index which is
+        // in bounds of the values, but the value there belongs to a different slot
+        nstl::slot_map_handle const nextGenerations[] = { { a.index, a.generation + 1 }, { b.index, b.generation + 1 } };
+        for (nstl::slot_map_handle handle : nextGenerations)
+        {
+            CHECK(!map.contains(handle));
+            CHECK(map.get(handle) == nullptr);
+            CHECK(!map.erase(handle));
+        }
+        CHECK(map.size() == 1);
+        CHECK(*map.get(c) == 3);
+    }
+
+    void testRetiredSlotsAreRejected()
+    {
+        nstl::slot_map<int, 2> map;
+
+        nstl::slot_map_handle handle;
+        for (uint32_t generation = 0; generation < 3; generation++)
+        {
+            handle = map.insert(static_cast<int>(generation));
+            CHECK(map.erase(handle));
+        }
+
+        // The retired slot has the maximum generation and an invalid dense index
+        nstl::slot_map_handle retired = { handle.index, 3 };
+        CHECK(!map.contains(retired));
+        CHECK(map.get(retired) == nullptr);
+        CHECK(!map.erase(retired));
+
+        nstl::slot_map_handle other = map.insert(10);
+        CHECK(other.index != retired.index);
+        CHECK(!map.contains(retired));
+        CHECK(*map.get(other) == 10);
+    }
+}
+
+int run(int, char**)
+{
+    testInsertAndErase();
+    testStaleHandlesAreRejected();
+    testSlotsAreReused();
+    testGenerationWrap();
+    testForgedHandlesAreRejected();
+    testRetiredSlotsAreRejected();
+
+    return EXIT_SUCCESS;
+}
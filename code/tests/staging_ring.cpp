@@ -0,0 +1,134 @@
+#include "check.h"
+
+#include "gfx/staging_ring.h"
+
+#include "platform/startup.h"
+
+// The ring only does the bookkeeping, the backends map the offsets to their staging memory
+
+namespace
+{
+    void testWrapAround()
+    {
+        gfx::staging_ring ring{ 100 };
+
+        CHECK(ring.allocate(40) == 0u);
+        ring.close_batch(1);
+        CHECK(ring.allocate(40) == 40u);
+        ring.close_batch(2);
+        CHECK(ring.get_used_size() == 80);
+
+        // Only [0, 40) is free after the first batch retires, so the next allocation can't use the end of the ring
+        CHECK(!ring.allocate(30));
+        ring.retire(1);
+        CHECK(ring.get_used_size() == 40);
+
+        CHECK(ring.allocate(30) == 0u);
+        ring.close_batch(3);
+
+        // The wasted end of the ring stays in use until the batch retires
+        CHECK(ring.get_used_size() == 90);
+        CHECK(!ring.allocate(20));
+        CHECK(ring.allocate(10) == 30u);
+        ring.close_batch(4);
+
+        CHECK(!ring.allocate(1));
+        ring.retire(2);
+        CHECK(ring.get_used_size() == 60);
+        CHECK(!ring.allocate(41));
+        CHECK(ring.allocate(40) == 40u);
+        ring.close_batch(5);
+
+        ring.retire(5);
+        CHECK(ring.get_used_size() == 0);
+        CHECK(ring.get_pending_batch_count() == 0);
+
+        // An empty ring starts from the beginning again
+        CHECK(ring.allocate(100) == 0u);
+    }
+
+    void testFullRing()
+    {
+        gfx::staging_ring ring{ 64 };
+
+        CHECK(!ring.allocate(0));
+        CHECK(!ring.allocate(65));
+
+        CHECK(ring.allocate(32) == 0u);
+        CHECK(ring.allocate(32) == 32u);
+        CHECK(ring.get_used_size() == 64);
+        CHECK(!ring.allocate(1));
+        ring.close_batch(1);
+
+        ring.retire(1);
+        CHECK(ring.get_used_size() == 0);
+        CHECK(ring.allocate(64) == 0u);
+    }
+
+    void testAlignment()
+    {
+        gfx::staging_ring ring{ 100 };
+
+        CHECK(ring.allocate(5) == 0u);
+
+        // 3-byte texel formats need multiples of 3 and 4
+        CHECK(ring.allocate(6, 3) == 6u);
+        CHECK(ring.allocate(4, 12) == 12u);
+        CHECK(ring.get_used_size() == 16);
+
+        ring.close_batch(1);
+        CHECK(ring.allocate(70, 12) == 24u);
+        ring.close_batch(2);
+        ring.retire(1);
+
+        // The aligned offset doesn't fit at the end of the ring, so the allocation wraps to the beginning
+        CHECK(ring.allocate(12, 12) == 0u);
+        CHECK(ring.get_used_size() == 78 + 18);
+    }
+
+    void testBatchesRetireInTicketOrder()
+    {
+        gfx::staging_ring ring{ 100 };
+
+        for (uint64_t ticket = 1; ticket <= 4; ticket++)
+        {
+            CHECK(ring.allocate(10));
+            ring.close_batch(ticket * 10);
+        }
+        CHECK(ring.get_pending_batch_count() == 4);
+
+        // A batch without allocations isn't recorded
+        ring.close_batch(50);
+        CHECK(ring.get_pending_batch_count() == 4);
+
+        // Tickets in between complete the batches before them
+        ring.retire(25);
+        CHECK(ring.get_pending_batch_count() == 2);
+        CHECK(ring.get_used_size() == 20);
+
+        ring.retire(25);
+        CHECK(ring.get_pending_batch_count() == 2);
+
+        // Open allocations aren't retired until their batch is closed and completed
+        CHECK(ring.allocate(10));
+        CHECK(ring.has_open_allocations());
+        ring.retire(40);
+        CHECK(ring.get_pending_batch_count() == 0);
+        CHECK(ring.get_used_size() == 10);
+
+        ring.close_batch(60);
+        CHECK(!ring.has_open_allocations());
+        ring.retire(60);
+        CHECK(ring.get_used_size() == 0);
+    }
+}
+
+int run(int, char**)
+{
+    testWrapAround();
+    testFullRing();
+    testAlignment();
+    testBatchesRetireInTicketOrder();
+
+    return EXIT_SUCCESS;
+}
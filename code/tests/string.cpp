@@ -0,0 +1,240 @@
+#include "check.h"
+
+#include "platform/startup.h"
+
+#include "nstl/string.h"
+#include "nstl/string_view.h"
+#include "nstl/utility.h"
+
+#include <stdlib.h>
+
+namespace
+{
+    // 3 pointers of storage minus the tag byte
+    constexpr size_t inlineCapacity = 23;
+
+    struct AllocationCounts
+    {
+        size_t allocations = 0;
+        size_t active = 0;
+    };
+
+    struct CountingAllocator
+    {
+        AllocationCounts* counts = nullptr;
+
+        void* allocate(size_t size, size_t)
+        {
+            counts->allocations++;
+            counts->active++;
+            return malloc(size);
+        }
+
+        void deallocate(void* ptr)
+        {
+            counts->active--;
+            free(ptr);
+        }
+
+        bool operator==(CountingAllocator const& rhs) const = default;
+    };
+
+    nstl::string createString(size_t length, nstl::any_allocator alloc = {})
+    {
+        nstl::string result{ nstl::move(alloc) };
+        for (size_t i = 0; i < length; i++)
+            result.push_back(static_cast<char>('a' + i % 26));
+        return result;
+    }
+
+    bool isStoredInline(nstl::string const& str)
+    {
+        char const* object = reinterpret_cast<char const*>(&str);
+        return str.data() >= object && str.data() < object + sizeof(str);
+    }
+
+    bool hasContents(nstl::string const& str, size_t length)
+    {
+        if (str.length() != length || str.c_str()[length] != '\0')
+            return false;
+
+        for (size_t i = 0; i < length; i++)
+            if (str[i] != static_cast<char>('a' + i % 26))
+                return false;
+
+        return true;
+    }
+
+    void testInlineHeapBoundary()
+    {
+        AllocationCounts counts;
+
+        {
+            nstl::string empty{ CountingAllocator{ &counts } };
+            CHECK(empty.empty() && isStoredInline(empty));
+            CHECK(empty.capacity() == inlineCapacity);
+            CHECK(empty.c_str()[0] == '\0');
+
+            // The full inline string uses the tag byte as the null terminator
+            nstl::string full = createString(inlineCapacity, CountingAllocator{ &counts });
+            CHECK(hasContents(full, inlineCapacity));
+            CHECK(isStoredInline(full));
+            CHECK(full.capacity() == inlineCapacity);
+            CHECK(counts.allocations == 0);
+
+            full.push_back('x');
+            CHECK(!isStoredInline(full));
+            CHECK(full.capacity() >= inlineCapacity + 1);
+            CHECK(full.length() == inlineCapacity + 1 && full.back() == 'x' && full.c_str()[inlineCapacity + 1] == '\0');
+            CHECK(counts.allocations == 1);
+
+            nstl::string heap = createString(inlineCapacity + 1, CountingAllocator{ &counts });
+            CHECK(hasContents(heap, inlineCapacity + 1));
+            CHECK(!isStoredInline(heap));
+            CHECK(counts.active == 2);
+
+            char const text[] = "abcdefghijklmnopqrstuvw";
+            static_assert(sizeof(text) - 1 == inlineCapacity);
+            CHECK(isStoredInline(nstl::string{ text }));
+            CHECK(!isStoredInline(nstl::string{ nstl::string_view{ "abcdefghijklmnopqrstuvwx" } }));
+            CHECK(nstl::string{ text } == text);
+        }
+
+        CHECK(counts.active == 0);
+    }
+
+    void testCopyMoveAndSwap()
+    {
+        size_t const lengths[] = { 0, 5, inlineCapacity, inlineCapacity + 1, 100 };
+
+        for (size_t length : lengths)
+        {
+            nstl::string source = createString(length);
+
+            nstl::string copy = source;
+            CHECK(hasContents(copy, length) && hasContents(source, length));
+            CHECK(isStoredInline(copy) == (length <= inlineCapacity));
+            if (length > 0)
+                CHECK(copy.data() != source.data());
+
+            nstl::string moved = nstl::move(copy);
+            CHECK(hasContents(moved, length));
+            CHECK(copy.empty() && copy.c_str()[0] == '\0');
+
+            // The moved-from string is still usable
+            copy += "reused";
+            CHECK(copy == "reused");
+
+            for (size_t otherLength : lengths)
+            {
+                nstl::string lhs = createString(length);
+                nstl::string rhs = createString(otherLength);
+
+                nstl::exchange(lhs, rhs);
+                CHECK(hasContents(lhs, otherLength) && hasContents(rhs, length));
+                CHECK(isStoredInline(lhs) == (otherLength <= inlineCapacity));
+                CHECK(isStoredInline(rhs) == (length <= inlineCapacity));
+
+                nstl::string assigned = createString(otherLength);
+                assigned = source;
+                CHECK(hasContents(assigned, length));
+
+                assigned = createString(otherLength);
+                CHECK(hasContents(assigned, otherLength));
+
+                nstl::string const& self = assigned;
+                assigned = self;
+                CHECK(hasContents(assigned, otherLength));
+            }
+        }
+    }
+
+    void testReserveAndShrink()
+    {
+        AllocationCounts counts;
+
+        {
+            nstl::string str = createString(10, CountingAllocator{ &counts });
+
+            // Fits inline, nothing to do
+            str.reserve(inlineCapacity);
+            CHECK(isStoredInline(str) && counts.allocations == 0);
+
+            str.reserve(inlineCapacity + 1);
+            CHECK(!isStoredInline(str));
+            CHECK(str.capacity() == inlineCapacity + 1);
+            CHECK(hasContents(str, 10));
+            CHECK(counts.allocations == 1);
+
+            // The string stays on the heap and keeps its capacity when it gets shorter
+            str.resize(3);
+            CHECK(hasContents(str, 3));
+            CHECK(!isStoredInline(str));
+            CHECK(str.capacity() == inlineCapacity + 1);
+
+            str.reserve(5);
+            str.resize(0);
+            CHECK(str.empty() && str.c_str()[0] == '\0');
+            CHECK(str.capacity() == inlineCapacity + 1);
+
+            for (size_t i = 0; i < inlineCapacity + 1; i++)
+                str.push_back(static_cast<char>('a' + i % 26));
+            CHECK(hasContents(str, inlineCapacity + 1));
+            CHECK(counts.allocations == 1);
+
+            // An inline string shrinks and grows without allocating
+            nstl::string inlineString = createString(inlineCapacity, CountingAllocator{ &counts });
+            inlineString.resize(5);
+            CHECK(hasContents(inlineString, 5) && isStoredInline(inlineString));
+            CHECK(inlineString.capacity() == inlineCapacity);
+            inlineString.resize(inlineCapacity);
+            CHECK(isStoredInline(inlineString) && inlineString.length() == inlineCapacity);
+            CHECK(inlineString.c_str()[inlineCapacity] == '\0');
+            CHECK(counts.allocations == 1);
+        }
+
+        CHECK(counts.active == 0);
+    }
+
+    void testNonDefaultAllocator()
+    {
+        AllocationCounts counts;
+
+        {
+            nstl::string str = createString(1000, CountingAllocator{ &counts });
+            CHECK(hasContents(str, 1000));
+
+            // Grows geometrically
+            CHECK(counts.allocations <= 10);
+            CHECK(counts.active == 1);
+
+            // Copies use the allocator of the source, moves take the memory over
+            nstl::string copy = str;
+            CHECK(counts.active == 2);
+
+            nstl::string moved = nstl::move(copy);
+            CHECK(counts.active == 2);
+            CHECK(hasContents(moved, 1000));
+
+            // Creates a new string with the default allocator
+            nstl::string substring = str.substr(0, 50);
+            CHECK(hasContents(substring, 50));
+            CHECK(counts.active == 2);
+
+            moved += str;
+            CHECK(moved.length() == 2000);
+        }
+
+        CHECK(counts.active == 0);
+    }
+}
+
+int run(int, char**)
+{
+    testInlineHeapBoundary();
+    testCopyMoveAndSwap();
+    testReserveAndShrink();
+    testNonDefaultAllocator();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,210 @@
+#include "check.h"
+
+#include "tlsf.h"
+
+#include "platform/startup.h"
+
+#include "nstl/vector.h"
+
+#include <stdint.h>
+
+// The allocator only manages offsets, so the suballocation logic of gfx_vk::memory is tested without a Vulkan device
+
+namespace
+{
+    using gfx_vk::tlsf_allocator;
+
+    void checkEmpty(tlsf_allocator const& allocator)
+    {
+        tlsf_allocator::statistics stats = allocator.get_statistics();
+        CHECK(allocator.is_empty());
+        CHECK(stats.used_size == 0);
+        CHECK(stats.free_block_count == 1);
+        CHECK(stats.largest_free_block == allocator.get_size());
+    }
+
+    void testAllocateAndFree()
+    {
+        tlsf_allocator allocator{ 1024 };
+
+        tlsf_allocator::allocation first = allocator.allocate(100, 1);
+        tlsf_allocator::allocation second = allocator.allocate(200, 1);
+        CHECK(first && second);
+        CHECK(first.offset + 100 <= second.offset || second.offset + 200 <= first.offset);
+        CHECK(allocator.get_used_size() == 300);
+        CHECK(allocator.get_statistics().allocation_count == 2);
+
+        allocator.free(first);
+        allocator.free(second);
+        checkEmpty(allocator);
+
+        // Freeing an empty allocation is allowed
+        allocator.free({});
+        checkEmpty(allocator);
+    }
+
+    void testAlignment()
+    {
+        tlsf_allocator allocator{ 1 << 20 };
+
+        nstl::vector<tlsf_allocator::allocation> allocations;
+        for (uint64_t alignment = 1; alignment <= 4096; alignment *= 2)
+        {
+            tlsf_allocator::allocation allocation = allocator.allocate(3, alignment);
+            CHECK(allocation);
+            CHECK(allocation.offset % alignment == 0);
+            allocations.push_back(allocation);
+        }
+
+        for (tlsf_allocator::allocation allocation : allocations)
+            allocator.free(allocation);
+        checkEmpty(allocator);
+    }
+
+    // Freed neighbours are merged in any order, so the whole range can be allocated again
+    void testCoalescing()
+    {
+        constexpr uint64_t size = 4096;
+        constexpr size_t count = 16;
+
+        size_t const orders[][count] = {
+            { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+            { 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 },
+            { 1, 3, 5, 7, 9, 11, 13, 15, 0, 2, 4, 6, 8, 10, 12, 14 },
+            { 7, 8, 6, 9, 5, 10, 4, 11, 3, 12, 2, 13, 1, 14, 0, 15 },
+        };
+
+        for (auto const& order : orders)
+        {
+            tlsf_allocator allocator{ size };
+
+            tlsf_allocator::allocation allocations[count];
+            for (tlsf_allocator::allocation& allocation : allocations)
+            {
+                allocation = allocator.allocate(size / count, 1);
+                CHECK(allocation);
+            }
+            CHECK(allocator.get_used_size() == size);
+            CHECK(!allocator.allocate(1, 1));
+
+            for (size_t index : order)
+                allocator.free(allocations[index]);
+            checkEmpty(allocator);
+
+            tlsf_allocator::allocation whole = allocator.allocate(size, 1);
+            CHECK(whole && whole.offset == 0);
+            allocator.free(whole);
+        }
+    }
+
+    // The caller falls back to a different allocator (a dedicated allocation in gfx_vk::memory) when it fails
+    void testFailedAllocations()
+    {
+        tlsf_allocator allocator{ 1024 };
+
+        CHECK(!allocator.allocate(1025, 1));
+        CHECK(!allocator.allocate(UINT64_MAX, 1));
+        CHECK(!allocator.allocate(1024, 2048));
+
+        // Fragmented: enough free memory in total, but no free block is big enough
+        nstl::vector<tlsf_allocator::allocation> allocations;
+        for (size_t i = 0; i < 8; i++)
+            allocations.push_back(allocator.allocate(128, 1));
+        for (size_t i = 0; i < allocations.size(); i += 2)
+            allocator.free(allocations[i]);
+
+        CHECK(allocator.get_used_size() == 512);
+        CHECK(!allocator.allocate(256, 1));
+        CHECK(allocator.allocate(128, 1));
+
+        checkEmpty(tlsf_allocator{ 1024 });
+    }
+
+    // A new block in gfx_vk::memory is created with this size, so it has to serve the request it was made for
+    void testRequiredSize()
+    {
+        uint64_t const sizes[] = { 1, 7, 31, 32, 33, 100, 255, 256, 1000, 4097, 65537, 1000003, (uint64_t{ 1 } << 26) + 1 };
+        uint64_t const alignments[] = { 1, 4, 16, 256, 4096, 65536 };
+
+        for (uint64_t size : sizes)
+        {
+            for (uint64_t alignment : alignments)
+            {
+                uint64_t requiredSize = tlsf_allocator::get_required_size(size, alignment);
+                CHECK(requiredSize >= size + alignment - 1);
+
+                tlsf_allocator allocator{ requiredSize };
+                tlsf_allocator::allocation allocation = allocator.allocate(size, alignment);
+                CHECK(allocation);
+                CHECK(allocation.offset % alignment == 0);
+                CHECK(allocation.offset + size <= requiredSize);
+            }
+        }
+
+        // Without the rounding the block is too small for the search
+        tlsf_allocator allocator{ 1000 + 256 };
+        CHECK(!allocator.allocate(1000, 256));
+    }
+
+    void testRandomAllocations()
+    {
+        constexpr uint64_t size = 1 << 20;
+        tlsf_allocator allocator{ size };
+
+        uint64_t state = 12345;
+        auto nextRandom = [&state]()
+        {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            return state >> 33;
+        };
+
+        struct Live
+        {
+            tlsf_allocator::allocation allocation;
+            uint64_t size = 0;
+        };
+        nstl::vector<Live> live;
+
+        for (size_t i = 0; i < 20000; i++)
+        {
+            if (live.empty() || nextRandom() % 3 != 0)
+            {
+                uint64_t allocationSize = 1 + nextRandom() % 4096;
+                uint64_t alignment = uint64_t{ 1 } << (nextRandom() % 9);
+                tlsf_allocator::allocation allocation = allocator.allocate(allocationSize, alignment);
+                if (!allocation)
+                    continue;
+
+                CHECK(allocation.offset % alignment == 0);
+                CHECK(allocation.offset + allocationSize <= size);
+                for (Live const& other : live)
+                    CHECK(allocation.offset + allocationSize <= other.allocation.offset || other.allocation.offset + other.size <= allocation.offset);
+
+                live.push_back({ allocation, allocationSize });
+            }
+            else
+            {
+                size_t index = static_cast<size_t>(nextRandom() % live.size());
+                allocator.free(live[index].allocation);
+                live[index] = live.back();
+                live.pop_back();
+            }
+        }
+
+        for (Live const& allocation : live)
+            allocator.free(allocation.allocation);
+        checkEmpty(allocator);
+    }
+}
+
+int run(int, char**)
+{
+    testAllocateAndFree();
+    testAlignment();
+    testCoalescing();
+    testFailedAllocations();
+    testRequiredSize();
+    testRandomAllocations();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace tglm
+{
+    struct mat4;
+    struct aabb;
+    struct sphere;
+    struct frustum;
+
+    aabb transformed(aabb const& box, mat4 const& m);
+    sphere bounding_sphere(aabb const& box);
+
+    bool intersects(frustum const& f, aabb const& box);
+    bool intersects(frustum const& f, sphere const& s);
+}
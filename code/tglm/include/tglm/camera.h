@@ -3,7 +3,11 @@
 namespace tglm
 {
     struct mat4;
+    struct frustum;
 
     // TODO implement options (left-handed/right-handed, [0;1]/[-1;1])
     mat4 perspective(float fovy, float aspect, float nearZ, float farZ);
+
+    // Extracts the clip planes of a combined projection * view matrix; planes are in the world space
+    frustum extract_frustum(mat4 const& view_projection);
 }
@@ -15,4 +15,8 @@ namespace tglm
     struct mat2;
     struct mat3;
     struct mat4;
+
+    struct aabb;
+    struct sphere;
+    struct frustum;
 }
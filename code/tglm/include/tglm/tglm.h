@@ -1,6 +1,7 @@
 #pragma once
 
 #include "tglm/affine.h"
+#include "tglm/bounds.h"
 #include "tglm/camera.h"
 #include "tglm/types.h"
 #include "tglm/util.h"
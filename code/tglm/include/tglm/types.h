@@ -13,3 +13,7 @@
 // #include "tglm/types/mat2.h" // TODO
 // #include "tglm/types/mat3.h" // TODO
 #include "tglm/types/mat4.h"
+
+#include "tglm/types/aabb.h"
+#include "tglm/types/sphere.h"
+#include "tglm/types/frustum.h"
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "tglm/types/vec3.h"
+
+namespace tglm
+{
+    struct aabb
+    {
+        static aabb empty();
+
+        aabb() = default;
+        aabb(vec3 const& min, vec3 const& max) : min(min), max(max) {}
+
+        bool is_empty() const;
+
+        void expand(vec3 const& point);
+        void expand(aabb const& other);
+
+        vec3 center() const;
+        vec3 extents() const;
+
+        vec3 min;
+        vec3 max;
+    };
+}
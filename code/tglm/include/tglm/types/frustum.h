@@ -0,0 +1,14 @@
+#pragma once
+
+#include "tglm/types/vec4.h"
+
+namespace tglm
+{
+    // Planes are normalized and point inwards: left, right, bottom, top, near, far
+    struct frustum
+    {
+        constexpr static size_t planes_count = 6;
+
+        vec4 planes[planes_count];
+    };
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "tglm/types/vec3.h"
+
+namespace tglm
+{
+    struct sphere
+    {
+        vec3 center;
+        float radius = 0.0f;
+    };
+}
@@ -0,0 +1,45 @@
+#include "tglm/types/aabb.h"
+
+#include "cglm/vec3.h"
+
+#include "float.h"
+
+tglm::aabb tglm::aabb::empty()
+{
+    return { vec3{ FLT_MAX }, vec3{ -FLT_MAX } };
+}
+
+bool tglm::aabb::is_empty() const
+{
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+void tglm::aabb::expand(vec3 const& point)
+{
+    glm_vec3_minv(min.data, const_cast<vec3&>(point).data, min.data);
+    glm_vec3_maxv(max.data, const_cast<vec3&>(point).data, max.data);
+}
+
+void tglm::aabb::expand(aabb const& other)
+{
+    if (other.is_empty())
+        return;
+
+    expand(other.min);
+    expand(other.max);
+}
+
+tglm::vec3 tglm::aabb::center() const
+{
+    vec3 result;
+    glm_vec3_center(const_cast<vec3&>(min).data, const_cast<vec3&>(max).data, result.data);
+    return result;
+}
+
+tglm::vec3 tglm::aabb::extents() const
+{
+    vec3 result;
+    glm_vec3_sub(const_cast<vec3&>(max).data, const_cast<vec3&>(min).data, result.data);
+    glm_vec3_scale(result.data, 0.5f, result.data);
+    return result;
+}
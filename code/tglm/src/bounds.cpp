@@ -0,0 +1,57 @@
+#include "tglm/bounds.h"
+
+#include "tglm/types/aabb.h"
+#include "tglm/types/frustum.h"
+#include "tglm/types/mat4.h"
+#include "tglm/types/sphere.h"
+
+#include "cglm/box.h"
+
+tglm::aabb tglm::transformed(aabb const& box, mat4 const& m)
+{
+    if (box.is_empty())
+        return box;
+
+    cglm_vec3 source[2];
+    glm_vec3_copy(const_cast<aabb&>(box).min.data, source[0]);
+    glm_vec3_copy(const_cast<aabb&>(box).max.data, source[1]);
+
+    cglm_vec3 destination[2];
+    glm_aabb_transform(source, const_cast<mat4&>(m).data, destination);
+
+    return { vec3{ destination[0], 3 }, vec3{ destination[1], 3 } };
+}
+
+tglm::sphere tglm::bounding_sphere(aabb const& box)
+{
+    if (box.is_empty())
+        return {};
+
+    vec3 extents = box.extents();
+    return { .center = box.center(), .radius = glm_vec3_norm(extents.data) };
+}
+
+bool tglm::intersects(frustum const& f, aabb const& box)
+{
+    // Test the "positive vertex" of the box against each plane
+    for (vec4 const& plane : f.planes)
+    {
+        float x = plane.x >= 0.0f ? box.max.x : box.min.x;
+        float y = plane.y >= 0.0f ? box.max.y : box.min.y;
+        float z = plane.z >= 0.0f ? box.max.z : box.min.z;
+
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+            return false;
+    }
+
+    return true;
+}
+
+bool tglm::intersects(frustum const& f, sphere const& s)
+{
+    for (vec4 const& plane : f.planes)
+        if (plane.x * s.center.x + plane.y * s.center.y + plane.z * s.center.z + plane.w < -s.radius)
+            return false;
+
+    return true;
+}
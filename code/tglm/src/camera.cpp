@@ -1,8 +1,10 @@
 #include "tglm/camera.h"
 
+#include "tglm/types/frustum.h"
 #include "tglm/types/mat4.h"
 
 #include "cglm/cam.h"
+#include "cglm/frustum.h"
 
 tglm::mat4 tglm::perspective(float fovy, float aspect, float nearZ, float farZ)
 {
@@ -10,3 +12,14 @@ tglm::mat4 tglm::perspective(float fovy, float aspect, float nearZ, float farZ)
     glm_perspective(fovy, aspect, nearZ, farZ, result.data);
     return result;
 }
+
+tglm::frustum tglm::extract_frustum(mat4 const& view_projection)
+{
+    cglm_vec4 planes[frustum::planes_count];
+    glm_frustum_planes(const_cast<mat4&>(view_projection).data, planes);
+
+    frustum result;
+    for (size_t i = 0; i < frustum::planes_count; i++)
+        result.planes[i] = vec4{ planes[i], 4 };
+    return result;
+}